@@ -0,0 +1,86 @@
+#pragma once
+
+#include "mapped_file.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The sprites decoded once and kept on disk the way the window draws them, so a later start maps
+// them in place instead of decoding them again.
+//
+// One file for all of them: a header, a table of one entry per image keyed by a hash of its
+// encoded bytes, then the pixels of each image starting on a 64 byte boundary. An edited image
+// hashes differently and is decoded again, entries nothing asks for any more are dropped the next
+// time the file is written. Little endian, as written by the machine that decoded them.
+
+namespace Simulation {
+    // The bytes of an encoded image, a PNG, as they are in a file or a resource
+    struct AssetSource {
+        const std::uint8_t* Data;
+        std::size_t Size;
+    };
+
+    // Premultiplied B, G, R, A bytes per pixel, rows from the top without padding: what Direct2D
+    // takes as DXGI_FORMAT_B8G8R8A8_UNORM with D2D1_ALPHA_MODE_PREMULTIPLIED
+    struct AssetImage {
+        int Width = 0, Height = 0;
+        const std::uint8_t* Pixels = nullptr;
+    };
+
+    struct AssetHeader {
+        static constexpr char Signature[8] = { 'S', 'I', 'M', 'A', 'S', 'S', 'E', 'T' };
+        static constexpr std::uint32_t CurrentVersion = 1;
+        static constexpr std::size_t Alignment = 64;
+
+        char Magic[8];
+        std::uint32_t Version;
+        std::uint32_t HeaderBytes;  // The header and the table, up to the first image
+        std::uint64_t FileBytes;
+        std::uint64_t Count;
+    };
+
+    struct AssetEntry {
+        std::uint64_t Hash;         // Of the encoded bytes
+        std::uint32_t Width, Height;
+        std::uint64_t Offset;       // Bytes from the start of the file
+    };
+
+    class AssetCache {
+    public:
+        static constexpr auto DefaultPath = "res/assets.bin";
+
+        // Every source's image, in the same order. Those the cache at cachePath holds are mapped
+        // in place, the rest are decoded in parallel on the pool and the cache written again with
+        // all of them. A cache that can not be written is no error, the images then stay in
+        // memory. False with Error() set if a source is not an image it can decode.
+        bool Load(const std::vector<AssetSource>&, const std::string& cachePath, ThreadPool& = ThreadPool::Shared());
+        void Close();
+
+        const std::string& Error() const;
+        std::size_t Size() const;
+        const AssetImage& Image(std::size_t) const;
+        // Of the last Load: the images it had to decode, and whether all of them are in the file
+        std::size_t Decoded() const;
+        bool Mapped() const;
+
+        // 64 bit FNV-1a
+        static std::uint64_t Hash(const std::uint8_t*, std::size_t);
+        // Straight RGBA to premultiplied BGRA, and back for the software renderer. Back is exact
+        // up to what premultiplying rounded away.
+        static void Premultiply(const std::uint8_t* rgba, std::size_t pixels, std::uint8_t* bgra);
+        static std::vector<std::uint8_t> Straight(const AssetImage&);
+    private:
+        MappedFile file;
+        std::vector<AssetImage> images;
+        std::vector<std::vector<std::uint8_t>> pixels;  // The images not in the file
+        std::string error;
+        std::size_t decoded = 0;
+
+        // Maps the cache, false if it is not a whole one of the current version
+        bool Map(const std::string& path);
+        const AssetEntry* Find(std::uint64_t hash) const;
+        static bool Write(const std::string& path, const std::vector<std::uint64_t>& hashes, const std::vector<AssetImage>&);
+    };
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+// A 5x7 pixel font for renderers without a text engine: printable ASCII plus the few symbols
+// the info texts use (° ƒ π φ ω)
+
+namespace Simulation::BitmapFont {
+    constexpr int GlyphWidth = 5;
+    constexpr int GlyphHeight = 7;
+    // Cell size, glyph plus spacing
+    constexpr int Advance = 6;
+    constexpr int LineHeight = 9;
+
+    // GlyphHeight rows from the top, bit 4 is the leftmost column. Characters the font does not have come back as '?'.
+    const std::uint8_t* Glyph(char32_t);
+}
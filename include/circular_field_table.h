@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Simulation {
+    // The circular field from Kernel::CircularField as a table over the orbit angle. On a circular
+    // orbit the field line through the satellite is the circle through the Earth's centre, whose
+    // tangent there points along (-sin 2a, cos 2a); scaled by sqrt(1 + 3 sin^2 a) that is the
+    // kernel's result, without any quadrant branches. Neither depends on the orbit radius, and the
+    // line's radius is just RadiusTrajectory / |cos a|, so one table serves every orbit and is
+    // built once per precision. Values and slopes are stored per entry for cubic Hermite interpolation.
+    template<class T>
+    class CircularFieldTable {
+    public:
+        static constexpr std::size_t Intervals = 1024;
+
+        CircularFieldTable();
+
+        // Same outputs as Kernel::CircularField, for an angle in [0, 2 pi]
+        void Lookup(T angleRadians, T radiusTrajectory, T& directionX, T& directionY, T& radius) const {
+            auto u = angleRadians * T(Intervals / TwoPi);
+            auto i = u > T(0) ? (std::size_t)u : 0;
+            i = i < Intervals ? i : Intervals - 1;
+            auto t = u - T(i);
+
+            // Hermite basis, slopes scaled from per radian to per interval
+            auto t2 = t * t;
+            auto h00 = (T(1) + T(2) * t) * (T(1) - t) * (T(1) - t);
+            auto h10 = t * (T(1) - t) * (T(1) - t) * T(TwoPi / Intervals);
+            auto h01 = t2 * (T(3) - T(2) * t);
+            auto h11 = t2 * (t - T(1)) * T(TwoPi / Intervals);
+
+            directionX = h00 * this->directionX[i] + h10 * slopeX[i] + h01 * this->directionX[i + 1] + h11 * slopeX[i + 1];
+            directionY = h00 * this->directionY[i] + h10 * slopeY[i] + h01 * this->directionY[i + 1] + h11 * slopeY[i + 1];
+            auto c = h00 * cosine[i] - h10 * sine[i] + h01 * cosine[i + 1] - h11 * sine[i + 1];
+            radius = radiusTrajectory / (c < T(0) ? -c : c);
+        }
+
+        // Largest deviation from Kernel::CircularField in long double: absolute for the direction,
+        // relative for the line radius, over an even sweep of the orbit plus the quarter turns
+        struct Error {
+            double Direction;
+            double Radius;
+        };
+        Error Measure(std::size_t samples) const;
+    private:
+        static constexpr long double TwoPi = 6.283185307179586476925286766559l;
+
+        T directionX[Intervals + 1], directionY[Intervals + 1];
+        T slopeX[Intervals + 1], slopeY[Intervals + 1];
+        T cosine[Intervals + 1], sine[Intervals + 1];
+    };
+
+    // One per precision, built the first time it is asked for. Not at compile time: 1025 entries of
+    // sines and square roots are far past what compilers allow a constant expression by default.
+    template<class T>
+    const CircularFieldTable<T>& DefaultCircularFieldTable();
+
+    extern template class CircularFieldTable<float>;
+    extern template class CircularFieldTable<double>;
+    extern template class CircularFieldTable<long double>;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+namespace Simulation {
+    // Requests from the UI thread, applied by the simulation thread between two ticks, so the
+    // simulation state only ever has one writer
+    struct Command {
+        enum class Type {
+            ChangePeriod,   // By Value seconds, ignored if the period would not stay positive
+            ScaleTimeWarp,  // By a factor of Value, clamped by the clock
+            ToggleTelemetry,// Starts or stops recording every tick, Value unused
+            ToggleFieldModel,// Field directions from the spherical harmonic model or the circular table, Value unused
+            TogglePause,    // Replay only, Value unused
+            Seek            // Replay only, by Value seconds of simulated time
+        };
+
+        Type Kind;
+        double Value;
+    };
+
+    class CommandQueue {
+    public:
+        // Any thread
+        void Post(Command command) {
+            std::lock_guard lock(mutex);
+            pending.push_back(command);
+        }
+
+        // The simulation thread. Valid until the next call.
+        const std::vector<Command>& Take() {
+            taken.clear();
+            std::lock_guard lock(mutex);
+            taken.swap(pending);
+            return taken;
+        }
+    private:
+        std::mutex mutex;
+        std::vector<Command> pending;
+        std::vector<Command> taken;
+    };
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "precision.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Simulation {
+    template<class T>
+    struct EarthState;
+    template<class T>
+    class BasicConstellation;
+
+    // Two objects no further apart than the screening distance, First < Second
+    template<class T>
+    struct Conjunction {
+        std::uint32_t First, Second;
+        T Distance;
+    };
+
+    struct ConjunctionStats {
+        std::size_t Objects = 0;
+        std::size_t Screened = 0;       // Left after the radial prefilter
+        std::size_t Cells = 0;
+        std::size_t Candidates = 0;     // Pairs in neighbouring cells whose distance was computed
+        std::size_t Conjunctions = 0;
+    };
+
+    // Close approach screening of many objects at one instant, in near linear time.
+    // Each object also has the band of distances from the Earth's center its orbit can reach:
+    // objects whose band lies under the Earth's surface are left out, and pairs whose bands are
+    // further apart than the screening distance can never meet, so are never measured.
+    // The rest are counting sorted into a uniform grid of cells at least the screening distance
+    // wide, rebuilt every call into the buffers of the last one, and every cell is compared with
+    // itself and its forward neighbours, in bands of rows spread over a thread pool.
+    // Explicitly instantiated for float, double and long double in conjunction.cpp.
+    template<class T>
+    class BasicConjunctionScreen {
+    public:
+        // Past this the cells are made wider than the screening distance
+        static constexpr std::size_t MaxCells = std::size_t(1) << 22;
+
+        // Pairs sorted by First, then Second, whatever the number of threads
+        const std::vector<Conjunction<T>>& Screen(const T* x, const T* y, const T* minRadius, const T* maxRadius, std::size_t count,
+                                                  T surfaceRadius, T distance, ThreadPool& = ThreadPool::Shared());
+        // Circular orbits: the band is the trajectory radius, the surface the Earth's radius
+        const std::vector<Conjunction<T>>& Screen(const BasicConstellation<T>&, const EarthState<T>&, T distance, ThreadPool& = ThreadPool::Shared());
+
+        const std::vector<Conjunction<T>>& Conjunctions() const;
+        const ConjunctionStats& Stats() const;
+    private:
+        // The screened objects in cell order
+        std::vector<std::uint32_t> index;
+        std::vector<T> x, y, minRadius, maxRadius;
+        std::vector<std::uint32_t> cellOf;
+        std::vector<std::uint32_t> cellStart;   // Cells + 1 offsets into the cell order
+        std::size_t columns = 0, rows = 0;
+
+        std::vector<std::vector<Conjunction<T>>> bandFound;
+        std::vector<std::size_t> bandCandidates;
+        std::vector<Conjunction<T>> found;
+        ConjunctionStats stats;
+
+        void Build(const T* x, const T* y, const T* minRadius, const T* maxRadius, std::size_t count, T surfaceRadius, T distance);
+        void SearchRows(std::size_t band, std::size_t firstRow, std::size_t lastRow, T distance);
+    };
+
+    using ConjunctionScreen = BasicConjunctionScreen<Scalar>;
+
+    extern template class BasicConjunctionScreen<float>;
+    extern template class BasicConjunctionScreen<double>;
+    extern template class BasicConjunctionScreen<long double>;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core.h"
+#include "precision.h"
+#include <cstddef>
+#include <vector>
+
+namespace Simulation {
+    template<class T>
+    struct EarthState;
+    template<class T>
+    class BasicSphericalHarmonicField;
+
+    // Many satellites on circular orbits around the same Earth, stored as one contiguous
+    // array per field so the bulk update streams through memory linearly.
+    // Explicitly instantiated for float, double and long double in constellation.cpp.
+    template<class T>
+    class BasicConstellation {
+    public:
+        // Orbit
+        std::vector<T> RadiusTrajectory;
+        std::vector<T> PeriodSeconds;
+        std::vector<PhaseScalar<T>> PhaseOffset; // Fraction of a turn at simulated time zero
+        std::vector<T> AngleDegrees, AngleRadians;
+        // Location
+        std::vector<T> X, Y;
+        // Axes
+        std::vector<T> RadialDirectionX, RadialDirectionY;
+        std::vector<T> TangentDirectionX, TangentDirectionY;
+        // Circular magnetic field
+        std::vector<T> FieldDirectionX, FieldDirectionY;
+        std::vector<T> FieldRadius;
+        // When set, the field directions come from this model instead, the radii still from the table
+        const BasicSphericalHarmonicField<T>* FieldModel = nullptr;
+
+        static constexpr std::size_t BytesPerSatellite = 13 * sizeof(T) + sizeof(PhaseScalar<T>);
+
+        std::size_t Size() const;
+        void Reserve(std::size_t);
+        void Clear();
+
+        // Returns the index of the new satellite. The angle is the one at simulated time zero.
+        std::size_t Add(T radiusTrajectory, T periodSeconds, T angleRadians);
+
+        // Change a period at the given simulated time, keeping the satellite's current angle
+        void SetPeriod(std::size_t index, T periodSeconds, PhaseScalar<T> timeSeconds);
+
+        // Recompute the locations, the axes and the fields from the current angles
+        void Update(const EarthState<T>& earth);
+        // Move every satellite to where it is at the given simulated time
+        void Propagate(PhaseScalar<T> timeSeconds, const EarthState<T>& earth);
+    private:
+        void UpdateAngles(PhaseScalar<T> timeSeconds);
+        // Locations and axes, vectorized
+        void UpdateOrbits(const EarthState<T>& earth);
+        // From the compile time table, a fetch per satellite
+        void UpdateCircularFields(const EarthState<T>& earth);
+    };
+
+    using Constellation = BasicConstellation<Scalar>;
+
+    extern template class BasicConstellation<float>;
+    extern template class BasicConstellation<double>;
+    extern template class BasicConstellation<long double>;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cmath>
+#include <chrono>
+
+namespace Simulation {
+    constexpr auto PI = 3.141592653589793l;
+
+    using Timepoint = std::chrono::high_resolution_clock::time_point;
+
+    static inline auto Now() {
+        return std::chrono::high_resolution_clock::now();
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+namespace Simulation {
+    // Ordered from the narrowest to the widest, so they can be compared
+    enum class InstructionSet {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    // The widest instruction set both the CPU and the build support
+    InstructionSet DetectInstructionSet();
+
+    bool IsSupported(InstructionSet);
+
+    const char* ToString(InstructionSet);
+}
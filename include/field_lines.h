@@ -0,0 +1,62 @@
+#pragma once
+
+#include "field_map.h"
+#include <cstdint>
+#include <vector>
+
+namespace Simulation {
+    // Laid out like D2D1_POINT_2F, so a line can be handed to a geometry sink as is
+    struct FieldLinePoint {
+        float X;
+        float Y;
+    };
+
+    // Polylines packed back to back: line i is Points[Offsets[i]] up to Points[Offsets[i + 1]]
+    struct FieldLineSet {
+        std::vector<FieldLinePoint> Points;
+        std::vector<std::uint32_t> Offsets;
+        // Bumped by Clear, so a renderer can tell when a geometry built from the points is stale
+        std::uint64_t Generation = 0;
+
+        std::size_t Lines() const;
+        const FieldLinePoint* Line(std::size_t, std::size_t& count) const;
+        void Clear();
+    };
+
+    struct FieldLineSettings {
+        std::size_t Lines = 24;         // Split evenly between both sides of the planet
+        float InnerShell = 1.25f;       // Apex of the innermost line, in planet radii
+        float Tolerance = 0.001f;       // Local error per step, px
+        float MinStep = 0.25f;          // px
+        float MaxStep = 64.0f;          // px
+        std::size_t MaxPoints = 4096;   // Per line
+        // Lines stop once they leave this rectangle, screen px
+        float Left = 0;
+        float Top = 0;
+        float Right = 0;
+        float Bottom = 0;
+
+        bool operator==(const FieldLineSettings&) const = default;
+    };
+
+    // Traces dipole field lines with an adaptive Bogacki-Shampine (RK23) integrator, one seed per
+    // pool task. The family of lines only changes with the field or the settings, so it is kept
+    // and handed back unchanged until one of them does.
+    class FieldLineTracer {
+    public:
+        const FieldLineSet& Trace(const DipoleField&, const FieldLineSettings&, ThreadPool& = ThreadPool::Shared());
+
+        // The line through one point, both ways until it meets the planet or leaves the rectangle.
+        // Not cached, it moves with the satellite.
+        void TraceThrough(const DipoleField&, const FieldLineSettings&, float x, float y, FieldLineSet&) const;
+
+        // Bumped every time Trace has to trace again, for callers that derive something from the lines
+        std::uint64_t Generation() const;
+    private:
+        DipoleField field;
+        FieldLineSettings settings;
+        FieldLineSet lines;
+        std::vector<std::vector<FieldLinePoint>> perSeed;
+        std::uint64_t generation = 0;
+    };
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "aligned_allocator.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <vector>
+
+namespace Simulation {
+    // A dipole magnetic field in screen space. With no tilt the moment points down the screen,
+    // like the Earth's, which gives the same field as MagneticFields::Circular.
+    struct DipoleField {
+        float CenterX = 0;
+        float CenterY = 0;
+        float Radius = 1;      // px, the field is zero inside
+        float Strength = 1;    // On the magnetic equator at Radius
+        float Tilt = 0;        // Of the magnetic axis from vertical, radians, counterclockwise
+
+        bool operator==(const DipoleField&) const = default;
+
+        // Unit moment, y up
+        void Moment(float& x, float& y) const;
+        // Field at a screen point, y up like the rest of the field code
+        void At(float x, float y, float& bx, float& by) const;
+        // The tilt that turns the field at a screen point along bx, by, y up, so that the line
+        // traced through the point follows the direction another model gives there
+        float TiltAlong(float x, float y, float bx, float by) const;
+    };
+
+    // A rectangle of screen space, sampled at the centres of Columns x Rows cells
+    struct FieldMapDomain {
+        float Left = 0;
+        float Top = 0;
+        float Right = 0;
+        float Bottom = 0;
+        std::size_t Columns = 0;
+        std::size_t Rows = 0;
+
+        float CellWidth() const;
+        float CellHeight() const;
+    };
+
+    // The field over a whole domain, as three dense row-major float planes. Evaluated in square
+    // tiles spread over a thread pool, each tile row by the vector dipole kernel.
+    class FieldMap {
+    public:
+        static constexpr std::size_t TileSize = 64;
+
+        FieldMapDomain Domain;
+        AlignedVector<float> X;
+        AlignedVector<float> Y;
+        AlignedVector<float> Magnitude;
+
+        void Evaluate(const DipoleField&, const FieldMapDomain&, ThreadPool& = ThreadPool::Shared());
+
+        std::size_t Cells() const;
+        std::size_t Tiles() const;
+
+        // Bilinear between cell centres, clamped to the outermost ones. False outside the domain.
+        bool Sample(float x, float y, float& bx, float& by, float& magnitude) const;
+    private:
+        void EvaluateTile(const DipoleField&, std::size_t tile);
+    };
+}
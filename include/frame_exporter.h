@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Simulation {
+    enum class ExportFormat {
+        // One numbered file per frame
+        Png,
+        // Raw 4:2:0 video in a single stream
+        Y4m
+    };
+
+    // What Submit does when every slot is still waiting for an encoder
+    enum class Backpressure {
+        // Give up the frame, for a window that must keep its frame rate
+        Drop,
+        // Wait for a slot, for offline renders that must not lose a frame
+        Wait
+    };
+
+    struct FrameExportSettings {
+        ExportFormat Format = ExportFormat::Y4m;
+        // The Y4M file, or the beginning of the PNG names: Path + "000042.png"
+        std::string Path;
+        int Width = 0, Height = 0;
+        double FramesPerSecond = 60.0;
+        Simulation::Backpressure Backpressure = Simulation::Backpressure::Drop;
+        // Frames copied but not yet encoded
+        std::size_t Slots = 8;
+        // 0 means one per hardware thread
+        unsigned Workers = 0;
+    };
+
+    struct FrameExportStats {
+        std::uint64_t Submitted = 0;
+        std::uint64_t Written = 0;
+        std::uint64_t Dropped = 0;
+        // Submits that found no free slot and waited for one
+        std::uint64_t Stalls = 0;
+        double StallSeconds = 0;
+        // Most frames ever queued at once, out of the slots
+        std::size_t PeakQueued = 0;
+        std::uint64_t Bytes = 0;
+        // Summed over the workers, excluding the writes
+        double EncodeSeconds = 0;
+        bool Failed = false;
+    };
+
+    // Writes rendered frames to disk behind the renderer's back. Submit copies a frame into one of
+    // a fixed ring of slots allocated up front and returns; dedicated workers convert and encode
+    // the slots and write them out, Y4M frames in the order they were submitted. The only thing
+    // the submitting thread ever waits for is the slot lock, or a free slot under Backpressure::Wait.
+    class FrameExporter {
+    public:
+        explicit FrameExporter(const FrameExportSettings&);
+        ~FrameExporter();
+
+        FrameExporter(const FrameExporter&) = delete;
+        FrameExporter& operator=(const FrameExporter&) = delete;
+
+        // Opening the Y4M file failed
+        bool Failed() const;
+
+        // R, G, B, A bytes per pixel in rows of Width, as SoftwareRenderer::Pixels. False if the
+        // frame was dropped.
+        bool Submit(const std::uint8_t* rgba);
+        // Encodes what is left, stops the workers and closes the file. Later submits are dropped.
+        void Finish();
+
+        FrameExportStats Stats() const;
+    private:
+        struct Job {
+            std::size_t Slot;
+            std::uint64_t Index;
+        };
+
+        FrameExportSettings settings;
+        std::size_t frameBytes;
+        std::vector<std::vector<std::uint8_t>> slots;
+        std::vector<std::thread> workers;
+        std::FILE* file;
+
+        mutable std::mutex mutex;
+        std::condition_variable queued, freed;
+        // Slot indices, used as a stack
+        std::vector<std::size_t> freeSlots;
+        // Ring of jobs, at most one per slot
+        std::vector<Job> jobs;
+        std::size_t head, count;
+        std::uint64_t nextIndex;
+        bool stopping;
+        FrameExportStats stats;
+
+        // Y4M frames go to the file strictly in order
+        std::mutex writeMutex;
+        std::condition_variable written;
+        std::uint64_t nextWrite;
+
+        void WorkerLoop();
+        void Encode(const std::uint8_t* rgba, std::vector<std::uint8_t>& out) const;
+        bool Write(std::uint64_t index, const std::vector<std::uint8_t>& data);
+    };
+
+    // Straight RGBA to limited range BT.709 Y'CbCr 4:2:0, each chroma sample from the average of
+    // its 2 x 2 pixels. The planes follow each other in out: Y, Cb, Cr.
+    void ConvertToYuv420(const std::uint8_t* rgba, int width, int height, std::uint8_t* out);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "frame_exporter.h"
+#include "scene.h"
+#include "snapshot.h"
+#include "software_renderer.h"
+#include "thread_pool.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Simulation {
+    struct FrameRecorderStats {
+        std::uint64_t Submitted = 0;
+        std::uint64_t Drawn = 0;
+        // Snapshots given up because the ones before them were still being drawn
+        std::uint64_t Dropped = 0;
+        double DrawSeconds = 0;
+        FrameExportStats Export;
+    };
+
+    // Records the window's frames without drawing them on the window's thread. Submit copies the
+    // snapshot, a few hundred bytes, into a short queue and returns; a thread of the recorder's own
+    // draws each one again with the software renderer, on a pool of its own, and hands the pixels
+    // to the exporter, waiting for its encoders rather than losing a drawn frame. When drawing
+    // falls behind, Submit drops snapshots instead of waiting.
+    class FrameRecorder {
+    public:
+        // Snapshots waiting to be drawn
+        static constexpr std::size_t QueueLength = 2;
+
+        // The exporter's Backpressure is ignored, drawn frames always wait for an encoder.
+        // rasterThreads as ThreadPool takes it.
+        explicit FrameRecorder(const FrameExportSettings&, unsigned rasterThreads = 0);
+        ~FrameRecorder();
+
+        FrameRecorder(const FrameRecorder&) = delete;
+        FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+        bool Failed() const;
+
+        // As SoftwareRenderer takes it, for the snapshots drawn from now on
+        void SetBitmap(BitmapId, int width, int height, std::vector<std::uint8_t> rgba);
+        // refreshHud as Scene::Draw takes it. False if the snapshot was dropped.
+        bool Submit(const Snapshot&, bool refreshHud);
+        // Later submits are dropped. What is queued is drawn, encoded and written out on the
+        // recorder's thread; Stop returns at once, Finish waits for it.
+        void Stop();
+        void Finish();
+        // Stopped and everything written out
+        bool Finished() const;
+
+        FrameRecorderStats Stats() const;
+    private:
+        struct Pending {
+            Snapshot Frame;
+            bool RefreshHud;
+        };
+        struct Bitmap {
+            BitmapId Id;
+            int Width, Height;
+            std::vector<std::uint8_t> Rgba;
+        };
+
+        ThreadPool pool;
+        SoftwareRenderer renderer;
+        Scene scene;
+        FrameExporter exporter;
+
+        mutable std::mutex mutex;
+        std::condition_variable queued;
+        // Ring of snapshots
+        Pending pending[QueueLength];
+        std::size_t head, count;
+        // Handed to the renderer before the next draw
+        std::vector<Bitmap> bitmaps;
+        bool stopping;
+        bool finished;
+        FrameRecorderStats stats;
+        std::thread thread;
+
+        void DrawLoop();
+    };
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace Simulation {
+    // How late a scheduler woke up for its deadlines
+    class JitterStats {
+    public:
+        // Lateness is kept in 1 us buckets up to FineMicroseconds, in 100 us buckets from there up
+        // to CoarseMicroseconds and anything later in one overflow bucket
+        static constexpr std::size_t FineMicroseconds = 1000;
+        static constexpr std::size_t CoarseMicroseconds = 100000;
+        static constexpr std::size_t CoarseBucket = 100;
+        static constexpr std::size_t Buckets = FineMicroseconds + (CoarseMicroseconds - FineMicroseconds) / CoarseBucket + 1;
+
+        void Record(std::chrono::nanoseconds lateness);
+        void Reset();
+
+        std::uint64_t Count() const;
+        double MeanMicroseconds() const;
+        double DeviationMicroseconds() const;
+        double MaxMicroseconds() const;
+        // Upper edge of the bucket the fraction falls into
+        double PercentileMicroseconds(double fraction) const;
+    private:
+        std::uint64_t count = 0;
+        double sum = 0;
+        double squares = 0;
+        double max = 0;
+        std::array<std::uint32_t, Buckets> histogram = {};
+    };
+
+    // Wakes a thread at a fixed rate against absolute deadlines: the n-th deadline is start + n
+    // periods, so neither the work done in between nor a late wake-up can add up into drift.
+    // Waits by sleeping until shortly before the deadline and spinning the rest; the spin margin
+    // follows how far the sleeps actually overshoot. A deadline missed by more than a whole
+    // period is skipped instead of run back to back.
+    //
+    // Wait is the only part that touches the real clock, the rest takes the time as a parameter
+    // and can be driven by made-up timestamps.
+    class FrameScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+        static constexpr auto MinSpin = std::chrono::microseconds(200);
+        static constexpr auto MaxSpin = std::chrono::microseconds(4000);
+
+        explicit FrameScheduler(double hertz);
+
+        std::chrono::nanoseconds Period() const;
+        // Takes effect from the next deadline on
+        void SetRate(double hertz);
+
+        // The first deadline is one period after start
+        void Start(Clock::time_point start);
+        Clock::time_point Deadline() const;
+
+        // The deadline was reached at now: records how late, moves on to the next deadline still
+        // ahead of now and returns how many were skipped on the way
+        std::uint64_t Arrive(Clock::time_point now);
+        // Arrives if the deadline has passed, for rates polled from another loop
+        bool Due(Clock::time_point now);
+        // Blocks until the deadline, then arrives
+        std::uint64_t Wait();
+
+        const JitterStats& Stats() const;
+        // Deadlines skipped since the last ResetStats
+        std::uint64_t Missed() const;
+        void ResetStats();
+
+        std::chrono::nanoseconds SpinMargin() const;
+    private:
+        std::chrono::nanoseconds period;
+        Clock::time_point deadline;
+        JitterStats stats;
+        std::uint64_t missed;
+        std::chrono::nanoseconds spin;
+    };
+}
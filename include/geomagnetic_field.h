@@ -0,0 +1,63 @@
+#pragma once
+
+#include "precision.h"
+#include "orbit_kernel.h"
+#include <cstddef>
+#include <string>
+
+namespace Simulation {
+    template<class T>
+    struct EarthState;
+
+    // Schmidt semi-normalized Gauss coefficients of a planet's internal field, in nT, like IGRF's
+    struct GaussCoefficients {
+        static constexpr int MaxDegree = Kernel::MaxHarmonicDegree;
+
+        int Degree = 0;     // Highest degree with a coefficient
+        double G[MaxDegree + 1][MaxDegree + 1] = {};
+        double H[MaxDegree + 1][MaxDegree + 1] = {};
+
+        // A text file of "g n m value" and "h n m value" lines, '#' starting a comment. False if the
+        // file can not be read or a line is not one of those; degrees past MaxDegree are skipped.
+        bool Load(const std::string& path);
+
+        // The field of a dipole along the axis only, the one the circular field tables describe
+        static GaussCoefficients AxialDipole(double g10);
+    };
+
+    // A spherical harmonic model of the planet's field in the plane of the orbits, the meridian
+    // through the planet's center at a fixed longitude. Everything that does not depend on where a
+    // satellite is, the coefficients combined with the cosines and sines of the longitude and the
+    // factors of the Legendre recurrence, is computed once here, so the per satellite work left to
+    // Kernel::HarmonicField is the recurrence itself, vectorized over the constellation.
+    // Explicitly instantiated for float, double and long double in geomagnetic_field.cpp.
+    template<class T>
+    class BasicSphericalHarmonicField {
+    public:
+        // Truncated to the degree, and to what the coefficients have. The longitude is the one of
+        // the +x half of the plane.
+        BasicSphericalHarmonicField(const GaussCoefficients&, int degree = GaussCoefficients::MaxDegree, double longitudeRadians = 0);
+
+        int Degree() const;
+
+        // nT at (x, y) in planet radii from the center, y up, on the scalar path
+        void At(T x, T y, T& bx, T& by) const;
+        // Field directions of satellites [0, n) at screen locations around the Earth, scaled like
+        // CircularField: the model's dipole part alone is 1 on the equator and 2 over the poles,
+        // whatever the distance. y up.
+        void Directions(const EarthState<T>&, const T* x, const T* y, T* directionX, T* directionY, std::size_t n) const;
+    private:
+        static constexpr int Size = (GaussCoefficients::MaxDegree + 1) * (GaussCoefficients::MaxDegree + 2) / 2;
+
+        int degree;
+        T terms[Size];
+        T recurrenceA[Size], recurrenceB[Size];
+        T normalization;    // 1 / the dipole strength
+    };
+
+    using SphericalHarmonicField = BasicSphericalHarmonicField<Scalar>;
+
+    extern template class BasicSphericalHarmonicField<float>;
+    extern template class BasicSphericalHarmonicField<double>;
+    extern template class BasicSphericalHarmonicField<long double>;
+}
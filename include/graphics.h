@@ -1,13 +1,24 @@
 #pragma once
 
 #include "main.h"
+#include "renderer.h"
+#include "scene.h"
+#include "frame_recorder.h"
+#include "asset_cache.h"
 #include <wincodec.h>
 #include <dwrite.h>
 
+#include <future>
+#include <memory>
 #include <string>
 
 namespace Simulation {
-    class Graphics {
+    // The Direct2D renderer of the window: bitmaps from the resources, strokes and text through
+    // DirectWrite. What goes on screen is decided by Scene, shared with the software renderer.
+    //
+    // The bitmaps are decoded on other threads while Direct2D and DirectWrite start up, through the
+    // asset cache so only the first start decodes at all, and through WIC if that fails.
+    class Graphics : public Renderer {
     private:
         // Default font
         static constexpr auto DefaultFontFamily = L"Comic Sans MS";
@@ -15,12 +26,18 @@ namespace Simulation {
         static constexpr auto DefaultFontStyle = DWRITE_FONT_STYLE_NORMAL;
         static constexpr auto DefaultFontStretch = DWRITE_FONT_STRETCH_NORMAL;
         static constexpr auto DefaultFontSize = 36.0f;
-        static constexpr auto DefaultTextColor = D2D1::ColorF::DarkGray;
 
-        // Satellite trajectory line
-        static constexpr auto SatelliteTrajectoryLineWidth = 10.0f;
-        static constexpr auto SatelliteTrajectoryLineColor = D2D1::ColorF::Gray;
-        static constexpr auto SatelliteTrajectoryLineDashStyle = D2D1_DASH_STYLE_DASH;
+        // Dash style of StrokeStyle::Dashed
+        static constexpr auto DashedLineDashStyle = D2D1_DASH_STYLE_DASH;
+
+        // Text layouts kept for the constant beginnings of strings, see Renderer::DrawString
+        static constexpr std::size_t PrefixCacheSize = 16;
+
+        // Path geometries kept for the polyline sets drawn most recently, rebuilt when a set changes
+        static constexpr std::size_t PolylineCacheSize = 4;
+
+        // Where Recording writes the window's frames to, next to the executable's working directory
+        static constexpr auto RecordingPath = "recording.y4m";
 
         HRESULT hResult;
         struct {
@@ -31,62 +48,72 @@ namespace Simulation {
             IDWriteFactory* dWriteFactory;
             IDWriteTextFormat* textFormatDefault;
             ID2D1SolidColorBrush* brush;
-            ID2D1StrokeStyle* strokeStyleSatelliteTrajectoryLine;
+            ID2D1StrokeStyle* strokeStyleDashed;
             ID2D1StrokeStyle* strokeStyleArrow;
-            IDWriteTextLayout* textLayoutPeriod;
-            IDWriteTextLayout* textLayoutFrequency;
-            IDWriteTextLayout* textLayoutAngularSpeed;
-            IDWriteTextLayout* textLayoutCircularMagneticField;
-            IDWriteTextLayout* textLayoutRadialAxis;
-            IDWriteTextLayout* textLayoutTangentAxis;
+            ID2D1BitmapRenderTarget* layerTarget;
         } d2d1;
 
-        float textLayoutCircularMagneticFieldOffsetX;
-        float textLayoutCircularMagneticFieldOffsetY;
-        float textLayoutRadialAxisOffsetX;
-        float textLayoutRadialAxisOffsetY;
-        float textLayoutTangentAxisOffsetX;
-        float textLayoutTangentAxisOffsetY;
+        // The window, or the static layer's bitmap between BeginLayer and EndLayer
+        ID2D1RenderTarget* target;
+        Color background;
+        std::uint64_t layerKey;
+        bool layerValid;
+
+        struct PolylineGeometry {
+            const FieldLineSet* Lines;
+            std::uint64_t Generation;
+            ID2D1PathGeometry* Geometry;
+        };
+        PolylineGeometry polylines[PolylineCacheSize];
+        std::size_t nextPolyline;
+
+        struct PrefixLayout {
+            std::wstring Text;
+            IDWriteTextLayout* Layout;
+            float Width;
+        };
+        PrefixLayout prefixes[PrefixCacheSize];
+        std::size_t nextPrefix;
+
+        Scene scene;
+
+        // The resources' images in the order of BitmapId, and the same in straight RGBA for the
+        // recorder, empty if they did not load
+        AssetCache assets;
+        std::vector<std::vector<std::uint8_t>> recordingSprites;
+        // True once they are loaded. After what the loading task writes to: destroyed first, it
+        // waits for the task while those are still there.
+        std::future<bool> assetsLoaded;
 
+        // While Recording: the frames drawn again in memory and written out, off this thread
+        std::unique_ptr<FrameRecorder> recorder;
+        // The last recording, stopped but still being written out
+        std::unique_ptr<FrameRecorder> finishing;
+
+        void StartLoadingAssets();
         void CreateFactory();
         void CreateRenderTarget(HWND);
         void LoadModules(); 
         void CreateDWriteFactory();
         void CreateDefaultTextFormat();
         void CreateBrush();
-        void CreateSatelliteTrajectoryLineStrokeStyle();
+        void CreateDashedStrokeStyle();
         void CreateArrowStrokeStyle();
-        void CreateTextLayouts();
-
-        void DrawEarth() const;
-        void DrawTrajectory() const;
-        void DrawMagneticFieldsLines() const;
-        void DrawSatellite() const;
-        void DrawAxes() const;
-        void DrawMagneticFieldsDirections() const;
-        void DrawInfo() const;
 
         IWICImagingFactory* CreateWICFactory();
         void LoadEarthModule(IWICImagingFactory*);
         void LoadSatelliteModule(IWICImagingFactory*);
         void LoadBitmapFromResource(IWICImagingFactory*, int, ID2D1Bitmap**);
+        void CreateBitmapFromAsset(const AssetImage&, ID2D1Bitmap**);
         const std::pair<void*, DWORD> GetResourcePointerAndSize(int);
-        void DrawMagneticFieldLinesCircular() const;
-        void DrawRadialAxis() const;
-        void DrawTangentAxis() const;
-        void DrawMagneticFieldDirectionCircular() const;
-        void CreateTextLayout(std::wstring, IDWriteTextLayout**);
-        void UpdateTextLayoutPeriod();
-        void UpdateTextLayoutFrequency();
-        void UpdateTextLayoutAngularSpeed();
-        void CreateTextLayoutCircularMagneticField();
-        void CreateTextLayoutRadialAxis();
-        void CreateTextLayoutTangentAxis();
-
-        void DrawInfoAngle(float, float) const;
-        void DrawInfoPeriod(float, float) const;
-        void DrawInfoFrequency(float, float) const;
-        void DrawInfoAngularSpeed(float, float) const;
+        void TakeSnapshot();
+        void Record(bool refreshHud);
+        ID2D1PathGeometry* GetPolylineGeometry(const FieldLineSet&);
+        ID2D1PathGeometry* CreatePolylineGeometry(const FieldLineSet&);
+        IDWriteTextLayout* GetPrefixLayout(std::wstring_view, float& width);
+        ID2D1StrokeStyle* GetStrokeStyle(StrokeStyle) const;
+        void SetBrushColor(Color) const;
+        bool DrawLayer();
 
         template<class T>
         void SafeRelease(T**) const;
@@ -94,8 +121,23 @@ namespace Simulation {
         Graphics(HWND);
         ~Graphics();
 
-        void Draw();
-        void UpdateTextLayouts();
+        // refreshHud: the angle text takes the new angle this frame
+        void Draw(bool refreshHud);
+
+        int Width() const override;
+        int Height() const override;
+
+        void BeginFrame(Color background) override;
+        void EndFrame() override;
+        bool BeginLayer(std::uint64_t key) override;
+        bool EndLayer() override;
+
+        void DrawBitmap(BitmapId, float centerX, float centerY, float size, float rotationDegrees) override;
+        void DrawEllipse(float centerX, float centerY, float radiusX, float radiusY, const Stroke&) override;
+        void DrawLine(float x1, float y1, float x2, float y2, const Stroke&) override;
+        void DrawPolylines(const FieldLineSet&, const Stroke&) override;
+        void DrawString(std::wstring_view, std::size_t prefixLength, float x, float y, Color) override;
+        void MeasureString(std::wstring_view, float& width, float& height) override;
 
         const ID2D1Bitmap* const GetEarthBitmap() const;
         const ID2D1Bitmap* const GetSatelliteBitmap() const;
@@ -103,7 +145,4 @@ namespace Simulation {
         bool Success() const;
         bool Failure() const;
     };
-
-    extern long double FieldLinesWidth;
-    extern long double BaseArrowLength, BaseArrowWidth;
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace Simulation {
+    // One line of the info text in a fixed buffer. The prefix ("φ = ", "T = ", ...) is written
+    // once and kept, every frame only rewrites what follows it, with numbers formatted by
+    // std::to_chars: drawing the info texts never touches the heap. Whatever does not fit is cut off.
+    class HudLine {
+    public:
+        static constexpr std::size_t Capacity = 96;
+
+        // Without a prefix
+        HudLine();
+        explicit HudLine(std::wstring_view prefix);
+
+        // Back to just the prefix
+        HudLine& Reset();
+        HudLine& Append(std::wstring_view);
+        // ASCII, widened
+        HudLine& Append(std::string_view);
+        // Fixed notation, the same digits std::to_wstring gives with the default precision of 6
+        HudLine& Append(double, int precision = 6);
+
+        std::wstring_view Text() const;
+        std::size_t PrefixLength() const;
+    private:
+        wchar_t text[Capacity];
+        std::size_t prefixLength;
+        std::size_t length;
+    };
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "precision.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Simulation {
+    template<class T>
+    struct OrbitalElements {
+        T SemiMajorAxis;       // a, px
+        T Eccentricity;        // e, [0, MaxEccentricity]
+        T ArgumentOfPeriapsis; // omega, radians counterclockwise from the +x axis
+        T MeanAnomalyAtEpoch;  // M0, radians at simulated time zero
+        T MeanMotion;          // n, radians per second
+
+        // n from the orbital period
+        static OrbitalElements FromPeriod(T semiMajorAxis, T eccentricity, T argumentOfPeriapsis, T meanAnomalyAtEpoch, T periodSeconds);
+    };
+
+    // Analytic two-body propagation of elliptical orbits around the Earth.
+    // Positions come from solving Kepler's equation, E - e sin E = M, with a fixed number of
+    // Halley iterations, so any satellite can be evaluated at any time without stepping,
+    // and the whole catalog in one vectorized pass.
+    // Explicitly instantiated for float, double and long double in kepler.cpp.
+    template<class T>
+    class BasicKeplerCatalog {
+    public:
+        static constexpr auto MaxEccentricity = T(0.99);
+        // Enough for full precision up to MaxEccentricity from the series starting guess
+        static constexpr int Iterations = sizeof(T) > sizeof(float) ? 5 : 4;
+
+        // Elements
+        std::vector<T> SemiMajorAxis;
+        std::vector<T> Eccentricity;
+        std::vector<T> ArgumentOfPeriapsis;
+        std::vector<T> MeanAnomalyAtEpoch;
+        std::vector<T> MeanMotion;
+        // Derived once in Add
+        std::vector<T> SemiMinorAxis;
+        std::vector<T> CosPeriapsis, SinPeriapsis;
+
+        std::size_t Size() const;
+        void Reserve(std::size_t);
+        void Clear();
+
+        // Returns the index of the new satellite. The eccentricity is clamped to MaxEccentricity.
+        std::size_t Add(const OrbitalElements<T>&);
+
+        // Location of every satellite relative to the Earth's center at the given simulated time,
+        // y pointing up. x and y must hold Size() elements.
+        void Propagate(PhaseScalar<T> timeSeconds, T* x, T* y) const;
+        void Propagate(PhaseScalar<T> timeSeconds, std::vector<T>& x, std::vector<T>& y) const;
+
+        // A single satellite, on the scalar path: matches Propagate within the kernel accuracy
+        void PositionAt(std::size_t index, PhaseScalar<T> timeSeconds, T& x, T& y) const;
+        // The chosen satellites, each at its own time, gathered for one vectorized pass.
+        // x and y must hold count elements.
+        void PositionsAt(const std::uint32_t* indices, const PhaseScalar<T>* timesSeconds, std::size_t count, T* x, T* y) const;
+    };
+
+    using KeplerCatalog = BasicKeplerCatalog<Scalar>;
+
+    extern template class BasicKeplerCatalog<float>;
+    extern template class BasicKeplerCatalog<double>;
+    extern template class BasicKeplerCatalog<long double>;
+}
@@ -1,9 +1,18 @@
 #pragma once
 
+#include "precision.h"
+
+namespace Simulation {
+    template<class T>
+    struct BasicSnapshot;
+    using Snapshot = BasicSnapshot<Scalar>;
+}
+
 namespace Simulation::MagneticFields {
     struct Circular {
-        static long double Radius;
-        static long double DirectionX, DirectionY;
-        static void Update();
+        static Scalar Radius;
+        static Scalar DirectionX, DirectionY;
+        // Render thread, alongside Satellite::Mirror
+        static void Mirror(const Snapshot&);
     };
 }
\ No newline at end of file
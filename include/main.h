@@ -4,36 +4,68 @@
 #include <Windows.h>
 #include <d2d1.h>
 
-#include <cmath>
-#include <chrono>
+#include "core.h"
+#include "precision.h"
+#include <atomic>
+#include <thread>
 
 namespace Simulation {
-    constexpr auto PI = 3.141592653589793l;
-
-    using Timepoint = std::chrono::high_resolution_clock::time_point;
-
-    static inline auto Now() {
-        return std::chrono::high_resolution_clock::now();
-    }
-
     class Main {
-        static constexpr auto TicksPerSecond = 200;
-        static constexpr auto TickDelay = std::chrono::microseconds((int)(1000000.0 / TicksPerSecond));
+    public:
+        // Each on a FrameScheduler of its own
+        static constexpr auto TicksPerSecond = 200.0;
+        static constexpr auto FramesPerSecond = 120.0;
+        // The angle text changes too fast to read at the frame rate
+        static constexpr auto HudRefreshesPerSecond = 10.0;
     private:
         HWND hWnd;
+        std::thread ticker;
+        std::thread renderer;
 
         inline void InitializeWindow(HINSTANCE);
         inline void InitializeModules() const;
-        inline void StartTicking() const;
+        inline void StartTicking();
+        inline void StartRendering();
         inline void MessageLoop() const;
     public:
-        int Run(HINSTANCE);
+        // A telemetry file on the command line is replayed instead of simulated
+        int Run(HINSTANCE, const wchar_t* commandLine);
     };
 
     class Graphics;
+    template<class T>
+    class BasicSimulationState;
+    using SimulationState = BasicSimulationState<Scalar>;
+    class SimulationClock;
+    template<class T>
+    class TripleBuffer;
+    template<class T>
+    struct BasicSnapshot;
+    using Snapshot = BasicSnapshot<Scalar>;
+    class CommandQueue;
+    class TelemetryRecorder;
+    class Replay;
+    class Scenario;
+    template<class T>
+    class BasicSphericalHarmonicField;
+    using SphericalHarmonicField = BasicSphericalHarmonicField<Scalar>;
 
     extern int Width, Height;
-    extern bool Running;
+    extern std::atomic<bool> Running;
+    // Toggled with R: the frames go to a video file as well
+    extern std::atomic<bool> Recording;
+    // Toggled with P in profiling builds: the zone timings drawn over the scene
+    extern std::atomic<bool> ProfileOverlay;
     extern Main MainInstance;
     extern Graphics* GraphicsInstance;
+    extern SimulationState StateInstance;
+    extern SimulationClock ClockInstance;
+    // Ticks from the simulation thread to the render thread
+    extern TripleBuffer<Snapshot> SnapshotsInstance;
+    // Requests from the UI thread to the simulation thread
+    extern CommandQueue CommandsInstance;
+    // Set while a recording plays in place of the simulation
+    extern Replay* ReplayInstance;
+    // Set when the command line names a scenario, what the satellites start from
+    extern const Scenario* ScenarioInstance;
 }
\ No newline at end of file
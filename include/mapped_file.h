@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Simulation {
+    // A whole file mapped read-only into memory, for formats laid out to be used in place
+    class MappedFile {
+    public:
+        MappedFile();
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(MappedFile&&) noexcept;
+        MappedFile& operator=(MappedFile&&) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Closes what was open before. False if the file is missing or can not be mapped; an
+        // empty file opens with no data.
+        bool Open(const std::string& path);
+        void Close();
+
+        bool IsOpen() const;
+        const std::uint8_t* Data() const;
+        std::size_t Size() const;
+    private:
+        const std::uint8_t* data;
+        std::size_t size;
+        bool open;
+#ifdef _WIN32
+        void* file;
+        void* mapping;
+#endif
+    };
+}
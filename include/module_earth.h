@@ -4,8 +4,8 @@
 
 namespace Simulation {
     struct Earth {
-        static long double Radius;
-        static long double X, Y;
+        static Scalar Radius;
+        static Scalar X, Y;
 
         static void Initialize(const ID2D1Bitmap* const bmp);
     };
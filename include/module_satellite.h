@@ -1,22 +1,39 @@
 #pragma once
 
 #include "main.h"
+#include <memory>
 
 namespace Simulation {
+    // The renderer's copy of the satellite, taken from the newest snapshot on the render thread.
+    // The simulation itself lives in StateInstance, owned by the simulation thread.
     class Satellite {
-        static constexpr auto DefaultPeriodSeconds = 30.0l;
     public:
-        static long double Radius;
-        static long double RadiusTrajectory;
-        static long double X, Y;
-        static long double PeriodSeconds;
-        static long double AngleDegrees, AngleRadians;
-        static long double RadialDirectionX, RadialDirectionY;
-        static long double TangentDirectionX, TangentDirectionY;
-        static Timepoint RotationBeginTimepoint;
+        static Scalar Radius;
+        static Scalar RadiusTrajectory;
+        static Scalar X, Y;
+        static Scalar PeriodSeconds;
+        static Scalar AngleDegrees, AngleRadians;
+        static Scalar RadialDirectionX, RadialDirectionY;
+        static Scalar TangentDirectionX, TangentDirectionY;
+        static Timepoint LastUpdateTimepoint;
 
         static void Initialize(const ID2D1Bitmap* const);
 
+        // Simulation thread: applies the posted commands, runs the steps that are due and
+        // publishes the result
         static void Update();
+        // Render thread
+        static void Mirror(const Snapshot&);
+    private:
+        // Where L records the ticks to, see telemetry.h
+        static constexpr auto TelemetryPath = "telemetry.bin";
+        static std::unique_ptr<TelemetryRecorder> Telemetry;
+        // What G switches the field directions to, loaded the first time
+        static constexpr auto FieldModelPath = "res/igrf13_2020.txt";
+        static std::unique_ptr<SphericalHarmonicField> FieldModel;
+
+        static void ApplyCommands();
+        static void ApplyReplayCommands();
+        static void Publish();
     };
 }
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "core.h"
+
+// Per-satellite physics, shared by the single-satellite state and the constellation.
+// Every function works on one element and has no side effects, so callers are free
+// to run it over any layout they like.
+
+namespace Simulation::Kernel {
+    template<class T>
+    inline void Location(T earthX, T earthY, T radiusTrajectory, T angleRadians, T& x, T& y) {
+        x = earthX + radiusTrajectory * std::cos(angleRadians);
+        y = earthY - radiusTrajectory * std::sin(angleRadians);
+    }
+
+    template<class T>
+    inline void RadialAxis(T earthX, T earthY, T x, T y, T& directionX, T& directionY) {
+        T dx = earthX - x;
+        T dy = y - earthY;
+        T size = std::sqrt(dx * dx + dy * dy);
+        directionX = dx / size;
+        directionY = dy / size;
+    }
+
+    template<class T>
+    inline void TangentAxis(T earthX, T earthY, T x, T y, T& directionX, T& directionY) {
+        T dx = y - earthY;
+        T dy = x - earthX;
+        T size = std::sqrt(dx * dx + dy * dy);
+        directionX = dx / size;
+        directionY = dy / size;
+    }
+
+    // The field direction of the circular magnetic field line passing through the satellite,
+    // scaled by the relative field strength (1 at the equator, 2 at the poles).
+    template<class T>
+    inline void CircularField(T earthX, T radiusTrajectory, T angleDegrees, T angleRadians, T x, T& directionX, T& directionY, T& radius) {
+        auto deg = angleDegrees;
+        auto rad = angleRadians;
+        auto r = radiusTrajectory / (T(2) * std::cos(rad));
+        if (deg == T(0) || deg == T(180)) {
+            directionX = T(0);
+            directionY = T(1);
+        }
+        else if (deg == T(90) || deg == T(270)) {
+            directionX = T(0);
+            directionY = T(-2);
+        }
+        else {
+            auto relX = x - earthX;
+            auto m = (r - relX) / std::sqrt(-relX * (relX - T(2) * r));
+            auto kx = ((deg > T(0)  && deg < T(90))  || (deg > T(180) && deg < T(270))) ? T(-1) : T(1);
+            auto ky = ((deg > T(45) && deg < T(135)) || (deg > T(225) && deg < T(315))) ? T(-1) : T(1);
+            auto _x = T(1) / std::sqrt(T(1) + m * m);
+            auto _y = std::abs(m) * _x;
+            auto s = std::sin(rad);
+            auto coef = std::sqrt(T(1) + T(3) * s * s);
+            directionX = _x * kx * coef;
+            directionY = _y * ky * coef;
+        }
+        radius = std::abs(r * T(2));
+    }
+
+    // A 2D dipole with unit moment (momentX, momentY), y up, at offset (dx, dy) from its centre:
+    // B = strength * (radius / r)^3 * (3 (m.r^) r^ - m), so the field is `strength` on the magnetic
+    // equator at `radius` and twice that over the poles, the same as CircularField. Zero inside
+    // `radius`, where the dipole no longer describes the planet.
+    template<class T>
+    inline void Dipole(T dx, T dy, T momentX, T momentY, T radius, T strength, T& bx, T& by) {
+        auto r2 = dx * dx + dy * dy;
+        if (r2 < radius * radius) {
+            bx = T(0);
+            by = T(0);
+            return;
+        }
+        auto inverse = T(1) / r2;
+        auto scale = strength * radius * radius * radius * inverse / std::sqrt(r2);
+        auto k = T(3) * (momentX * dx + momentY * dy) * inverse;
+        bx = scale * (k * dx - momentX);
+        by = scale * (k * dy - momentY);
+    }
+
+    // Solves E - e sin E = M for the eccentric anomaly: series starting guess, then Halley steps
+    template<class T>
+    inline T EccentricAnomaly(T meanAnomaly, T eccentricity, int iterations) {
+        auto m = meanAnomaly;
+        auto e = eccentricity;
+        auto E = m + e * std::sin(m) * (T(1) + e * std::cos(m));
+        for (int i = 0; i < iterations; i++) {
+            auto s = std::sin(E);
+            auto c = std::cos(E);
+            auto f = E - e * s - m;
+            auto f1 = T(1) - e * c;
+            auto f2 = e * s;
+            E -= T(2) * f * f1 / (T(2) * f1 * f1 - f * f2);
+        }
+        return E;
+    }
+
+    // Location on an ellipse with the Earth at its focus, rotated by the argument of periapsis, y up
+    template<class T>
+    inline void Kepler(T meanAnomaly, T eccentricity, T semiMajorAxis, T semiMinorAxis, T cosPeriapsis, T sinPeriapsis, int iterations, T& x, T& y) {
+        auto E = EccentricAnomaly(meanAnomaly, eccentricity, iterations);
+        auto px = semiMajorAxis * (std::cos(E) - eccentricity);
+        auto py = semiMinorAxis * std::sin(E);
+        x = cosPeriapsis * px - sinPeriapsis * py;
+        y = sinPeriapsis * px + cosPeriapsis * py;
+    }
+
+    // How far a satellite at (x, y) clears the elevation mask of a ground station at (stationX, stationY)
+    // with unit up vector (upX, upY), everything relative to the Earth's center, y up:
+    // (sin(elevation) |sin(elevation)| - maskTerm) times the squared distance, with maskTerm
+    // sin(mask) |sin(mask)|. Has the sign of elevation - mask without a square root, and is
+    // smooth in the satellite's location, for root finding.
+    template<class T>
+    inline T VisibilityMargin(T x, T y, T stationX, T stationY, T upX, T upY, T maskTerm) {
+        T dx = x - stationX;
+        T dy = y - stationY;
+        T up = dx * upX + dy * upY;
+        return up * std::abs(up) - maskTerm * (dx * dx + dy * dy);
+    }
+
+    // Highest degree HarmonicField keeps rows of Legendre functions for
+    constexpr int MaxHarmonicDegree = 13;
+
+    // The a and b factors of HarmonicField's recurrence up to degree, packed at n (n + 1) / 2 + m
+    template<class T>
+    inline void HarmonicRecurrence(int degree, T* a, T* b) {
+        for (int n = 1; n <= degree; n++) {
+            auto base = n * (n + 1) / 2;
+            for (int m = 0; m < n; m++) {
+                auto root = std::sqrt(T(n * n - m * m));
+                a[base + m] = T(2 * n - 1) / root;
+                b[base + m] = std::sqrt(T((n - 1) * (n - 1) - m * m)) / root;
+            }
+            a[base + n] = n == 1 ? T(1) : std::sqrt(T(2 * n - 1) / T(2 * n));
+            b[base + n] = T(0);
+        }
+    }
+
+    // The field of a spherical harmonic expansion of the planet's potential, in the meridian plane,
+    // at (x, y) in planet radii from the center, y up along the axis, times r^3 and normalization:
+    // a dipole of unit normalized strength then gives 1 on its equator and 2 over its poles at every
+    // distance, like CircularField. Undefined at the center.
+    // terms, packed at n (n + 1) / 2 + m, hold g cos(m lon) + h sin(m lon) of the +x meridian; the -x
+    // one is the same with odd orders negated. The Schmidt semi-normalized Legendre functions of
+    // cos(colatitude) and their derivatives come from the recurrence P(n, m) = a P(n - 1, m) cos -
+    // b P(n - 2, m), with P(n, n) = a P(n - 1, n - 1) sin on the diagonal, a and b packed like terms.
+    // The out-of-plane component is dropped.
+    template<class T>
+    inline void HarmonicField(T x, T y, int degree, const T* terms, const T* a, const T* b, T normalization, T& bx, T& by) {
+        auto r = std::sqrt(x * x + y * y);
+        auto inverse = T(1) / r;
+        auto side = x < T(0) ? T(-1) : T(1);
+        auto c = y * inverse;
+        auto s = side * x * inverse;
+
+        // Rows n - 1 and n - 2 alternate, row n overwrites n - 2 as it goes
+        T p[2][MaxHarmonicDegree + 1] = {}, dp[2][MaxHarmonicDegree + 1] = {};
+        p[0][0] = T(1);
+        T radial[2] = {}, polar[2] = {};    // Even and odd orders
+        auto scale = normalization;         // (1 / r)^(n + 2) r^3
+        for (int n = 1; n <= degree; n++) {
+            auto base = n * (n + 1) / 2;
+            auto& current = p[n & 1];
+            auto& dcurrent = dp[n & 1];
+            const auto& previous = p[(n - 1) & 1];
+            const auto& dprevious = dp[(n - 1) & 1];
+            for (int m = 0; m < n; m++) {
+                auto k = base + m;
+                auto value = a[k] * c * previous[m] - b[k] * current[m];
+                auto derivative = a[k] * (c * dprevious[m] - s * previous[m]) - b[k] * dcurrent[m];
+                current[m] = value;
+                dcurrent[m] = derivative;
+            }
+            current[n] = a[base + n] * s * previous[n - 1];
+            dcurrent[n] = a[base + n] * (s * dprevious[n - 1] + c * previous[n - 1]);
+
+            for (int m = 0; m <= n; m++) {
+                auto term = terms[base + m] * scale;
+                radial[m & 1] += T(n + 1) * term * current[m];
+                polar[m & 1] -= term * dcurrent[m];
+            }
+            scale *= inverse;
+        }
+
+        auto br = radial[0] + side * radial[1];
+        auto bt = polar[0] + side * polar[1];
+        bx = side * (br * s + bt * c);
+        by = br * c - bt * s;
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// PNG without zlib. The encoder deflates with fixed Huffman codes and a greedy single-probe LZ77,
+// about what zlib does at level 1: the frames are mostly flat colour, which that already shrinks
+// to a few percent, and it keeps an encoder fast enough for a worker per core.
+//
+// The decoder takes whatever an image editor writes, so the sprites load the same on every
+// platform: every colour type and bit depth, stored, fixed and dynamic blocks, all five filters
+// and transparency. Interlaced files are not read.
+
+namespace Simulation::Png {
+    // Straight RGBA rows in, an 8 bit RGB or RGBA file out (appended to out)
+    void Encode(const std::uint8_t* rgba, int width, int height, std::size_t stride, bool alpha, std::vector<std::uint8_t>& out);
+    // A whole file in, straight RGBA rows out (replacing rgba), 8 bits a channel. False if it is
+    // not a PNG, is damaged or interlaced.
+    bool Decode(const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& rgba, int& width, int& height);
+
+    std::uint32_t Crc32(const std::uint8_t*, std::size_t, std::uint32_t crc = 0);
+    std::uint32_t Adler32(const std::uint8_t*, std::size_t, std::uint32_t adler = 1);
+}
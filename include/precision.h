@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// The scalar type the simulation runs on, chosen at build time:
+// SIMULATION_PRECISION_FLOAT, SIMULATION_PRECISION_DOUBLE (default) or SIMULATION_PRECISION_LONG_DOUBLE.
+// The physics core is a set of templates instantiated for all three, so the other precisions
+// stay available for comparison (see MeasureDrift) whichever one the build picked.
+
+namespace Simulation {
+#if defined(SIMULATION_PRECISION_FLOAT)
+    using Scalar = float;
+#elif defined(SIMULATION_PRECISION_LONG_DOUBLE)
+    using Scalar = long double;
+#else
+    using Scalar = double;
+#endif
+
+    template<class T>
+    constexpr T Pi = T(3.14159265358979323846264338327950288l);
+
+    // Orbit phases are kept in at least double precision whatever T is: a float phase
+    // would lose a visible fraction of a turn within hours of simulated time.
+    template<class T>
+    using PhaseScalar = std::common_type_t<T, double>;
+
+    template<class T>
+    const char* PrecisionName();
+
+    // How far a precision wanders from long double when both step the same scenario
+    struct DriftSample {
+        std::uint64_t Steps;
+        double Position;  // Largest distance between the satellites, px
+        double Angle;     // Largest angle difference, degrees
+        double Field;     // Largest difference of the field direction
+    };
+
+    struct DriftReport {
+        const char* Precision;
+        std::size_t BytesPerSatellite;
+        std::size_t Satellites;
+        DriftSample Samples[8];
+        std::size_t SampleCount;
+    };
+
+    // Steps the displayed satellite and a small constellation in T and in long double side by side,
+    // sampling the deviation at each checkpoint (ascending, up to 8)
+    template<class T>
+    DriftReport MeasureDrift(const std::uint64_t* checkpoints, std::size_t count, long double dtSeconds);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Scoped timing zones for the hot paths, built in with -DSIMULATION_PROFILING (CMake option
+// SIMULATION_PROFILING). Without it SIMULATION_PROFILE_ZONE expands to nothing and the functions
+// below are empty, so an ordinary build carries no trace of the profiler.
+//
+// A zone takes two steady_clock readings and appends one event to a ring of its own thread: no
+// lock, no allocation after a thread's first zone. Readers copy the rings and drop whatever a
+// thread overwrote while they were copying.
+
+#if defined(SIMULATION_PROFILING)
+#define SIMULATION_PROFILE_CONCATENATE_(a, b) a##b
+#define SIMULATION_PROFILE_CONCATENATE(a, b) SIMULATION_PROFILE_CONCATENATE_(a, b)
+// name: a string literal, zones are told apart by its address
+#define SIMULATION_PROFILE_ZONE(name) ::Simulation::Profiler::Zone SIMULATION_PROFILE_CONCATENATE(profileZone, __LINE__)(name)
+#else
+#define SIMULATION_PROFILE_ZONE(name) ((void)0)
+#endif
+
+namespace Simulation::Profiler {
+#if defined(SIMULATION_PROFILING)
+    constexpr bool Enabled = true;
+#else
+    constexpr bool Enabled = false;
+#endif
+
+    // Events kept per thread, the oldest are overwritten
+    constexpr std::size_t EventsPerThread = 1 << 16;
+
+    struct Event {
+        const char* Name;
+        // Nanoseconds since the profiler started
+        std::int64_t Begin, End;
+        // Zones open around this one on its thread
+        std::uint32_t Depth;
+    };
+
+    // A zone over a rolling window: durations in a histogram of 8 buckets per octave
+    struct ZoneSummary {
+        static constexpr std::size_t Buckets = 160;
+        static constexpr double FirstBucketMicroseconds = 0.1;
+
+        const char* Name;
+        const char* Thread;
+        std::uint32_t Depth;
+        std::uint64_t Count;
+        double TotalMicroseconds;
+        double MaxMicroseconds;
+        std::uint32_t Histogram[Buckets];
+
+        double MeanMicroseconds() const;
+        // Upper edge of the bucket the fraction falls into
+        double PercentileMicroseconds(double fraction) const;
+    };
+
+    // Shown in summaries and as the thread's name in traces
+    void SetThreadName(const char*);
+    std::int64_t Now();
+
+    // Every zone that ended within the window, per thread outer zones first. Fills at most capacity
+    // and returns how many it filled; allocates nothing once warmed up.
+    std::size_t Summarize(std::chrono::nanoseconds window, ZoneSummary* summaries, std::size_t capacity);
+    // Chrome trace-event JSON of every event still in the rings, for chrome://tracing or Perfetto
+    bool WriteChromeTrace(const char* path);
+    // Forgets the events recorded so far
+    void Clear();
+
+    class Zone {
+    public:
+        explicit Zone(const char* name);
+        ~Zone();
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+    private:
+        const char* name;
+        std::int64_t begin;
+    };
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Simulation {
+    struct FieldLineSet;
+
+    // Straight, not premultiplied, 0 to 1
+    struct Color {
+        float R;
+        float G;
+        float B;
+        float A;
+    };
+
+    enum class StrokeStyle {
+        Solid,      // Flat caps
+        Dashed,     // Dashes and gaps twice the width long, flat caps
+        Arrow       // Round start cap, triangle end cap
+    };
+
+    struct Stroke {
+        Simulation::Color Color;
+        float Width;
+        StrokeStyle Style;
+    };
+
+    enum class BitmapId {
+        Earth,
+        Satellite
+    };
+
+    // The drawing primitives the scene is made of, in screen pixels with y down. Implemented by
+    // Graphics on Direct2D and by SoftwareRenderer into a plain RGBA buffer.
+    class Renderer {
+    public:
+        virtual ~Renderer() = default;
+
+        virtual int Width() const = 0;
+        virtual int Height() const = 0;
+
+        virtual void BeginFrame(Color background) = 0;
+        virtual void EndFrame() = 0;
+
+        // The static layer: whatever is drawn between a BeginLayer that returns true and EndLayer
+        // is kept, on top of the background, and put back in later frames for as long as they ask
+        // for the same key. A false return means the kept layer is still good and is used as is.
+        // At most one layer per frame, before anything else is drawn; the key has to change
+        // whenever anything drawn into the layer would. EndLayer returns false if the layer could
+        // not be kept: it is dropped, and what went into it has to be drawn again onto the frame.
+        virtual bool BeginLayer(std::uint64_t key) = 0;
+        virtual bool EndLayer() = 0;
+
+        // Square, size x size, turned clockwise about its centre
+        virtual void DrawBitmap(BitmapId, float centerX, float centerY, float size, float rotationDegrees) = 0;
+        virtual void DrawEllipse(float centerX, float centerY, float radiusX, float radiusY, const Stroke&) = 0;
+        virtual void DrawLine(float x1, float y1, float x2, float y2, const Stroke&) = 0;
+        // Round joins; the set has to stay alive until EndFrame
+        virtual void DrawPolylines(const FieldLineSet&, const Stroke&) = 0;
+        // In the default font, from the top left corner. Not DrawText, which windows.h turns into a macro.
+        // The first prefixLength characters come back unchanged frame after frame (all of a constant
+        // label, "φ = " of a number), so a renderer may keep them laid out.
+        virtual void DrawString(std::wstring_view, std::size_t prefixLength, float x, float y, Color) = 0;
+        virtual void MeasureString(std::wstring_view, float& width, float& height) = 0;
+    };
+}
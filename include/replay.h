@@ -0,0 +1,65 @@
+#pragma once
+
+#include "snapshot.h"
+#include "telemetry.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Simulation {
+    // Plays a recorded telemetry file back as snapshots, for the renderer to draw in place of the
+    // live simulation. Every row holds a whole step, so any row is a keyframe. The sparse index
+    // keeps the last row at or before each whole KeyframeSeconds of simulated time: a seek looks
+    // its interval up directly and binary-searches only the rows inside it, which the step rate
+    // bounds, however long the recording is.
+    class Replay {
+    public:
+        static constexpr std::int64_t KeyframeNanoseconds = 1000000000;
+        static constexpr auto MinSpeed = 1.0 / 64.0;
+        static constexpr auto MaxSpeed = 1000000.0;
+
+        // False unless the file holds at least one row
+        bool Open(const std::string& path);
+
+        std::uint64_t Rows() const;
+        std::size_t Keyframes() const;
+        std::int64_t BeginNanoseconds() const;
+        std::int64_t EndNanoseconds() const;
+
+        // The playhead, in simulated nanoseconds, clamped to the recording
+        std::int64_t Position() const;
+        void Seek(std::int64_t nanoseconds);
+
+        bool Paused() const;
+        void SetPaused(bool);
+        // Simulated seconds per real second, clamped to [MinSpeed, MaxSpeed]
+        double Speed() const;
+        void SetSpeed(double);
+
+        // Moves the playhead on by the real time passed, unless paused. Stops at the end.
+        void Advance(std::chrono::nanoseconds real);
+
+        // The last row at or before the time
+        std::uint64_t Find(std::int64_t nanoseconds) const;
+        // The row under the playhead as the live simulation would have captured it
+        template<class T>
+        void Capture(BasicSnapshot<T>&) const;
+    private:
+        TelemetryFile file;
+        std::vector<std::uint64_t> keyframes;
+        std::int64_t begin = 0, end = 0;
+        std::int64_t position = 0;
+        // Fraction of a nanosecond carried from one Advance to the next
+        double carry = 0;
+        double speed = 1.0;
+        bool paused = false;
+
+        std::int64_t Time(std::uint64_t row) const;
+        double Value(TelemetryColumn, std::uint64_t row) const;
+    };
+
+    extern template void Replay::Capture(BasicSnapshot<float>&) const;
+    extern template void Replay::Capture(BasicSnapshot<double>&) const;
+    extern template void Replay::Capture(BasicSnapshot<long double>&) const;
+}
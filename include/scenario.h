@@ -0,0 +1,117 @@
+#pragma once
+
+#include "mapped_file.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// What a run starts from: the displayed satellite's orbit and a catalog of circular and Kepler
+// orbits, lengths in Earth radii so one scenario fits any screen.
+//
+// Written by hand as text, one record per line, '#' starting a comment:
+//
+//     period SECONDS                          The displayed satellite's period
+//     trajectory RADII                        The displayed satellite's orbit radius
+//     circular RADII PERIOD ANGLE             ANGLE in degrees at simulated time zero
+//     kepler A E PERIAPSIS ANOMALY PERIOD     Degrees, the mean anomaly at time zero
+//
+// and compiled next to it, to the text's path + ".bin": a 4096 byte header, then one contiguous
+// array of doubles per column, each starting on a 64 byte boundary, every derived value the
+// catalogs keep already computed. The compiled file is mapped and read in place. Little endian,
+// as written by the machine that compiled it.
+
+namespace Simulation {
+    template<class T>
+    class BasicSimulationState;
+    template<class T>
+    class BasicKeplerCatalog;
+
+    enum class ScenarioColumn : std::uint32_t {
+        // Circular orbits
+        RadiusTrajectory,
+        PeriodSeconds,
+        AngleRadians,
+        // Kepler orbits
+        SemiMajorAxis,
+        Eccentricity,
+        ArgumentOfPeriapsis,
+        MeanAnomalyAtEpoch,
+        MeanMotion,
+        SemiMinorAxis,
+        CosPeriapsis,
+        SinPeriapsis,
+        Count
+    };
+
+    constexpr auto ScenarioColumns = (std::size_t)ScenarioColumn::Count;
+
+    struct ScenarioHeader {
+        static constexpr char Signature[8] = { 'S', 'I', 'M', 'S', 'C', 'E', 'N', 'E' };
+        static constexpr std::uint32_t CurrentVersion = 1;
+        static constexpr std::size_t Bytes = 4096;
+        static constexpr std::size_t Alignment = 64;
+
+        char Magic[8];
+        std::uint32_t Version;
+        std::uint32_t HeaderBytes;
+        std::uint64_t FileBytes;
+        // The text it was compiled from, as it was then. A different size or modification time
+        // means the text changed since.
+        std::uint64_t SourceBytes;
+        std::int64_t SourceModified;
+        double PeriodSeconds;
+        double TrajectoryEarthRadii;
+        std::uint64_t Circular;
+        std::uint64_t Kepler;
+        std::uint64_t Offsets[ScenarioColumns];    // Bytes from the start of the file
+    };
+    static_assert(sizeof(ScenarioHeader) <= ScenarioHeader::Bytes);
+
+    class Scenario {
+    public:
+        // What the front end takes for a scenario on its command line, the compiled one adds ".bin"
+        static constexpr auto TextExtension = ".scn";
+        static constexpr auto CompiledExtension = ".bin";
+        static constexpr double DefaultPeriodSeconds = 30;
+        static constexpr double DefaultTrajectoryEarthRadii = 4;
+
+        // A text scenario opens its compiled file, compiling it first when it is missing, not
+        // readable as one, or older than the text. A compiled file on its own, or one whose text
+        // is gone, opens as it is. False with Error() set otherwise.
+        bool Open(const std::string& path, ThreadPool& = ThreadPool::Shared());
+        void Close();
+
+        bool IsOpen() const;
+        const std::string& Error() const;
+        // Whether the last Open had to compile the text
+        bool Compiled() const;
+
+        double PeriodSeconds() const;
+        double TrajectoryEarthRadii() const;
+        std::size_t Circular() const;
+        std::size_t Kepler() const;
+        // Circular() or Kepler() doubles, in place in the mapped file
+        const double* Column(ScenarioColumn) const;
+
+        // The displayed satellite's period and orbit, back to its start, and the circular orbits
+        // in place of the constellation. The Earth has to be initialized.
+        template<class T>
+        void Apply(BasicSimulationState<T>&) const;
+        // The Kepler orbits in place of the catalog's, copied column by column
+        template<class T>
+        void Apply(T earthRadius, BasicKeplerCatalog<T>&) const;
+
+        // Parses the text in chunks spread over the pool and writes the compiled file, replacing
+        // the old one only once the new one is complete. False with "path:line: what" in error.
+        static bool Compile(const std::string& textPath, const std::string& compiledPath, std::string& error, ThreadPool& = ThreadPool::Shared());
+    private:
+        MappedFile file;
+        const ScenarioHeader* header = nullptr;
+        std::string error;
+        bool compiled = false;
+
+        // Maps the compiled file, false if it is not a whole one of the current version
+        bool Map(const std::string& path);
+    };
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "renderer.h"
+#include "field_lines.h"
+#include "hud.h"
+#include "snapshot.h"
+#include "profiler.h"
+#include <vector>
+
+namespace Simulation {
+    // What the window shows, drawn through the Renderer interface so every backend draws the same
+    // frame from the same snapshot. The planet, the orbit, the family of field lines and the texts
+    // that only depend on the period make up the renderer's static layer; the rest moves with the
+    // satellite and is drawn over it every frame.
+    class Scene {
+    public:
+        // The parts Draw is made of, in drawing order
+        enum class Phase {
+            Earth,
+            Trajectory,
+            FieldLines,
+            SatelliteFieldLine,
+            Satellite,
+            Axes,
+            FieldDirection,
+            InfoAngle,
+            InfoOrbit,
+            Count
+        };
+
+        static constexpr Color Background = { 0.0f, 0.0f, 0.0f, 1.0f };
+        static constexpr Color TextColor = { 0.663f, 0.663f, 0.663f, 1.0f };  // D2D DarkGray
+
+        // Satellite trajectory line
+        static constexpr float SatelliteTrajectoryLineWidth = 10.0f;
+        static constexpr Color SatelliteTrajectoryLineColor = { 0.502f, 0.502f, 0.502f, 1.0f };  // D2D Gray
+
+        // Info texts, top left
+        static constexpr float InfoX = 20.0f;
+        static constexpr float InfoY = 10.0f;
+        static constexpr float InfoLineSpacing = 50.0f;
+
+        // Profiler overlay, under the info texts, in profiling builds
+        static constexpr std::size_t ProfileLines = 16;
+        static constexpr float ProfileY = InfoY + 5 * InfoLineSpacing;
+        static constexpr float ProfileLineSpacing = 40.0f;
+
+        // The angle text only takes the snapshot's angle when refreshHud is set, so it can be
+        // refreshed at a readable rate of its own
+        void Draw(Renderer&, const Snapshot&, bool refreshHud = true);
+
+        // The zone timings of the last second, refreshed with the angle text
+        void SetProfileOverlay(bool);
+
+        // One phase alone in a frame of its own, without the static layer, for benchmarks
+        void DrawPhase(Renderer&, const Snapshot&, Phase);
+        static const char* ToString(Phase);
+    private:
+        FieldLineTracer fieldLineTracer;
+        const FieldLineSet* fieldLines = nullptr;
+        FieldLineSet satelliteFieldLine;
+
+        HudLine angleText{ L"φ = " };
+        HudLine periodText{ L"T = " };
+        HudLine frequencyText{ L"ƒ = " };
+        HudLine speedText{ L"ω = " };
+
+        bool profileOverlay = false;
+        std::vector<Profiler::ZoneSummary> profileSummaries;
+        HudLine profileText[ProfileLines];
+        std::size_t profileLineCount = 0;
+
+        // Label sizes only depend on the renderer's font, measured once per renderer
+        const Renderer* measuredWith = nullptr;
+        float radialAxisWidth, radialAxisHeight;
+        float tangentAxisWidth, tangentAxisHeight;
+        float magneticFieldWidth, magneticFieldHeight;
+
+        void MeasureLabels(Renderer&);
+        void UpdateFieldLines(const Renderer&, const Snapshot&);
+        std::uint64_t StaticLayerKey(const Renderer&, const Snapshot&) const;
+        // What goes into the static layer
+        void DrawStatic(Renderer&, const Snapshot&);
+
+        void DrawEarth(Renderer&, const Snapshot&) const;
+        void DrawTrajectory(Renderer&, const Snapshot&) const;
+        void DrawMagneticFieldLines(Renderer&) const;
+        void DrawSatelliteFieldLine(Renderer&) const;
+        void DrawSatellite(Renderer&, const Snapshot&) const;
+        void DrawAxes(Renderer&, const Snapshot&) const;
+        void DrawMagneticFieldsDirections(Renderer&, const Snapshot&) const;
+        void DrawInfoAngle(Renderer&, const Snapshot&, bool refresh);
+        void DrawInfoOrbit(Renderer&, const Snapshot&);
+        void DrawProfile(Renderer&, bool refresh);
+
+        // An arrow BaseArrowLength long per unit of (dx, dy), y up, with its label past the tip
+        void DrawArrow(Renderer&, const Snapshot&, Scalar dx, Scalar dy, Color, std::wstring_view label, float labelWidth, float labelHeight) const;
+    };
+
+    extern long double FieldLinesWidth;
+    extern long double BaseArrowLength, BaseArrowWidth;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "simd_kernel.h"
+#include "simd_vector.h"
+
+// The vectorized dipole field kernel, instantiated next to the orbit kernel in the per instruction set units
+
+namespace Simulation::Simd {
+    void EvaluateDipoleRowSSE2(const DipoleRow<double>&, std::size_t n);
+    void EvaluateDipoleRowSSE2(const DipoleRow<float>&, std::size_t n);
+    void EvaluateDipoleRowAVX2(const DipoleRow<double>&, std::size_t n);
+    void EvaluateDipoleRowAVX2(const DipoleRow<float>&, std::size_t n);
+    void EvaluateDipoleRowAVX512(const DipoleRow<double>&, std::size_t n);
+    void EvaluateDipoleRowAVX512(const DipoleRow<float>&, std::size_t n);
+
+    // Same steps as Kernel::Dipole, with the inside of the planet masked to zero instead of branched around
+    template<class V>
+    inline void EvaluateDipoleRowVector(const DipoleRow<typename V::Scalar>& row, std::size_t n) {
+        using T = typename V::Scalar;
+
+        T lanes[V::Width];
+        for (int k = 0; k < V::Width; k++) {
+            lanes[k] = T(k);
+        }
+        const auto step = V::Set(row.StepX);
+        const auto dy = V::Set(row.OffsetY);
+        const auto mx = V::Set(row.MomentX);
+        const auto my = V::Set(row.MomentY);
+        const auto radius2 = V::Set(row.Radius * row.Radius);
+        const auto strength = V::Set(row.Strength * row.Radius * row.Radius * row.Radius);
+        const auto one = V::Set(1.0f);
+        const auto three = V::Set(3.0f);
+        const auto zero = V::Set(0.0f);
+        const auto dy2 = V::Mul(dy, dy);
+        const auto mDotY = V::Mul(my, dy);
+
+        const auto lane = V::Load(lanes);
+        const auto startX = V::Set(row.StartX);
+
+        std::size_t i = 0;
+        for (; i + V::Width <= n; i += V::Width) {
+            // From the column index rather than by accumulation, so long rows do not drift
+            auto dx = V::MulAdd(V::Add(V::Set(T(i)), lane), step, startX);
+            auto r2 = V::MulAdd(dx, dx, dy2);
+            auto inverseR = V::Div(one, V::Sqrt(r2));
+            auto inverse = V::Mul(inverseR, inverseR);
+            auto scale = V::Mul(V::Mul(strength, inverse), inverseR);
+            auto k = V::Mul(V::Mul(three, V::MulAdd(mx, dx, mDotY)), inverse);
+            auto bx = V::Mul(scale, V::Sub(V::Mul(k, dx), mx));
+            auto by = V::Mul(scale, V::Sub(V::Mul(k, dy), my));
+
+            auto inside = V::Less(r2, radius2);
+            bx = V::Select(inside, zero, bx);
+            by = V::Select(inside, zero, by);
+            V::Store(row.X + i, bx);
+            V::Store(row.Y + i, by);
+            V::Store(row.Magnitude + i, V::Sqrt(V::MulAdd(bx, bx, V::Mul(by, by))));
+        }
+
+        // Whatever does not fill a whole register
+        EvaluateDipoleRowScalar(row, i, n);
+    }
+}
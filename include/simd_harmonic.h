@@ -0,0 +1,85 @@
+#pragma once
+
+#include "simd_kernel.h"
+#include "simd_vector.h"
+#include "orbit_kernel.h"
+
+// The vectorized spherical harmonic field kernel, instantiated next to the orbit kernel in the per instruction set units
+
+namespace Simulation::Simd {
+    void EvaluateHarmonicFieldSSE2(const HarmonicRows<double>&, std::size_t n);
+    void EvaluateHarmonicFieldSSE2(const HarmonicRows<float>&, std::size_t n);
+    void EvaluateHarmonicFieldAVX2(const HarmonicRows<double>&, std::size_t n);
+    void EvaluateHarmonicFieldAVX2(const HarmonicRows<float>&, std::size_t n);
+    void EvaluateHarmonicFieldAVX512(const HarmonicRows<double>&, std::size_t n);
+    void EvaluateHarmonicFieldAVX512(const HarmonicRows<float>&, std::size_t n);
+
+    // Same steps as Kernel::HarmonicField, a satellite per lane, the side of the axis a lane is on
+    // folded into the odd order sums by a select instead of a branch
+    template<class V>
+    inline void EvaluateHarmonicFieldVector(const HarmonicRows<typename V::Scalar>& rows, std::size_t n) {
+        using T = typename V::Scalar;
+        using Vector = typename V::Vector;
+        constexpr auto Rows = Kernel::MaxHarmonicDegree + 1;
+
+        const auto zero = V::Set(0.0f);
+        const auto one = V::Set(1.0f);
+        const auto minusOne = V::Set(-1.0f);
+        const auto centerX = V::Set(rows.CenterX);
+        const auto centerY = V::Set(rows.CenterY);
+        const auto inverseRadius = V::Set(rows.InverseRadius);
+        const auto normalization = V::Set(rows.Normalization);
+
+        std::size_t i = 0;
+        for (; i + V::Width <= n; i += V::Width) {
+            auto x = V::Mul(V::Sub(V::Load(rows.X + i), centerX), inverseRadius);
+            auto y = V::Mul(V::Sub(centerY, V::Load(rows.Y + i)), inverseRadius);
+            auto inverse = V::Div(one, V::Sqrt(V::MulAdd(x, x, V::Mul(y, y))));
+            auto side = V::Select(V::Less(x, zero), minusOne, one);
+            auto c = V::Mul(y, inverse);
+            auto s = V::Mul(V::Mul(side, x), inverse);
+
+            Vector p[2][Rows], dp[2][Rows];
+            for (int m = 0; m < Rows; m++) {
+                p[0][m] = p[1][m] = dp[0][m] = dp[1][m] = zero;
+            }
+            p[0][0] = one;
+            Vector radial[2] = { zero, zero }, polar[2] = { zero, zero };
+            auto scale = normalization;
+            for (int d = 1; d <= rows.Degree; d++) {
+                auto base = d * (d + 1) / 2;
+                auto& current = p[d & 1];
+                auto& dcurrent = dp[d & 1];
+                const auto& previous = p[(d - 1) & 1];
+                const auto& dprevious = dp[(d - 1) & 1];
+                for (int m = 0; m < d; m++) {
+                    auto a = V::Set(rows.RecurrenceA[base + m]);
+                    auto b = V::Set(rows.RecurrenceB[base + m]);
+                    auto value = V::Sub(V::Mul(a, V::Mul(c, previous[m])), V::Mul(b, current[m]));
+                    auto derivative = V::Sub(V::Mul(a, V::Sub(V::Mul(c, dprevious[m]), V::Mul(s, previous[m]))), V::Mul(b, dcurrent[m]));
+                    current[m] = value;
+                    dcurrent[m] = derivative;
+                }
+                auto a = V::Set(rows.RecurrenceA[base + d]);
+                current[d] = V::Mul(a, V::Mul(s, previous[d - 1]));
+                dcurrent[d] = V::Mul(a, V::MulAdd(s, dprevious[d - 1], V::Mul(c, previous[d - 1])));
+
+                auto degreeFactor = V::Set(T(d + 1));
+                for (int m = 0; m <= d; m++) {
+                    auto term = V::Mul(V::Set(rows.Terms[base + m]), scale);
+                    radial[m & 1] = V::MulAdd(V::Mul(degreeFactor, term), current[m], radial[m & 1]);
+                    polar[m & 1] = V::Sub(polar[m & 1], V::Mul(term, dcurrent[m]));
+                }
+                scale = V::Mul(scale, inverse);
+            }
+
+            auto br = V::MulAdd(side, radial[1], radial[0]);
+            auto bt = V::MulAdd(side, polar[1], polar[0]);
+            V::Store(rows.DirectionX + i, V::Mul(side, V::MulAdd(br, s, V::Mul(bt, c))));
+            V::Store(rows.DirectionY + i, V::Sub(V::Mul(br, c), V::Mul(bt, s)));
+        }
+
+        // Whatever does not fill a whole register
+        EvaluateHarmonicFieldScalar(rows, i, n);
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "simd_orbit.h"
+
+// The vectorized Kepler solver, instantiated next to the orbit kernel in the per instruction set units
+
+namespace Simulation::Simd {
+    void SolveKeplerSSE2(const KeplerArrays<double>&, int iterations, std::size_t n);
+    void SolveKeplerSSE2(const KeplerArrays<float>&, int iterations, std::size_t n);
+    void SolveKeplerAVX2(const KeplerArrays<double>&, int iterations, std::size_t n);
+    void SolveKeplerAVX2(const KeplerArrays<float>&, int iterations, std::size_t n);
+    void SolveKeplerAVX512(const KeplerArrays<double>&, int iterations, std::size_t n);
+    void SolveKeplerAVX512(const KeplerArrays<float>&, int iterations, std::size_t n);
+
+    // Same steps as Kernel::Kepler, every lane runs the same number of iterations
+    template<class V>
+    inline void SolveKeplerVector(const KeplerArrays<typename V::Scalar>& a, int iterations, std::size_t n) {
+        const auto one = V::Set(1.0f);
+        const auto two = V::Set(2.0f);
+
+        std::size_t i = 0;
+        for (; i + V::Width <= n; i += V::Width) {
+            auto m = V::Load(a.MeanAnomaly + i);
+            auto e = V::Load(a.Eccentricity + i);
+
+            typename V::Vector s, c;
+            SinCos<V>(m, s, c);
+            auto E = V::MulAdd(V::Mul(e, s), V::MulAdd(e, c, one), m);
+            for (int k = 0; k < iterations; k++) {
+                SinCos<V>(E, s, c);
+                auto es = V::Mul(e, s);
+                auto f = V::Sub(V::Sub(E, es), m);
+                auto f1 = V::Sub(one, V::Mul(e, c));
+                auto numerator = V::Mul(V::Mul(two, f), f1);
+                auto denominator = V::Sub(V::Mul(V::Mul(two, f1), f1), V::Mul(f, es));
+                E = V::Sub(E, V::Div(numerator, denominator));
+            }
+            SinCos<V>(E, s, c);
+
+            auto px = V::Mul(V::Load(a.SemiMajorAxis + i), V::Sub(c, e));
+            auto py = V::Mul(V::Load(a.SemiMinorAxis + i), s);
+            auto cw = V::Load(a.CosPeriapsis + i);
+            auto sw = V::Load(a.SinPeriapsis + i);
+            V::Store(a.X + i, V::Sub(V::Mul(cw, px), V::Mul(sw, py)));
+            V::Store(a.Y + i, V::MulAdd(sw, px, V::Mul(cw, py)));
+        }
+
+        // Whatever does not fill a whole register
+        SolveKeplerScalar(a, iterations, i, n);
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "cpu_features.h"
+#include <cstddef>
+
+namespace Simulation::Simd {
+    // Views into the constellation arrays the orbit kernel reads and writes
+    template<class T>
+    struct OrbitArrays {
+        const T* RadiusTrajectory;
+        const T* AngleRadians;
+        T* X;
+        T* Y;
+        T* RadialDirectionX;
+        T* RadialDirectionY;
+        T* TangentDirectionX;
+        T* TangentDirectionY;
+    };
+
+    // Locations and unit radial/tangent axes for satellites [0, n), on the active instruction set.
+    // float and double have vector kernels, long double always takes the scalar path.
+    template<class T>
+    void UpdateOrbits(T earthX, T earthY, const OrbitArrays<T>&, std::size_t n);
+    template<class T>
+    void UpdateOrbits(InstructionSet, T earthX, T earthY, const OrbitArrays<T>&, std::size_t n);
+
+    // The reference path, built on the per-element kernel, for satellites [begin, end)
+    template<class T>
+    void UpdateOrbitsScalar(T earthX, T earthY, const OrbitArrays<T>&, std::size_t begin, std::size_t end);
+
+    // Views into the Kepler catalog for the Kepler kernel. MeanAnomaly may alias X: each block is
+    // read before it is written.
+    template<class T>
+    struct KeplerArrays {
+        const T* MeanAnomaly; // Reduced to [-pi, pi]
+        const T* Eccentricity;
+        const T* SemiMajorAxis;
+        const T* SemiMinorAxis;
+        const T* CosPeriapsis;
+        const T* SinPeriapsis;
+        T* X;
+        T* Y;
+    };
+
+    // Solves Kepler's equation with a fixed number of Halley iterations and writes the locations
+    // relative to the focus, for satellites [0, n)
+    template<class T>
+    void SolveKepler(const KeplerArrays<T>&, int iterations, std::size_t n);
+    template<class T>
+    void SolveKepler(InstructionSet, const KeplerArrays<T>&, int iterations, std::size_t n);
+    template<class T>
+    void SolveKeplerScalar(const KeplerArrays<T>&, int iterations, std::size_t begin, std::size_t end);
+
+    // One row of a dipole field map: n samples StepX apart, starting StartX to the right of the
+    // dipole and OffsetY above it. Writes the field (y up) and its magnitude.
+    template<class T>
+    struct DipoleRow {
+        T StartX;
+        T StepX;
+        T OffsetY;
+        T MomentX;
+        T MomentY;
+        T Radius;
+        T Strength;
+        T* X;
+        T* Y;
+        T* Magnitude;
+    };
+
+    template<class T>
+    void EvaluateDipoleRow(const DipoleRow<T>&, std::size_t n);
+    template<class T>
+    void EvaluateDipoleRow(InstructionSet, const DipoleRow<T>&, std::size_t n);
+    template<class T>
+    void EvaluateDipoleRowScalar(const DipoleRow<T>&, std::size_t begin, std::size_t end);
+
+    // Kernel::VisibilityMargin of satellites [0, n) from one ground station
+    template<class T>
+    struct VisibilityRow {
+        T StationX;
+        T StationY;
+        T UpX;
+        T UpY;
+        T MaskTerm;
+        const T* X;
+        const T* Y;
+        T* Margin;
+    };
+
+    template<class T>
+    void EvaluateVisibility(const VisibilityRow<T>&, std::size_t n);
+    template<class T>
+    void EvaluateVisibility(InstructionSet, const VisibilityRow<T>&, std::size_t n);
+    template<class T>
+    void EvaluateVisibilityScalar(const VisibilityRow<T>&, std::size_t begin, std::size_t end);
+
+    // Kernel::HarmonicField of satellites [0, n) on screen: the planet's center and radius in px
+    // map their screen locations (y down) to the kernel's frame. Directions come out y up.
+    template<class T>
+    struct HarmonicRows {
+        int Degree;
+        const T* Terms;
+        const T* RecurrenceA;
+        const T* RecurrenceB;
+        T Normalization;
+        T CenterX;
+        T CenterY;
+        T InverseRadius;
+        const T* X;
+        const T* Y;
+        T* DirectionX;
+        T* DirectionY;
+    };
+
+    template<class T>
+    void EvaluateHarmonicField(const HarmonicRows<T>&, std::size_t n);
+    template<class T>
+    void EvaluateHarmonicField(InstructionSet, const HarmonicRows<T>&, std::size_t n);
+    template<class T>
+    void EvaluateHarmonicFieldScalar(const HarmonicRows<T>&, std::size_t begin, std::size_t end);
+
+    // Defaults to the widest supported set. Requests for unsupported sets fall back to the widest supported one.
+    InstructionSet ActiveInstructionSet();
+    void SetActiveInstructionSet(InstructionSet);
+
+    // Maximum absolute deviation from the long double scalar path, over a sweep of angles
+    // that includes the 0/90/180/270 degree special cases
+    struct Accuracy {
+        double Location;
+        double Axes;
+    };
+    template<class T>
+    Accuracy MeasureAccuracy(InstructionSet, std::size_t samples);
+
+    // Largest location error, in px on a 500 px orbit, against a long double solution iterated
+    // to convergence, over a grid of mean anomalies and eccentricities up to 0.99
+    template<class T>
+    double MeasureKeplerAccuracy(InstructionSet, std::size_t samples);
+
+    // Largest field error relative to the local field strength, against the long double kernel,
+    // over rows that cross the whole field from the surface outwards
+    template<class T>
+    double MeasureDipoleAccuracy(InstructionSet, std::size_t samples);
+
+    // Largest visibility margin error relative to the squared station distance, against the
+    // long double kernel, for stations all around the Earth and satellites out to ten radii
+    template<class T>
+    double MeasureVisibilityAccuracy(InstructionSet, std::size_t samples);
+
+    // Largest spherical harmonic field error relative to the local field strength, against the
+    // long double kernel, for a degree 8 expansion from the surface out to ten radii
+    template<class T>
+    double MeasureHarmonicAccuracy(InstructionSet, std::size_t samples);
+}
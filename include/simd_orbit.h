@@ -0,0 +1,116 @@
+#pragma once
+
+#include "simd_kernel.h"
+#include "simd_vector.h"
+#include <iterator>
+
+// The vectorized orbit kernel, written once against the wrappers in simd_vector.h and
+// instantiated by one translation unit per instruction set.
+
+namespace Simulation::Simd {
+    void UpdateOrbitsSSE2(double earthX, double earthY, const OrbitArrays<double>&, std::size_t n);
+    void UpdateOrbitsSSE2(float earthX, float earthY, const OrbitArrays<float>&, std::size_t n);
+    void UpdateOrbitsAVX2(double earthX, double earthY, const OrbitArrays<double>&, std::size_t n);
+    void UpdateOrbitsAVX2(float earthX, float earthY, const OrbitArrays<float>&, std::size_t n);
+    void UpdateOrbitsAVX512(double earthX, double earthY, const OrbitArrays<double>&, std::size_t n);
+    void UpdateOrbitsAVX512(float earthX, float earthY, const OrbitArrays<float>&, std::size_t n);
+
+    template<class T>
+    struct SinCosConstants;
+
+    template<>
+    struct SinCosConstants<double> {
+        // Adding 1.5 * 2^52 rounds to an integer and leaves it in the low mantissa bits
+        static constexpr double Magic = 6755399441055744.0;
+        static constexpr double TwoOverPi = 0.63661977236758134308;
+        static constexpr double PiOverTwo[] = { 1.57079625129699707031, 7.54978941586159635336e-8, 5.39030285815811905290e-15 };
+        static constexpr double Sin[] = {
+            1.58962301576546568060e-10, -2.50507477628578072866e-8, 2.75573136213857245213e-6,
+            -1.98412698295895385996e-4, 8.33333333332211858878e-3, -1.66666666666666307295e-1
+        };
+        static constexpr double Cos[] = {
+            -1.13585365213876817300e-11, 2.08757008419747316778e-9, -2.75573141792967388112e-7,
+            2.48015872888517045348e-5, -1.38888888888730564116e-3, 4.16666666666665929218e-2
+        };
+    };
+
+    template<>
+    struct SinCosConstants<float> {
+        // 1.5 * 2^23
+        static constexpr float Magic = 12582912.0f;
+        static constexpr float TwoOverPi = 0.636619772f;
+        static constexpr float PiOverTwo[] = { 1.5703125f, 4.837512969970703125e-4f, 7.54978995489188216e-8f };
+        static constexpr float Sin[] = { -1.9515295891e-4f, 8.3321608736e-3f, -1.6666654611e-1f };
+        static constexpr float Cos[] = { 2.443315711809948e-5f, -1.388731625493765e-3f, 4.166664568298827e-2f };
+    };
+
+    // sin and cos of x at once: reduce by pi/2 (Cody-Waite, three parts), evaluate the Cephes
+    // minimax polynomials on [-pi/4, pi/4], then pick and negate by quadrant. Accurate to a few ulp
+    // for the angles of an orbit.
+    template<class V>
+    inline void SinCos(typename V::Vector x, typename V::Vector& s, typename V::Vector& c) {
+        using C = SinCosConstants<typename V::Scalar>;
+        const auto magic = V::Set(C::Magic);
+        auto q = V::MulAdd(x, V::Set(C::TwoOverPi), magic);
+        auto n = V::Sub(q, magic);
+
+        auto r = x;
+        for (auto part : C::PiOverTwo) {
+            r = V::MulAdd(n, V::Set(-part), r);
+        }
+        auto z = V::Mul(r, r);
+
+        auto ps = V::Set(C::Sin[0]);
+        for (std::size_t k = 1; k < std::size(C::Sin); k++) {
+            ps = V::MulAdd(ps, z, V::Set(C::Sin[k]));
+        }
+        auto sinR = V::MulAdd(V::Mul(r, z), ps, r);
+
+        auto pc = V::Set(C::Cos[0]);
+        for (std::size_t k = 1; k < std::size(C::Cos); k++) {
+            pc = V::MulAdd(pc, z, V::Set(C::Cos[k]));
+        }
+        auto cosR = V::MulAdd(V::Mul(z, z), pc, V::MulAdd(z, V::Set(-0.5f), V::Set(1.0f)));
+
+        // Odd quadrants swap sin and cos, quadrants 2-3 negate sin, quadrants 1-2 negate cos
+        const auto negative = V::Set(-0.0f);
+        auto swap = V::template BitMask<0>(q);
+        auto signS = V::And(V::template BitMask<1>(q), negative);
+        auto signC = V::And(V::template BitMask<1>(V::Add(q, V::Set(1.0f))), negative);
+        s = V::Xor(V::Select(swap, cosR, sinR), signS);
+        c = V::Xor(V::Select(swap, sinR, cosR), signC);
+    }
+
+    template<class V>
+    inline void UpdateOrbitsVector(typename V::Scalar earthX, typename V::Scalar earthY, const OrbitArrays<typename V::Scalar>& a, std::size_t n) {
+        const auto ex = V::Set(earthX);
+        const auto ey = V::Set(earthY);
+
+        std::size_t i = 0;
+        for (; i + V::Width <= n; i += V::Width) {
+            typename V::Vector s, c;
+            SinCos<V>(V::Load(a.AngleRadians + i), s, c);
+            auto radius = V::Load(a.RadiusTrajectory + i);
+
+            // Location
+            auto x = V::MulAdd(radius, c, ex);
+            auto y = V::Sub(ey, V::Mul(radius, s));
+            V::Store(a.X + i, x);
+            V::Store(a.Y + i, y);
+
+            // Axes, from the same differences the scalar kernel uses. The tangent is the radial turned by 90 degrees.
+            auto dx = V::Sub(ex, x);
+            auto dy = V::Sub(y, ey);
+            auto size = V::Sqrt(V::MulAdd(dx, dx, V::Mul(dy, dy)));
+            auto radialX = V::Div(dx, size);
+            auto radialY = V::Div(dy, size);
+            V::Store(a.RadialDirectionX + i, radialX);
+            V::Store(a.RadialDirectionY + i, radialY);
+            V::Store(a.TangentDirectionX + i, radialY);
+            V::Store(a.TangentDirectionY + i, V::Xor(radialX, V::Set(-0.0f)));
+        }
+
+        // Whatever does not fill a whole register
+        UpdateOrbitsScalar(earthX, earthY, a, i, n);
+    }
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <immintrin.h>
+
+// Thin wrappers over the x86 vector registers, so the kernels in simd_orbit.h and friends are written once.
+// Each wrapper is only visible in translation units compiled for its instruction set.
+
+namespace Simulation::Simd {
+    template<class T>
+    struct SSE2;
+    template<class T>
+    struct AVX2;
+    template<class T>
+    struct AVX512;
+
+    template<>
+    struct SSE2<double> {
+        using Scalar = double;
+        using Vector = __m128d;
+        static constexpr int Width = 2;
+
+        static Vector Load(const double* p) { return _mm_loadu_pd(p); }
+        static void Store(double* p, Vector v) { _mm_storeu_pd(p, v); }
+        static Vector Set(double x) { return _mm_set1_pd(x); }
+
+        static Vector Add(Vector a, Vector b) { return _mm_add_pd(a, b); }
+        static Vector Sub(Vector a, Vector b) { return _mm_sub_pd(a, b); }
+        static Vector Mul(Vector a, Vector b) { return _mm_mul_pd(a, b); }
+        static Vector Div(Vector a, Vector b) { return _mm_div_pd(a, b); }
+        static Vector Sqrt(Vector a) { return _mm_sqrt_pd(a); }
+        static Vector MulAdd(Vector a, Vector b, Vector c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+
+        static Vector And(Vector a, Vector b) { return _mm_and_pd(a, b); }
+        static Vector Xor(Vector a, Vector b) { return _mm_xor_pd(a, b); }
+        static Vector Select(Vector mask, Vector a, Vector b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+        static Vector Less(Vector a, Vector b) { return _mm_cmplt_pd(a, b); }
+
+        // All ones in the lanes whose integer (stored as double + 1.5 * 2^52) has the given bit set
+        template<int Bit>
+        static Vector BitMask(Vector q) {
+            auto bits = _mm_and_si128(_mm_srli_epi64(_mm_castpd_si128(q), Bit), _mm_set1_epi64x(1));
+            return _mm_castsi128_pd(_mm_sub_epi64(_mm_setzero_si128(), bits));
+        }
+    };
+
+    template<>
+    struct SSE2<float> {
+        using Scalar = float;
+        using Vector = __m128;
+        static constexpr int Width = 4;
+
+        static Vector Load(const float* p) { return _mm_loadu_ps(p); }
+        static void Store(float* p, Vector v) { _mm_storeu_ps(p, v); }
+        static Vector Set(float x) { return _mm_set1_ps(x); }
+
+        static Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+        static Vector Sub(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+        static Vector Mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+        static Vector Div(Vector a, Vector b) { return _mm_div_ps(a, b); }
+        static Vector Sqrt(Vector a) { return _mm_sqrt_ps(a); }
+        static Vector MulAdd(Vector a, Vector b, Vector c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+        static Vector And(Vector a, Vector b) { return _mm_and_ps(a, b); }
+        static Vector Xor(Vector a, Vector b) { return _mm_xor_ps(a, b); }
+        static Vector Select(Vector mask, Vector a, Vector b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+        static Vector Less(Vector a, Vector b) { return _mm_cmplt_ps(a, b); }
+
+        // All ones in the lanes whose integer (stored as float + 1.5 * 2^23) has the given bit set
+        template<int Bit>
+        static Vector BitMask(Vector q) {
+            auto bits = _mm_and_si128(_mm_srli_epi32(_mm_castps_si128(q), Bit), _mm_set1_epi32(1));
+            return _mm_castsi128_ps(_mm_sub_epi32(_mm_setzero_si128(), bits));
+        }
+    };
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+    template<>
+    struct AVX2<double> {
+        using Scalar = double;
+        using Vector = __m256d;
+        static constexpr int Width = 4;
+
+        static Vector Load(const double* p) { return _mm256_loadu_pd(p); }
+        static void Store(double* p, Vector v) { _mm256_storeu_pd(p, v); }
+        static Vector Set(double x) { return _mm256_set1_pd(x); }
+
+        static Vector Add(Vector a, Vector b) { return _mm256_add_pd(a, b); }
+        static Vector Sub(Vector a, Vector b) { return _mm256_sub_pd(a, b); }
+        static Vector Mul(Vector a, Vector b) { return _mm256_mul_pd(a, b); }
+        static Vector Div(Vector a, Vector b) { return _mm256_div_pd(a, b); }
+        static Vector Sqrt(Vector a) { return _mm256_sqrt_pd(a); }
+        static Vector MulAdd(Vector a, Vector b, Vector c) { return _mm256_fmadd_pd(a, b, c); }
+
+        static Vector And(Vector a, Vector b) { return _mm256_and_pd(a, b); }
+        static Vector Xor(Vector a, Vector b) { return _mm256_xor_pd(a, b); }
+        static Vector Select(Vector mask, Vector a, Vector b) { return _mm256_blendv_pd(b, a, mask); }
+        static Vector Less(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+
+        template<int Bit>
+        static Vector BitMask(Vector q) {
+            auto bits = _mm256_and_si256(_mm256_srli_epi64(_mm256_castpd_si256(q), Bit), _mm256_set1_epi64x(1));
+            return _mm256_castsi256_pd(_mm256_sub_epi64(_mm256_setzero_si256(), bits));
+        }
+    };
+
+    template<>
+    struct AVX2<float> {
+        using Scalar = float;
+        using Vector = __m256;
+        static constexpr int Width = 8;
+
+        static Vector Load(const float* p) { return _mm256_loadu_ps(p); }
+        static void Store(float* p, Vector v) { _mm256_storeu_ps(p, v); }
+        static Vector Set(float x) { return _mm256_set1_ps(x); }
+
+        static Vector Add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+        static Vector Sub(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+        static Vector Mul(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+        static Vector Div(Vector a, Vector b) { return _mm256_div_ps(a, b); }
+        static Vector Sqrt(Vector a) { return _mm256_sqrt_ps(a); }
+        static Vector MulAdd(Vector a, Vector b, Vector c) { return _mm256_fmadd_ps(a, b, c); }
+
+        static Vector And(Vector a, Vector b) { return _mm256_and_ps(a, b); }
+        static Vector Xor(Vector a, Vector b) { return _mm256_xor_ps(a, b); }
+        static Vector Select(Vector mask, Vector a, Vector b) { return _mm256_blendv_ps(b, a, mask); }
+        static Vector Less(Vector a, Vector b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+
+        template<int Bit>
+        static Vector BitMask(Vector q) {
+            auto bits = _mm256_and_si256(_mm256_srli_epi32(_mm256_castps_si256(q), Bit), _mm256_set1_epi32(1));
+            return _mm256_castsi256_ps(_mm256_sub_epi32(_mm256_setzero_si256(), bits));
+        }
+    };
+#endif
+
+#if defined(__AVX512F__)
+    template<>
+    struct AVX512<double> {
+        using Scalar = double;
+        using Vector = __m512d;
+        static constexpr int Width = 8;
+
+        static Vector Load(const double* p) { return _mm512_loadu_pd(p); }
+        static void Store(double* p, Vector v) { _mm512_storeu_pd(p, v); }
+        static Vector Set(double x) { return _mm512_set1_pd(x); }
+
+        static Vector Add(Vector a, Vector b) { return _mm512_add_pd(a, b); }
+        static Vector Sub(Vector a, Vector b) { return _mm512_sub_pd(a, b); }
+        static Vector Mul(Vector a, Vector b) { return _mm512_mul_pd(a, b); }
+        static Vector Div(Vector a, Vector b) { return _mm512_div_pd(a, b); }
+        static Vector Sqrt(Vector a) { return _mm512_sqrt_pd(a); }
+        static Vector MulAdd(Vector a, Vector b, Vector c) { return _mm512_fmadd_pd(a, b, c); }
+
+        // AVX-512F has no floating point logic, go through the integer unit
+        static Vector And(Vector a, Vector b) { return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(a), _mm512_castpd_si512(b))); }
+        static Vector Xor(Vector a, Vector b) { return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a), _mm512_castpd_si512(b))); }
+        static Vector Select(Vector mask, Vector a, Vector b) {
+            auto k = _mm512_test_epi64_mask(_mm512_castpd_si512(mask), _mm512_castpd_si512(mask));
+            return _mm512_mask_blend_pd(k, b, a);
+        }
+        // Masks live in k registers, spread them back over the lanes so Select and And see the same thing as on AVX2
+        static Vector Less(Vector a, Vector b) { return _mm512_castsi512_pd(_mm512_maskz_set1_epi64(_mm512_cmp_pd_mask(a, b, _CMP_LT_OQ), -1)); }
+
+        template<int Bit>
+        static Vector BitMask(Vector q) {
+            auto bits = _mm512_and_si512(_mm512_srli_epi64(_mm512_castpd_si512(q), Bit), _mm512_set1_epi64(1));
+            return _mm512_castsi512_pd(_mm512_sub_epi64(_mm512_setzero_si512(), bits));
+        }
+    };
+
+    template<>
+    struct AVX512<float> {
+        using Scalar = float;
+        using Vector = __m512;
+        static constexpr int Width = 16;
+
+        static Vector Load(const float* p) { return _mm512_loadu_ps(p); }
+        static void Store(float* p, Vector v) { _mm512_storeu_ps(p, v); }
+        static Vector Set(float x) { return _mm512_set1_ps(x); }
+
+        static Vector Add(Vector a, Vector b) { return _mm512_add_ps(a, b); }
+        static Vector Sub(Vector a, Vector b) { return _mm512_sub_ps(a, b); }
+        static Vector Mul(Vector a, Vector b) { return _mm512_mul_ps(a, b); }
+        static Vector Div(Vector a, Vector b) { return _mm512_div_ps(a, b); }
+        static Vector Sqrt(Vector a) { return _mm512_sqrt_ps(a); }
+        static Vector MulAdd(Vector a, Vector b, Vector c) { return _mm512_fmadd_ps(a, b, c); }
+
+        static Vector And(Vector a, Vector b) { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+        static Vector Xor(Vector a, Vector b) { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+        static Vector Select(Vector mask, Vector a, Vector b) {
+            auto k = _mm512_test_epi32_mask(_mm512_castps_si512(mask), _mm512_castps_si512(mask));
+            return _mm512_mask_blend_ps(k, b, a);
+        }
+        static Vector Less(Vector a, Vector b) { return _mm512_castsi512_ps(_mm512_maskz_set1_epi32(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ), -1)); }
+
+        template<int Bit>
+        static Vector BitMask(Vector q) {
+            auto bits = _mm512_and_si512(_mm512_srli_epi32(_mm512_castps_si512(q), Bit), _mm512_set1_epi32(1));
+            return _mm512_castsi512_ps(_mm512_sub_epi32(_mm512_setzero_si512(), bits));
+        }
+    };
+#endif
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "simd_kernel.h"
+#include "simd_vector.h"
+
+// The vectorized ground station visibility kernel, instantiated next to the orbit kernel in the per instruction set units
+
+namespace Simulation::Simd {
+    void EvaluateVisibilitySSE2(const VisibilityRow<double>&, std::size_t n);
+    void EvaluateVisibilitySSE2(const VisibilityRow<float>&, std::size_t n);
+    void EvaluateVisibilityAVX2(const VisibilityRow<double>&, std::size_t n);
+    void EvaluateVisibilityAVX2(const VisibilityRow<float>&, std::size_t n);
+    void EvaluateVisibilityAVX512(const VisibilityRow<double>&, std::size_t n);
+    void EvaluateVisibilityAVX512(const VisibilityRow<float>&, std::size_t n);
+
+    // Same steps as Kernel::VisibilityMargin, the sign of the up component applied by a select
+    template<class V>
+    inline void EvaluateVisibilityVector(const VisibilityRow<typename V::Scalar>& row, std::size_t n) {
+        const auto stationX = V::Set(row.StationX);
+        const auto stationY = V::Set(row.StationY);
+        const auto upX = V::Set(row.UpX);
+        const auto upY = V::Set(row.UpY);
+        const auto mask = V::Set(row.MaskTerm);
+        const auto zero = V::Set(0.0f);
+
+        std::size_t i = 0;
+        for (; i + V::Width <= n; i += V::Width) {
+            auto dx = V::Sub(V::Load(row.X + i), stationX);
+            auto dy = V::Sub(V::Load(row.Y + i), stationY);
+            auto up = V::MulAdd(dx, upX, V::Mul(dy, upY));
+            auto up2 = V::Mul(up, up);
+            auto signedUp2 = V::Select(V::Less(up, zero), V::Sub(zero, up2), up2);
+            V::Store(row.Margin + i, V::Sub(signedUp2, V::Mul(mask, V::MulAdd(dx, dx, V::Mul(dy, dy)))));
+        }
+
+        // Whatever does not fill a whole register
+        EvaluateVisibilityScalar(row, i, n);
+    }
+}
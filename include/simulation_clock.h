@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace Simulation {
+    // Turns wall-clock time into a whole number of fixed simulation steps.
+    // Real time is scaled by the time warp and collected in an accumulator; every full step in it
+    // is handed out by Advance, the remainder waits for the next call. The simulation only ever
+    // sees fixed steps, so scheduler jitter can not leak into the physics.
+    class SimulationClock {
+    public:
+        static constexpr auto DefaultStep = std::chrono::nanoseconds(5000000); // 200 Hz
+        static constexpr auto MinTimeWarp = 1.0;
+        static constexpr auto MaxTimeWarp = 1000000.0;
+
+        explicit SimulationClock(std::chrono::nanoseconds step = DefaultStep);
+
+        std::chrono::nanoseconds Step() const;
+        double StepSeconds() const;
+
+        double TimeWarp() const;
+        // Clamped to [MinTimeWarp, MaxTimeWarp]
+        void SetTimeWarp(double);
+
+        // Feed the real time since the previous call, returns the number of steps now due
+        std::uint64_t Advance(std::chrono::nanoseconds real);
+
+        // Fraction of a step waiting in the accumulator, for interpolating between two states
+        double Alpha() const;
+
+        // Total steps handed out so far
+        std::uint64_t Steps() const;
+
+        void Reset();
+    private:
+        std::chrono::nanoseconds step;
+        double timeWarp;
+        // Simulated nanoseconds not yet handed out, kept in double for the sub-nanosecond warp remainders
+        double accumulator;
+        std::uint64_t steps;
+    };
+}
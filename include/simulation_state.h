@@ -0,0 +1,109 @@
+#pragma once
+
+#include "core.h"
+#include "precision.h"
+#include "constellation.h"
+#include "geomagnetic_field.h"
+#include <cstdint>
+
+namespace Simulation {
+    template<class T>
+    struct EarthState {
+        T Radius;
+        T X, Y;
+    };
+
+    template<class T>
+    struct SatelliteState {
+        T Radius;
+        T RadiusTrajectory;
+        T X, Y;
+        T PeriodSeconds;
+        // Fraction of a turn at simulated time zero
+        PhaseScalar<T> PhaseOffset;
+        T AngleDegrees, AngleRadians;
+        T RadialDirectionX, RadialDirectionY;
+        T TangentDirectionX, TangentDirectionY;
+    };
+
+    // Radius of the circular field line through the satellite, and the field direction there: from
+    // the circular field table, or from the spherical harmonic model when one is set
+    template<class T>
+    struct CircularFieldState {
+        T Radius;
+        T DirectionX, DirectionY;
+    };
+
+    // The physical state of the simulation, free of any window or render target.
+    // The Win32 front end steps it on the simulation thread and hands snapshots of it to the
+    // renderer (snapshot.h), the headless runner steps it directly.
+    //
+    // Simulated time is an integer count of nanoseconds and every angle is a pure function of it
+    // (phase offset + time / period), so a run is bit-reproducible however its steps are batched,
+    // and StepN costs the same for any n.
+    //
+    // Explicitly instantiated for float, double and long double in simulation_state.cpp.
+    // The displayed satellite and its field at some time, on their own
+    template<class T>
+    struct DisplayedState {
+        std::int64_t ElapsedNanoseconds;
+        SatelliteState<T> Satellite;
+        CircularFieldState<T> CircularField;
+    };
+
+    template<class T>
+    class BasicSimulationState {
+    public:
+        static constexpr auto DefaultPeriodSeconds = T(30);
+        static constexpr auto DefaultTrajectoryEarthRadii = T(4);
+
+        EarthState<T> Earth;
+        SatelliteState<T> Satellite;
+        CircularFieldState<T> CircularField;
+        // Additional satellites, stepped together with the displayed one
+        BasicConstellation<T> Satellites;
+        std::int64_t ElapsedNanoseconds;
+
+        BasicSimulationState();
+
+        PhaseScalar<T> ElapsedSeconds() const;
+
+        void InitializeEarth(T radius, T x, T y);
+        void InitializeSatellite(T radius);
+
+        // Place the satellite at the given fraction of a full orbit, then recompute everything
+        void SetOrbitFraction(T fraction);
+        // Change the period without moving the satellite: the orbit carries on from the current angle
+        void SetPeriod(T seconds);
+        // Recompute the angles, locations, axes and fields from the current time
+        void Update();
+
+        // dt is rounded to whole nanoseconds
+        void Step(T dtSeconds);
+        void StepN(std::uint64_t n, T dtSeconds);
+        void StepNanoseconds(std::int64_t);
+
+        // What Satellite and CircularField hold at another time, bit for bit, without stepping
+        // anything: the constellation stays where it is
+        DisplayedState<T> DisplayedAt(std::int64_t elapsedNanoseconds) const;
+
+        // Field directions of the satellite and the constellation from a spherical harmonic model
+        // instead of the circular field table, or back from the table for null. Not owned, has to
+        // outlive the state or be unset first.
+        void SetFieldModel(const BasicSphericalHarmonicField<T>*);
+        const BasicSphericalHarmonicField<T>* FieldModel() const;
+    private:
+        const BasicSphericalHarmonicField<T>* fieldModel;
+
+        void UpdateAngle(PhaseScalar<T> elapsedSeconds, SatelliteState<T>&) const;
+        void UpdateLocation(SatelliteState<T>&) const;
+        void UpdateAxes(SatelliteState<T>&) const;
+        void UpdateCircularField(const SatelliteState<T>&, CircularFieldState<T>&) const;
+    };
+
+    using SimulationState = BasicSimulationState<Scalar>;
+
+    extern template class BasicSimulationState<float>;
+    extern template class BasicSimulationState<double>;
+    extern template class BasicSimulationState<long double>;
+}
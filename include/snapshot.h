@@ -0,0 +1,30 @@
+#pragma once
+
+#include "simulation_state.h"
+#include "triple_buffer.h"
+
+namespace Simulation {
+    // Everything the renderer draws for one tick, copied out of the simulation state so the
+    // renderer never reads anything the simulation thread is still writing
+    template<class T>
+    struct BasicSnapshot {
+        std::uint64_t Tick;
+        std::int64_t ElapsedNanoseconds;
+        double TimeWarp;
+        EarthState<T> Earth;
+        SatelliteState<T> Satellite;
+        CircularFieldState<T> CircularField;
+
+        void Capture(const BasicSimulationState<T>& state, std::uint64_t tick, double timeWarp) {
+            Tick = tick;
+            ElapsedNanoseconds = state.ElapsedNanoseconds;
+            TimeWarp = timeWarp;
+            Earth = state.Earth;
+            Satellite = state.Satellite;
+            CircularField = state.CircularField;
+        }
+    };
+
+    using Snapshot = BasicSnapshot<Scalar>;
+    using SnapshotBuffer = TripleBuffer<Snapshot>;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "renderer.h"
+#include "thread_pool.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Simulation {
+    // Draws into an RGBA buffer in memory, for machines without a window or a GPU. A frame is
+    // recorded as a list of commands and rasterized at EndFrame in square tiles spread over a
+    // thread pool: every tile runs through the whole list clipped to itself, so no two threads
+    // ever touch the same pixel and the result does not depend on the number of threads.
+    //
+    // The static layer is kept as a second buffer. While it stays valid only the tiles something
+    // is drawn into, this frame or the last, are rasterized again: from a copy of the layer, the
+    // rest of the buffer still holds exactly that.
+    class SoftwareRenderer : public Renderer {
+    public:
+        static constexpr int TileSize = 64;
+        // The bitmap font scaled to about the window's 36 px text
+        static constexpr int TextScale = 4;
+
+        SoftwareRenderer(int width, int height, ThreadPool& = ThreadPool::Shared());
+
+        // R, G, B, A bytes per pixel, rows from the top
+        const std::uint8_t* Pixels() const;
+        // Straight RGBA bytes. A bitmap without pixels is drawn as a plain disc.
+        void SetBitmap(BitmapId, int width, int height, std::vector<std::uint8_t> rgba);
+        // Binary PPM, without the alpha
+        bool WritePPM(const char* path) const;
+        // Tiles the last EndFrame had to rasterize, out of Tiles()
+        std::size_t DirtyTiles() const;
+        std::size_t Tiles() const;
+
+        int Width() const override;
+        int Height() const override;
+
+        void BeginFrame(Color background) override;
+        void EndFrame() override;
+        bool BeginLayer(std::uint64_t key) override;
+        bool EndLayer() override;
+
+        void DrawBitmap(BitmapId, float centerX, float centerY, float size, float rotationDegrees) override;
+        void DrawEllipse(float centerX, float centerY, float radiusX, float radiusY, const Stroke&) override;
+        void DrawLine(float x1, float y1, float x2, float y2, const Stroke&) override;
+        void DrawPolylines(const FieldLineSet&, const Stroke&) override;
+        void DrawString(std::wstring_view, std::size_t prefixLength, float x, float y, Color) override;
+        void MeasureString(std::wstring_view, float& width, float& height) override;
+    private:
+        struct Command {
+            enum class Type {
+                Bitmap,
+                Ellipse,
+                Line,
+                Polylines,
+                Text
+            };
+
+            Type Kind;
+            float Parameters[5];
+            Simulation::Stroke Stroke;
+            BitmapId Bitmap;
+            const FieldLineSet* Lines;
+            std::size_t TextBegin, TextEnd;
+            // Everything the command may touch, for skipping it in the tiles it does not
+            float MinX, MinY, MaxX, MaxY;
+        };
+
+        struct Image {
+            int Width = 0;
+            int Height = 0;
+            std::vector<std::uint8_t> Pixels;
+        };
+
+        // The part of the target one tile may write
+        struct Tile {
+            std::uint8_t* Pixels;
+            int Stride;
+            int X0, Y0, X1, Y1;
+        };
+
+        int width, height;
+        int columns, rows;
+        ThreadPool& pool;
+        std::vector<std::uint8_t> pixels;
+        Color background;
+        std::vector<Command> commands;
+        std::u32string text;
+        Image bitmaps[2];
+
+        std::vector<std::uint8_t> layer;
+        std::uint64_t layerKey;
+        bool layerValid;
+        bool layerUsed;     // This frame
+        bool layerChanged;  // This frame
+        bool recordingLayer;
+
+        // Per tile: something besides the layer was drawn into it last frame, or is this frame
+        std::vector<std::uint8_t> drawnLast, drawnNow;
+        std::vector<std::size_t> dirty;
+
+        void MarkTiles(std::vector<std::uint8_t>&, float minX, float minY, float maxX, float maxY) const;
+        void MarkCommand(std::vector<std::uint8_t>&, const Command&) const;
+        // Into target, starting from the background or from a copy of the same tile of base
+        void RasterizeTile(std::uint8_t* target, const std::uint8_t* base, std::size_t);
+        void RasterizeBitmap(const Tile&, const Command&) const;
+        void RasterizeEllipse(const Tile&, const Command&) const;
+        void RasterizeLine(const Tile&, const Command&) const;
+        void RasterizePolylines(const Tile&, const Command&) const;
+        void RasterizeText(const Tile&, const Command&) const;
+    };
+}
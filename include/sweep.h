@@ -0,0 +1,71 @@
+#pragma once
+
+#include "precision.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Simulation {
+    // One independent simulation: the displayed satellite alone, from its start for DurationSeconds
+    // in fixed steps of StepSeconds
+    struct SweepCase {
+        double PeriodSeconds;
+        double TrajectoryEarthRadii;
+        double DurationSeconds;
+        double StepSeconds;
+    };
+
+    // FROM:TO:COUNT, evenly spaced with both ends included, or a single value
+    struct SweepRange {
+        double From = 0, To = 0;
+        std::size_t Count = 0;
+
+        static bool Parse(const char* text, SweepRange&);
+        std::vector<double> Values() const;
+    };
+
+    struct SweepResult {
+        SweepCase Case;
+        std::uint64_t Steps;
+        // Over every step, in units of the field on the surface at the equator: the circular field's
+        // relative strength, falling off with the cube of the distance like the dipole's
+        double MinField, MaxField;
+        double Coverage;    // Fraction of the orbit's 1 degree sectors the satellite was in at a step
+        double Seconds;     // Wall time of the run
+    };
+
+    // Many simulations of different periods and orbits, one ThreadPool::ParallelFor task each, so
+    // the pool's work stealing evens long and short runs out, and reduced to one row each.
+    // Every row is the same whatever the number of threads, but for its wall time.
+    // Explicitly instantiated for float, double and long double in sweep.cpp.
+    template<class T>
+    class BasicParameterSweep {
+    public:
+        // Every period with every radius, periods outermost
+        static std::vector<SweepCase> Grid(const std::vector<double>& periods, const std::vector<double>& radii, double durationSeconds, double stepSeconds);
+        // A text file of "PERIOD RADII DURATION STEP" lines, '#' starting a comment. False with
+        // "path:line: what" in error.
+        static bool Load(const std::string& path, std::vector<SweepCase>&, std::string& error);
+
+        // In the order of the cases. Cases that do not describe an orbit get a row of zeros.
+        const std::vector<SweepResult>& Run(const std::vector<SweepCase>&, ThreadPool& = ThreadPool::Shared());
+
+        const std::vector<SweepResult>& Results() const;
+        // Wall time of the last Run, and the sum of its rows' wall times
+        double Seconds() const;
+        double BusySeconds() const;
+    private:
+        std::vector<SweepResult> results;
+        double seconds = 0;
+
+        static SweepResult RunCase(const SweepCase&);
+    };
+
+    using ParameterSweep = BasicParameterSweep<Scalar>;
+
+    extern template class BasicParameterSweep<float>;
+    extern template class BasicParameterSweep<double>;
+    extern template class BasicParameterSweep<long double>;
+}
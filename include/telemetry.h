@@ -0,0 +1,188 @@
+#pragma once
+
+#include "mapped_file.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The satellite state at every fixed simulation step on disk, laid out to be mapped and scanned a column at a time.
+// A tick that runs more than TelemetryRecorder::MaxRowsPerBatch steps, at a high time warp, has
+// only every n-th of them recorded, evenly spread and always its last: at most that many rows per tick.
+//
+// A 4096 byte header, then blocks of BlockRows rows. Inside a block every column is one
+// contiguous array of 8 byte cells: the time as int64 nanoseconds, the rest as double. Every
+// block has the full size, the unused tail of the last one is zero, so the address of any cell
+// follows from the header alone. Little endian, as written by the machine that recorded it.
+
+namespace Simulation {
+    enum class TelemetryColumn : std::uint32_t {
+        Time,
+        Angle,
+        X,
+        Y,
+        RadialX,
+        RadialY,
+        TangentX,
+        TangentY,
+        FieldX,
+        FieldY,
+        FieldRadius,
+        Period,
+        Count
+    };
+
+    constexpr auto TelemetryColumns = (std::size_t)TelemetryColumn::Count;
+
+    const char* ToString(TelemetryColumn);
+
+    // What stays the same from step to step, everything else a replay needs to draw the scene
+    struct TelemetryScene {
+        double EarthRadius;
+        double EarthX, EarthY;
+        double SatelliteRadius;
+        double RadiusTrajectory;
+
+        template<class Source>
+        static TelemetryScene From(const Source& source) {
+            return { (double)source.Earth.Radius, (double)source.Earth.X, (double)source.Earth.Y,
+                     (double)source.Satellite.Radius, (double)source.Satellite.RadiusTrajectory };
+        }
+    };
+
+    struct TelemetryHeader {
+        static constexpr char Signature[8] = { 'S', 'I', 'M', 'T', 'E', 'L', 'E', 'M' };
+        static constexpr std::uint32_t CurrentVersion = 2;
+        static constexpr std::size_t Bytes = 4096;
+        // The cell types of TelemetryColumnInfo
+        static constexpr std::uint32_t Int64 = 0, Float64 = 1;
+
+        char Magic[8];
+        std::uint32_t Version;
+        std::uint32_t HeaderBytes;
+        std::uint32_t Columns;
+        std::uint32_t BlockRows;
+        // Rows in the blocks written so far, kept up to date while recording
+        std::uint64_t Rows;
+        TelemetryScene Scene;
+        struct TelemetryColumnInfo {
+            char Name[16];
+            std::uint32_t Type;
+            std::uint32_t Reserved;
+        } ColumnInfo[TelemetryColumns];
+    };
+    static_assert(sizeof(TelemetryHeader) <= TelemetryHeader::Bytes);
+
+    // One row: the satellite and its field after a step, in double whatever the build's Scalar
+    struct TelemetrySample {
+        std::int64_t ElapsedNanoseconds;
+        double Values[TelemetryColumns - 1];
+
+        // From a simulation state or a snapshot
+        template<class Source>
+        static TelemetrySample From(const Source& source) {
+            const auto& satellite = source.Satellite;
+            const auto& field = source.CircularField;
+            return { source.ElapsedNanoseconds, {
+                (double)satellite.AngleDegrees, (double)satellite.X, (double)satellite.Y,
+                (double)satellite.RadialDirectionX, (double)satellite.RadialDirectionY,
+                (double)satellite.TangentDirectionX, (double)satellite.TangentDirectionY,
+                (double)field.DirectionX, (double)field.DirectionY, (double)field.Radius, (double)satellite.PeriodSeconds } };
+        }
+    };
+
+    // Appends rows on the simulation thread. Rows go into an in-memory block laid out as on disk,
+    // a full block is handed to a background thread that writes it and moves on the row count in
+    // the header. Recording waits only when every block buffer is still queued for writing.
+    class TelemetryRecorder {
+    public:
+        // 4096 rows: 20 simulated seconds at the default 200 Hz step, 352 KiB per block
+        static constexpr std::size_t DefaultBlockRows = 4096;
+        static constexpr std::size_t Buffers = 4;
+        // 51200 rows a second at the window's 200 Hz ticks
+        static constexpr std::uint64_t MaxRowsPerBatch = 256;
+
+        TelemetryRecorder(const std::string& path, const TelemetryScene&, std::size_t blockRows = DefaultBlockRows);
+        ~TelemetryRecorder();
+
+        TelemetryRecorder(const TelemetryRecorder&) = delete;
+        TelemetryRecorder& operator=(const TelemetryRecorder&) = delete;
+
+        // Creating or writing the file failed
+        bool Failed() const;
+
+        void Record(const TelemetrySample&);
+        // Rows for the last steps steps of stepNanoseconds each that brought state to where it is.
+        // The displayed satellite is worked out at every step's time alone, nothing is stepped
+        // again. Over MaxRowsPerBatch steps only every n-th is recorded, as the header describes.
+        template<class State>
+        void RecordSteps(const State& state, std::uint64_t steps, std::int64_t stepNanoseconds) {
+            if (steps == 0) {
+                return;
+            }
+            auto stride = (steps + MaxRowsPerBatch - 1) / MaxRowsPerBatch;
+            for (auto k = (steps - 1) % stride + 1; k < steps; k += stride) {
+                Record(TelemetrySample::From(state.DisplayedAt(state.ElapsedNanoseconds - (std::int64_t)(steps - k) * stepNanoseconds)));
+            }
+            Record(TelemetrySample::From(state));
+        }
+        // Writes the last, partial block and closes the file
+        void Finish();
+
+        std::uint64_t Rows() const;
+        // Records that had to wait for a buffer
+        std::uint64_t Stalls() const;
+    private:
+        struct Block {
+            std::vector<std::uint64_t> Cells;
+            std::size_t Rows;
+        };
+
+        std::size_t blockRows;
+        std::FILE* file;
+        std::vector<Block> blocks;
+        // Written to by Record, owned by the recording thread
+        Block* filling;
+        std::uint64_t rows;
+        std::uint64_t stalls;
+
+        mutable std::mutex mutex;
+        std::condition_variable queued, freed;
+        std::vector<Block*> freeBlocks;
+        // In order, at most Buffers of them
+        std::vector<Block*> full;
+        bool stopping;
+        bool failed;
+        std::thread writer;
+
+        void Queue(Block*);
+        void WriterLoop();
+    };
+
+    // A recorded file mapped into memory: columns are read in place, block by block
+    class TelemetryFile {
+    public:
+        // False unless the file is a telemetry file this version can read
+        bool Open(const std::string& path);
+
+        std::uint64_t Rows() const;
+        std::size_t BlockRows() const;
+        std::size_t Blocks() const;
+        // Rows used in the block, BlockRows except in the last
+        std::size_t RowsIn(std::size_t block) const;
+        const TelemetryScene& Scene() const;
+
+        const std::int64_t* Times(std::size_t block) const;
+        const double* Column(TelemetryColumn, std::size_t block) const;
+    private:
+        MappedFile file;
+        const TelemetryHeader* header = nullptr;
+        std::size_t blocks = 0;
+
+        const std::uint8_t* Cells(std::size_t column, std::size_t block) const;
+    };
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Simulation {
+    // A fixed set of worker threads for data-parallel loops. The calling thread joins in,
+    // so a pool of one thread has no workers at all and runs everything inline.
+    //
+    // Work stealing: a loop starts out split into one contiguous range per thread, each thread
+    // takes indices from the front of its own and, once it runs dry, steals the back half of the
+    // largest range left. Threads only share a cache line when they steal, run neighbouring
+    // indices, and a thread that wakes late or draws slow tasks is relieved by the others.
+    class ThreadPool {
+    public:
+        // 0 means one thread per hardware thread
+        explicit ThreadPool(unsigned threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Including the calling thread
+        unsigned Size() const;
+
+        // Runs task(i) for every i in [0, count) and returns once all of them are done, each index
+        // exactly once but in no particular order. Calls from inside a task run inline instead of
+        // deadlocking on the busy pool.
+        void ParallelFor(std::size_t count, const std::function<void(std::size_t)>& task);
+
+        // Shared by everything that does not need a pool of its own
+        static ThreadPool& Shared();
+    private:
+        std::vector<std::thread> workers;
+        std::mutex callerMutex; // One ParallelFor at a time
+
+        std::mutex mutex;
+        std::condition_variable wake, done;
+        std::uint64_t generation;
+        unsigned busy;
+        bool stopping;
+
+        // What is left of a thread's range, begin in the low half and end in the high half, so
+        // the owner taking one index and a thief taking half are both a single compare-exchange
+        struct alignas(64) Range {
+            std::atomic<std::uint64_t> Bounds;
+        };
+        static constexpr std::size_t MaxRange = 0xFFFFFFFFu;
+
+        const std::function<void(std::size_t)>* task;
+        std::size_t offset;     // Of index 0 of the ranges, loops past MaxRange go in rounds
+        std::unique_ptr<Range[]> ranges;
+
+        void WorkerLoop(unsigned index);
+        void RunTasks(unsigned index);
+        bool Steal(unsigned index);
+    };
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Simulation {
+    // Hands the newest value from one writer thread to one reader thread without locks and without
+    // either side ever waiting. The writer fills Back() and publishes it, the reader takes the newest
+    // published value into Front() whenever it likes; values published in between are dropped.
+    //
+    // Three slots: one the writer owns, one the reader owns, and one in the middle that they swap
+    // through with a single atomic exchange, a flag in its index saying whether it is unread.
+    template<class T>
+    class TripleBuffer {
+    public:
+        TripleBuffer() : slots(), middle(1), back(0), front(2) {}
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        // Writer side
+        T& Back() {
+            return slots[back];
+        }
+
+        void Publish() {
+            back = middle.exchange(back | Fresh, std::memory_order_acq_rel) & Index;
+        }
+
+        // Reader side. True when there was something new, which Front() now holds.
+        bool Update() {
+            if ((middle.load(std::memory_order_relaxed) & Fresh) == 0) {
+                return false;
+            }
+            front = middle.exchange(front, std::memory_order_acq_rel) & Index;
+            return true;
+        }
+
+        const T& Front() const {
+            return slots[front];
+        }
+    private:
+        static constexpr std::uint8_t Index = 3;
+        static constexpr std::uint8_t Fresh = 4;
+
+        T slots[3];
+        // On their own cache lines, each side only ever touches its own index and the middle
+        alignas(64) std::atomic<std::uint8_t> middle;
+        alignas(64) std::uint8_t back;
+        alignas(64) std::uint8_t front;
+    };
+}
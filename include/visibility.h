@@ -0,0 +1,127 @@
+#pragma once
+
+#include "precision.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Simulation {
+    template<class T>
+    class BasicKeplerCatalog;
+
+    // Ground stations on the surface of the Earth disc, each with the lowest elevation above its
+    // horizon it can track at. Locations are relative to the Earth's center, y up, like the Kepler catalog.
+    // Explicitly instantiated for float, double and long double in visibility.cpp.
+    template<class T>
+    class BasicGroundStations {
+    public:
+        std::vector<T> AngleRadians;    // Counterclockwise from the +x axis
+        std::vector<T> MinElevation;    // Radians, [0, pi/2]
+        // Derived once in Add
+        std::vector<T> UpX, UpY;
+        std::vector<T> MaskTerm;        // sin(MinElevation)^2, see Kernel::VisibilityMargin
+
+        std::size_t Size() const;
+        void Reserve(std::size_t);
+        void Clear();
+
+        // Returns the index of the new station. A mask under the horizon is raised to it:
+        // above the horizon the Earth itself can never block the line of sight.
+        std::size_t Add(T angleRadians, T minElevationRadians);
+
+        // Radians above the station's horizon, on the scalar path
+        T Elevation(std::size_t station, T earthRadius, T x, T y) const;
+        // Kernel::VisibilityMargin of satellites [0, n) on the active instruction set, >= 0 where visible
+        void Margins(std::size_t station, T earthRadius, const T* x, const T* y, T* margin, std::size_t n) const;
+    };
+
+    using GroundStations = BasicGroundStations<Scalar>;
+
+    // A satellite above a station's mask from Rise to Set, in simulated seconds. Windows already
+    // open at the start of the planned range rise there, ones still open at its end set there.
+    struct ContactWindow {
+        std::uint32_t Station;
+        std::uint32_t Satellite;
+        double Rise;
+        double Set;
+    };
+
+    struct ContactSettings {
+        double BeginSeconds = 0;
+        double EndSeconds = 0;
+        // The whole catalog is evaluated this far apart, then every crossing between two samples is
+        // refined. Contacts shorter than this can fall between samples and be missed.
+        double SampleSeconds = 1;
+        double ToleranceSeconds = 1e-3;
+    };
+
+    struct ContactStats {
+        std::size_t Samples = 0;
+        std::size_t Evaluations = 0;    // Station-satellite margins on the sample grid
+        std::size_t Crossings = 0;      // Rises and sets refined
+        std::size_t RefineSteps = 0;    // Satellite locations the refinement took
+    };
+
+    // Contact windows of every station with every satellite over a time range. The catalog is
+    // propagated a block of samples at a time, and each station's margins against the whole block
+    // are computed by the vector kernel, stations spread over a thread pool. Wherever a margin
+    // changes sign between two samples, the time of the crossing is found by Illinois false
+    // position, all the crossings of a station in a block stepped together so every step is one
+    // vectorized pass of the Kepler solver.
+    // Explicitly instantiated for float, double and long double in visibility.cpp.
+    template<class T>
+    class BasicContactPlanner {
+    public:
+        static constexpr std::size_t BlockSamples = 32;
+
+        // Sorted by station, satellite and rise
+        const std::vector<ContactWindow>& Plan(const BasicGroundStations<T>&, const BasicKeplerCatalog<T>&, T earthRadius,
+                                               const ContactSettings&, ThreadPool& = ThreadPool::Shared());
+
+        const std::vector<ContactWindow>& Windows() const;
+        const ContactStats& Stats() const;
+    private:
+        // Locations of the whole catalog at each sample of a block, one row per sample
+        std::vector<T> x, y;
+        // Margins at the last two samples, alternating, one row per station
+        std::vector<T> margins[2];
+        // When each station-satellite window opened, NaN while closed
+        std::vector<double> rise;
+
+        // A sign change of one satellite's margin, bracketed by [Begin, End]
+        struct Crossing {
+            std::uint32_t Satellite;
+            bool Rising;
+            int Kept;       // Which end the last step kept, for the Illinois halving
+            double Begin, End;
+            double BeginValue, EndValue;
+        };
+
+        // Per station, so stations refine in parallel without sharing anything
+        struct Workspace {
+            std::vector<Crossing> Crossings;
+            std::vector<std::uint32_t> Active, Satellites;
+            std::vector<PhaseScalar<T>> Times;
+            std::vector<T> X, Y;
+            std::vector<ContactWindow> Windows;
+            ContactStats Stats;
+        };
+
+        std::vector<Workspace> workspaces;
+        std::vector<ContactWindow> windows;
+        ContactStats stats;
+
+        void Refine(const BasicGroundStations<T>&, const BasicKeplerCatalog<T>&, T earthRadius, std::size_t station, double tolerance, Workspace&) const;
+    };
+
+    using ContactPlanner = BasicContactPlanner<Scalar>;
+
+    extern template class BasicGroundStations<float>;
+    extern template class BasicGroundStations<double>;
+    extern template class BasicGroundStations<long double>;
+
+    extern template class BasicContactPlanner<float>;
+    extern template class BasicContactPlanner<double>;
+    extern template class BasicContactPlanner<long double>;
+}
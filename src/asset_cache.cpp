@@ -0,0 +1,237 @@
+#include "../include/asset_cache.h"
+#include "../include/png.h"
+#include "../include/profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace Simulation {
+    namespace {
+        bool WriteAll(std::FILE* file, const void* data, std::size_t bytes) {
+            return bytes == 0 || std::fwrite(data, 1, bytes, file) == bytes;
+        }
+
+        std::uint64_t Aligned(std::uint64_t offset) {
+            return (offset + AssetHeader::Alignment - 1) / AssetHeader::Alignment * AssetHeader::Alignment;
+        }
+
+        const AssetEntry* Entries(const AssetHeader* header) {
+            return reinterpret_cast<const AssetEntry*>(header + 1);
+        }
+    }
+
+    bool AssetCache::Load(const std::vector<AssetSource>& sources, const std::string& cachePath, ThreadPool& pool) {
+        SIMULATION_PROFILE_ZONE("AssetCache::Load");
+        Close();
+        std::vector<std::uint64_t> hashes(sources.size());
+        for (std::size_t i = 0; i < sources.size(); i++) {
+            hashes[i] = Hash(sources[i].Data, sources[i].Size);
+        }
+
+        images.resize(sources.size());
+        std::vector<std::size_t> missing;
+        Map(cachePath);
+        for (std::size_t i = 0; i < sources.size(); i++) {
+            if (auto entry = Find(hashes[i])) {
+                images[i] = { (int)entry->Width, (int)entry->Height, file.Data() + entry->Offset };
+            }
+            else {
+                missing.push_back(i);
+            }
+        }
+        if (missing.empty()) {
+            return true;
+        }
+
+        // Everything goes to memory first: the file is about to be replaced under the mapping
+        pixels.resize(sources.size());
+        std::vector<char> failed(sources.size(), 0);
+        pool.ParallelFor(missing.size(), [&](std::size_t k) {
+            auto i = missing[k];
+            std::vector<std::uint8_t> rgba;
+            int width, height;
+            if (!Png::Decode(sources[i].Data, sources[i].Size, rgba, width, height)) {
+                failed[i] = 1;
+                return;
+            }
+            pixels[i].resize(rgba.size());
+            Premultiply(rgba.data(), rgba.size() / 4, pixels[i].data());
+            images[i] = { width, height, pixels[i].data() };
+        });
+        for (auto i : missing) {
+            if (failed[i]) {
+                Close();
+                error = "asset " + std::to_string(i) + ": not a PNG it can decode";
+                return false;
+            }
+        }
+        decoded = missing.size();
+        for (std::size_t i = 0; i < sources.size(); i++) {
+            if (pixels[i].empty()) {
+                auto bytes = (std::size_t)images[i].Width * images[i].Height * 4;
+                pixels[i].assign(images[i].Pixels, images[i].Pixels + bytes);
+                images[i].Pixels = pixels[i].data();
+            }
+        }
+        file.Close();
+
+        if (!Write(cachePath, hashes, images) || !Map(cachePath)) {
+            return true;
+        }
+        for (std::size_t i = 0; i < sources.size(); i++) {
+            auto entry = Find(hashes[i]);
+            if (entry == nullptr) {
+                return true;
+            }
+            images[i].Pixels = file.Data() + entry->Offset;
+        }
+        pixels.clear();
+        return true;
+    }
+
+    void AssetCache::Close() {
+        file.Close();
+        images.clear();
+        pixels.clear();
+        error.clear();
+        decoded = 0;
+    }
+
+    const std::string& AssetCache::Error() const {
+        return error;
+    }
+
+    std::size_t AssetCache::Size() const {
+        return images.size();
+    }
+
+    const AssetImage& AssetCache::Image(std::size_t index) const {
+        return images[index];
+    }
+
+    std::size_t AssetCache::Decoded() const {
+        return decoded;
+    }
+
+    bool AssetCache::Mapped() const {
+        return pixels.empty();
+    }
+
+    std::uint64_t AssetCache::Hash(const std::uint8_t* data, std::size_t size) {
+        auto hash = 0xCBF29CE484222325ull;
+        for (std::size_t i = 0; i < size; i++) {
+            hash = (hash ^ data[i]) * 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    void AssetCache::Premultiply(const std::uint8_t* rgba, std::size_t count, std::uint8_t* bgra) {
+        for (std::size_t i = 0; i < count; i++, rgba += 4, bgra += 4) {
+            auto alpha = rgba[3];
+            bgra[0] = (std::uint8_t)((rgba[2] * alpha + 127) / 255);
+            bgra[1] = (std::uint8_t)((rgba[1] * alpha + 127) / 255);
+            bgra[2] = (std::uint8_t)((rgba[0] * alpha + 127) / 255);
+            bgra[3] = alpha;
+        }
+    }
+
+    std::vector<std::uint8_t> AssetCache::Straight(const AssetImage& image) {
+        auto count = (std::size_t)image.Width * image.Height;
+        std::vector<std::uint8_t> rgba(count * 4);
+        auto bgra = image.Pixels;
+        auto target = rgba.data();
+        for (std::size_t i = 0; i < count; i++, bgra += 4, target += 4) {
+            auto alpha = bgra[3];
+            auto unmultiply = [&](int value) {
+                return alpha == 0 ? (std::uint8_t)0 : (std::uint8_t)std::min(255, (value * 255 + alpha / 2) / alpha);
+            };
+            target[0] = unmultiply(bgra[2]);
+            target[1] = unmultiply(bgra[1]);
+            target[2] = unmultiply(bgra[0]);
+            target[3] = alpha;
+        }
+        return rgba;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    bool AssetCache::Map(const std::string& path) {
+        if (!file.Open(path) || file.Size() < sizeof(AssetHeader)) {
+            file.Close();
+            return false;
+        }
+        const auto* header = reinterpret_cast<const AssetHeader*>(file.Data());
+        auto valid = std::memcmp(header->Magic, AssetHeader::Signature, sizeof(header->Magic)) == 0 &&
+                     header->Version == AssetHeader::CurrentVersion && header->FileBytes == file.Size() &&
+                     header->Count <= (file.Size() - sizeof(AssetHeader)) / sizeof(AssetEntry) &&
+                     header->HeaderBytes >= sizeof(AssetHeader) + header->Count * sizeof(AssetEntry);
+        for (std::uint64_t i = 0; valid && i < header->Count; i++) {
+            const auto& entry = Entries(header)[i];
+            auto bytes = (std::uint64_t)entry.Width * entry.Height * 4;
+            valid = entry.Offset % AssetHeader::Alignment == 0 && entry.Offset >= header->HeaderBytes && bytes <= file.Size() &&
+                    entry.Offset + bytes <= file.Size();
+        }
+        if (!valid) {
+            file.Close();
+            return false;
+        }
+        return true;
+    }
+
+    const AssetEntry* AssetCache::Find(std::uint64_t hash) const {
+        if (!file.IsOpen()) {
+            return nullptr;
+        }
+        const auto* header = reinterpret_cast<const AssetHeader*>(file.Data());
+        auto entries = Entries(header);
+        auto end = entries + header->Count;
+        auto entry = std::find_if(entries, end, [&](const AssetEntry& e) {
+            return e.Hash == hash;
+        });
+        return entry != end ? entry : nullptr;
+    }
+
+    bool AssetCache::Write(const std::string& path, const std::vector<std::uint64_t>& hashes, const std::vector<AssetImage>& images) {
+        AssetHeader header = {};
+        std::memcpy(header.Magic, AssetHeader::Signature, sizeof(header.Magic));
+        header.Version = AssetHeader::CurrentVersion;
+        header.Count = images.size();
+        header.HeaderBytes = (std::uint32_t)Aligned(sizeof(AssetHeader) + images.size() * sizeof(AssetEntry));
+        std::vector<AssetEntry> entries(images.size());
+        auto offset = (std::uint64_t)header.HeaderBytes;
+        for (std::size_t i = 0; i < images.size(); i++) {
+            entries[i] = { hashes[i], (std::uint32_t)images[i].Width, (std::uint32_t)images[i].Height, offset };
+            offset = Aligned(offset + (std::uint64_t)images[i].Width * images[i].Height * 4);
+        }
+        header.FileBytes = offset;
+
+        // Next to the old file, then over it, so nobody ever maps half a file
+        auto temporary = path + ".tmp";
+        auto file = std::fopen(temporary.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        static const std::uint8_t zeros[AssetHeader::Alignment] = {};
+        auto ok = WriteAll(file, &header, sizeof(header)) && WriteAll(file, entries.data(), entries.size() * sizeof(AssetEntry));
+        auto written = sizeof(header) + entries.size() * sizeof(AssetEntry);
+        for (std::size_t i = 0; ok && i < images.size(); i++) {
+            ok &= WriteAll(file, zeros, (std::size_t)(entries[i].Offset - written));
+            auto bytes = (std::size_t)images[i].Width * images[i].Height * 4;
+            ok &= WriteAll(file, images[i].Pixels, bytes);
+            written = (std::size_t)entries[i].Offset + bytes;
+        }
+        ok &= WriteAll(file, zeros, (std::size_t)(header.FileBytes - written));
+        ok &= std::fclose(file) == 0;
+        std::error_code failure;
+        if (ok) {
+            std::filesystem::rename(temporary, path, failure);
+        }
+        if (!ok || failure) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,456 @@
+#include "../include/simulation_state.h"
+#include "../include/simd_kernel.h"
+#include "../include/orbit_kernel.h"
+#include "../include/circular_field_table.h"
+#include "../include/scene.h"
+#include "../include/software_renderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Microbenchmarks of the physics kernels and the render phases, written as JSON or CSV so runs can
+// be kept and compared: --compare flags every case whose median got slower than a saved CSV run.
+//
+// Each case is set up once, then calibrated to an iteration count that runs for --min-time, then
+// timed --repetitions times over that count. Reported are the statistics of the time per
+// iteration across the repetitions.
+
+namespace Simulation::Benchmark {
+    enum class Format {
+        Json,
+        Csv
+    };
+
+    struct Options {
+        const char* Filter = nullptr;
+        int Repetitions = 10;
+        double MinSeconds = 0.02;
+        Benchmark::Format Format = Benchmark::Format::Json;
+        const char* Output = nullptr;
+        const char* Compare = nullptr;
+        double Threshold = 0.10;    // Slower by more than this fraction is a regression
+        unsigned Threads = 1;       // Render cases
+        bool List = false;
+    };
+
+    // Runs the case's body the given number of times
+    using Runner = std::function<void(std::uint64_t)>;
+
+    struct Case {
+        std::string Name;
+        const char* Precision;
+        std::size_t Satellites;
+        double AngleDegrees;
+        // Allocates what the case needs only when it is about to run
+        std::function<Runner()> Setup;
+
+        std::string Id() const {
+            char text[160];
+            std::snprintf(text, sizeof(text), "%s/%s/n=%zu/angle=%g", Name.c_str(), Precision, Satellites, AngleDegrees);
+            return text;
+        }
+    };
+
+    struct Result {
+        const Case* Of;
+        std::uint64_t Iterations;
+        double Mean, Median, Deviation, Min, Max;  // Nanoseconds per iteration
+    };
+
+    // The 0/90/180/270 degree cases take their own branches in Kernel::CircularField, 45 is where
+    // its y sign flips, 33.3 is any other angle
+    constexpr double Angles[] = { 0.0, 45.0, 90.0, 180.0, 270.0, 33.3 };
+    constexpr std::size_t SatelliteCounts[] = { 0, 1000, 100000 };
+
+    // Keeps the compiler from dropping a computation whose result is never used
+#if defined(__GNUC__)
+    template<class T>
+    inline void Keep(const T& value) {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+#else
+    inline volatile double KeptValue;
+    template<class T>
+    inline void Keep(const T& value) {
+        KeptValue = (double)value;
+    }
+#endif
+
+    static double Seconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double>(duration).count();
+    }
+
+    template<class T>
+    static std::shared_ptr<BasicSimulationState<T>> MakeState(double angleDegrees, std::size_t satellites) {
+        auto state = std::make_shared<BasicSimulationState<T>>();
+        state->InitializeEarth(T(110.5), T(960), T(540));
+        state->InitializeSatellite(T(200));
+        state->SetOrbitFraction(T(angleDegrees / 360.0));
+        // Between 1.5 and 6 Earth radii, as the headless runner spreads them
+        state->Satellites.Reserve(satellites);
+        for (std::size_t i = 0; i < satellites; i++) {
+            auto t = satellites > 1 ? (T)i / (T)(satellites - 1) : T(0);
+            auto radius = state->Earth.Radius * (T(1.5) + T(4.5) * t);
+            auto period = state->Satellite.PeriodSeconds * std::pow(radius / state->Satellite.RadiusTrajectory, T(1.5));
+            state->Satellites.Add(radius, period, T(2) * Pi<T> * (T)std::fmod(i * 0.618033988749895, 1.0));
+        }
+        state->Satellites.Update(state->Earth);
+        return state;
+    }
+
+    template<class T>
+    static void AddPhysicsCases(std::vector<Case>& cases) {
+        auto precision = PrecisionName<T>();
+        for (auto angle : Angles) {
+            // What Satellite::Update does per tick past the clock: angle, location, axes, field
+            cases.push_back({ "update", precision, 0, angle, [angle] {
+                auto state = MakeState<T>(angle, 0);
+                return Runner([state](std::uint64_t n) {
+                    for (std::uint64_t i = 0; i < n; i++) {
+                        state->Update();
+                        Keep(state->CircularField.DirectionX);
+                    }
+                });
+            } });
+            // MagneticFields::Circular::Update as it is now, from the table
+            cases.push_back({ "circular_table", precision, 0, angle, [angle] {
+                auto state = MakeState<T>(angle, 0);
+                return Runner([state](std::uint64_t n) {
+                    const auto& satellite = state->Satellite;
+                    T x, y, radius;
+                    for (std::uint64_t i = 0; i < n; i++) {
+                        DefaultCircularFieldTable<T>().Lookup(satellite.AngleRadians, satellite.RadiusTrajectory, x, y, radius);
+                        Keep(x);
+                        Keep(y);
+                        Keep(radius);
+                    }
+                });
+            } });
+            // And the closed form it replaced, branches and all
+            cases.push_back({ "circular_kernel", precision, 0, angle, [angle] {
+                auto state = MakeState<T>(angle, 0);
+                return Runner([state](std::uint64_t n) {
+                    const auto& satellite = state->Satellite;
+                    T x, y, radius;
+                    for (std::uint64_t i = 0; i < n; i++) {
+                        Kernel::CircularField(state->Earth.X, satellite.RadiusTrajectory, satellite.AngleDegrees, satellite.AngleRadians, satellite.X, x, y, radius);
+                        Keep(x);
+                        Keep(y);
+                        Keep(radius);
+                    }
+                });
+            } });
+        }
+        // A whole 5 ms tick: the displayed satellite and the constellation
+        for (auto satellites : SatelliteCounts) {
+            cases.push_back({ "step", precision, satellites, 0.0, [satellites] {
+                auto state = MakeState<T>(0.0, satellites);
+                return Runner([state](std::uint64_t n) {
+                    for (std::uint64_t i = 0; i < n; i++) {
+                        state->StepNanoseconds(5000000);
+                        Keep(state->Satellite.X);
+                    }
+                });
+            } });
+        }
+    }
+
+    // Everything the software renderer needs for a 1080p frame of the window's scene
+    struct RenderTarget {
+        ThreadPool Pool;
+        SoftwareRenderer Renderer;
+        Simulation::Scene Scene;
+        Snapshot Capture;
+
+        RenderTarget(unsigned threads, double angleDegrees) : Pool(threads), Renderer(1920, 1080, Pool) {
+            auto state = MakeState<Scalar>(angleDegrees, 0);
+            Capture.Capture(*state, 0, 1.0);
+        }
+    };
+
+    static void AddRenderCases(std::vector<Case>& cases, const Options& options) {
+        auto precision = PrecisionName<Scalar>();
+        auto threads = options.Threads;
+        for (auto angle : Angles) {
+            // A steady frame: the static layer is kept, the moving parts are drawn and rasterized
+            cases.push_back({ "render_frame", precision, 0, angle, [threads, angle] {
+                auto target = std::make_shared<RenderTarget>(threads, angle);
+                target->Scene.Draw(target->Renderer, target->Capture);
+                return Runner([target](std::uint64_t n) {
+                    for (std::uint64_t i = 0; i < n; i++) {
+                        target->Scene.Draw(target->Renderer, target->Capture);
+                        Keep(target->Renderer.Pixels()[0]);
+                    }
+                });
+            } });
+            // Every tile cleared and nothing drawn, what each phase below costs at least
+            cases.push_back({ "render_empty", precision, 0, angle, [threads, angle] {
+                auto target = std::make_shared<RenderTarget>(threads, angle);
+                return Runner([target](std::uint64_t n) {
+                    for (std::uint64_t i = 0; i < n; i++) {
+                        target->Renderer.BeginFrame(Scene::Background);
+                        target->Renderer.EndFrame();
+                        Keep(target->Renderer.Pixels()[0]);
+                    }
+                });
+            } });
+            for (int p = 0; p < (int)Scene::Phase::Count; p++) {
+                auto phase = (Scene::Phase)p;
+                cases.push_back({ std::string("render_") + Scene::ToString(phase), precision, 0, angle, [threads, angle, phase] {
+                    auto target = std::make_shared<RenderTarget>(threads, angle);
+                    return Runner([target, phase](std::uint64_t n) {
+                        for (std::uint64_t i = 0; i < n; i++) {
+                            target->Scene.DrawPhase(target->Renderer, target->Capture, phase);
+                            Keep(target->Renderer.Pixels()[0]);
+                        }
+                    });
+                } });
+            }
+        }
+    }
+
+    static Result Measure(const Case& benchmark, const Options& options) {
+        auto run = benchmark.Setup();
+
+        // Double the count until a run is long enough, then aim straight for the minimum time
+        std::uint64_t iterations = 1;
+        while (true) {
+            auto begin = std::chrono::steady_clock::now();
+            run(iterations);
+            auto seconds = Seconds(std::chrono::steady_clock::now() - begin);
+            if (seconds >= options.MinSeconds) {
+                break;
+            }
+            auto target = seconds > 0.0 ? (std::uint64_t)std::ceil(iterations * options.MinSeconds * 1.1 / seconds) : iterations * 10;
+            iterations = std::clamp(target, iterations * 2, iterations * 100);
+        }
+
+        std::vector<double> samples;
+        for (int r = 0; r < options.Repetitions; r++) {
+            auto begin = std::chrono::steady_clock::now();
+            run(iterations);
+            samples.push_back(Seconds(std::chrono::steady_clock::now() - begin) * 1e9 / iterations);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        Result result{};
+        result.Of = &benchmark;
+        result.Iterations = iterations;
+        auto n = samples.size();
+        result.Min = samples.front();
+        result.Max = samples.back();
+        result.Median = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+        double sum = 0, squares = 0;
+        for (auto sample : samples) {
+            sum += sample;
+        }
+        result.Mean = sum / n;
+        for (auto sample : samples) {
+            squares += (sample - result.Mean) * (sample - result.Mean);
+        }
+        result.Deviation = n > 1 ? std::sqrt(squares / (n - 1)) : 0.0;
+        return result;
+    }
+
+    static void WriteResults(std::FILE* file, const std::vector<Result>& results, const Options& options) {
+        if (options.Format == Format::Csv) {
+            std::fputs("name,precision,satellites,angle,iterations,repetitions,mean_ns,median_ns,stddev_ns,min_ns,max_ns\n", file);
+            for (const auto& r : results) {
+                std::fprintf(file, "%s,%s,%zu,%g,%llu,%d,%.3f,%.3f,%.3f,%.3f,%.3f\n", r.Of->Name.c_str(), r.Of->Precision, r.Of->Satellites,
+                             r.Of->AngleDegrees, (unsigned long long)r.Iterations, options.Repetitions, r.Mean, r.Median, r.Deviation, r.Min, r.Max);
+            }
+            return;
+        }
+        std::fprintf(file, "{\n  \"context\": {\"isa\": \"%s\", \"build_precision\": \"%s\", \"render_threads\": %u, \"repetitions\": %d, \"min_time_sec\": %g},\n",
+                     ToString(Simd::ActiveInstructionSet()), PrecisionName<Scalar>(), options.Threads, options.Repetitions, options.MinSeconds);
+        std::fputs("  \"benchmarks\": [\n", file);
+        for (std::size_t i = 0; i < results.size(); i++) {
+            const auto& r = results[i];
+            std::fprintf(file, "    {\"name\": \"%s\", \"precision\": \"%s\", \"satellites\": %zu, \"angle\": %g, \"iterations\": %llu, "
+                               "\"mean_ns\": %.3f, \"median_ns\": %.3f, \"stddev_ns\": %.3f, \"min_ns\": %.3f, \"max_ns\": %.3f}%s\n",
+                         r.Of->Name.c_str(), r.Of->Precision, r.Of->Satellites, r.Of->AngleDegrees, (unsigned long long)r.Iterations,
+                         r.Mean, r.Median, r.Deviation, r.Min, r.Max, i + 1 < results.size() ? "," : "");
+        }
+        std::fputs("  ]\n}\n", file);
+    }
+
+    using Key = std::tuple<std::string, std::string, std::size_t, std::string>;
+
+    // Medians of an earlier --format csv run, by name, precision, satellites and angle as written
+    static bool ReadBaseline(const char* path, std::map<Key, double>& medians) {
+        auto file = std::fopen(path, "r");
+        if (file == nullptr) {
+            return false;
+        }
+        char line[512];
+        auto header = true;
+        while (std::fgets(line, sizeof(line), file) != nullptr) {
+            if (header) {
+                header = false;
+                continue;
+            }
+            std::vector<std::string> fields;
+            std::string field;
+            for (auto c = line; *c != 0 && *c != '\n' && *c != '\r'; c++) {
+                if (*c == ',') {
+                    fields.push_back(field);
+                    field.clear();
+                }
+                else {
+                    field += *c;
+                }
+            }
+            fields.push_back(field);
+            if (fields.size() >= 8) {
+                medians[{ fields[0], fields[1], (std::size_t)std::strtoull(fields[2].c_str(), nullptr, 10), fields[3] }] = std::strtod(fields[7].c_str(), nullptr);
+            }
+        }
+        std::fclose(file);
+        return true;
+    }
+
+    // Every case slower than the baseline by more than the threshold, to stderr. The number of them.
+    static int Compare(const std::vector<Result>& results, const std::map<Key, double>& baseline, const Options& options) {
+        auto regressions = 0;
+        for (const auto& r : results) {
+            char angle[32];
+            std::snprintf(angle, sizeof(angle), "%g", r.Of->AngleDegrees);
+            auto found = baseline.find({ r.Of->Name, r.Of->Precision, r.Of->Satellites, angle });
+            if (found == baseline.end() || found->second <= 0.0) {
+                continue;
+            }
+            auto ratio = r.Median / found->second;
+            if (ratio > 1.0 + options.Threshold) {
+                std::fprintf(stderr, "REGRESSION %-52s %10.2f ns -> %10.2f ns  %+.1f%%\n", r.Of->Id().c_str(), found->second, r.Median, (ratio - 1.0) * 100.0);
+                regressions++;
+            }
+        }
+        return regressions;
+    }
+
+    static void PrintUsage() {
+        std::puts("Usage: simulation_bench [--filter TEXT] [--repetitions N] [--min-time SECONDS] [--threads N]");
+        std::puts("                        [--format json|csv] [--output FILE] [--compare BASELINE.csv] [--threshold FRACTION]");
+        std::puts("                        [--list]");
+    }
+
+    static bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            auto arg = argv[i];
+            if (std::strcmp(arg, "--help") == 0) {
+                return false;
+            }
+            if (std::strcmp(arg, "--list") == 0) {
+                options.List = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "Missing value for %s\n", arg);
+                return false;
+            }
+            auto value = argv[++i];
+            if (std::strcmp(arg, "--filter") == 0) {
+                options.Filter = value;
+            }
+            else if (std::strcmp(arg, "--repetitions") == 0) {
+                options.Repetitions = std::atoi(value);
+            }
+            else if (std::strcmp(arg, "--min-time") == 0) {
+                options.MinSeconds = std::strtod(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--threads") == 0) {
+                options.Threads = (unsigned)std::strtoul(value, nullptr, 10);
+            }
+            else if (std::strcmp(arg, "--format") == 0) {
+                if (std::strcmp(value, "json") == 0) {
+                    options.Format = Format::Json;
+                }
+                else if (std::strcmp(value, "csv") == 0) {
+                    options.Format = Format::Csv;
+                }
+                else {
+                    std::fprintf(stderr, "Unknown format %s\n", value);
+                    return false;
+                }
+            }
+            else if (std::strcmp(arg, "--output") == 0) {
+                options.Output = value;
+            }
+            else if (std::strcmp(arg, "--compare") == 0) {
+                options.Compare = value;
+            }
+            else if (std::strcmp(arg, "--threshold") == 0) {
+                options.Threshold = std::strtod(value, nullptr);
+            }
+            else {
+                std::fprintf(stderr, "Unknown option %s\n", arg);
+                return false;
+            }
+        }
+        return options.Repetitions > 0 && options.MinSeconds > 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    using namespace Simulation::Benchmark;
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<Case> cases;
+    AddPhysicsCases<float>(cases);
+    AddPhysicsCases<double>(cases);
+    AddPhysicsCases<long double>(cases);
+    AddRenderCases(cases, options);
+
+    std::vector<Result> results;
+    for (const auto& benchmark : cases) {
+        auto id = benchmark.Id();
+        if (options.Filter != nullptr && id.find(options.Filter) == std::string::npos) {
+            continue;
+        }
+        if (options.List) {
+            std::puts(id.c_str());
+            continue;
+        }
+        results.push_back(Measure(benchmark, options));
+        // Progress on stderr, the results stay machine-readable
+        const auto& r = results.back();
+        std::fprintf(stderr, "%-52s %12.2f ns  +- %5.1f%%\n", id.c_str(), r.Median, r.Mean > 0.0 ? r.Deviation / r.Mean * 100.0 : 0.0);
+    }
+    if (options.List) {
+        return 0;
+    }
+
+    auto file = options.Output != nullptr ? std::fopen(options.Output, "w") : stdout;
+    if (file == nullptr) {
+        std::fprintf(stderr, "Could not write %s\n", options.Output);
+        return 1;
+    }
+    WriteResults(file, results, options);
+    if (file != stdout) {
+        std::fclose(file);
+    }
+
+    if (options.Compare != nullptr) {
+        std::map<Key, double> baseline;
+        if (!ReadBaseline(options.Compare, baseline)) {
+            std::fprintf(stderr, "Could not read %s\n", options.Compare);
+            return 1;
+        }
+        // A distinct exit code, so scripts can tell a regression from a failure
+        return Compare(results, baseline, options) > 0 ? 2 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "../include/bitmap_font.h"
+#include <iterator>
+
+namespace Simulation::BitmapFont {
+    struct Entry {
+        char32_t Code;
+        std::uint8_t Rows[GlyphHeight];
+    };
+
+    // ASCII 0x20-0x7E in order, then the extras
+    static constexpr Entry Glyphs[] = {
+        { 0x0020, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+        { 0x0021, { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 } },
+        { 0x0022, { 0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00 } },
+        { 0x0023, { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A } },
+        { 0x0024, { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 } },
+        { 0x0025, { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 } },
+        { 0x0026, { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D } },
+        { 0x0027, { 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 } },
+        { 0x0028, { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 } },
+        { 0x0029, { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 } },
+        { 0x002A, { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 } },
+        { 0x002B, { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 } },
+        { 0x002C, { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 } },
+        { 0x002D, { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+        { 0x002E, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } },
+        { 0x002F, { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } },
+        { 0x0030, { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } },
+        { 0x0031, { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+        { 0x0032, { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } },
+        { 0x0033, { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+        { 0x0034, { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } },
+        { 0x0035, { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+        { 0x0036, { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } },
+        { 0x0037, { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+        { 0x0038, { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } },
+        { 0x0039, { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+        { 0x003A, { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+        { 0x003B, { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 } },
+        { 0x003C, { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 } },
+        { 0x003D, { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 } },
+        { 0x003E, { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 } },
+        { 0x003F, { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 } },
+        { 0x0040, { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E } },
+        { 0x0041, { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+        { 0x0042, { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+        { 0x0043, { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } },
+        { 0x0044, { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+        { 0x0045, { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } },
+        { 0x0046, { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+        { 0x0047, { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } },
+        { 0x0048, { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+        { 0x0049, { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+        { 0x004A, { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+        { 0x004B, { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } },
+        { 0x004C, { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+        { 0x004D, { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+        { 0x004E, { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+        { 0x004F, { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+        { 0x0050, { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+        { 0x0051, { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } },
+        { 0x0052, { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+        { 0x0053, { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } },
+        { 0x0054, { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+        { 0x0055, { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+        { 0x0056, { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+        { 0x0057, { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } },
+        { 0x0058, { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+        { 0x0059, { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } },
+        { 0x005A, { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } },
+        { 0x005B, { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E } },
+        { 0x005C, { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 } },
+        { 0x005D, { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E } },
+        { 0x005E, { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 } },
+        { 0x005F, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F } },
+        { 0x0060, { 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00 } },
+        { 0x0061, { 0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F } },
+        { 0x0062, { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E } },
+        { 0x0063, { 0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E } },
+        { 0x0064, { 0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F } },
+        { 0x0065, { 0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E } },
+        { 0x0066, { 0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08 } },
+        { 0x0067, { 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x0E } },
+        { 0x0068, { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11 } },
+        { 0x0069, { 0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E } },
+        { 0x006A, { 0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0C } },
+        { 0x006B, { 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12 } },
+        { 0x006C, { 0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+        { 0x006D, { 0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11 } },
+        { 0x006E, { 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11 } },
+        { 0x006F, { 0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E } },
+        { 0x0070, { 0x00, 0x00, 0x1E, 0x11, 0x1E, 0x10, 0x10 } },
+        { 0x0071, { 0x00, 0x00, 0x0D, 0x13, 0x0F, 0x01, 0x01 } },
+        { 0x0072, { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10 } },
+        { 0x0073, { 0x00, 0x00, 0x0E, 0x10, 0x0E, 0x01, 0x1E } },
+        { 0x0074, { 0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06 } },
+        { 0x0075, { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D } },
+        { 0x0076, { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+        { 0x0077, { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A } },
+        { 0x0078, { 0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11 } },
+        { 0x0079, { 0x00, 0x00, 0x11, 0x11, 0x0F, 0x01, 0x0E } },
+        { 0x007A, { 0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F } },
+        { 0x007B, { 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02 } },
+        { 0x007C, { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+        { 0x007D, { 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08 } },
+        { 0x007E, { 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00 } },
+        { 0x00B0, { 0x0C, 0x12, 0x12, 0x0C, 0x00, 0x00, 0x00 } },
+        { 0x0192, { 0x03, 0x04, 0x0E, 0x04, 0x04, 0x04, 0x18 } },
+        { 0x03C0, { 0x00, 0x1F, 0x0A, 0x0A, 0x0A, 0x0A, 0x09 } },
+        { 0x03C6, { 0x04, 0x0E, 0x15, 0x15, 0x15, 0x0E, 0x04 } },
+        { 0x03C9, { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A } },
+    };
+
+    static constexpr std::size_t AsciiBegin = 0x20;
+    static constexpr std::size_t AsciiEnd = 0x7F;
+
+    const std::uint8_t* Glyph(char32_t code) {
+        if (code >= AsciiBegin && code < AsciiEnd) {
+            return Glyphs[code - AsciiBegin].Rows;
+        }
+        for (auto i = AsciiEnd - AsciiBegin; i < std::size(Glyphs); i++) {
+            if (Glyphs[i].Code == code) {
+                return Glyphs[i].Rows;
+            }
+        }
+        return Glyphs['?' - AsciiBegin].Rows;
+    }
+}
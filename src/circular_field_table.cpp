@@ -0,0 +1,65 @@
+#include "../include/circular_field_table.h"
+#include "../include/orbit_kernel.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace Simulation {
+    template<class T>
+    CircularFieldTable<T>::CircularFieldTable() {
+        for (std::size_t i = 0; i <= Intervals; i++) {
+            auto a = TwoPi * i / Intervals;
+            auto s = std::sin(a), c = std::cos(a);
+            auto s2 = 2 * s * c, c2 = c * c - s * s;
+            auto g = std::sqrt(1 + 3 * s * s);
+            auto dg = 3 * s * c / g;
+            directionX[i] = T(-s2 * g);
+            directionY[i] = T(c2 * g);
+            slopeX[i] = T(-2 * c2 * g - s2 * dg);
+            slopeY[i] = T(-2 * s2 * g + c2 * dg);
+            cosine[i] = T(c);
+            sine[i] = T(s);
+        }
+    }
+
+    template<class T>
+    typename CircularFieldTable<T>::Error CircularFieldTable<T>::Measure(std::size_t samples) const {
+        const long double earthX = 960, earthY = 540, radiusTrajectory = 442;
+
+        std::vector<long double> angles = { 0.0l, 90.0l, 180.0l, 270.0l };
+        for (std::size_t i = 0; i < samples; i++) {
+            angles.push_back(360.0l * i / samples);
+        }
+
+        Error error = {};
+        for (auto deg : angles) {
+            auto rad = deg * PI / 180.0l;
+            long double x, y, dx, dy, radius;
+            Kernel::Location(earthX, earthY, radiusTrajectory, rad, x, y);
+            Kernel::CircularField(earthX, radiusTrajectory, deg, rad, x, dx, dy, radius);
+
+            T tx, ty, tr;
+            Lookup(T(rad), T(radiusTrajectory), tx, ty, tr);
+            error.Direction = std::max({ error.Direction, (double)std::abs(tx - dx), (double)std::abs(ty - dy) });
+            // Around the quarter turns the radius runs off to infinity in both
+            if (std::abs(std::cos(rad)) > 1e-3l) {
+                error.Radius = std::max(error.Radius, (double)std::abs(tr / radius - 1));
+            }
+        }
+        return error;
+    }
+
+    template<class T>
+    const CircularFieldTable<T>& DefaultCircularFieldTable() {
+        static const CircularFieldTable<T> table;
+        return table;
+    }
+
+    template class CircularFieldTable<float>;
+    template class CircularFieldTable<double>;
+    template class CircularFieldTable<long double>;
+
+    template const CircularFieldTable<float>& DefaultCircularFieldTable<float>();
+    template const CircularFieldTable<double>& DefaultCircularFieldTable<double>();
+    template const CircularFieldTable<long double>& DefaultCircularFieldTable<long double>();
+}
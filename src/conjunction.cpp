@@ -0,0 +1,200 @@
+#include "../include/conjunction.h"
+#include "../include/constellation.h"
+#include "../include/simulation_state.h"
+#include "../include/profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Simulation {
+    template<class T>
+    const std::vector<Conjunction<T>>& BasicConjunctionScreen<T>::Screen(const T* px, const T* py, const T* pMinRadius, const T* pMaxRadius, std::size_t count,
+                                                                         T surfaceRadius, T distance, ThreadPool& pool) {
+        SIMULATION_PROFILE_ZONE("ConjunctionScreen::Screen");
+        stats = {};
+        stats.Objects = count;
+        found.clear();
+        if (count == 0 || !(distance > T(0))) {
+            return found;
+        }
+
+        Build(px, py, pMinRadius, pMaxRadius, count, surfaceRadius, distance);
+        stats.Cells = columns * rows;
+        if (stats.Screened == 0) {
+            return found;
+        }
+
+        // A few bands of rows per thread, so the dense rows around the Earth even out
+        auto bands = std::min(rows, (std::size_t)pool.Size() * 4);
+        if (bandFound.size() < bands) {
+            bandFound.resize(bands);
+        }
+        bandCandidates.assign(bands, 0);
+        pool.ParallelFor(bands, [&](std::size_t band) {
+            SearchRows(band, rows * band / bands, rows * (band + 1) / bands, distance);
+        });
+
+        for (std::size_t band = 0; band < bands; band++) {
+            stats.Candidates += bandCandidates[band];
+            found.insert(found.end(), bandFound[band].begin(), bandFound[band].end());
+        }
+        std::sort(found.begin(), found.end(), [](const Conjunction<T>& a, const Conjunction<T>& b) {
+            return a.First != b.First ? a.First < b.First : a.Second < b.Second;
+        });
+        stats.Conjunctions = found.size();
+        return found;
+    }
+
+    template<class T>
+    const std::vector<Conjunction<T>>& BasicConjunctionScreen<T>::Screen(const BasicConstellation<T>& constellation, const EarthState<T>& earth, T distance, ThreadPool& pool) {
+        const auto* radius = constellation.RadiusTrajectory.data();
+        return Screen(constellation.X.data(), constellation.Y.data(), radius, radius, constellation.Size(), earth.Radius, distance, pool);
+    }
+
+    template<class T>
+    const std::vector<Conjunction<T>>& BasicConjunctionScreen<T>::Conjunctions() const {
+        return found;
+    }
+
+    template<class T>
+    const ConjunctionStats& BasicConjunctionScreen<T>::Stats() const {
+        return stats;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    template<class T>
+    void BasicConjunctionScreen<T>::Build(const T* px, const T* py, const T* pMinRadius, const T* pMaxRadius, std::size_t count, T surfaceRadius, T distance) {
+        constexpr auto Excluded = std::numeric_limits<std::uint32_t>::max();
+
+        // Radial prefilter, and the bounds of what is left
+        auto left = std::numeric_limits<T>::max(), top = left;
+        auto right = std::numeric_limits<T>::lowest(), bottom = right;
+        std::size_t n = 0;
+        cellOf.resize(count);
+        for (std::size_t i = 0; i < count; i++) {
+            if (!(pMaxRadius[i] >= surfaceRadius) || !std::isfinite(px[i]) || !std::isfinite(py[i])) {
+                cellOf[i] = Excluded;
+                continue;
+            }
+            cellOf[i] = 0;
+            left = std::min(left, px[i]);
+            right = std::max(right, px[i]);
+            top = std::min(top, py[i]);
+            bottom = std::max(bottom, py[i]);
+            n++;
+        }
+        stats.Screened = n;
+        if (n == 0) {
+            columns = rows = 0;
+            cellStart.assign(1, 0);
+            return;
+        }
+
+        // Slightly wider than the distance, so rounding can not put a close pair two cells apart,
+        // and no narrower than one object per cell on average, so sparse sets are not all empty cells
+        auto width = (double)(right - left), height = (double)(bottom - top);
+        auto cell = std::max((double)distance * 1.001, std::sqrt(width * height / n));
+        while ((std::floor(width / cell) + 1) * (std::floor(height / cell) + 1) > (double)MaxCells) {
+            cell *= 2;
+        }
+        columns = (std::size_t)(width / cell) + 1;
+        rows = (std::size_t)(height / cell) + 1;
+        auto cells = columns * rows;
+
+        // Counting sort into the cells, keeping index order within each
+        cellStart.assign(cells + 1, 0);
+        for (std::size_t i = 0; i < count; i++) {
+            if (cellOf[i] == Excluded) {
+                continue;
+            }
+            auto column = std::min((std::size_t)((double)(px[i] - left) / cell), columns - 1);
+            auto row = std::min((std::size_t)((double)(py[i] - top) / cell), rows - 1);
+            cellOf[i] = (std::uint32_t)(row * columns + column);
+            cellStart[cellOf[i] + 1]++;
+        }
+        for (std::size_t c = 0; c < cells; c++) {
+            cellStart[c + 1] += cellStart[c];
+        }
+
+        index.resize(n);
+        x.resize(n);
+        y.resize(n);
+        minRadius.resize(n);
+        maxRadius.resize(n);
+        // Each start walks to the end of its cell, the start of the next one
+        for (std::size_t i = 0; i < count; i++) {
+            if (cellOf[i] == Excluded) {
+                continue;
+            }
+            auto k = cellStart[cellOf[i]]++;
+            index[k] = (std::uint32_t)i;
+            x[k] = px[i];
+            y[k] = py[i];
+            minRadius[k] = pMinRadius[i];
+            maxRadius[k] = pMaxRadius[i];
+        }
+        for (auto c = cells; c > 0; c--) {
+            cellStart[c] = cellStart[c - 1];
+        }
+        cellStart[0] = 0;
+    }
+
+    template<class T>
+    void BasicConjunctionScreen<T>::SearchRows(std::size_t band, std::size_t firstRow, std::size_t lastRow, T distance) {
+        auto& out = bandFound[band];
+        out.clear();
+        std::size_t candidates = 0;
+        auto squared = distance * distance;
+
+        auto test = [&](std::uint32_t a, std::uint32_t b) {
+            // Orbits whose radial bands never come within the distance
+            if (minRadius[a] > maxRadius[b] + distance || minRadius[b] > maxRadius[a] + distance) {
+                return;
+            }
+            candidates++;
+            auto dx = x[a] - x[b], dy = y[a] - y[b];
+            auto d = dx * dx + dy * dy;
+            if (d <= squared) {
+                auto i = index[a], j = index[b];
+                out.push_back({ std::min(i, j), std::max(i, j), std::sqrt(d) });
+            }
+        };
+
+        for (auto row = firstRow; row < lastRow; row++) {
+            for (std::size_t column = 0; column < columns; column++) {
+                auto cell = row * columns + column;
+                auto begin = cellStart[cell], end = cellStart[cell + 1];
+                if (begin == end) {
+                    continue;
+                }
+                for (auto a = begin; a < end; a++) {
+                    for (auto b = a + 1; b < end; b++) {
+                        test(a, b);
+                    }
+                }
+                // Forward neighbours only, so each pair of cells is compared once
+                const std::ptrdiff_t neighbours[4][2] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+                for (const auto& offset : neighbours) {
+                    auto c = (std::ptrdiff_t)column + offset[0];
+                    auto r = row + (std::size_t)offset[1];
+                    if (c < 0 || c >= (std::ptrdiff_t)columns || r >= rows) {
+                        continue;
+                    }
+                    auto other = r * columns + (std::size_t)c;
+                    auto otherBegin = cellStart[other], otherEnd = cellStart[other + 1];
+                    for (auto a = begin; a < end; a++) {
+                        for (auto b = otherBegin; b < otherEnd; b++) {
+                            test(a, b);
+                        }
+                    }
+                }
+            }
+        }
+        bandCandidates[band] = candidates;
+    }
+
+    template class BasicConjunctionScreen<float>;
+    template class BasicConjunctionScreen<double>;
+    template class BasicConjunctionScreen<long double>;
+}
@@ -0,0 +1,111 @@
+#include "../include/constellation.h"
+#include "../include/simulation_state.h"
+#include "../include/orbit_kernel.h"
+#include "../include/circular_field_table.h"
+#include "../include/simd_kernel.h"
+
+namespace Simulation {
+    template<class T>
+    std::size_t BasicConstellation<T>::Size() const {
+        return AngleRadians.size();
+    }
+
+    template<class T>
+    void BasicConstellation<T>::Reserve(std::size_t n) {
+        for (auto field : { &RadiusTrajectory, &PeriodSeconds, &AngleDegrees, &AngleRadians, &X, &Y,
+                            &RadialDirectionX, &RadialDirectionY, &TangentDirectionX, &TangentDirectionY,
+                            &FieldDirectionX, &FieldDirectionY, &FieldRadius }) {
+            field->reserve(n);
+        }
+        PhaseOffset.reserve(n);
+    }
+
+    template<class T>
+    void BasicConstellation<T>::Clear() {
+        for (auto field : { &RadiusTrajectory, &PeriodSeconds, &AngleDegrees, &AngleRadians, &X, &Y,
+                            &RadialDirectionX, &RadialDirectionY, &TangentDirectionX, &TangentDirectionY,
+                            &FieldDirectionX, &FieldDirectionY, &FieldRadius }) {
+            field->clear();
+        }
+        PhaseOffset.clear();
+    }
+
+    template<class T>
+    std::size_t BasicConstellation<T>::Add(T radiusTrajectory, T periodSeconds, T angleRadians) {
+        auto index = Size();
+        RadiusTrajectory.push_back(radiusTrajectory);
+        PeriodSeconds.push_back(periodSeconds);
+        PhaseOffset.push_back(angleRadians / (2 * Pi<PhaseScalar<T>>));
+        AngleRadians.push_back(angleRadians);
+        AngleDegrees.push_back(angleRadians * T(180) / Pi<T>);
+        for (auto field : { &X, &Y, &RadialDirectionX, &RadialDirectionY, &TangentDirectionX, &TangentDirectionY,
+                            &FieldDirectionX, &FieldDirectionY, &FieldRadius }) {
+            field->push_back(T(0));
+        }
+        return index;
+    }
+
+    template<class T>
+    void BasicConstellation<T>::SetPeriod(std::size_t index, T periodSeconds, PhaseScalar<T> timeSeconds) {
+        auto phase = PhaseOffset[index] + timeSeconds / PeriodSeconds[index] - timeSeconds / periodSeconds;
+        PhaseOffset[index] = phase - std::floor(phase);
+        PeriodSeconds[index] = periodSeconds;
+    }
+
+    template<class T>
+    void BasicConstellation<T>::Update(const EarthState<T>& earth) {
+        UpdateOrbits(earth);
+        UpdateCircularFields(earth);
+    }
+
+    template<class T>
+    void BasicConstellation<T>::Propagate(PhaseScalar<T> timeSeconds, const EarthState<T>& earth) {
+        UpdateAngles(timeSeconds);
+        Update(earth);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    template<class T>
+    void BasicConstellation<T>::UpdateAngles(PhaseScalar<T> timeSeconds) {
+        using P = PhaseScalar<T>;
+        auto n = Size();
+        auto period = PeriodSeconds.data();
+        auto offset = PhaseOffset.data();
+        auto deg = AngleDegrees.data();
+        auto rad = AngleRadians.data();
+        for (std::size_t i = 0; i < n; i++) {
+            auto phase = offset[i] + timeSeconds / period[i];
+            phase -= std::floor(phase);
+            deg[i] = T(360 * phase);
+            rad[i] = T(2 * Pi<P> * phase);
+        }
+    }
+
+    template<class T>
+    void BasicConstellation<T>::UpdateOrbits(const EarthState<T>& earth) {
+        Simd::OrbitArrays<T> arrays = {
+            RadiusTrajectory.data(), AngleRadians.data(),
+            X.data(), Y.data(),
+            RadialDirectionX.data(), RadialDirectionY.data(),
+            TangentDirectionX.data(), TangentDirectionY.data()
+        };
+        Simd::UpdateOrbits(earth.X, earth.Y, arrays, Size());
+    }
+
+    template<class T>
+    void BasicConstellation<T>::UpdateCircularFields(const EarthState<T>& earth) {
+        const auto& table = DefaultCircularFieldTable<T>();
+        auto n = Size();
+        for (std::size_t i = 0; i < n; i++) {
+            table.Lookup(AngleRadians[i], RadiusTrajectory[i], FieldDirectionX[i], FieldDirectionY[i], FieldRadius[i]);
+        }
+        if (FieldModel != nullptr) {
+            FieldModel->Directions(earth, X.data(), Y.data(), FieldDirectionX.data(), FieldDirectionY.data(), n);
+        }
+    }
+
+    template class BasicConstellation<float>;
+    template class BasicConstellation<double>;
+    template class BasicConstellation<long double>;
+}
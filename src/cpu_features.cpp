@@ -0,0 +1,88 @@
+#include "../include/cpu_features.h"
+#include <initializer_list>
+
+#if defined(SIMULATION_SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace Simulation {
+#if defined(SIMULATION_SIMD_X86)
+#if defined(_MSC_VER)
+    static bool CpuSupportsAVX2() {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid(info, 1);
+        auto fma = (info[2] & (1 << 12)) != 0;
+        auto osxsave = (info[2] & (1 << 27)) != 0;
+        if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }
+
+    static bool CpuSupportsAVX512() {
+        if (!CpuSupportsAVX2() || (_xgetbv(0) & 0xE6) != 0xE6) {
+            return false;
+        }
+        int info[4];
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 16)) != 0;
+    }
+#else
+    static bool CpuSupportsAVX2() {
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }
+
+    static bool CpuSupportsAVX512() {
+        return CpuSupportsAVX2() && __builtin_cpu_supports("avx512f");
+    }
+#endif
+#endif
+
+    bool IsSupported(InstructionSet set) {
+        switch (set) {
+        case InstructionSet::Scalar:
+            return true;
+#if defined(SIMULATION_SIMD_X86)
+        case InstructionSet::SSE2:
+            return true; // Baseline on x86-64
+        case InstructionSet::AVX2:
+            return CpuSupportsAVX2();
+        case InstructionSet::AVX512:
+            return CpuSupportsAVX512();
+#endif
+        default:
+            return false;
+        }
+    }
+
+    InstructionSet DetectInstructionSet() {
+        static const auto detected = [] {
+            for (auto set : { InstructionSet::AVX512, InstructionSet::AVX2, InstructionSet::SSE2 }) {
+                if (IsSupported(set)) {
+                    return set;
+                }
+            }
+            return InstructionSet::Scalar;
+        }();
+        return detected;
+    }
+
+    const char* ToString(InstructionSet set) {
+        switch (set) {
+        case InstructionSet::SSE2:
+            return "sse2";
+        case InstructionSet::AVX2:
+            return "avx2";
+        case InstructionSet::AVX512:
+            return "avx512";
+        default:
+            return "scalar";
+        }
+    }
+}
@@ -2,6 +2,8 @@
 #include "../include/module_satellite.h"
 #include "../include/main.h"
 #include "../include/graphics.h"
+#include "../include/command_queue.h"
+#include "../include/profiler.h"
 
 namespace Simulation {
     LRESULT __stdcall EventHandler::WindowProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
@@ -28,6 +30,36 @@ namespace Simulation {
         case VK_OEM_PLUS:
             HandleEventKeyPlusPressed();
             break;
+        case VK_SPACE:
+            CommandsInstance.Post({ Command::Type::TogglePause, 0.0 });
+            break;
+        case VK_LEFT:
+        case VK_RIGHT: {
+            // Scrubbing the replay, by ten seconds or with Shift by ten minutes
+            auto seconds = IsKeyDown(VK_SHIFT) ? 600.0 : 10.0;
+            CommandsInstance.Post({ Command::Type::Seek, key == VK_LEFT ? -seconds : seconds });
+            break;
+        }
+        case VK_HOME:
+            CommandsInstance.Post({ Command::Type::Seek, -1e12 });
+            break;
+        case 'L':
+            // The recorder belongs to the simulation thread like everything else it writes
+            CommandsInstance.Post({ Command::Type::ToggleTelemetry, 0.0 });
+            break;
+        case 'G':
+            CommandsInstance.Post({ Command::Type::ToggleFieldModel, 0.0 });
+            break;
+        case 'P':
+            ProfileOverlay = !ProfileOverlay;
+            break;
+        case 'E':
+            // The rings are read while the threads keep writing to them
+            Profiler::WriteChromeTrace("profile.json");
+            break;
+        case 'R':
+            Recording = !Recording;
+            break;
         case VK_ESCAPE:
             Running = false;
             break;
@@ -35,22 +67,25 @@ namespace Simulation {
     }
 
     void EventHandler::HandleEventKeyMinusPressed() {
+        // Posted to the simulation thread, the texts follow once the renderer sees the change
         if (IsKeyDown('T')) {
             // Decrease the period
-            if (Satellite::PeriodSeconds > 5.0l) {
-                Satellite::PeriodSeconds -= 5.0l;
-                Satellite::RotationBeginTimepoint = Now();
-                GraphicsInstance->UpdateTextLayouts();
-            }
+            CommandsInstance.Post({ Command::Type::ChangePeriod, -5.0 });
+        }
+        else if (IsKeyDown('W')) {
+            // Slow the simulated time down
+            CommandsInstance.Post({ Command::Type::ScaleTimeWarp, 0.1 });
         }
     }
 
     void EventHandler::HandleEventKeyPlusPressed() {
         if (IsKeyDown('T')) {
             // Increase the period
-            Satellite::PeriodSeconds += 5.0l;
-            Satellite::RotationBeginTimepoint = Now();
-            GraphicsInstance->UpdateTextLayouts();
+            CommandsInstance.Post({ Command::Type::ChangePeriod, 5.0 });
+        }
+        else if (IsKeyDown('W')) {
+            // Speed the simulated time up
+            CommandsInstance.Post({ Command::Type::ScaleTimeWarp, 10.0 });
         }
     }
 
@@ -0,0 +1,199 @@
+#include "../include/field_lines.h"
+#include "../include/orbit_kernel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Simulation {
+    std::size_t FieldLineSet::Lines() const {
+        return Offsets.empty() ? 0 : Offsets.size() - 1;
+    }
+
+    const FieldLinePoint* FieldLineSet::Line(std::size_t i, std::size_t& count) const {
+        count = Offsets[i + 1] - Offsets[i];
+        return Points.data() + Offsets[i];
+    }
+
+    void FieldLineSet::Clear() {
+        Points.clear();
+        Offsets.clear();
+        Generation++;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    // Everything a single line needs, in coordinates relative to the dipole, y up
+    struct LineIntegrator {
+        double MomentX;
+        double MomentY;
+        double Radius;
+        double CenterX;
+        double CenterY;
+        double Left, Right, Top, Bottom;
+        const FieldLineSettings* Settings;
+
+        // Unit field direction. The strength drops out, only the inside test needs a radius.
+        void Direction(double x, double y, double sign, double& dx, double& dy) const {
+            double bx, by;
+            Kernel::Dipole(x, y, MomentX, MomentY, 1e-9, 1.0, bx, by);
+            auto size = std::sqrt(bx * bx + by * by);
+            dx = sign * bx / size;
+            dy = sign * by / size;
+        }
+
+        bool Outside(double x, double y) const {
+            return x < Left || x > Right || y > Top || y < Bottom;
+        }
+
+        void Emit(double x, double y, std::vector<FieldLinePoint>& out) const {
+            out.push_back({ (float)(CenterX + x), (float)(CenterY - y) });
+        }
+
+        // Integrates from (x, y) along sign * B until the line meets the planet, leaves the
+        // rectangle or runs out of points. Bogacki-Shampine with first-same-as-last, where the step
+        // is limited both by the embedded error estimate and by how far the line turns in one step.
+        void Trace(double x, double y, double sign, std::vector<FieldLinePoint>& out) const {
+            const auto& s = *Settings;
+            const double MaxTurn = 0.05; // Radians per step, keeps the polyline smooth when drawn
+            auto h = std::clamp(1.0, (double)s.MinStep, (double)s.MaxStep);
+
+            auto first = out.size();
+            Emit(x, y, out);
+            double k1x, k1y;
+            Direction(x, y, sign, k1x, k1y);
+            while (out.size() - first < s.MaxPoints) {
+                double k2x, k2y, k3x, k3y, k4x, k4y;
+                Direction(x + h * 0.5 * k1x, y + h * 0.5 * k1y, sign, k2x, k2y);
+                Direction(x + h * 0.75 * k2x, y + h * 0.75 * k2y, sign, k3x, k3y);
+                auto x3 = x + h * (2.0 / 9.0 * k1x + 1.0 / 3.0 * k2x + 4.0 / 9.0 * k3x);
+                auto y3 = y + h * (2.0 / 9.0 * k1y + 1.0 / 3.0 * k2y + 4.0 / 9.0 * k3y);
+                Direction(x3, y3, sign, k4x, k4y);
+
+                auto ex = h * (-5.0 / 72.0 * k1x + 1.0 / 12.0 * k2x + 1.0 / 9.0 * k3x - 1.0 / 8.0 * k4x);
+                auto ey = h * (-5.0 / 72.0 * k1y + 1.0 / 12.0 * k2y + 1.0 / 9.0 * k3y - 1.0 / 8.0 * k4y);
+                auto error = std::sqrt(ex * ex + ey * ey);
+                auto turn = std::sqrt((k4x - k1x) * (k4x - k1x) + (k4y - k1y) * (k4y - k1y));
+                auto factor = std::min(0.9 * std::cbrt(s.Tolerance / std::max(error, 1e-12)), MaxTurn / std::max(turn, 1e-12));
+                if ((error > s.Tolerance || turn > MaxTurn) && h > s.MinStep) {
+                    h = std::max((double)s.MinStep, h * std::max(0.2, factor));
+                    continue;
+                }
+
+                // Into the planet: finish exactly on the surface
+                if (x3 * x3 + y3 * y3 < Radius * Radius) {
+                    auto dx = x3 - x, dy = y3 - y;
+                    auto a = dx * dx + dy * dy;
+                    auto b = 2 * (x * dx + y * dy);
+                    auto c = x * x + y * y - Radius * Radius;
+                    auto t = (-b - std::sqrt(std::max(0.0, b * b - 4 * a * c))) / (2 * a);
+                    Emit(x + t * dx, y + t * dy, out);
+                    return;
+                }
+
+                x = x3;
+                y = y3;
+                k1x = k4x;
+                k1y = k4y;
+                Emit(x, y, out);
+                if (Outside(x, y)) {
+                    return;
+                }
+                h = std::clamp(h * std::min(4.0, factor), (double)s.MinStep, (double)s.MaxStep);
+            }
+        }
+    };
+
+    static LineIntegrator MakeIntegrator(const DipoleField& field, const FieldLineSettings& settings) {
+        float mx, my;
+        field.Moment(mx, my);
+        LineIntegrator integrator;
+        integrator.MomentX = mx;
+        integrator.MomentY = my;
+        integrator.Radius = field.Radius;
+        integrator.CenterX = field.CenterX;
+        integrator.CenterY = field.CenterY;
+        integrator.Left = settings.Left - field.CenterX;
+        integrator.Right = settings.Right - field.CenterX;
+        integrator.Top = field.CenterY - settings.Top;
+        integrator.Bottom = field.CenterY - settings.Bottom;
+        integrator.Settings = &settings;
+        return integrator;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    const FieldLineSet& FieldLineTracer::Trace(const DipoleField& newField, const FieldLineSettings& newSettings, ThreadPool& pool) {
+        if (generation > 0 && newField == field && newSettings == settings) {
+            return lines;
+        }
+        field = newField;
+        settings = newSettings;
+        generation++;
+
+        auto integrator = MakeIntegrator(field, settings);
+        auto perSide = (settings.Lines + 1) / 2;
+
+        // Apexes spaced geometrically from the inner shell out past the farthest corner, so the
+        // outer lines leave the screen. A dipole line with its apex at L radii meets the surface at
+        // magnetic latitude acos(sqrt(1 / L)).
+        auto corner = 0.0;
+        for (auto x : { integrator.Left, integrator.Right }) {
+            for (auto y : { integrator.Top, integrator.Bottom }) {
+                corner = std::max(corner, std::sqrt(x * x + y * y));
+            }
+        }
+        auto inner = (double)settings.InnerShell;
+        auto outer = std::max(inner, 1.5 * corner / field.Radius);
+
+        perSeed.resize(2 * perSide);
+        pool.ParallelFor(perSeed.size(), [&](std::size_t seed) {
+            auto k = seed / 2;
+            auto shell = perSide > 1 ? inner * std::pow(outer / inner, (double)k / (perSide - 1)) : inner;
+            auto latitude = std::acos(std::sqrt(1.0 / shell));
+            auto side = seed % 2 == 0 ? 1.0 : -1.0;
+
+            // Magnetic equator and north in the tilted frame, north opposite the moment
+            auto ex = std::cos((double)field.Tilt), ey = std::sin((double)field.Tilt);
+            auto nx = -integrator.MomentX, ny = -integrator.MomentY;
+            auto r = field.Radius * (1.0 + 1e-6);
+            auto x = r * (side * std::cos(latitude) * ex + std::sin(latitude) * nx);
+            auto y = r * (side * std::cos(latitude) * ey + std::sin(latitude) * ny);
+
+            // Whichever way leads away from the surface
+            double dx, dy;
+            integrator.Direction(x, y, 1.0, dx, dy);
+            auto& out = perSeed[seed];
+            out.clear();
+            integrator.Trace(x, y, dx * x + dy * y >= 0 ? 1.0 : -1.0, out);
+        });
+
+        lines.Clear();
+        lines.Offsets.push_back(0);
+        for (const auto& line : perSeed) {
+            lines.Points.insert(lines.Points.end(), line.begin(), line.end());
+            lines.Offsets.push_back((std::uint32_t)lines.Points.size());
+        }
+        return lines;
+    }
+
+    void FieldLineTracer::TraceThrough(const DipoleField& through, const FieldLineSettings& limits, float x, float y, FieldLineSet& out) const {
+        out.Clear();
+        auto integrator = MakeIntegrator(through, limits);
+        auto localX = (double)x - through.CenterX, localY = (double)through.CenterY - y;
+        if (localX * localX + localY * localY < integrator.Radius * integrator.Radius) {
+            return;
+        }
+
+        // Backwards first, reversed, then forwards straight after it without repeating the starting
+        // point. Called every frame, so it only ever reuses the capacity out already has.
+        integrator.Trace(localX, localY, -1.0, out.Points);
+        std::reverse(out.Points.begin(), out.Points.end());
+        out.Points.pop_back();
+        integrator.Trace(localX, localY, 1.0, out.Points);
+        out.Offsets.push_back(0);
+        out.Offsets.push_back((std::uint32_t)out.Points.size());
+    }
+
+    std::uint64_t FieldLineTracer::Generation() const {
+        return generation;
+    }
+}
@@ -0,0 +1,116 @@
+#include "../include/field_map.h"
+#include "../include/orbit_kernel.h"
+#include "../include/simd_kernel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Simulation {
+    void DipoleField::Moment(float& x, float& y) const {
+        x = std::sin(Tilt);
+        y = -std::cos(Tilt);
+    }
+
+    void DipoleField::At(float x, float y, float& bx, float& by) const {
+        float mx, my;
+        Moment(mx, my);
+        Kernel::Dipole(x - CenterX, CenterY - y, mx, my, Radius, Strength, bx, by);
+    }
+
+    float DipoleField::TiltAlong(float x, float y, float bx, float by) const {
+        // Along and across the radius a dipole's field is (2 cos a, -sin a), a the angle from the
+        // radius to the moment. The moment points down the screen at no tilt.
+        auto rx = (double)x - CenterX, ry = (double)CenterY - y;
+        auto r = std::sqrt(rx * rx + ry * ry);
+        if (r == 0 || (bx == 0 && by == 0)) {
+            return Tilt;
+        }
+        auto along = (bx * rx + by * ry) / r, across = (by * rx - bx * ry) / r;
+        auto a = std::atan2(-2 * across, along);
+        return (float)(std::atan2(ry, rx) + a + std::acos(0.0));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    float FieldMapDomain::CellWidth() const {
+        return Columns > 0 ? (Right - Left) / Columns : 0.0f;
+    }
+
+    float FieldMapDomain::CellHeight() const {
+        return Rows > 0 ? (Bottom - Top) / Rows : 0.0f;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    void FieldMap::Evaluate(const DipoleField& field, const FieldMapDomain& domain, ThreadPool& pool) {
+        Domain = domain;
+        auto cells = Cells();
+        X.resize(cells);
+        Y.resize(cells);
+        Magnitude.resize(cells);
+
+        pool.ParallelFor(Tiles(), [&](std::size_t tile) {
+            EvaluateTile(field, tile);
+        });
+    }
+
+    std::size_t FieldMap::Cells() const {
+        return Domain.Columns * Domain.Rows;
+    }
+
+    std::size_t FieldMap::Tiles() const {
+        auto across = (Domain.Columns + TileSize - 1) / TileSize;
+        auto down = (Domain.Rows + TileSize - 1) / TileSize;
+        return across * down;
+    }
+
+    void FieldMap::EvaluateTile(const DipoleField& field, std::size_t tile) {
+        auto across = (Domain.Columns + TileSize - 1) / TileSize;
+        auto column = tile % across * TileSize;
+        auto row = tile / across * TileSize;
+        auto columns = std::min(TileSize, Domain.Columns - column);
+        auto rows = std::min(TileSize, Domain.Rows - row);
+        auto cellWidth = Domain.CellWidth();
+        auto cellHeight = Domain.CellHeight();
+
+        Simd::DipoleRow<float> kernel = {};
+        field.Moment(kernel.MomentX, kernel.MomentY);
+        kernel.StartX = Domain.Left + (column + 0.5f) * cellWidth - field.CenterX;
+        kernel.StepX = cellWidth;
+        kernel.Radius = field.Radius;
+        kernel.Strength = field.Strength;
+
+        for (auto j = row; j < row + rows; j++) {
+            auto offset = j * Domain.Columns + column;
+            kernel.OffsetY = field.CenterY - (Domain.Top + (j + 0.5f) * cellHeight);
+            kernel.X = X.data() + offset;
+            kernel.Y = Y.data() + offset;
+            kernel.Magnitude = Magnitude.data() + offset;
+            Simd::EvaluateDipoleRow(kernel, columns);
+        }
+    }
+
+    bool FieldMap::Sample(float x, float y, float& bx, float& by, float& magnitude) const {
+        auto minX = std::min(Domain.Left, Domain.Right), maxX = std::max(Domain.Left, Domain.Right);
+        auto minY = std::min(Domain.Top, Domain.Bottom), maxY = std::max(Domain.Top, Domain.Bottom);
+        if (Cells() == 0 || x < minX || x > maxX || y < minY || y > maxY) {
+            return false;
+        }
+
+        // Continuous cell coordinates, cell centres on the integers
+        auto u = std::clamp((x - Domain.Left) / Domain.CellWidth() - 0.5f, 0.0f, (float)(Domain.Columns - 1));
+        auto v = std::clamp((y - Domain.Top) / Domain.CellHeight() - 0.5f, 0.0f, (float)(Domain.Rows - 1));
+        auto i0 = std::min((std::size_t)u, Domain.Columns - 1), j0 = std::min((std::size_t)v, Domain.Rows - 1);
+        auto i1 = std::min(i0 + 1, Domain.Columns - 1), j1 = std::min(j0 + 1, Domain.Rows - 1);
+        auto fu = u - i0, fv = v - j0;
+
+        auto lerp = [&](const AlignedVector<float>& plane) {
+            auto top = plane[j0 * Domain.Columns + i0] * (1 - fu) + plane[j0 * Domain.Columns + i1] * fu;
+            auto bottom = plane[j1 * Domain.Columns + i0] * (1 - fu) + plane[j1 * Domain.Columns + i1] * fu;
+            return top * (1 - fv) + bottom * fv;
+        };
+        bx = lerp(X);
+        by = lerp(Y);
+        magnitude = lerp(Magnitude);
+        return true;
+    }
+}
@@ -0,0 +1,231 @@
+#include "../include/frame_exporter.h"
+#include "../include/png.h"
+#include "../include/profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace Simulation {
+    using Clock = std::chrono::steady_clock;
+
+    static std::size_t Yuv420Bytes(int width, int height) {
+        auto chroma = (std::size_t)((width + 1) / 2) * ((height + 1) / 2);
+        return (std::size_t)width * height + 2 * chroma;
+    }
+
+    FrameExporter::FrameExporter(const FrameExportSettings& settings)
+        : settings(settings), frameBytes((std::size_t)settings.Width * settings.Height * 4), file(nullptr),
+          head(0), count(0), nextIndex(0), stopping(false), nextWrite(0) {
+        auto slotCount = std::max<std::size_t>(1, settings.Slots);
+        slots.resize(slotCount);
+        for (std::size_t i = 0; i < slotCount; i++) {
+            slots[i].resize(frameBytes);
+            freeSlots.push_back(slotCount - 1 - i);
+        }
+        jobs.resize(slotCount);
+
+        if (settings.Format == ExportFormat::Y4m) {
+            file = std::fopen(settings.Path.c_str(), "wb");
+            if (file == nullptr) {
+                stats.Failed = true;
+                stopping = true;
+                return;
+            }
+            auto numerator = (long long)(settings.FramesPerSecond * 1000.0 + 0.5), denominator = 1000ll;
+            auto divisor = std::gcd(numerator, denominator);
+            divisor = divisor > 0 ? divisor : 1;
+            std::fprintf(file, "YUV4MPEG2 W%d H%d F%lld:%lld Ip A1:1 C420jpeg\n", settings.Width, settings.Height,
+                         numerator / divisor, denominator / divisor);
+        }
+
+        auto threads = settings.Workers > 0 ? settings.Workers : std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; i++) {
+            workers.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    FrameExporter::~FrameExporter() {
+        Finish();
+    }
+
+    bool FrameExporter::Failed() const {
+        std::lock_guard lock(mutex);
+        return stats.Failed;
+    }
+
+    bool FrameExporter::Submit(const std::uint8_t* rgba) {
+        SIMULATION_PROFILE_ZONE("FrameExporter::Submit");
+        std::size_t slot;
+        {
+            std::unique_lock lock(mutex);
+            stats.Submitted++;
+            if (freeSlots.empty() && !stopping) {
+                if (settings.Backpressure == Backpressure::Drop) {
+                    stats.Dropped++;
+                    return false;
+                }
+                auto begin = Clock::now();
+                freed.wait(lock, [this] { return !freeSlots.empty() || stopping; });
+                stats.Stalls++;
+                stats.StallSeconds += std::chrono::duration<double>(Clock::now() - begin).count();
+            }
+            if (stopping) {
+                stats.Dropped++;
+                return false;
+            }
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+
+        // The slot belongs to this thread until it is queued, the copy needs no lock
+        std::memcpy(slots[slot].data(), rgba, frameBytes);
+
+        {
+            std::lock_guard lock(mutex);
+            jobs[(head + count) % jobs.size()] = { slot, nextIndex++ };
+            count++;
+            stats.PeakQueued = std::max(stats.PeakQueued, count);
+        }
+        queued.notify_one();
+        return true;
+    }
+
+    void FrameExporter::Finish() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        queued.notify_all();
+        freed.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+        if (file != nullptr) {
+            if (std::fclose(file) != 0) {
+                std::lock_guard lock(mutex);
+                stats.Failed = true;
+            }
+            file = nullptr;
+        }
+    }
+
+    FrameExportStats FrameExporter::Stats() const {
+        std::lock_guard lock(mutex);
+        return stats;
+    }
+
+    void FrameExporter::WorkerLoop() {
+        Profiler::SetThreadName("Exporter");
+        // Grows to the largest encoded frame once, then is reused
+        std::vector<std::uint8_t> out;
+        while (true) {
+            Job job;
+            {
+                std::unique_lock lock(mutex);
+                queued.wait(lock, [this] { return count > 0 || stopping; });
+                if (count == 0) {
+                    return;
+                }
+                job = jobs[head];
+                head = (head + 1) % jobs.size();
+                count--;
+            }
+
+            auto begin = Clock::now();
+            out.clear();
+            Encode(slots[job.Slot].data(), out);
+            auto encoded = Clock::now();
+
+            // The slot is free again as soon as it is encoded, the write works from out
+            {
+                std::lock_guard lock(mutex);
+                freeSlots.push_back(job.Slot);
+                stats.EncodeSeconds += std::chrono::duration<double>(encoded - begin).count();
+            }
+            freed.notify_one();
+
+            auto ok = Write(job.Index, out);
+            std::lock_guard lock(mutex);
+            if (ok) {
+                stats.Written++;
+                stats.Bytes += out.size();
+            }
+            else {
+                stats.Failed = true;
+            }
+        }
+    }
+
+    void FrameExporter::Encode(const std::uint8_t* rgba, std::vector<std::uint8_t>& out) const {
+        SIMULATION_PROFILE_ZONE("FrameExporter::Encode");
+        if (settings.Format == ExportFormat::Png) {
+            Png::Encode(rgba, settings.Width, settings.Height, (std::size_t)settings.Width * 4, false, out);
+            return;
+        }
+        static constexpr char Header[] = "FRAME\n";
+        out.resize(sizeof(Header) - 1 + Yuv420Bytes(settings.Width, settings.Height));
+        std::memcpy(out.data(), Header, sizeof(Header) - 1);
+        ConvertToYuv420(rgba, settings.Width, settings.Height, out.data() + sizeof(Header) - 1);
+    }
+
+    bool FrameExporter::Write(std::uint64_t index, const std::vector<std::uint8_t>& data) {
+        if (settings.Format == ExportFormat::Png) {
+            char number[32];
+            std::snprintf(number, sizeof(number), "%06llu.png", (unsigned long long)index);
+            auto path = settings.Path + number;
+            auto png = std::fopen(path.c_str(), "wb");
+            if (png == nullptr) {
+                return false;
+            }
+            auto ok = std::fwrite(data.data(), 1, data.size(), png) == data.size();
+            return std::fclose(png) == 0 && ok;
+        }
+
+        std::unique_lock lock(writeMutex);
+        written.wait(lock, [&] { return nextWrite == index; });
+        auto ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+        nextWrite++;
+        lock.unlock();
+        written.notify_all();
+        return ok;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    // BT.709 in 8 bit fixed point, scaled to 219 steps of luma and 224 of chroma
+    static inline int Luma(int r, int g, int b) {
+        return ((47 * r + 157 * g + 16 * b + 128) >> 8) + 16;
+    }
+
+    void ConvertToYuv420(const std::uint8_t* rgba, int width, int height, std::uint8_t* out) {
+        auto chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+        auto y = out;
+        auto cb = y + (std::size_t)width * height;
+        auto cr = cb + (std::size_t)chromaWidth * chromaHeight;
+
+        for (int row = 0; row < height; row++) {
+            auto source = rgba + (std::size_t)row * width * 4;
+            auto target = y + (std::size_t)row * width;
+            for (int x = 0; x < width; x++) {
+                target[x] = (std::uint8_t)Luma(source[4 * x], source[4 * x + 1], source[4 * x + 2]);
+            }
+        }
+
+        for (int row = 0; row < chromaHeight; row++) {
+            auto top = rgba + (std::size_t)(2 * row) * width * 4;
+            // The last row of an odd height is its own neighbour
+            auto bottom = 2 * row + 1 < height ? top + (std::size_t)width * 4 : top;
+            for (int x = 0; x < chromaWidth; x++) {
+                auto left = 8 * x, right = 2 * x + 1 < width ? left + 4 : left;
+                auto r = top[left] + top[right] + bottom[left] + bottom[right];
+                auto g = top[left + 1] + top[right + 1] + bottom[left + 1] + bottom[right + 1];
+                auto b = top[left + 2] + top[right + 2] + bottom[left + 2] + bottom[right + 2];
+                // The sums are four pixels, the extra 2 bits go into the shift
+                cb[(std::size_t)row * chromaWidth + x] = (std::uint8_t)(((-26 * r - 87 * g + 112 * b + 512) >> 10) + 128);
+                cr[(std::size_t)row * chromaWidth + x] = (std::uint8_t)(((112 * r - 102 * g - 10 * b + 512) >> 10) + 128);
+            }
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#include "../include/frame_recorder.h"
+#include "../include/profiler.h"
+
+namespace Simulation {
+    using Clock = std::chrono::steady_clock;
+
+    static FrameExportSettings Waiting(FrameExportSettings settings) {
+        settings.Backpressure = Backpressure::Wait;
+        return settings;
+    }
+
+    FrameRecorder::FrameRecorder(const FrameExportSettings& settings, unsigned rasterThreads)
+        : pool(rasterThreads), renderer(settings.Width, settings.Height, pool), exporter(Waiting(settings)),
+          pending(), head(0), count(0), stopping(false), finished(false) {
+        if (exporter.Failed()) {
+            stopping = true;
+            finished = true;
+            return;
+        }
+        thread = std::thread([this] { DrawLoop(); });
+    }
+
+    FrameRecorder::~FrameRecorder() {
+        Finish();
+    }
+
+    bool FrameRecorder::Failed() const {
+        return exporter.Failed();
+    }
+
+    void FrameRecorder::SetBitmap(BitmapId id, int width, int height, std::vector<std::uint8_t> rgba) {
+        std::lock_guard lock(mutex);
+        bitmaps.push_back({ id, width, height, std::move(rgba) });
+    }
+
+    bool FrameRecorder::Submit(const Snapshot& snapshot, bool refreshHud) {
+        SIMULATION_PROFILE_ZONE("FrameRecorder::Submit");
+        {
+            std::lock_guard lock(mutex);
+            stats.Submitted++;
+            if (stopping || count == QueueLength) {
+                stats.Dropped++;
+                return false;
+            }
+            pending[(head + count) % QueueLength] = { snapshot, refreshHud };
+            count++;
+        }
+        queued.notify_one();
+        return true;
+    }
+
+    void FrameRecorder::Stop() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        queued.notify_all();
+    }
+
+    void FrameRecorder::Finish() {
+        Stop();
+        if (thread.joinable()) {
+            thread.join();
+        }
+        exporter.Finish();
+    }
+
+    bool FrameRecorder::Finished() const {
+        std::lock_guard lock(mutex);
+        return finished;
+    }
+
+    FrameRecorderStats FrameRecorder::Stats() const {
+        FrameRecorderStats copy;
+        {
+            std::lock_guard lock(mutex);
+            copy = stats;
+        }
+        copy.Export = exporter.Stats();
+        return copy;
+    }
+
+    void FrameRecorder::DrawLoop() {
+        Profiler::SetThreadName("Recorder");
+        while (true) {
+            Pending next;
+            std::vector<Bitmap> changed;
+            {
+                std::unique_lock lock(mutex);
+                queued.wait(lock, [this] { return count > 0 || stopping; });
+                if (count == 0) {
+                    break;
+                }
+                next = pending[head];
+                head = (head + 1) % QueueLength;
+                count--;
+                changed.swap(bitmaps);
+            }
+            for (auto& bitmap : changed) {
+                renderer.SetBitmap(bitmap.Id, bitmap.Width, bitmap.Height, std::move(bitmap.Rgba));
+            }
+
+            auto begin = Clock::now();
+            scene.Draw(renderer, next.Frame, next.RefreshHud);
+            auto drawn = Clock::now();
+            exporter.Submit(renderer.Pixels());
+
+            std::lock_guard lock(mutex);
+            stats.Drawn++;
+            stats.DrawSeconds += std::chrono::duration<double>(drawn - begin).count();
+        }
+
+        exporter.Finish();
+        std::lock_guard lock(mutex);
+        finished = true;
+    }
+}
@@ -0,0 +1,134 @@
+#include "../include/frame_scheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace Simulation {
+    void JitterStats::Record(std::chrono::nanoseconds lateness) {
+        auto us = std::max(0.0, std::chrono::duration<double, std::micro>(lateness).count());
+        count++;
+        sum += us;
+        squares += us * us;
+        max = std::max(max, us);
+        auto bucket = us < FineMicroseconds ? (std::size_t)us : FineMicroseconds + (std::size_t)(us - FineMicroseconds) / CoarseBucket;
+        histogram[std::min(bucket, Buckets - 1)]++;
+    }
+
+    void JitterStats::Reset() {
+        *this = JitterStats();
+    }
+
+    std::uint64_t JitterStats::Count() const {
+        return count;
+    }
+
+    double JitterStats::MeanMicroseconds() const {
+        return count > 0 ? sum / count : 0.0;
+    }
+
+    double JitterStats::DeviationMicroseconds() const {
+        if (count == 0) {
+            return 0.0;
+        }
+        auto mean = sum / count;
+        return std::sqrt(std::max(0.0, squares / count - mean * mean));
+    }
+
+    double JitterStats::MaxMicroseconds() const {
+        return max;
+    }
+
+    double JitterStats::PercentileMicroseconds(double fraction) const {
+        auto wanted = (std::uint64_t)std::ceil(fraction * count);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i + 1 < Buckets; i++) {
+            seen += histogram[i];
+            if (seen >= wanted) {
+                return i < FineMicroseconds ? (double)(i + 1) : (double)(FineMicroseconds + (i - FineMicroseconds + 1) * CoarseBucket);
+            }
+        }
+        return max;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    FrameScheduler::FrameScheduler(double hertz) : missed(0), spin(std::chrono::microseconds(1000)) {
+        SetRate(hertz);
+        Start(Clock::now());
+    }
+
+    std::chrono::nanoseconds FrameScheduler::Period() const {
+        return period;
+    }
+
+    void FrameScheduler::SetRate(double hertz) {
+        period = std::chrono::nanoseconds((std::int64_t)std::llround(1e9 / hertz));
+    }
+
+    void FrameScheduler::Start(Clock::time_point start) {
+        deadline = start + period;
+    }
+
+    FrameScheduler::Clock::time_point FrameScheduler::Deadline() const {
+        return deadline;
+    }
+
+    std::uint64_t FrameScheduler::Arrive(Clock::time_point now) {
+        stats.Record(now - deadline);
+
+        // Still on the grid of the original deadlines, however late this one was
+        deadline += period;
+        std::uint64_t skipped = 0;
+        if (deadline <= now) {
+            skipped = (std::uint64_t)((now - deadline) / period) + 1;
+            deadline += period * (std::int64_t)skipped;
+        }
+        missed += skipped;
+        return skipped;
+    }
+
+    bool FrameScheduler::Due(Clock::time_point now) {
+        if (now < deadline) {
+            return false;
+        }
+        Arrive(now);
+        return true;
+    }
+
+    std::uint64_t FrameScheduler::Wait() {
+        // Sleep while the deadline is comfortably beyond what a sleep may overshoot
+        auto wake = deadline - spin;
+        if (Clock::now() < wake) {
+            std::this_thread::sleep_until(wake);
+            auto overshoot = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - wake);
+            // Jumps up to a bad overshoot at once, creeps back down by 1/16 per wait
+            auto next = std::max(2 * overshoot, spin - spin / 16);
+            spin = std::clamp<std::chrono::nanoseconds>(next, MinSpin, MaxSpin);
+        }
+
+        // Spin the rest
+        auto now = Clock::now();
+        while (now < deadline) {
+            std::this_thread::yield();
+            now = Clock::now();
+        }
+        return Arrive(now);
+    }
+
+    const JitterStats& FrameScheduler::Stats() const {
+        return stats;
+    }
+
+    std::uint64_t FrameScheduler::Missed() const {
+        return missed;
+    }
+
+    void FrameScheduler::ResetStats() {
+        stats.Reset();
+        missed = 0;
+    }
+
+    std::chrono::nanoseconds FrameScheduler::SpinMargin() const {
+        return spin;
+    }
+}
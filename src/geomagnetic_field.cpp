@@ -0,0 +1,103 @@
+#include "../include/geomagnetic_field.h"
+#include "../include/simulation_state.h"
+#include "../include/simd_kernel.h"
+#include "../include/profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace Simulation {
+    bool GaussCoefficients::Load(const std::string& path) {
+        auto file = std::fopen(path.c_str(), "r");
+        if (file == nullptr) {
+            return false;
+        }
+        *this = {};
+        auto ok = true;
+        char line[256];
+        while (ok && std::fgets(line, sizeof(line), file) != nullptr) {
+            auto text = line;
+            while (*text == ' ' || *text == '\t') {
+                text++;
+            }
+            if (*text == '#' || *text == '\n' || *text == '\r' || *text == 0) {
+                continue;
+            }
+            char kind = 0;
+            int n = 0, m = 0;
+            double value = 0;
+            if (std::sscanf(text, " %c %d %d %lf", &kind, &n, &m, &value) != 4 || (kind != 'g' && kind != 'h') || n < 1 || m < 0 || m > n) {
+                ok = false;
+                break;
+            }
+            if (n > MaxDegree) {
+                continue;
+            }
+            (kind == 'g' ? G : H)[n][m] = value;
+            Degree = std::max(Degree, n);
+        }
+        std::fclose(file);
+        return ok && Degree > 0;
+    }
+
+    GaussCoefficients GaussCoefficients::AxialDipole(double g10) {
+        GaussCoefficients coefficients;
+        coefficients.Degree = 1;
+        coefficients.G[1][0] = g10;
+        return coefficients;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    template<class T>
+    BasicSphericalHarmonicField<T>::BasicSphericalHarmonicField(const GaussCoefficients& coefficients, int degree, double longitudeRadians)
+        : degree(std::clamp(degree, 0, coefficients.Degree)), terms(), recurrenceA(), recurrenceB(), normalization(1) {
+        for (int n = 1; n <= this->degree; n++) {
+            for (int m = 0; m <= n; m++) {
+                terms[n * (n + 1) / 2 + m] = T(coefficients.G[n][m] * std::cos(m * longitudeRadians) + coefficients.H[n][m] * std::sin(m * longitudeRadians));
+            }
+        }
+        Kernel::HarmonicRecurrence(this->degree, recurrenceA, recurrenceB);
+        auto dipole = std::sqrt(coefficients.G[1][0] * coefficients.G[1][0] + coefficients.G[1][1] * coefficients.G[1][1] + coefficients.H[1][1] * coefficients.H[1][1]);
+        if (dipole > 0) {
+            normalization = T(1 / dipole);
+        }
+    }
+
+    template<class T>
+    int BasicSphericalHarmonicField<T>::Degree() const {
+        return degree;
+    }
+
+    template<class T>
+    void BasicSphericalHarmonicField<T>::At(T x, T y, T& bx, T& by) const {
+        Kernel::HarmonicField(x, y, degree, terms, recurrenceA, recurrenceB, T(1), bx, by);
+        auto inverse = T(1) / std::sqrt(x * x + y * y);
+        auto cube = inverse * inverse * inverse;
+        bx *= cube;
+        by *= cube;
+    }
+
+    template<class T>
+    void BasicSphericalHarmonicField<T>::Directions(const EarthState<T>& earth, const T* x, const T* y, T* directionX, T* directionY, std::size_t n) const {
+        SIMULATION_PROFILE_ZONE("Harmonic::Directions");
+        Simd::HarmonicRows<T> rows = {};
+        rows.Degree = degree;
+        rows.Terms = terms;
+        rows.RecurrenceA = recurrenceA;
+        rows.RecurrenceB = recurrenceB;
+        rows.Normalization = normalization;
+        rows.CenterX = earth.X;
+        rows.CenterY = earth.Y;
+        rows.InverseRadius = T(1) / earth.Radius;
+        rows.X = x;
+        rows.Y = y;
+        rows.DirectionX = directionX;
+        rows.DirectionY = directionY;
+        Simd::EvaluateHarmonicField(rows, n);
+    }
+
+    template class BasicSphericalHarmonicField<float>;
+    template class BasicSphericalHarmonicField<double>;
+    template class BasicSphericalHarmonicField<long double>;
+}
@@ -1,27 +1,29 @@
 ﻿#include "../include/graphics.h"
 #include "../include/resource.h"
-#include "../include/module_earth.h"
 #include "../include/module_satellite.h"
-#include "../include/magnetic_field_circular.h"
-#include <string>
+#include "../include/snapshot.h"
+#include "../include/profiler.h"
 
 namespace Simulation {
-    long double FieldLinesWidth = 10.0f;
-    long double BaseArrowLength = 150.0l, BaseArrowWidth = 25.0l;
-
-    Graphics::Graphics(HWND hWnd) : hResult(S_OK), d2d1() {
+    Graphics::Graphics(HWND hWnd) : hResult(S_OK), d2d1(), target(nullptr), background(), layerKey(0), layerValid(false), polylines(), nextPolyline(0), prefixes(), nextPrefix(0) {
+        StartLoadingAssets();
         CreateFactory();
         CreateRenderTarget(hWnd);
-        LoadModules();
         CreateDWriteFactory();
         CreateDefaultTextFormat();
         CreateBrush();
-        CreateSatelliteTrajectoryLineStrokeStyle();
+        CreateDashedStrokeStyle();
         CreateArrowStrokeStyle();
-        CreateTextLayouts();
+        LoadModules();
     }
 
     Graphics::~Graphics() {
+        for (auto& polyline : polylines) {
+            SafeRelease(&polyline.Geometry);
+        }
+        for (auto& prefix : prefixes) {
+            SafeRelease(&prefix.Layout);
+        }
         SafeRelease(&d2d1.factory);
         SafeRelease(&d2d1.renderTarget);
         SafeRelease(&d2d1.bmpEarth);
@@ -29,31 +31,89 @@ namespace Simulation {
         SafeRelease(&d2d1.dWriteFactory);
         SafeRelease(&d2d1.textFormatDefault);
         SafeRelease(&d2d1.brush);
-        SafeRelease(&d2d1.strokeStyleSatelliteTrajectoryLine);
+        SafeRelease(&d2d1.strokeStyleDashed);
         SafeRelease(&d2d1.strokeStyleArrow);
-        SafeRelease(&d2d1.textLayoutPeriod);
-        SafeRelease(&d2d1.textLayoutFrequency);
-        SafeRelease(&d2d1.textLayoutAngularSpeed);
-        SafeRelease(&d2d1.textLayoutCircularMagneticField);
-        SafeRelease(&d2d1.textLayoutRadialAxis);
-        SafeRelease(&d2d1.textLayoutTangentAxis);
-    }
-
-    void Graphics::Draw() {
-        d2d1.renderTarget->BeginDraw();
-        d2d1.renderTarget->Clear(D2D1::ColorF(0, 0, 0)); // Black background
-        DrawEarth();
-        DrawTrajectory();
-        DrawMagneticFieldsLines();
-        DrawSatellite();
-        DrawAxes();
-        DrawMagneticFieldsDirections();
-        DrawInfo();
-        d2d1.renderTarget->EndDraw();
+        SafeRelease(&d2d1.layerTarget);
+    }
+
+    void Graphics::Draw(bool refreshHud) {
+        SIMULATION_PROFILE_ZONE("Graphics::Draw");
+        TakeSnapshot();
+        if (Success()) {
+            scene.SetProfileOverlay(ProfileOverlay);
+            scene.Draw(*this, SnapshotsInstance.Front(), refreshHud);
+            Record(refreshHud);
+        }
+    }
+
+    // The window's target can not be read back, so a recorded frame is the same snapshot drawn
+    // once more by the software renderer. That happens on the recorder's thread: this one only
+    // queues a copy of the snapshot, and the ones the recorder can not take right away are dropped
+    // rather than slow the window down.
+    void Graphics::Record(bool refreshHud) {
+        SIMULATION_PROFILE_ZONE("Graphics::Record");
+        // A stopped recording writes out what it still has on its own thread, and is let go of
+        // once it is done
+        if (finishing && finishing->Finished()) {
+            finishing.reset();
+        }
+        if (!Recording) {
+            if (recorder) {
+                recorder->Stop();
+                finishing = std::move(recorder);
+            }
+            return;
+        }
+        if (!recorder) {
+            if (finishing) {
+                // Still writing the same file, the new recording starts once it is closed
+                return;
+            }
+            FrameExportSettings settings;
+            settings.Format = ExportFormat::Y4m;
+            settings.Path = RecordingPath;
+            settings.Width = Simulation::Width;
+            settings.Height = Simulation::Height;
+            settings.FramesPerSecond = Main::FramesPerSecond;
+            recorder = std::make_unique<FrameRecorder>(settings);
+            if (recorder->Failed()) {
+                Recording = false;
+                recorder.reset();
+                return;
+            }
+            for (std::size_t i = 0; i < recordingSprites.size(); i++) {
+                const auto& image = assets.Image(i);
+                recorder->SetBitmap((BitmapId)i, image.Width, image.Height, recordingSprites[i]);
+            }
+        }
+        recorder->Submit(SnapshotsInstance.Front(), refreshHud);
     }
 
     ////////////////////////////////////////////////////////////////////////////////////////
 
+    void Graphics::StartLoadingAssets() {
+        std::vector<AssetSource> sources;
+        for (auto resId : { IMG_EARTH, IMG_SATELLITE }) {
+            auto resInfo = GetResourcePointerAndSize(resId);
+            if (Failure()) {
+                // Left to the WIC path to report
+                hResult = S_OK;
+                return;
+            }
+            sources.push_back({ reinterpret_cast<const std::uint8_t*>(resInfo.first), resInfo.second });
+        }
+        // The resources stay mapped as long as the module, the cache as long as this
+        assetsLoaded = std::async(std::launch::async, [this, sources]() {
+            if (!assets.Load(sources, AssetCache::DefaultPath)) {
+                return false;
+            }
+            for (std::size_t i = 0; i < assets.Size(); i++) {
+                recordingSprites.push_back(AssetCache::Straight(assets.Image(i)));
+            }
+            return true;
+        });
+    }
+
     void Graphics::CreateFactory() {
         if (Success()) {
             auto type = D2D1_FACTORY_TYPE_SINGLE_THREADED;
@@ -63,7 +123,7 @@ namespace Simulation {
 
     void Graphics::CreateRenderTarget(HWND hWnd) {
         if (Success()) {
-            auto size = D2D1::SizeU(Width, Height);
+            auto size = D2D1::SizeU(Simulation::Width, Simulation::Height);
             auto props1 = D2D1::RenderTargetProperties();
             auto props2 = D2D1::HwndRenderTargetProperties(hWnd, size);
             hResult = d2d1.factory->CreateHwndRenderTarget(props1, props2, &d2d1.renderTarget);
@@ -72,6 +132,16 @@ namespace Simulation {
 
     void Graphics::LoadModules() {
         if (Success()) {
+            if (assetsLoaded.valid() && assetsLoaded.get()) {
+                CreateBitmapFromAsset(assets.Image((std::size_t)BitmapId::Earth), &d2d1.bmpEarth);
+                CreateBitmapFromAsset(assets.Image((std::size_t)BitmapId::Satellite), &d2d1.bmpSatellite);
+                if (Success()) {
+                    return;
+                }
+                SafeRelease(&d2d1.bmpEarth);
+                SafeRelease(&d2d1.bmpSatellite);
+                hResult = S_OK;
+            }
             auto wicFactory = CreateWICFactory();
             LoadEarthModule(wicFactory);
             LoadSatelliteModule(wicFactory);
@@ -106,17 +176,17 @@ namespace Simulation {
         }
     }
 
-    void Graphics::CreateSatelliteTrajectoryLineStrokeStyle() {
+    void Graphics::CreateDashedStrokeStyle() {
         if (Success()) {
             auto startCap = D2D1_CAP_STYLE_FLAT;
             auto endCap = D2D1_CAP_STYLE_FLAT;
             auto dashCap = D2D1_CAP_STYLE_FLAT;
             auto lineJoin = D2D1_LINE_JOIN_BEVEL;
             auto miterLimit = 10.0f;
-            auto dashStyle = SatelliteTrajectoryLineDashStyle;
+            auto dashStyle = DashedLineDashStyle;
             auto dashOffset = 0.0f;
             auto props = D2D1::StrokeStyleProperties(startCap, endCap, dashCap, lineJoin, miterLimit, dashStyle, dashOffset);
-            hResult = d2d1.factory->CreateStrokeStyle(props, NULL, 0, &d2d1.strokeStyleSatelliteTrajectoryLine);
+            hResult = d2d1.factory->CreateStrokeStyle(props, NULL, 0, &d2d1.strokeStyleDashed);
         }
     }
 
@@ -134,81 +204,143 @@ namespace Simulation {
         }
     }
 
-    void Graphics::CreateTextLayouts() {
-        if (Success()) {
-            UpdateTextLayoutPeriod();
-            UpdateTextLayoutFrequency();
-            UpdateTextLayoutAngularSpeed();
-            CreateTextLayoutCircularMagneticField();
-            CreateTextLayoutRadialAxis();
-            CreateTextLayoutTangentAxis();
-        }
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    int Graphics::Width() const {
+        return Simulation::Width;
     }
 
-    void Graphics::UpdateTextLayouts() {
-        if (Success()) {
-            // Cleanup the previous layouts
-            SafeRelease(&d2d1.textLayoutPeriod);
-            SafeRelease(&d2d1.textLayoutFrequency);
-            SafeRelease(&d2d1.textLayoutAngularSpeed);
+    int Graphics::Height() const {
+        return Simulation::Height;
+    }
 
-            UpdateTextLayoutPeriod();
-            UpdateTextLayoutFrequency();
-            UpdateTextLayoutAngularSpeed();
+    void Graphics::BeginFrame(Color color) {
+        // The layer is drawn over the background, a new one needs a new layer
+        if (color.R != background.R || color.G != background.G || color.B != background.B || color.A != background.A) {
+            layerValid = false;
         }
+        background = color;
+        target = d2d1.renderTarget;
+        target->BeginDraw();
+        target->Clear(D2D1::ColorF(color.R, color.G, color.B, color.A));
     }
 
-    ////////////////////////////////////////////////////////////////////////////////////////
+    void Graphics::EndFrame() {
+        // Where the GPU work is waited for, and with vsync the present
+        SIMULATION_PROFILE_ZONE("Graphics::EndFrame");
+        d2d1.renderTarget->EndDraw();
+    }
 
-    void Graphics::DrawEarth() const {
-        auto x = Earth::X - Earth::Radius;
-        auto y = Earth::Y - Earth::Radius;
-        auto size = 2 * Earth::Radius;
-        auto rect = D2D1::RectF(x, y, x + size, y + size);
-        d2d1.renderTarget->DrawBitmap(d2d1.bmpEarth, rect);
+    // Failures of the layer are kept out of hResult: the static part then goes straight onto the
+    // window, and the layer's target is made again the next frame
+    bool Graphics::BeginLayer(std::uint64_t key) {
+        if (layerValid && key == layerKey && DrawLayer()) {
+            return false;
+        }
+        layerValid = false;
+        if (d2d1.layerTarget == nullptr && FAILED(d2d1.renderTarget->CreateCompatibleRenderTarget(&d2d1.layerTarget))) {
+            d2d1.layerTarget = nullptr;
+            return true;
+        }
+        layerKey = key;
+        target = d2d1.layerTarget;
+        target->BeginDraw();
+        target->Clear(D2D1::ColorF(background.R, background.G, background.B, background.A));
+        return true;
     }
 
-    void Graphics::DrawTrajectory() const {
-        d2d1.brush->SetColor(D2D1::ColorF(SatelliteTrajectoryLineColor));
-        auto center = D2D1::Point2F(Earth::X, Earth::Y);
-        auto radius = Satellite::RadiusTrajectory;
-        auto ellipse = D2D1::Ellipse(center, radius, radius);
-        d2d1.renderTarget->DrawEllipse(ellipse, d2d1.brush, SatelliteTrajectoryLineWidth, d2d1.strokeStyleSatelliteTrajectoryLine);
+    bool Graphics::EndLayer() {
+        if (target != d2d1.layerTarget) {
+            return true;
+        }
+        target = d2d1.renderTarget;
+        // D2DERR_RECREATE_TARGET among others
+        if (FAILED(d2d1.layerTarget->EndDraw()) || !DrawLayer()) {
+            SafeRelease(&d2d1.layerTarget);
+            return false;
+        }
+        layerValid = true;
+        return true;
     }
 
-    void Graphics::DrawMagneticFieldsLines() const {
-        DrawMagneticFieldLinesCircular();
+    bool Graphics::DrawLayer() {
+        ID2D1Bitmap* bitmap = nullptr;
+        if (FAILED(d2d1.layerTarget->GetBitmap(&bitmap))) {
+            return false;
+        }
+        d2d1.renderTarget->DrawBitmap(bitmap);
+        SafeRelease(&bitmap);
+        return true;
     }
 
-    void Graphics::DrawSatellite() const {
-        auto x = Satellite::X - Satellite::Radius;
-        auto y = Satellite::Y - Satellite::Radius;
-        auto size = 2 * Satellite::Radius;
+    void Graphics::DrawBitmap(BitmapId id, float centerX, float centerY, float size, float rotationDegrees) {
+        auto bitmap = id == BitmapId::Earth ? d2d1.bmpEarth : d2d1.bmpSatellite;
+        auto x = centerX - size / 2;
+        auto y = centerY - size / 2;
         auto rect = D2D1::RectF(x, y, x + size, y + size);
-        auto center = D2D1::Point2F(Satellite::X, Satellite::Y);
-        auto rotation = D2D1::Matrix3x2F::Rotation(-Satellite::AngleDegrees, center);
-        d2d1.renderTarget->SetTransform(rotation);
-        d2d1.renderTarget->DrawBitmap(d2d1.bmpSatellite, rect);
-        d2d1.renderTarget->SetTransform(D2D1::Matrix3x2F::Identity());
+        if (rotationDegrees != 0) {
+            auto rotation = D2D1::Matrix3x2F::Rotation(rotationDegrees, D2D1::Point2F(centerX, centerY));
+            target->SetTransform(rotation);
+        }
+        target->DrawBitmap(bitmap, rect);
+        target->SetTransform(D2D1::Matrix3x2F::Identity());
     }
 
-    void Graphics::DrawAxes() const {
-        DrawRadialAxis();
-        DrawTangentAxis();
+    void Graphics::DrawEllipse(float centerX, float centerY, float radiusX, float radiusY, const Stroke& stroke) {
+        SetBrushColor(stroke.Color);
+        auto ellipse = D2D1::Ellipse(D2D1::Point2F(centerX, centerY), radiusX, radiusY);
+        target->DrawEllipse(ellipse, d2d1.brush, stroke.Width, GetStrokeStyle(stroke.Style));
     }
 
-    void Graphics::DrawMagneticFieldsDirections() const {
-        DrawMagneticFieldDirectionCircular();
+    void Graphics::DrawLine(float x1, float y1, float x2, float y2, const Stroke& stroke) {
+        SetBrushColor(stroke.Color);
+        auto p1 = D2D1::Point2F(x1, y1);
+        auto p2 = D2D1::Point2F(x2, y2);
+        target->DrawLine(p1, p2, d2d1.brush, stroke.Width, GetStrokeStyle(stroke.Style));
     }
 
-    void Graphics::DrawInfo() const {
-        float x = 20.0f, y = 10.0f;
-        d2d1.brush->SetColor(D2D1::ColorF(DefaultTextColor));
+    void Graphics::DrawPolylines(const FieldLineSet& lines, const Stroke& stroke) {
+        auto geometry = GetPolylineGeometry(lines);
+        if (geometry != nullptr) {
+            SetBrushColor(stroke.Color);
+            target->DrawGeometry(geometry, d2d1.brush, stroke.Width, GetStrokeStyle(stroke.Style));
+        }
+    }
+
+    void Graphics::DrawString(std::wstring_view text, std::size_t prefixLength, float x, float y, Color color) {
+        SetBrushColor(color);
+        if (prefixLength > 0) {
+            // The constant beginning from its kept layout, the rest straight after it
+            float width;
+            auto layout = GetPrefixLayout(text.substr(0, prefixLength), width);
+            if (layout != nullptr) {
+                target->DrawTextLayout(D2D1::Point2F(x, y), layout, d2d1.brush);
+                text.remove_prefix(prefixLength);
+                x += width;
+            }
+        }
+        if (!text.empty()) {
+            auto rect = D2D1::RectF(x, y, (float)Simulation::Width, (float)Simulation::Height);
+            target->DrawTextW(text.data(), (UINT32)text.length(), d2d1.textFormatDefault, rect, d2d1.brush);
+        }
+    }
 
-        DrawInfoAngle(x, y);
-        DrawInfoPeriod(x, y + 50.0f);
-        DrawInfoFrequency(x, y + 100.0f);
-        DrawInfoAngularSpeed(x, y + 150.0f);
+    void Graphics::MeasureString(std::wstring_view text, float& width, float& height) {
+        width = height = 0;
+        IDWriteTextLayout* layout = nullptr;
+        if (Success()) {
+            auto format = d2d1.textFormatDefault;
+            hResult = d2d1.dWriteFactory->CreateTextLayout(text.data(), (UINT32)text.length(), format, (float)Simulation::Width, (float)Simulation::Height, &layout);
+        }
+        if (Success()) {
+            DWRITE_TEXT_METRICS metrics;
+            hResult = layout->GetMetrics(&metrics);
+            if (Success()) {
+                width = metrics.widthIncludingTrailingWhitespace;
+                height = metrics.height;
+            }
+        }
+        SafeRelease(&layout);
     }
 
     ////////////////////////////////////////////////////////////////////////////////////////
@@ -281,6 +413,16 @@ namespace Simulation {
         SafeRelease(&stream);
     }
 
+    void Graphics::CreateBitmapFromAsset(const AssetImage& image, ID2D1Bitmap** pBmp) {
+        if (Success()) {
+            // Already what the bitmap holds, copied straight from the mapped cache
+            auto size = D2D1::SizeU(image.Width, image.Height);
+            auto format = D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED);
+            auto props = D2D1::BitmapProperties(format);
+            hResult = d2d1.renderTarget->CreateBitmap(size, image.Pixels, image.Width * 4, props, pBmp);
+        }
+    }
+
     const std::pair<void*, DWORD> Graphics::GetResourcePointerAndSize(int resId) {
         // Locate the resource
         HRSRC imageResHandle = FindResource(NULL, MAKEINTRESOURCE(resId), L"Image");
@@ -304,193 +446,106 @@ namespace Simulation {
         return std::pair(nullptr, 0);
     }
 
-    void Graphics::DrawMagneticFieldLinesCircular() const {
-        // Brush color = weak red
-        auto color = D2D1::ColorF(D2D1::ColorF::Red, 0.5f);
-        d2d1.brush->SetColor(color);
-
-        if (Satellite::AngleDegrees == 90.0l || Satellite::AngleDegrees == 270.0l) {
-            // Draw straight line
-            auto p1 = D2D1::Point2F(Earth::X, 0.0f);
-            auto p2 = D2D1::Point2F(Earth::X, (float)Height);
-            d2d1.renderTarget->DrawLine(p1, p2, d2d1.brush, FieldLinesWidth);
-        }
-        else {
-            auto r = abs(MagneticFields::Circular::Radius);
-            auto rE = r / 2.0l;
-            // Left
-            {
-                auto center = D2D1::Point2F(Earth::X - rE, Earth::Y);
-                auto ellipse = D2D1::Ellipse(center, rE, rE);
-                d2d1.renderTarget->DrawEllipse(ellipse, d2d1.brush, FieldLinesWidth);
-            }
-            // Right
-            {
-                auto center = D2D1::Point2F(Earth::X + rE, Earth::Y);
-                auto ellipse = D2D1::Ellipse(center, rE, rE);
-                d2d1.renderTarget->DrawEllipse(ellipse, d2d1.brush, FieldLinesWidth);
-            }
+    void Graphics::TakeSnapshot() {
+        // The newest tick the simulation published, if one came in since the last frame
+        if (SnapshotsInstance.Update()) {
+            Satellite::Mirror(SnapshotsInstance.Front());
         }
     }
-    
-    void Graphics::DrawRadialAxis() const {
-        // Brush color = white
-        auto color = D2D1::ColorF(D2D1::ColorF::White);
-        d2d1.brush->SetColor(color);
-
-        auto dx = Satellite::RadialDirectionX;
-        auto dy = Satellite::RadialDirectionY;
-
-        auto ax = dx * BaseArrowLength;
-        auto ay = dy * BaseArrowLength;
-
-        auto p1 = D2D1::Point2F(Satellite::X, Satellite::Y);
-        auto p2 = D2D1::Point2F(Satellite::X + ax, Satellite::Y - ay);
-        d2d1.renderTarget->DrawLine(p1, p2, d2d1.brush, BaseArrowWidth, d2d1.strokeStyleArrow);
-
-        auto size = BaseArrowLength * sqrt(pow(dx, 2.0l) + pow(dy, 2.0l));
-        auto len = BaseArrowLength * (size + 50.0l) / size;
-        auto p3 = D2D1::Point2F(Satellite::X + dx * len - textLayoutTangentAxisOffsetX / 2.0l, Satellite::Y - dy * len - textLayoutTangentAxisOffsetY / 2.0l);
-
-        d2d1.renderTarget->DrawTextLayout(p3, d2d1.textLayoutRadialAxis, d2d1.brush);
-    }
-
-    void Graphics::DrawTangentAxis() const {
-        // Brush color = white
-        auto color = D2D1::ColorF(D2D1::ColorF::White);
-        d2d1.brush->SetColor(color);
-
-        auto dx = Satellite::TangentDirectionX;
-        auto dy = Satellite::TangentDirectionY;
 
-        auto ax = dx * BaseArrowLength;
-        auto ay = dy * BaseArrowLength;
-
-        auto p1 = D2D1::Point2F(Satellite::X, Satellite::Y);
-        auto p2 = D2D1::Point2F(Satellite::X + ax, Satellite::Y - ay);
-        d2d1.renderTarget->DrawLine(p1, p2, d2d1.brush, BaseArrowWidth, d2d1.strokeStyleArrow);
-
-        auto size = BaseArrowLength * sqrt(pow(dx, 2.0l) + pow(dy, 2.0l));
-        auto len = BaseArrowLength * (size + 50.0l) / size;
-        auto p3 = D2D1::Point2F(Satellite::X + dx * len - textLayoutRadialAxisOffsetX / 2.0l, Satellite::Y - dy * len - textLayoutRadialAxisOffsetY / 2.0l);
-
-        d2d1.renderTarget->DrawTextLayout(p3, d2d1.textLayoutTangentAxis, d2d1.brush);
-    }
-
-    void Graphics::DrawMagneticFieldDirectionCircular() const {
-        // Brush color = strong red
-        auto color = D2D1::ColorF(D2D1::ColorF::Red);
-        d2d1.brush->SetColor(color);
-
-        auto dx = MagneticFields::Circular::DirectionX;
-        auto dy = MagneticFields::Circular::DirectionY;
-
-        auto ax = dx * BaseArrowLength;
-        auto ay = dy * BaseArrowLength;
-
-        auto p1 = D2D1::Point2F(Satellite::X, Satellite::Y);
-        auto p2 = D2D1::Point2F(Satellite::X + ax, Satellite::Y - ay);
-        d2d1.renderTarget->DrawLine(p1, p2, d2d1.brush, BaseArrowWidth, d2d1.strokeStyleArrow);
-
-        auto size = BaseArrowLength * sqrt(pow(dx, 2.0l) + pow(dy, 2.0l));
-        auto len = BaseArrowLength * (size + 50.0l) / size;
-        auto p3 = D2D1::Point2F(Satellite::X + dx * len - textLayoutCircularMagneticFieldOffsetX / 2.0l, Satellite::Y - dy * len - textLayoutCircularMagneticFieldOffsetY / 2.0l);
+    ID2D1PathGeometry* Graphics::GetPolylineGeometry(const FieldLineSet& lines) {
+        // The family of field lines keeps its generation for as long as the field stays put, so
+        // its geometry is only built again after a retrace
+        for (auto& polyline : polylines) {
+            if (polyline.Lines == &lines) {
+                if (polyline.Generation != lines.Generation) {
+                    SafeRelease(&polyline.Geometry);
+                    polyline.Geometry = CreatePolylineGeometry(lines);
+                    polyline.Generation = lines.Generation;
+                }
+                return polyline.Geometry;
+            }
+        }
 
-        d2d1.renderTarget->DrawTextLayout(p3, d2d1.textLayoutCircularMagneticField, d2d1.brush);
+        auto& polyline = polylines[nextPolyline];
+        nextPolyline = (nextPolyline + 1) % PolylineCacheSize;
+        SafeRelease(&polyline.Geometry);
+        polyline.Lines = &lines;
+        polyline.Generation = lines.Generation;
+        polyline.Geometry = CreatePolylineGeometry(lines);
+        return polyline.Geometry;
     }
 
-    void Graphics::CreateTextLayout(std::wstring text, IDWriteTextLayout** pLayout) {
-        auto cstr = text.c_str();
-        auto len = text.length();
-        auto format = d2d1.textFormatDefault;
-        auto width = (float)Width;
-        auto height = (float)Height;
-        hResult = d2d1.dWriteFactory->CreateTextLayout(cstr, len, format, width, height, pLayout);
-    }
+    ID2D1PathGeometry* Graphics::CreatePolylineGeometry(const FieldLineSet& lines) {
+        static_assert(sizeof(FieldLinePoint) == sizeof(D2D1_POINT_2F));
 
-    void Graphics::UpdateTextLayoutPeriod() {
+        ID2D1PathGeometry* geometry = nullptr;
+        ID2D1GeometrySink* sink = nullptr;
         if (Success()) {
-            auto text = L"T = " + std::to_wstring(Satellite::PeriodSeconds) + L"sec";
-            CreateTextLayout(text, &d2d1.textLayoutPeriod);
+            hResult = d2d1.factory->CreatePathGeometry(&geometry);
         }
-    }
-
-    void Graphics::UpdateTextLayoutFrequency() {
         if (Success()) {
-            auto freq = std::to_wstring(1.0l / Satellite::PeriodSeconds);
-            auto text = L"ƒ = " + freq + L"Hz";
-            CreateTextLayout(text, &d2d1.textLayoutFrequency);
+            hResult = geometry->Open(&sink);
         }
-    }
-
-    void Graphics::UpdateTextLayoutAngularSpeed() {
         if (Success()) {
-            auto vel1 = std::to_wstring(2.0l / Satellite::PeriodSeconds);
-            auto vel2 = std::to_wstring(360.0l / Satellite::PeriodSeconds);
-            auto text = L"ω = " + vel1 + L"π/sec (" + vel2 + L"°/sec)";
-            CreateTextLayout(text, &d2d1.textLayoutAngularSpeed);
+            for (std::size_t i = 0; i < lines.Lines(); i++) {
+                std::size_t count;
+                auto points = reinterpret_cast<const D2D1_POINT_2F*>(lines.Line(i, count));
+                if (count < 2) {
+                    continue;
+                }
+                sink->BeginFigure(points[0], D2D1_FIGURE_BEGIN_HOLLOW);
+                sink->AddLines(points + 1, (UINT32)(count - 1));
+                sink->EndFigure(D2D1_FIGURE_END_OPEN);
+            }
+            hResult = sink->Close();
         }
+        SafeRelease(&sink);
+        return geometry;
     }
 
-    void Graphics::CreateTextLayoutCircularMagneticField() {
-        if (Success()) {
-            CreateTextLayout(L"B", &d2d1.textLayoutCircularMagneticField);
-
-            DWRITE_TEXT_METRICS metrics;
-            hResult = d2d1.textLayoutCircularMagneticField->GetMetrics(&metrics);
-            if (Success()) {
-                textLayoutCircularMagneticFieldOffsetX = metrics.widthIncludingTrailingWhitespace;
-                textLayoutCircularMagneticFieldOffsetY = metrics.height;
+    IDWriteTextLayout* Graphics::GetPrefixLayout(std::wstring_view text, float& width) {
+        for (const auto& prefix : prefixes) {
+            if (prefix.Layout != nullptr && prefix.Text == text) {
+                width = prefix.Width;
+                return prefix.Layout;
             }
         }
-    }
 
-    void Graphics::CreateTextLayoutRadialAxis() {
+        // Only a new prefix allocates, a handful of times over the whole run
+        auto& prefix = prefixes[nextPrefix];
+        nextPrefix = (nextPrefix + 1) % PrefixCacheSize;
+        SafeRelease(&prefix.Layout);
         if (Success()) {
-            CreateTextLayout(L"R", &d2d1.textLayoutRadialAxis);
-
-            DWRITE_TEXT_METRICS metrics;
-            hResult = d2d1.textLayoutRadialAxis->GetMetrics(&metrics);
-            if (Success()) {
-                textLayoutRadialAxisOffsetX = metrics.widthIncludingTrailingWhitespace;
-                textLayoutRadialAxisOffsetY = metrics.height;
-            }
+            auto format = d2d1.textFormatDefault;
+            hResult = d2d1.dWriteFactory->CreateTextLayout(text.data(), (UINT32)text.length(), format, (float)Simulation::Width, (float)Simulation::Height, &prefix.Layout);
         }
-    }
-
-    void Graphics::CreateTextLayoutTangentAxis() {
         if (Success()) {
-            CreateTextLayout(L"T", &d2d1.textLayoutTangentAxis);
-
             DWRITE_TEXT_METRICS metrics;
-            hResult = d2d1.textLayoutTangentAxis->GetMetrics(&metrics);
-            if (Success()) {
-                textLayoutTangentAxisOffsetX = metrics.widthIncludingTrailingWhitespace;
-                textLayoutTangentAxisOffsetY = metrics.height;
-            }
+            hResult = prefix.Layout->GetMetrics(&metrics);
+            prefix.Width = metrics.widthIncludingTrailingWhitespace;
+            prefix.Text = text;
+        }
+        if (Failure()) {
+            SafeRelease(&prefix.Layout);
+        }
+        width = prefix.Width;
+        return prefix.Layout;
+    }
+
+    ID2D1StrokeStyle* Graphics::GetStrokeStyle(StrokeStyle style) const {
+        switch (style) {
+        case StrokeStyle::Dashed:
+            return d2d1.strokeStyleDashed;
+        case StrokeStyle::Arrow:
+            return d2d1.strokeStyleArrow;
+        default:
+            return nullptr;
         }
     }
 
-    ////////////////////////////////////////////////////////////////////////////////////////
-
-    void Graphics::DrawInfoAngle(float x, float y) const {
-        auto angR = std::to_wstring(Satellite::AngleRadians / PI);
-        auto angD = std::to_wstring(Satellite::AngleDegrees);
-        auto text = L"φ = " + angR + L"π (" + angD + L"°)";
-        auto rect = D2D1::RectF(x, y, (float)Width, (float)Height);
-        d2d1.renderTarget->DrawTextW(text.c_str(), text.length(), d2d1.textFormatDefault, rect, d2d1.brush);
-    }
-
-    void Graphics::DrawInfoPeriod(float x, float y) const {
-        d2d1.renderTarget->DrawTextLayout(D2D1::Point2F(x, y), d2d1.textLayoutPeriod, d2d1.brush);
-    }
-
-    void Graphics::DrawInfoFrequency(float x, float y) const {
-        d2d1.renderTarget->DrawTextLayout(D2D1::Point2F(x, y), d2d1.textLayoutFrequency, d2d1.brush);
-    }
-
-    void Graphics::DrawInfoAngularSpeed(float x, float y) const {
-        d2d1.renderTarget->DrawTextLayout(D2D1::Point2F(x, y), d2d1.textLayoutAngularSpeed, d2d1.brush);
+    void Graphics::SetBrushColor(Color color) const {
+        d2d1.brush->SetColor(D2D1::ColorF(color.R, color.G, color.B, color.A));
     }
 
     ////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,2501 @@
+#include "../include/simulation_state.h"
+#include "../include/simulation_clock.h"
+#include "../include/simd_kernel.h"
+#include "../include/kepler.h"
+#include "../include/conjunction.h"
+#include "../include/visibility.h"
+#include "../include/geomagnetic_field.h"
+#include "../include/scenario.h"
+#include "../include/sweep.h"
+#include "../include/field_map.h"
+#include "../include/field_lines.h"
+#include "../include/orbit_kernel.h"
+#include "../include/circular_field_table.h"
+#include "../include/triple_buffer.h"
+#include "../include/scene.h"
+#include "../include/software_renderer.h"
+#include "../include/hud.h"
+#include "../include/frame_scheduler.h"
+#include "../include/frame_exporter.h"
+#include "../include/frame_recorder.h"
+#include "../include/png.h"
+#include "../include/asset_cache.h"
+#include "../include/telemetry.h"
+#include "../include/replay.h"
+#include "../include/profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+// Headless entry point: runs the same physics as the Win32 front end, without a window
+// and without sleeping between ticks, as fast as the CPU allows.
+
+// Test hook: every heap allocation in the process goes through here and is counted, so --verify
+// can check that drawing a frame allocates nothing once the buffers have grown to size
+static std::atomic<std::uint64_t> HeapAllocations = 0;
+
+static void* CountedAllocate(std::size_t size, std::size_t alignment) {
+    HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    size = size == 0 ? 1 : size;
+    auto p = alignment <= alignof(std::max_align_t) ? std::malloc(size) : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(std::size_t size) {
+    return CountedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, (std::size_t)alignment);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+namespace Simulation::Headless {
+    enum class Mode {
+        Run,
+        Verify,
+        Drift,
+        Kepler,
+        FieldMap,
+        FieldLines,
+        Render,
+        Schedule,
+        Export,
+        Scan,
+        Replay,
+        Conjunctions,
+        Contacts,
+        Geomagnetic,
+        Scenario,
+        Sweep,
+        Assets
+    };
+
+    struct Options {
+        Headless::Mode Mode = Headless::Mode::Run;
+        std::uint64_t Steps = 10000000;
+        std::size_t Satellites = 0;
+        Scalar DtSeconds = Scalar(1) / Scalar(200);
+        Scalar PeriodSeconds = SimulationState::DefaultPeriodSeconds;
+        Scalar EarthRadius = Scalar(110.5);     // Half the width of res/Earth.png
+        Scalar SatelliteRadius = Scalar(200);   // Half the width of res/Satellite.png
+        Scalar Width = Scalar(1920), Height = Scalar(1080);
+        InstructionSet Isa = DetectInstructionSet();
+        unsigned Threads = 0;                   // One per hardware thread
+        bool FastForward = false;
+        std::uint64_t Frames = 120;
+        const char* Output = nullptr;           // Last rendered frame as a PPM
+        double Rate = 200.0;                    // Hz, --schedule
+        double WorkMicroseconds = 1000.0;       // Busy time per tick, --schedule
+        ExportFormat Format = ExportFormat::Y4m;  // --export
+        const char* Telemetry = nullptr;        // Every step recorded to this file
+        const char* Input = nullptr;            // --scan, --replay, --geomagnetic, --scenario, --sweep
+        double SeekSeconds = 0.0;               // --replay
+        double Speed = 1.0;                     // --replay
+        const char* Profile = nullptr;          // Chrome trace of the run, profiling builds only
+        Scalar Distance = Scalar(1);            // px, --conjunctions
+        std::size_t Stations = 200;             // --contacts
+        double DurationSeconds = 0.0;           // --contacts, 0 is five reference periods
+        double SampleSeconds = 0.0;             // --contacts, 0 is a hundredth of the reference period
+        int Degree = GaussCoefficients::MaxDegree;  // --geomagnetic
+        const char* Periods = "10:60:6";        // --sweep grid, seconds
+        const char* Radii = "1.5:6:10";         // --sweep grid, Earth radii
+        const char* Sprites = nullptr;          // Directory of Earth.png and Satellite.png, --render, --export, --assets
+    };
+
+    static void PrintUsage() {
+        std::puts("Usage: simulation_headless [--steps N] [--satellites N] [--dt SECONDS] [--period SECONDS]");
+        std::puts("                           [--earth-radius PX] [--width PX] [--height PX]");
+        std::puts("                           [--isa scalar|sse2|avx2|avx512] [--threads N] [--fast-forward]");
+        std::puts("                           [--verify] [--drift] [--kepler] [--field-map] [--field-lines]");
+        std::puts("                           [--render] [--frames N] [--output FILE.ppm] [--sprites DIR]");
+        std::puts("                           [--schedule] [--rate HZ] [--work US]");
+        std::puts("                           [--export png|y4m] [--frames N] [--output FILE.y4m|PREFIX] [--sprites DIR]");
+        std::puts("                           [--telemetry FILE] [--scan FILE]");
+        std::puts("                           [--replay FILE] [--seek SECONDS] [--speed X] [--frames N] [--output FILE.ppm]");
+        std::puts("                           [--profile FILE.json]");
+        std::puts("                           [--conjunctions PX] [--satellites N]");
+        std::puts("                           [--contacts STATIONS] [--satellites N] [--duration SECONDS] [--sample SECONDS]");
+        std::puts("                           [--geomagnetic FILE] [--degree N] [--satellites N]");
+        std::puts("                           [--scenario FILE.scn] [--satellites N]");
+        std::puts("                           [--sweep grid|FILE] [--periods FROM:TO:N] [--radii FROM:TO:N] [--duration SECONDS] [--dt SECONDS]");
+        std::puts("                           [--assets DIR]");
+    }
+
+    static bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            auto arg = argv[i];
+            if (std::strcmp(arg, "--help") == 0) {
+                return false;
+            }
+            if (std::strcmp(arg, "--verify") == 0) {
+                options.Mode = Mode::Verify;
+                continue;
+            }
+            if (std::strcmp(arg, "--drift") == 0) {
+                options.Mode = Mode::Drift;
+                continue;
+            }
+            if (std::strcmp(arg, "--kepler") == 0) {
+                options.Mode = Mode::Kepler;
+                continue;
+            }
+            if (std::strcmp(arg, "--field-map") == 0) {
+                options.Mode = Mode::FieldMap;
+                continue;
+            }
+            if (std::strcmp(arg, "--field-lines") == 0) {
+                options.Mode = Mode::FieldLines;
+                continue;
+            }
+            if (std::strcmp(arg, "--render") == 0) {
+                options.Mode = Mode::Render;
+                continue;
+            }
+            if (std::strcmp(arg, "--schedule") == 0) {
+                options.Mode = Mode::Schedule;
+                continue;
+            }
+            if (std::strcmp(arg, "--fast-forward") == 0) {
+                options.FastForward = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "Missing value for %s\n", arg);
+                return false;
+            }
+            auto value = argv[++i];
+            if (std::strcmp(arg, "--steps") == 0) {
+                options.Steps = std::strtoull(value, nullptr, 10);
+            }
+            else if (std::strcmp(arg, "--satellites") == 0) {
+                options.Satellites = std::strtoull(value, nullptr, 10);
+            }
+            else if (std::strcmp(arg, "--dt") == 0) {
+                options.DtSeconds = (Scalar)std::strtold(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--period") == 0) {
+                options.PeriodSeconds = (Scalar)std::strtold(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--earth-radius") == 0) {
+                options.EarthRadius = (Scalar)std::strtold(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--width") == 0) {
+                options.Width = (Scalar)std::strtold(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--height") == 0) {
+                options.Height = (Scalar)std::strtold(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--threads") == 0) {
+                options.Threads = (unsigned)std::strtoul(value, nullptr, 10);
+            }
+            else if (std::strcmp(arg, "--frames") == 0) {
+                options.Frames = std::strtoull(value, nullptr, 10);
+            }
+            else if (std::strcmp(arg, "--output") == 0) {
+                options.Output = value;
+            }
+            else if (std::strcmp(arg, "--rate") == 0) {
+                options.Rate = std::strtod(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--work") == 0) {
+                options.WorkMicroseconds = std::strtod(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--telemetry") == 0) {
+                options.Telemetry = value;
+            }
+            else if (std::strcmp(arg, "--scan") == 0) {
+                options.Mode = Mode::Scan;
+                options.Input = value;
+            }
+            else if (std::strcmp(arg, "--profile") == 0) {
+                options.Profile = value;
+            }
+            else if (std::strcmp(arg, "--replay") == 0) {
+                options.Mode = Mode::Replay;
+                options.Input = value;
+            }
+            else if (std::strcmp(arg, "--conjunctions") == 0) {
+                options.Mode = Mode::Conjunctions;
+                options.Distance = (Scalar)std::strtold(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--contacts") == 0) {
+                options.Mode = Mode::Contacts;
+                options.Stations = std::strtoull(value, nullptr, 10);
+            }
+            else if (std::strcmp(arg, "--duration") == 0) {
+                options.DurationSeconds = std::strtod(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--sample") == 0) {
+                options.SampleSeconds = std::strtod(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--geomagnetic") == 0) {
+                options.Mode = Mode::Geomagnetic;
+                options.Input = value;
+            }
+            else if (std::strcmp(arg, "--scenario") == 0) {
+                options.Mode = Mode::Scenario;
+                options.Input = value;
+            }
+            else if (std::strcmp(arg, "--sweep") == 0) {
+                options.Mode = Mode::Sweep;
+                options.Input = value;
+            }
+            else if (std::strcmp(arg, "--assets") == 0) {
+                options.Mode = Mode::Assets;
+                options.Sprites = value;
+            }
+            else if (std::strcmp(arg, "--sprites") == 0) {
+                options.Sprites = value;
+            }
+            else if (std::strcmp(arg, "--periods") == 0) {
+                options.Periods = value;
+            }
+            else if (std::strcmp(arg, "--radii") == 0) {
+                options.Radii = value;
+            }
+            else if (std::strcmp(arg, "--degree") == 0) {
+                options.Degree = std::atoi(value);
+            }
+            else if (std::strcmp(arg, "--seek") == 0) {
+                options.SeekSeconds = std::strtod(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--speed") == 0) {
+                options.Speed = std::strtod(value, nullptr);
+            }
+            else if (std::strcmp(arg, "--export") == 0) {
+                options.Mode = Mode::Export;
+                if (std::strcmp(value, "png") == 0) {
+                    options.Format = ExportFormat::Png;
+                }
+                else if (std::strcmp(value, "y4m") == 0) {
+                    options.Format = ExportFormat::Y4m;
+                }
+                else {
+                    std::fprintf(stderr, "Unknown export format %s\n", value);
+                    return false;
+                }
+            }
+            else if (std::strcmp(arg, "--isa") == 0) {
+                auto found = false;
+                for (auto set : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 }) {
+                    if (std::strcmp(value, ToString(set)) == 0) {
+                        options.Isa = set;
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    std::fprintf(stderr, "Unknown instruction set %s\n", value);
+                    return false;
+                }
+            }
+            else {
+                std::fprintf(stderr, "Unknown option %s\n", arg);
+                return false;
+            }
+        }
+        return options.DtSeconds > 0 && options.PeriodSeconds > 0 && options.Rate > 0;
+    }
+
+    // Spread the extra satellites between 1.5 and 6 Earth radii, with periods following Kepler's third law
+    static void AddSatellites(SimulationState& state, const Options& options) {
+        auto n = options.Satellites;
+        auto r0 = state.Satellite.RadiusTrajectory;
+        state.Satellites.Reserve(n);
+        for (std::size_t i = 0; i < n; i++) {
+            auto t = n > 1 ? (Scalar)i / (n - 1) : Scalar(0);
+            auto radius = state.Earth.Radius * (Scalar(1.5) + Scalar(4.5) * t);
+            auto period = options.PeriodSeconds * std::pow(radius / r0, Scalar(1.5));
+            auto angle = 2 * Pi<Scalar> * (Scalar)std::fmod(i * 0.618033988749895, 1.0);
+            state.Satellites.Add(radius, period, angle);
+        }
+        state.Satellites.Update(state.Earth);
+    }
+
+    static double ThreadCpuSeconds() {
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return now.tv_sec + now.tv_nsec * 1e-9;
+    }
+
+    static bool ReadFile(const std::string& path, std::vector<std::uint8_t>& bytes) {
+        auto file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        bytes.clear();
+        std::uint8_t buffer[65536];
+        for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file)) > 0;) {
+            bytes.insert(bytes.end(), buffer, buffer + n);
+        }
+        std::fclose(file);
+        return true;
+    }
+
+    // The window's sprites, in BitmapId order
+    static constexpr const char* SpriteFiles[] = { "Earth.png", "Satellite.png" };
+
+    // The sprites of a directory through the asset cache next to them. files keeps the encoded
+    // bytes the sources point into.
+    static bool LoadSprites(const char* directory, ThreadPool& pool, AssetCache& cache, std::vector<std::vector<std::uint8_t>>& files) {
+        std::string prefix = std::string(directory) + "/";
+        files.resize(std::size(SpriteFiles));
+        std::vector<AssetSource> sources;
+        for (std::size_t i = 0; i < std::size(SpriteFiles); i++) {
+            if (!ReadFile(prefix + SpriteFiles[i], files[i])) {
+                std::fprintf(stderr, "Could not read %s%s\n", prefix.c_str(), SpriteFiles[i]);
+                return false;
+            }
+            sources.push_back({ files[i].data(), files[i].size() });
+        }
+        if (!cache.Load(sources, prefix + "assets.bin", pool)) {
+            std::fprintf(stderr, "%s\n", cache.Error().c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // --sprites in place of the plain discs the software renderer draws without them
+    static bool SetSprites(const Options& options, ThreadPool& pool, SoftwareRenderer& renderer) {
+        if (options.Sprites == nullptr) {
+            return true;
+        }
+        AssetCache cache;
+        std::vector<std::vector<std::uint8_t>> files;
+        if (!LoadSprites(options.Sprites, pool, cache, files)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < cache.Size(); i++) {
+            const auto& image = cache.Image(i);
+            renderer.SetBitmap((BitmapId)i, image.Width, image.Height, AssetCache::Straight(image));
+        }
+        return true;
+    }
+
+    // Compare every supported vector kernel against the scalar long double path
+    template<class T>
+    static bool VerifyPrecision(double locationTolerance, double axesTolerance) {
+        auto ok = true;
+        for (auto set : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 }) {
+            if (!IsSupported(set)) {
+                std::printf("%-7s %-8s unsupported\n", PrecisionName<T>(), ToString(set));
+                continue;
+            }
+            auto accuracy = Simd::MeasureAccuracy<T>(set, 100000);
+            auto passed = accuracy.Location < locationTolerance && accuracy.Axes < axesTolerance;
+            std::printf("%-7s %-8s location %.3e  axes %.3e  %s\n", PrecisionName<T>(), ToString(set), accuracy.Location, accuracy.Axes, passed ? "ok" : "FAILED");
+            ok &= passed;
+        }
+        for (auto set : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 }) {
+            if (IsSupported(set)) {
+                // Relative to the 500 px orbit the accuracy sweep uses
+                auto error = Simd::MeasureKeplerAccuracy<T>(set, 20000);
+                auto passed = error < locationTolerance;
+                std::printf("%-7s %-8s kepler   %.3e  %s\n", PrecisionName<T>(), ToString(set), error, passed ? "ok" : "FAILED");
+                ok &= passed;
+            }
+        }
+        for (auto set : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 }) {
+            if (IsSupported(set)) {
+                // Relative to the local field strength
+                auto error = Simd::MeasureDipoleAccuracy<T>(set, 4000);
+                auto passed = error < axesTolerance;
+                std::printf("%-7s %-8s dipole   %.3e  %s\n", PrecisionName<T>(), ToString(set), error, passed ? "ok" : "FAILED");
+                ok &= passed;
+            }
+        }
+        for (auto set : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 }) {
+            if (IsSupported(set)) {
+                // Relative to the squared distance from the station
+                auto error = Simd::MeasureVisibilityAccuracy<T>(set, 4000);
+                auto passed = error < axesTolerance;
+                std::printf("%-7s %-8s visible  %.3e  %s\n", PrecisionName<T>(), ToString(set), error, passed ? "ok" : "FAILED");
+                ok &= passed;
+            }
+        }
+        for (auto set : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 }) {
+            if (IsSupported(set)) {
+                // Relative to the local field strength
+                auto error = Simd::MeasureHarmonicAccuracy<T>(set, 4000);
+                auto passed = error < axesTolerance;
+                std::printf("%-7s %-8s harmonic %.3e  %s\n", PrecisionName<T>(), ToString(set), error, passed ? "ok" : "FAILED");
+                ok &= passed;
+            }
+        }
+        return ok;
+    }
+
+    // The circular field lines are circles through the Earth, an approximation of the dipole's
+    // field lines, but the strength along the orbit is the dipole's: 1 on the equator, 2 over the poles
+    static bool VerifyCircularDipole() {
+        const long double earthX = 960, earthY = 540, radius = 442;
+        auto error = 0.0l;
+        for (int i = 0; i < 3600; i++) {
+            auto deg = i / 10.0l;
+            auto rad = deg * PI / 180.0l;
+            long double x, y, cx, cy, r, bx, by;
+            Kernel::Location(earthX, earthY, radius, rad, x, y);
+            Kernel::CircularField(earthX, radius, deg, rad, x, cx, cy, r);
+            // Half the radius at eight times the strength, so the orbit is well clear of the inside
+            Kernel::Dipole(x - earthX, earthY - y, 0.0l, -1.0l, radius / 2, 8.0l, bx, by);
+            error = std::max(error, std::abs(std::sqrt(cx * cx + cy * cy) - std::sqrt(bx * bx + by * by)));
+        }
+        auto passed = error < 1e-9l;
+        std::printf("circular vs dipole strength %.3e  %s\n", (double)error, passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // Dipole field lines keep r = L cos^2(latitude) in the magnetic frame: take L from where a traced
+    // line starts and see how far, in px, the rest of it strays from that curve
+    static bool VerifyFieldLines() {
+        DipoleField field;
+        field.CenterX = 960;
+        field.CenterY = 540;
+        field.Radius = 110.5f;
+        field.Tilt = 0.3f;
+        FieldLineSettings settings;
+        settings.Right = 1920;
+        settings.Bottom = 1080;
+
+        FieldLineTracer tracer;
+        const auto& lines = tracer.Trace(field, settings);
+        auto error = 0.0;
+        for (std::size_t i = 0; i < lines.Lines(); i++) {
+            // Asking again has to hand back the same lines without tracing them again
+            std::size_t count;
+            auto points = tracer.Trace(field, settings).Line(i, count);
+            auto polar = [&](const FieldLinePoint& p, double& r, double& c) {
+                auto x = (double)p.X - field.CenterX, y = (double)field.CenterY - p.Y;
+                r = std::sqrt(x * x + y * y);
+                // Distance from the magnetic axis over r is cos(latitude)
+                c = (x * std::cos((double)field.Tilt) + y * std::sin((double)field.Tilt)) / r;
+            };
+            double r, c;
+            polar(points[0], r, c);
+            auto shell = r / (c * c);
+            for (std::size_t k = 1; k < count; k++) {
+                polar(points[k], r, c);
+                error = std::max(error, std::abs(r - shell * c * c));
+            }
+        }
+        // The scene's B arrow, the circular field, along the line the scene traces through the
+        // satellite, all round the orbit
+        field.Tilt = 0;
+        SimulationState state;
+        state.InitializeEarth(Scalar(field.Radius), Scalar(field.CenterX), Scalar(field.CenterY));
+        state.InitializeSatellite(Scalar(200));
+        FieldLineSet through;
+        auto across = 0.0;
+        for (int i = 0; i < 16; i++) {
+            state.Step(state.Satellite.PeriodSeconds * Scalar(0.0637));
+            auto sx = (float)state.Satellite.X, sy = (float)state.Satellite.Y;
+            auto bx = (double)state.CircularField.DirectionX, by = (double)state.CircularField.DirectionY;
+            auto tilted = field;
+            tilted.Tilt = field.TiltAlong(sx, sy, (float)bx, (float)by);
+            tracer.TraceThrough(tilted, settings, sx, sy, through);
+            auto nearest = 1.0;
+            for (std::size_t k = 1; k < through.Points.size(); k++) {
+                const auto& a = through.Points[k - 1];
+                const auto& b = through.Points[k];
+                auto tx = (double)b.X - a.X, ty = (double)a.Y - b.Y;
+                auto length = std::sqrt(tx * tx + ty * ty);
+                auto mx = ((double)a.X + b.X) / 2 - sx, my = ((double)a.Y + b.Y) / 2 - sy;
+                if (length > 0 && mx * mx + my * my < 25) {
+                    nearest = std::min(nearest, std::abs(tx * by - ty * bx) / (length * std::sqrt(bx * bx + by * by)));
+                }
+            }
+            across = std::max(across, nearest);
+        }
+
+        auto passed = tracer.Generation() == 1 && error < 0.5 && across < 1e-2;
+        std::printf("field lines    %zu lines, %zu points, off the dipole curve by %.3e px, arrow off its line %.1e  %s\n", lines.Lines(), lines.Points.size(),
+                    error, across, passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // The table against the formula it replaces
+    template<class T>
+    static bool VerifyCircularFieldTable(double directionTolerance, double radiusTolerance) {
+        auto error = DefaultCircularFieldTable<T>().Measure(100000);
+        auto passed = error.Direction < directionTolerance && error.Radius < radiusTolerance;
+        std::printf("%-7s table    direction %.3e  radius %.3e  %s\n", PrecisionName<T>(), error.Direction, error.Radius, passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // A writer publishing as fast as it can against a reader polling as fast as it can: every value
+    // the reader sees has to be whole, newer than the one before, and the last one has to arrive
+    static bool VerifyTripleBuffer() {
+        struct Payload {
+            std::uint64_t Sequence;
+            std::uint64_t Check[15];
+        };
+        constexpr std::uint64_t Count = 2000000;
+
+        TripleBuffer<Payload> buffer;
+        std::atomic<bool> finished = false;
+        std::thread writer([&] {
+            for (std::uint64_t i = 1; i <= Count; i++) {
+                auto& payload = buffer.Back();
+                payload.Sequence = i;
+                for (auto& check : payload.Check) {
+                    check = i * 0x9E3779B97F4A7C15ull;
+                }
+                buffer.Publish();
+                // Lets the reader in every so often when both share a core
+                if (i % 1024 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            finished = true;
+        });
+
+        std::uint64_t last = 0, reads = 0, torn = 0, stale = 0;
+        while (true) {
+            auto done = finished.load();
+            if (buffer.Update()) {
+                const auto& payload = buffer.Front();
+                for (auto check : payload.Check) {
+                    torn += check != payload.Sequence * 0x9E3779B97F4A7C15ull;
+                }
+                stale += payload.Sequence <= last;
+                last = payload.Sequence;
+                reads++;
+            }
+            else if (done) {
+                break;
+            }
+        }
+        writer.join();
+
+        auto passed = torn == 0 && stale == 0 && last == Count;
+        std::printf("triple buffer  %llu published, %llu read, %llu torn, %llu stale  %s\n", (unsigned long long)Count,
+                    (unsigned long long)reads, (unsigned long long)torn, (unsigned long long)stale, passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // Tiles never share a pixel, so a frame has to come out the same to the bit on any number of
+    // threads, and the planet has to land where the state says it is
+    static bool VerifySoftwareRenderer() {
+        SimulationState state;
+        state.InitializeEarth(Scalar(110.5), Scalar(480), Scalar(270));
+        state.InitializeSatellite(Scalar(50));
+        state.Step(Scalar(1.25));
+        Snapshot snapshot;
+        snapshot.Capture(state, 1, 1.0);
+
+        ThreadPool single(1), pool(4);
+        SoftwareRenderer one(960, 540, single), many(960, 540, pool);
+        Scene scene;
+        scene.Draw(one, snapshot);
+        scene.Draw(many, snapshot);
+        auto bytes = (std::size_t)960 * 540 * 4;
+        auto same = std::memcmp(one.Pixels(), many.Pixels(), bytes) == 0;
+
+        // Halfway between the centre and the surface, away from every line
+        auto earth = one.Pixels() + ((std::size_t)270 * 960 + 480 - 55) * 4;
+        auto planet = earth[2] > 150 && earth[0] < 80;
+        auto corner = one.Pixels() + ((std::size_t)539 * 960 + 959) * 4;
+        auto black = corner[0] == 0 && corner[1] == 0 && corner[2] == 0;
+
+        auto passed = same && planet && black;
+        std::printf("software       %s across threads, planet %s, background %s  %s\n", same ? "identical" : "different",
+                    planet ? "ok" : "missing", black ? "ok" : "wrong", passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // Frames drawn over the kept static layer, only in the dirty tiles, against every frame drawn
+    // from scratch: they have to match to the bit, through a change of period and an Earth image
+    // arriving late, both of which invalidate the layer
+    static bool VerifyStaticLayer() {
+        SimulationState state;
+        state.InitializeEarth(Scalar(110.5), Scalar(480), Scalar(270));
+        state.InitializeSatellite(Scalar(50));
+        constexpr int Sprite = 32;
+        std::vector<std::uint8_t> earth((std::size_t)Sprite * Sprite * 4);
+        for (std::size_t i = 0; i < earth.size(); i++) {
+            earth[i] = (std::uint8_t)(i * 37 % 256 | (i % 4 == 3 ? 0x80 : 0));
+        }
+
+        SoftwareRenderer kept(960, 540);
+        Scene keptScene;
+        std::size_t frames = 0, mismatches = 0, dirty = 0, rebuilt = 0;
+        for (int frame = 0; frame < 60; frame++) {
+            if (frame == 30) {
+                state.SetPeriod(state.Satellite.PeriodSeconds + 5);
+            }
+            if (frame == 45) {
+                kept.SetBitmap(BitmapId::Earth, Sprite, Sprite, earth);
+            }
+            state.Step(Scalar(0.1));
+            Snapshot snapshot;
+            snapshot.Capture(state, frame, 1.0);
+            keptScene.Draw(kept, snapshot);
+
+            SoftwareRenderer fresh(960, 540);
+            if (frame >= 45) {
+                fresh.SetBitmap(BitmapId::Earth, Sprite, Sprite, earth);
+            }
+            Scene freshScene;
+            freshScene.Draw(fresh, snapshot);
+            mismatches += std::memcmp(kept.Pixels(), fresh.Pixels(), (std::size_t)960 * 540 * 4) != 0;
+            rebuilt += kept.DirtyTiles() == kept.Tiles();
+            dirty += kept.DirtyTiles();
+            frames++;
+        }
+
+        // The first frame and the ones after the period change and the new image draw everything
+        auto passed = mismatches == 0 && rebuilt == 3;
+        std::printf("static layer   %zu frames, %zu mismatched, %zu full redraws, %.1f of %zu tiles per frame  %s\n", frames, mismatches,
+                    rebuilt, (double)dirty / frames, kept.Tiles(), passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // Numbers into the fixed buffers have to read exactly as std::to_wstring writes them
+    static bool VerifyHudFormatting() {
+        const double values[] = { 0.0, 1.0 / 3.0, -2.5, 12.0, 0.0333333333, 123456.789, 1e-7, 359.9999999 };
+        auto mismatches = 0;
+        for (auto value : values) {
+            HudLine line(L"x = ");
+            line.Append(value).Append(L"sec");
+            mismatches += line.Text() != L"x = " + std::to_wstring(value) + L"sec";
+        }
+        auto passed = mismatches == 0;
+        std::printf("hud            %d of %zu numbers formatted differently  %s\n", mismatches, std::size(values), passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // Once a full turn has grown every buffer to size, drawing the next turn must not allocate
+    static bool VerifyFrameAllocations() {
+        SimulationState state;
+        state.InitializeEarth(Scalar(110.5), Scalar(960), Scalar(540));
+        state.InitializeSatellite(Scalar(200));
+
+        ThreadPool pool(4);
+        SoftwareRenderer renderer(1920, 1080, pool);
+        Scene scene;
+        Snapshot snapshot;
+        constexpr int FramesPerTurn = 240;
+        auto dt = state.Satellite.PeriodSeconds / FramesPerTurn;
+        std::uint64_t allocations = 0;
+        for (int turn = 0; turn < 2; turn++) {
+            auto before = HeapAllocations.load();
+            for (int frame = 0; frame < FramesPerTurn; frame++) {
+                state.Step(dt);
+                snapshot.Capture(state, frame, 1.0);
+                scene.Draw(renderer, snapshot);
+            }
+            allocations = HeapAllocations.load() - before;
+        }
+        auto passed = allocations == 0;
+        std::printf("allocations    %llu in %d steady frames  %s\n", (unsigned long long)allocations, FramesPerTurn, passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // The scheduler on made-up timestamps: late arrivals must not move later deadlines, a
+    // deadline missed by more than a period is skipped, and the statistics add up
+    // Real time in, whole steps out, the remainder carried over; and however the steps are taken,
+    // one at a time or all at once, the state lands on the same bits
+    static bool VerifyClock() {
+        using namespace std::chrono_literals;
+        SimulationClock clock(5ms);
+        auto first = clock.Advance(3ms);
+        auto second = clock.Advance(3ms);
+        auto carried = first == 0 && second == 1 && std::abs(clock.Alpha() - 0.2) < 1e-12;
+        auto third = clock.Advance(4ms);
+        carried &= third == 1 && clock.Alpha() == 0.0 && clock.Steps() == 2 && clock.Advance(-1ms) == 0;
+
+        clock.SetTimeWarp(0.1);
+        auto low = clock.TimeWarp();
+        clock.SetTimeWarp(1e9);
+        auto high = clock.TimeWarp();
+        clock.SetTimeWarp(10);
+        auto warped = clock.Advance(1ms) == 2 && clock.Alpha() == 0.0;
+        auto clamped = low == SimulationClock::MinTimeWarp && high == SimulationClock::MaxTimeWarp && warped;
+
+        constexpr std::uint64_t Steps = 1000;
+        SimulationState one, all;
+        for (auto state : { &one, &all }) {
+            state->InitializeEarth(Scalar(110.5), Scalar(960), Scalar(540));
+            state->InitializeSatellite(Scalar(200));
+            for (int i = 0; i < 8; i++) {
+                state->Satellites.Add(Scalar(200 + 40 * i), Scalar(10 + 7 * i), Scalar(0.7 * i));
+            }
+            state->Satellites.Update(state->Earth);
+        }
+        auto dt = Scalar(1) / Scalar(200);
+        for (std::uint64_t i = 0; i < Steps; i++) {
+            one.Step(dt);
+        }
+        all.StepN(Steps, dt);
+        auto identical = one.ElapsedNanoseconds == all.ElapsedNanoseconds && one.Satellite.AngleDegrees == all.Satellite.AngleDegrees &&
+                         one.Satellite.X == all.Satellite.X && one.Satellite.Y == all.Satellite.Y &&
+                         one.CircularField.DirectionX == all.CircularField.DirectionX && one.CircularField.DirectionY == all.CircularField.DirectionY &&
+                         one.Satellites.X == all.Satellites.X && one.Satellites.Y == all.Satellites.Y &&
+                         one.Satellites.FieldDirectionX == all.Satellites.FieldDirectionX && one.Satellites.FieldDirectionY == all.Satellites.FieldDirectionY;
+
+        // A new period keeps the satellite where it is and moves it on at the new rate from there
+        auto before = (double)one.Satellite.AngleDegrees;
+        one.SetPeriod(Scalar(45));
+        auto kept = std::abs((double)one.Satellite.AngleDegrees - before);
+        one.Step(Scalar(0.5));
+        auto moved = std::fmod((double)one.Satellite.AngleDegrees - before + 360.0, 360.0);
+        auto rebased = kept < 1e-9 && std::abs(moved - 360.0 * 0.5 / 45) < 1e-9;
+
+        auto passed = carried && clamped && identical && rebased;
+        std::printf("clock          remainder %s, warp %g..%g, %llu steps %s, period change moves %.3e deg  %s\n", carried ? "carried" : "LOST", low, high,
+                    (unsigned long long)Steps, identical ? "identical" : "DIFFER", kept, passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    static bool VerifyFrameScheduler() {
+        using namespace std::chrono_literals;
+        FrameScheduler schedule(200.0);
+        auto start = FrameScheduler::Clock::time_point(1s);
+        schedule.Start(start);
+
+        // Always 3 ms late, a thousand times over: a delay loop would have drifted by 3 s
+        std::uint64_t skipped = 0;
+        for (int i = 0; i < 1000; i++) {
+            skipped += schedule.Arrive(schedule.Deadline() + 3ms);
+        }
+        auto onGrid = schedule.Deadline() == start + 1001 * 5ms;
+
+        // 12 ms late: the next two deadlines have already passed as well
+        auto missed = schedule.Arrive(schedule.Deadline() + 12ms);
+        auto resumed = schedule.Deadline() == start + 1004 * 5ms;
+
+        const auto& stats = schedule.Stats();
+        auto counted = stats.Count() == 1001 && std::abs(stats.MaxMicroseconds() - 12000.0) < 1e-6 &&
+                       std::abs(stats.MeanMicroseconds() - (1000 * 3000.0 + 12000.0) / 1001) < 1e-6 && stats.PercentileMicroseconds(0.99) == 3100.0;
+        auto due = !schedule.Due(schedule.Deadline() - 1ns) && schedule.Due(schedule.Deadline());
+
+        auto passed = skipped == 0 && onGrid && missed == 2 && resumed && counted && due;
+        std::printf("scheduler      deadlines %s, %llu skipped, stats %s  %s\n", onGrid && resumed ? "on grid" : "DRIFTED",
+                    (unsigned long long)missed, counted ? "ok" : "wrong", passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // Small frames that differ in every pixel through several workers at once: the Y4M file has to
+    // hold each of them converted exactly once and in submission order, and every PNG chunk has to
+    // carry the right CRC. With one slot and nothing waiting, frames are dropped, never lost silently.
+    static bool VerifyFrameExport() {
+        constexpr int Width = 33, Height = 17, Frames = 24;
+        auto frameBytes = (std::size_t)Width * Height * 4;
+        std::vector<std::uint8_t> frames(frameBytes * Frames);
+        for (std::size_t i = 0; i < frames.size(); i++) {
+            frames[i] = (std::uint8_t)(i * 2654435761u >> 13);
+        }
+
+        FrameExportSettings settings;
+        settings.Format = ExportFormat::Y4m;
+        settings.Path = "verify_export.y4m";
+        settings.Width = Width;
+        settings.Height = Height;
+        settings.Backpressure = Backpressure::Wait;
+        settings.Slots = 3;
+        settings.Workers = 4;
+        FrameExportStats y4m;
+        {
+            FrameExporter exporter(settings);
+            for (int i = 0; i < Frames; i++) {
+                exporter.Submit(frames.data() + i * frameBytes);
+            }
+            exporter.Finish();
+            y4m = exporter.Stats();
+        }
+        std::vector<std::uint8_t> file;
+        if (auto f = std::fopen(settings.Path.c_str(), "rb")) {
+            std::uint8_t buffer[4096];
+            for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), f)) > 0;) {
+                file.insert(file.end(), buffer, buffer + n);
+            }
+            std::fclose(f);
+        }
+        std::remove(settings.Path.c_str());
+        std::string header = "YUV4MPEG2 W33 H17 F60:1 Ip A1:1 C420jpeg\n";
+        auto yuvBytes = (std::size_t)Width * Height + 2 * (std::size_t)((Width + 1) / 2) * ((Height + 1) / 2);
+        std::vector<std::uint8_t> expected(yuvBytes);
+        auto ordered = file.size() == header.size() + Frames * (6 + yuvBytes) && std::memcmp(file.data(), header.data(), header.size()) == 0;
+        for (int i = 0; ordered && i < Frames; i++) {
+            ConvertToYuv420(frames.data() + i * frameBytes, Width, Height, expected.data());
+            auto frame = file.data() + header.size() + i * (6 + yuvBytes);
+            ordered = std::memcmp(frame, "FRAME\n", 6) == 0 && std::memcmp(frame + 6, expected.data(), yuvBytes) == 0;
+        }
+        ordered &= y4m.Written == Frames && y4m.Dropped == 0 && !y4m.Failed;
+
+        // Signature, then length, type, data and CRC over type and data until IEND
+        std::vector<std::uint8_t> png;
+        Png::Encode(frames.data(), Width, Height, (std::size_t)Width * 4, true, png);
+        auto chunks = png.size() > 8 && png[1] == 'P';
+        std::size_t at = 8;
+        std::string last;
+        while (chunks && at + 12 <= png.size()) {
+            auto length = (std::size_t)png[at] << 24 | (std::size_t)png[at + 1] << 16 | (std::size_t)png[at + 2] << 8 | png[at + 3];
+            if (at + 12 + length > png.size()) {
+                chunks = false;
+                break;
+            }
+            auto crc = Png::Crc32(png.data() + at + 4, length + 4);
+            auto stored = (std::uint32_t)png[at + 8 + length] << 24 | (std::uint32_t)png[at + 9 + length] << 16 |
+                          (std::uint32_t)png[at + 10 + length] << 8 | png[at + 11 + length];
+            chunks = crc == stored;
+            last.assign((const char*)png.data() + at + 4, 4);
+            at += 12 + length;
+        }
+        chunks &= last == "IEND" && at == png.size();
+
+        settings.Backpressure = Backpressure::Drop;
+        settings.Slots = 1;
+        settings.Workers = 1;
+        FrameExportStats dropped;
+        {
+            FrameExporter exporter(settings);
+            for (int i = 0; i < Frames; i++) {
+                exporter.Submit(frames.data() + i * frameBytes);
+            }
+            exporter.Finish();
+            dropped = exporter.Stats();
+        }
+        std::remove(settings.Path.c_str());
+        auto accounted = dropped.Submitted == Frames && dropped.Written + dropped.Dropped == Frames;
+
+        auto passed = ordered && chunks && accounted;
+        std::printf("export         y4m %s, png chunks %s, %llu of %d dropped without waiting  %s\n", ordered ? "in order" : "WRONG",
+                    chunks ? "ok" : "corrupt", (unsigned long long)dropped.Dropped, Frames, passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // Recording must not slow down the thread that draws the window: all it does per frame is queue
+    // a snapshot, a small fraction of drawing the frame again. The recorder draws what it can take,
+    // drops the rest without losing count, and its first frame is the one drawn directly.
+    static bool VerifyFrameRecorder() {
+        constexpr int Width = 480, Height = 270, Frames = 60;
+        SimulationState state;
+        state.InitializeEarth(Scalar(55), Scalar(Width / 2), Scalar(Height / 2));
+        state.InitializeSatellite(Scalar(50));
+        std::vector<Snapshot> snapshots(Frames);
+        for (int i = 0; i < Frames; i++) {
+            state.Step(Scalar(1) / Scalar(60));
+            snapshots[i].Capture(state, i, 1.0);
+        }
+
+        // Sprites the plain discs can not be mistaken for: a recorder that never got them draws a
+        // different first frame
+        constexpr int Sprite = 64;
+        std::vector<std::uint8_t> sprite((std::size_t)Sprite * Sprite * 4);
+        for (std::size_t i = 0; i < sprite.size(); i += 4) {
+            auto x = (int)(i / 4 % Sprite), y = (int)(i / 4 / Sprite);
+            sprite[i] = (std::uint8_t)(x * 4);
+            sprite[i + 1] = (std::uint8_t)(y * 4);
+            sprite[i + 2] = (std::uint8_t)((x ^ y) * 4);
+            sprite[i + 3] = (std::uint8_t)(128 + x * 2);
+        }
+        std::vector<std::uint8_t> plain;
+        {
+            SoftwareRenderer discs(Width, Height);
+            Scene().Draw(discs, snapshots[0]);
+            plain.assign(discs.Pixels(), discs.Pixels() + (std::size_t)Width * Height * 4);
+        }
+
+        // What the window's thread used to do for every recorded frame
+        ThreadPool pool(2);
+        SoftwareRenderer direct(Width, Height, pool);
+        direct.SetBitmap(BitmapId::Earth, Sprite, Sprite, sprite);
+        direct.SetBitmap(BitmapId::Satellite, Sprite, Sprite, sprite);
+        Scene scene;
+        std::vector<std::uint8_t> first;
+        auto begin = Now();
+        for (int i = 0; i < Frames; i++) {
+            scene.Draw(direct, snapshots[i]);
+            if (i == 0) {
+                first.assign(direct.Pixels(), direct.Pixels() + (std::size_t)Width * Height * 4);
+            }
+        }
+        auto draw = std::chrono::duration<double>(Now() - begin).count() / Frames;
+
+        FrameExportSettings settings;
+        settings.Format = ExportFormat::Y4m;
+        settings.Path = "verify_recorder.y4m";
+        settings.Width = Width;
+        settings.Height = Height;
+        settings.Workers = 2;
+        FrameRecorderStats stats;
+        double submit = 0, stop = 0;
+        {
+            // At a frame every two draws, about what a window leaves the recorder between vsyncs.
+            // In this thread's own CPU time: on few cores the recorder may run inside a submit's
+            // wall time, but it is not the submit's work.
+            FrameRecorder recorder(settings, 2);
+            recorder.SetBitmap(BitmapId::Earth, Sprite, Sprite, sprite);
+            recorder.SetBitmap(BitmapId::Satellite, Sprite, Sprite, sprite);
+            for (int i = 0; i < Frames; i++) {
+                auto cpu = ThreadCpuSeconds();
+                recorder.Submit(snapshots[i], true);
+                submit += ThreadCpuSeconds() - cpu;
+                if (i + 1 < Frames) {
+                    std::this_thread::sleep_for(std::chrono::duration<double>(2 * draw));
+                }
+            }
+            // Stopped with the last snapshot still queued, the way the window stops a recording
+            auto cpu = ThreadCpuSeconds();
+            recorder.Stop();
+            stop = ThreadCpuSeconds() - cpu;
+            while (!recorder.Finished()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            stats = recorder.Stats();
+        }
+        submit /= Frames;
+
+        std::vector<std::uint8_t> file;
+        ReadFile(settings.Path, file);
+        std::remove(settings.Path.c_str());
+        auto yuvBytes = (std::size_t)Width * Height + 2 * (std::size_t)((Width + 1) / 2) * ((Height + 1) / 2);
+        std::vector<std::uint8_t> expected(yuvBytes);
+        ConvertToYuv420(first.data(), Width, Height, expected.data());
+        auto header = file.empty() ? std::string() : std::string((const char*)file.data(), std::find(file.begin(), file.end(), '\n') - file.begin() + 1);
+        auto written = file.size() == header.size() + stats.Drawn * (6 + yuvBytes) && first != plain &&
+                       std::memcmp(file.data() + header.size() + 6, expected.data(), yuvBytes) == 0;
+        auto counted = stats.Submitted == Frames && stats.Drawn + stats.Dropped == Frames && stats.Drawn >= Frames / 2 &&
+                       stats.Export.Written == stats.Drawn && stats.Export.Dropped == 0;
+        auto cheap = submit < draw / 20 && stop < draw / 20;
+
+        auto passed = written && counted && cheap;
+        std::printf("recorder       submit %.2f us, stop %.2f us against %.3f ms to draw, %llu drawn, %llu dropped  %s\n", submit * 1e6,
+                    stop * 1e6, draw * 1e3, (unsigned long long)stats.Drawn, (unsigned long long)stats.Dropped, passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // A run recorded in small blocks, the last one partial, read back through the mapping: every
+    // cell has to hold exactly what a state stepped one step at a time held after its step
+    static bool VerifyTelemetry() {
+        const char* path = "verify_telemetry.bin";
+        constexpr std::uint64_t Steps = 2500;
+        constexpr std::size_t BlockRows = 256;
+        constexpr std::int64_t Step = 5000000;
+        // Then one batch far over the limit, recorded every Stride-th step
+        constexpr std::uint64_t Stride = 4, Large = Stride * TelemetryRecorder::MaxRowsPerBatch;
+        SimulationState state;
+        state.InitializeEarth(Scalar(110.5), Scalar(960), Scalar(540));
+        state.InitializeSatellite(Scalar(200));
+        std::uint64_t stalls;
+        bool failed;
+        {
+            // In batches of one to five steps, the way the window's ticks take them
+            TelemetryRecorder recorder(path, TelemetryScene::From(state), BlockRows);
+            for (std::uint64_t done = 0, batch = 1; done < Steps; done += batch, batch = batch % 5 + 1) {
+                batch = std::min(batch, Steps - done);
+                state.StepNanoseconds((std::int64_t)batch * Step);
+                recorder.RecordSteps(state, batch, Step);
+            }
+            state.StepNanoseconds((std::int64_t)Large * Step);
+            recorder.RecordSteps(state, Large, Step);
+            recorder.Finish();
+            stalls = recorder.Stalls();
+            failed = recorder.Failed();
+        }
+
+        SimulationState replay;
+        replay.InitializeEarth(Scalar(110.5), Scalar(960), Scalar(540));
+        replay.InitializeSatellite(Scalar(200));
+        std::uint64_t mismatches = 0, read = 0;
+        {
+            TelemetryFile file;
+            auto opened = file.Open(path);
+            for (std::size_t block = 0; opened && block < file.Blocks(); block++) {
+                for (std::size_t row = 0; row < file.RowsIn(block); row++) {
+                    // One step at a time, to the same bits
+                    for (std::uint64_t k = 0; k < (read < Steps ? 1 : Stride); k++) {
+                        replay.StepNanoseconds(Step);
+                    }
+                    auto expected = TelemetrySample::From(replay);
+                    mismatches += file.Times(block)[row] != expected.ElapsedNanoseconds;
+                    for (std::size_t c = 1; c < TelemetryColumns; c++) {
+                        mismatches += file.Column((TelemetryColumn)c, block)[row] != expected.Values[c - 1];
+                    }
+                    read++;
+                }
+            }
+        }
+        std::remove(path);
+
+        auto rows = Steps + Large / Stride;
+        auto passed = !failed && read == rows && mismatches == 0;
+        std::printf("telemetry      %llu of %llu rows read back, %llu cells differ, %llu stalls  %s\n", (unsigned long long)read,
+                    (unsigned long long)rows, (unsigned long long)mismatches, (unsigned long long)stalls, passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // A recording with uneven ticks, the way the window's ticker steps: every seek has to land on
+    // the row a plain search of the time column finds, and play, pause and speed have to move the
+    // playhead by exactly the simulated time they promise
+    static bool VerifyReplay() {
+        const char* path = "verify_replay.bin";
+        constexpr std::uint64_t Ticks = 20000;
+        SimulationState state;
+        state.InitializeEarth(Scalar(110.5), Scalar(960), Scalar(540));
+        state.InitializeSatellite(Scalar(200));
+        std::vector<std::int64_t> times;
+        {
+            TelemetryRecorder recorder(path, TelemetryScene::From(state), 1000);
+            for (std::uint64_t i = 0; i < Ticks; i++) {
+                if (i == Ticks / 2) {
+                    state.SetPeriod(state.Satellite.PeriodSeconds + 5);
+                }
+                state.StepNanoseconds(5000000 * (std::int64_t)(1 + i * 2654435761u % 3));
+                recorder.Record(TelemetrySample::From(state));
+                times.push_back(state.ElapsedNanoseconds);
+            }
+        }
+
+        Simulation::Replay replay;
+        auto opened = replay.Open(path);
+        std::uint64_t wrong = 0;
+        for (std::uint64_t i = 0; opened && i < 5000; i++) {
+            // Exactly on a tick, just before one, and anywhere at all
+            auto t = i % 3 == 0 ? times[i * 7919 % Ticks] : i % 3 == 1 ? times[i * 7919 % Ticks] - 1 : (std::int64_t)(i * 2654435761u % (std::uint64_t)times.back());
+            auto expected = (std::uint64_t)std::max<std::ptrdiff_t>(0, std::upper_bound(times.begin(), times.end(), t) - times.begin() - 1);
+            wrong += replay.Find(t) != expected;
+        }
+
+        // The state at the last tick, read back as a snapshot
+        Snapshot snapshot;
+        replay.Seek(times.back());
+        replay.Capture(snapshot);
+        auto captured = snapshot.ElapsedNanoseconds == state.ElapsedNanoseconds && snapshot.Satellite.X == state.Satellite.X &&
+                        snapshot.Satellite.PeriodSeconds == state.Satellite.PeriodSeconds && snapshot.Earth.Radius == state.Earth.Radius;
+
+        using namespace std::chrono_literals;
+        replay.Seek(times.front());
+        replay.SetSpeed(2.0);
+        replay.Advance(1s);
+        auto played = replay.Position() == times.front() + 2000000000;
+        replay.SetPaused(true);
+        replay.Advance(1s);
+        played &= replay.Position() == times.front() + 2000000000;
+        replay.SetPaused(false);
+        replay.SetSpeed(Simulation::Replay::MaxSpeed);
+        replay.Advance(1s);
+        played &= replay.Position() == replay.EndNanoseconds();
+        std::remove(path);
+
+        auto passed = opened && wrong == 0 && captured && played;
+        std::printf("replay         %zu keyframes, %llu of 5000 seeks wrong, snapshot %s, playback %s  %s\n", replay.Keyframes(),
+                    (unsigned long long)wrong, captured ? "ok" : "wrong", played ? "ok" : "wrong", passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // Nested zones on two threads: each zone counted once per pass, outer zones ahead of inner
+    // ones, every thread under its own name, and all of it in the trace
+    static bool VerifyProfiler() {
+        if (!Profiler::Enabled) {
+            std::printf("profiler       compiled out  ok\n");
+            return true;
+        }
+        constexpr int Passes = 100;
+        Profiler::Clear();
+        auto work = [] {
+            for (int i = 0; i < Passes; i++) {
+                SIMULATION_PROFILE_ZONE("Verify::Outer");
+                SIMULATION_PROFILE_ZONE("Verify::Inner");
+            }
+        };
+        work();
+        std::thread other([&] {
+            Profiler::SetThreadName("Verify");
+            work();
+        });
+        other.join();
+
+        Profiler::ZoneSummary zones[16];
+        auto count = Profiler::Summarize(std::chrono::minutes(1), zones, std::size(zones));
+        std::size_t outer = 0, inner = 0, named = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            auto mine = std::strcmp(zones[i].Name, "Verify::Outer") == 0 || std::strcmp(zones[i].Name, "Verify::Inner") == 0;
+            outer += std::strcmp(zones[i].Name, "Verify::Outer") == 0 && zones[i].Count == Passes && (i + 1 < count && zones[i + 1].Depth > zones[i].Depth);
+            inner += std::strcmp(zones[i].Name, "Verify::Inner") == 0 && zones[i].Count == Passes;
+            named += mine && std::strcmp(zones[i].Thread, "Verify") == 0;
+        }
+
+        const char* path = "verify_profile.json";
+        auto written = Profiler::WriteChromeTrace(path);
+        std::size_t events = 0;
+        if (auto file = std::fopen(path, "r")) {
+            char line[512];
+            while (std::fgets(line, sizeof(line), file) != nullptr) {
+                events += std::strstr(line, "\"Verify::") != nullptr && std::strstr(line, "\"ph\":\"X\"") != nullptr;
+            }
+            std::fclose(file);
+        }
+        std::remove(path);
+
+        auto passed = outer == 2 && inner == 2 && named == 2 && written && events == 4 * Passes;
+        std::printf("profiler       %zu zones, %zu nested, %zu on the named thread, %zu trace events  %s\n", count, outer, named, events,
+                    passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // The grid against every pair, under the same rules: objects below the surface are left out and
+    // so are pairs of radial bands further apart than the distance. A distance far under the
+    // spread of the objects makes the grid grow its cells past MaxCells.
+    static bool VerifyConjunctions() {
+        constexpr std::size_t Count = 3000;
+        const Scalar surface = 100;
+        std::vector<Scalar> x(Count), y(Count), minRadius(Count), maxRadius(Count);
+        for (std::size_t i = 0; i < Count; i++) {
+            auto u = (Scalar)std::fmod(i * 0.618033988749895, 1.0);
+            auto v = (Scalar)std::fmod(i * 0.754877666246693, 1.0);
+            auto r = Scalar(60) + Scalar(400) * u;
+            x[i] = r * std::cos(2 * Pi<Scalar> * v);
+            y[i] = r * std::sin(2 * Pi<Scalar> * v);
+            minRadius[i] = r - Scalar(8) * v;
+            maxRadius[i] = r + Scalar(8) * u;
+            // Every tenth one right next to the one before, so there is plenty to find
+            if (i % 10 == 9) {
+                x[i] = x[i - 1] + Scalar(3) * (u - Scalar(0.5));
+                y[i] = y[i - 1] + Scalar(3) * (v - Scalar(0.5));
+            }
+        }
+
+        ThreadPool single(1), pool(4);
+        ConjunctionScreen one, many;
+        auto passed = true;
+        std::size_t pairs = 0, candidates = 0;
+        for (auto distance : { Scalar(6), Scalar(0.001) }) {
+            std::vector<Conjunction<Scalar>> expected;
+            for (std::size_t i = 0; i < Count; i++) {
+                for (auto j = i + 1; j < Count; j++) {
+                    if (maxRadius[i] < surface || maxRadius[j] < surface ||
+                        minRadius[i] > maxRadius[j] + distance || minRadius[j] > maxRadius[i] + distance) {
+                        continue;
+                    }
+                    auto dx = x[i] - x[j], dy = y[i] - y[j];
+                    if (dx * dx + dy * dy <= distance * distance) {
+                        expected.push_back({ (std::uint32_t)i, (std::uint32_t)j, std::sqrt(dx * dx + dy * dy) });
+                    }
+                }
+            }
+            const auto& a = one.Screen(x.data(), y.data(), minRadius.data(), maxRadius.data(), Count, surface, distance, single);
+            const auto& b = many.Screen(x.data(), y.data(), minRadius.data(), maxRadius.data(), Count, surface, distance, pool);
+            passed &= a.size() == expected.size() && b.size() == expected.size();
+            for (std::size_t k = 0; passed && k < expected.size(); k++) {
+                passed &= a[k].First == expected[k].First && a[k].Second == expected[k].Second && a[k].Distance == expected[k].Distance;
+                passed &= b[k].First == a[k].First && b[k].Second == a[k].Second && b[k].Distance == a[k].Distance;
+            }
+            pairs += expected.size();
+            candidates += one.Stats().Candidates;
+        }
+
+        std::printf("conjunctions   %zu pairs, %zu candidates of %zu possible, 1 and 4 threads  %s\n", pairs, candidates,
+                    Count * (Count - 1), passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // Eccentric orbits seen from stations all around, planned on a coarse grid and refined, against
+    // a scan of every pair a millisecond apart
+    static bool VerifyContacts() {
+        const Scalar earthRadius = Scalar(110.5);
+        KeplerCatalog catalog;
+        for (int i = 0; i < 24; i++) {
+            auto u = (Scalar)std::fmod(i * 0.618033988749895, 1.0);
+            auto a = earthRadius * (Scalar(1.6) + Scalar(3) * u);
+            catalog.Add(OrbitalElements<Scalar>::FromPeriod(a, Scalar(0.3) * u, 2 * Pi<Scalar> * u, Scalar(0.7) * i, 30 * std::pow(a / (4 * earthRadius), Scalar(1.5))));
+        }
+        GroundStations stations;
+        for (int s = 0; s < 6; s++) {
+            stations.Add(2 * Pi<Scalar> * s / 6 + Scalar(0.1), Scalar(0.05) * s);
+        }
+
+        ContactSettings settings;
+        settings.EndSeconds = 60;
+        settings.SampleSeconds = 0.25;
+        settings.ToleranceSeconds = 1e-6;
+        ThreadPool pool(4);
+        ContactPlanner planner;
+        const auto& planned = planner.Plan(stations, catalog, earthRadius, settings, pool);
+
+        constexpr auto Step = 1e-3;
+        std::vector<ContactWindow> scanned;
+        for (std::size_t s = 0; s < stations.Size(); s++) {
+            for (std::size_t i = 0; i < catalog.Size(); i++) {
+                auto open = -1.0;
+                for (auto k = 0; k * Step <= settings.EndSeconds; k++) {
+                    Scalar x, y;
+                    catalog.PositionAt(i, k * Step, x, y);
+                    auto visible = stations.Elevation(s, earthRadius, x, y) >= stations.MinElevation[s];
+                    if (visible && open < 0) {
+                        open = k * Step;
+                    }
+                    else if (!visible && open >= 0) {
+                        scanned.push_back({ (std::uint32_t)s, (std::uint32_t)i, open, k * Step });
+                        open = -1.0;
+                    }
+                }
+                if (open >= 0) {
+                    scanned.push_back({ (std::uint32_t)s, (std::uint32_t)i, open, settings.EndSeconds });
+                }
+            }
+        }
+
+        // Windows shorter than a sample may fall between samples, so only the others have to be found.
+        // Every planned one has to be in the scan, rise and set within the scan step.
+        auto matches = [&](const ContactWindow& a, const ContactWindow& b) {
+            return a.Station == b.Station && a.Satellite == b.Satellite && std::abs(a.Rise - b.Rise) <= Step && std::abs(a.Set - b.Set) <= Step;
+        };
+        std::size_t missed = 0, extra = 0;
+        for (const auto& w : scanned) {
+            if (w.Set - w.Rise > settings.SampleSeconds && std::none_of(planned.begin(), planned.end(), [&](const ContactWindow& p) { return matches(p, w); })) {
+                missed++;
+            }
+        }
+        for (const auto& p : planned) {
+            if (std::none_of(scanned.begin(), scanned.end(), [&](const ContactWindow& w) { return matches(p, w); })) {
+                extra++;
+            }
+        }
+
+        auto passed = !planned.empty() && missed == 0 && extra == 0;
+        std::printf("contacts       %zu windows, %zu scanned, %zu missed, %zu not in the scan, %.1f refine steps per crossing  %s\n", planned.size(),
+                    scanned.size(), missed, extra, planner.Stats().Crossings > 0 ? (double)planner.Stats().RefineSteps / planner.Stats().Crossings : 0.0,
+                    passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // An axial dipole model has to be the 2D dipole, so as strong as the circular field. A full model, read back
+    // from a file, has to be minus the gradient of its potential, built here from the standard
+    // library's associated Legendre functions instead of the recurrence.
+    static bool VerifyGeomagnetic() {
+        using Field = BasicSphericalHarmonicField<long double>;
+        const long double earthX = 960, earthY = 540, radius = 442, earthRadius = 110.5l;
+        EarthState<long double> earth = { earthRadius, earthX, earthY };
+        Field dipole(GaussCoefficients::AxialDipole(-29404.8));
+        auto dipoleError = 0.0l;
+        for (int i = 0; i < 3600; i++) {
+            auto deg = i / 10.0l;
+            auto rad = deg * PI / 180.0l;
+            long double x, y, cx, cy, r, dx, dy, bx, by;
+            Kernel::Location(earthX, earthY, radius, rad, x, y);
+            Kernel::CircularField(earthX, radius, deg, rad, x, cx, cy, r);
+            Kernel::Dipole(x - earthX, earthY - y, 0.0l, -1.0l, radius / 2, 8.0l, dx, dy);
+            dipole.Directions(earth, &x, &y, &bx, &by, 1);
+            dipoleError = std::max(dipoleError, std::hypot(bx - dx, by - dy));
+            dipoleError = std::max(dipoleError, std::abs(std::hypot(bx, by) - std::hypot(cx, cy)));
+        }
+
+        GaussCoefficients written;
+        written.Degree = GaussCoefficients::MaxDegree;
+        for (int n = 1; n <= written.Degree; n++) {
+            for (int m = 0; m <= n; m++) {
+                written.G[n][m] = std::round(3e4 * std::cos(1.7 * n + 2.3 * m) / (n * n * n)) / 10;
+                written.H[n][m] = m > 0 ? std::round(3e4 * std::sin(0.9 * n + 1.3 * m) / (n * n * n)) / 10 : 0;
+            }
+        }
+        const char* path = "verify_gauss.txt";
+        if (auto file = std::fopen(path, "w")) {
+            std::fputs("# Gauss coefficients\n", file);
+            for (int n = 1; n <= written.Degree; n++) {
+                for (int m = 0; m <= n; m++) {
+                    std::fprintf(file, "g %d %d %.1f\n", n, m, written.G[n][m]);
+                    if (m > 0) {
+                        std::fprintf(file, "h %d %d %.1f\n", n, m, written.H[n][m]);
+                    }
+                }
+            }
+            std::fclose(file);
+        }
+        GaussCoefficients read;
+        auto loaded = read.Load(path);
+        std::remove(path);
+        auto same = loaded && read.Degree == written.Degree;
+        for (int n = 1; same && n <= written.Degree; n++) {
+            for (int m = 0; m <= n; m++) {
+                same &= read.G[n][m] == written.G[n][m] && read.H[n][m] == written.H[n][m];
+            }
+        }
+
+        // Schmidt semi-normalized: the standard functions, without the Condon-Shortley phase, scaled
+        const auto longitude = 0.7l;
+        auto potential = [&](long double x, long double y) {
+            auto r = std::sqrt(x * x + y * y);
+            auto lon = x < 0 ? longitude + PI : longitude;
+            auto sum = 0.0l;
+            for (int n = 1; n <= read.Degree; n++) {
+                for (int m = 0; m <= n; m++) {
+                    auto factorials = 1.0l;
+                    for (int k = n - m + 1; k <= n + m; k++) {
+                        factorials *= k;
+                    }
+                    auto schmidt = m == 0 ? 1.0l : std::sqrt(2.0l / factorials);
+                    auto p = schmidt * std::assoc_legendre((unsigned)n, (unsigned)m, y / r);
+                    sum += std::pow(r, -(long double)(n + 1)) * (read.G[n][m] * std::cos(m * lon) + read.H[n][m] * std::sin(m * lon)) * p;
+                }
+            }
+            return sum;
+        };
+        Field field(read, GaussCoefficients::MaxDegree, (double)longitude);
+        auto gradientError = 0.0l;
+        for (int i = 0; i < 500; i++) {
+            auto r = 1.0l + 5.0l * i / 500;
+            auto a = 7.0l * 2.0l * PI * i / 500;
+            auto x = r * std::cos(a), y = r * std::sin(a);
+            const auto h = 1e-4l;
+            auto gx = -(potential(x + h, y) - potential(x - h, y)) / (2 * h);
+            auto gy = -(potential(x, y + h) - potential(x, y - h)) / (2 * h);
+            long double bx, by;
+            field.At(x, y, bx, by);
+            gradientError = std::max(gradientError, std::hypot(bx - gx, by - gy) / std::hypot(gx, gy));
+        }
+
+        auto passed = dipoleError < 1e-9l && same && gradientError < 1e-6l;
+        std::printf("geomagnetic    dipole %.3e, file %s, gradient %.3e  %s\n", (double)dipoleError, same ? "read back" : "DIFFERS",
+                    (double)gradientError, passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // n circular orbits and n Kepler ones, the i-th of each the same whatever n
+    static bool WriteScenario(const char* path, std::size_t n, const char* extra = nullptr) {
+        auto file = std::fopen(path, "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        std::fputs("# Generated\nperiod 25.5\ntrajectory 3.5   # Earth radii\n\n", file);
+        for (std::size_t i = 0; i < n; i++) {
+            auto u = std::fmod(i * 0.618033988749895, 1.0);
+            auto v = std::fmod(i * 0.754877666246693, 1.0);
+            // Every other line ends in CRLF
+            std::fprintf(file, "circular %.17g %.17g %.17g%s\n", 1.5 + 4.5 * u, 20 + 40 * v, 360 * v, i % 2 != 0 ? "\r" : "");
+            std::fprintf(file, "kepler\t%.17g %.17g %.17g %.17g %.17g\n", 1.5 + 4.5 * v, 0.3 * u, 360 * u, 720 * v - 360, 20 + 40 * u);
+        }
+        if (extra != nullptr) {
+            std::fputs(extra, file);
+        }
+        return std::fclose(file) == 0;
+    }
+
+    // A scenario parsed over several threads has to be what adding the same orbits one by one
+    // gives. Its compiled file has to be reused while the text stays the same, and rebuilt once it
+    // changes, and a bad line reported at its number.
+    static bool VerifyScenario() {
+        constexpr std::size_t Count = 4000;
+        const char* path = "verify_scenario.scn";
+        auto compiledPath = std::string(path) + Scenario::CompiledExtension;
+        ThreadPool pool(4);
+        SimulationState state;
+        state.InitializeEarth(Scalar(110.5), Scalar(960), Scalar(540));
+        state.InitializeSatellite(Scalar(200));
+
+        Scenario scenario;
+        auto opened = WriteScenario(path, Count) && scenario.Open(path, pool);
+        auto compiled = scenario.Compiled();
+        std::size_t differences = 0;
+        if (opened) {
+            scenario.Apply(state);
+            KeplerCatalog loaded, added;
+            scenario.Apply(state.Earth.Radius, loaded);
+            SimulationState expected;
+            expected.InitializeEarth(Scalar(110.5), Scalar(960), Scalar(540));
+            expected.InitializeSatellite(Scalar(200));
+            expected.SetPeriod(Scalar(25.5));
+            for (std::size_t i = 0; i < Count; i++) {
+                auto u = std::fmod(i * 0.618033988749895, 1.0);
+                auto v = std::fmod(i * 0.754877666246693, 1.0);
+                auto radians = Pi<double> / 180;
+                expected.Satellites.Add(Scalar(1.5 + 4.5 * u) * expected.Earth.Radius, Scalar(20 + 40 * v), Scalar(360 * v * radians));
+                added.Add(OrbitalElements<Scalar>::FromPeriod(Scalar(1.5 + 4.5 * v) * expected.Earth.Radius, Scalar(0.3 * u), Scalar(360 * u * radians),
+                                                              Scalar((720 * v - 360) * radians), Scalar(20 + 40 * u)));
+            }
+            expected.Satellites.Propagate(expected.ElapsedSeconds(), expected.Earth);
+            differences += state.Satellite.PeriodSeconds != expected.Satellite.PeriodSeconds;
+            differences += state.Satellite.RadiusTrajectory != Scalar(3.5) * state.Earth.Radius;
+            differences += state.Satellites.Size() != Count || loaded.Size() != Count;
+            std::vector<Scalar> x, y, ex, ey;
+            loaded.Propagate(12.5, x, y);
+            added.Propagate(12.5, ex, ey);
+            for (std::size_t i = 0; differences == 0 && i < Count; i++) {
+                differences += state.Satellites.X[i] != expected.Satellites.X[i] || state.Satellites.Y[i] != expected.Satellites.Y[i];
+                differences += std::abs(x[i] - ex[i]) > 1e-9 || std::abs(y[i] - ey[i]) > 1e-9;
+            }
+        }
+
+        // Opened again as it is, then changed
+        auto reused = opened && scenario.Open(path, pool) && !scenario.Compiled();
+        auto rebuilt = WriteScenario(path, Count, "kepler 2 0.1 0 0 30\n") && scenario.Open(path, pool) && scenario.Compiled() &&
+                       scenario.Kepler() == Count + 1;
+        auto direct = scenario.Open(compiledPath, pool) && scenario.Kepler() == Count + 1;
+        // Four lines of header, two per orbit, then the bad one
+        auto expectedError = std::string(path) + ":" + std::to_string(4 + 2 * Count + 1) + ":";
+        auto rejected = WriteScenario(path, Count, "kepler 2 1.5 0 0 30\n") && !scenario.Open(path, pool) &&
+                        scenario.Error().compare(0, expectedError.size(), expectedError) == 0;
+        scenario.Close();
+        std::remove(path);
+        std::remove(compiledPath.c_str());
+
+        auto passed = opened && compiled && differences == 0 && reused && rebuilt && direct && rejected;
+        std::printf("scenario       %zu orbits, %zu differ, %s, %s, %s  %s\n", 2 * Count, differences, reused ? "reused" : "NOT REUSED",
+                    rebuilt ? "rebuilt when changed" : "NOT REBUILT", rejected ? "bad line found" : "BAD LINE MISSED", passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // Every index of a loop with very uneven tasks has to run exactly once, however the threads
+    // steal from each other, and a sweep has to give the same rows on one thread and on many
+    static bool VerifySweep() {
+        constexpr std::size_t Count = 20000;
+        ThreadPool pool(8);
+        std::vector<std::atomic<int>> runs(Count);
+        std::atomic<std::uint64_t> sink = 0;
+        for (int pass = 0; pass < 20; pass++) {
+            pool.ParallelFor(Count, [&](std::size_t i) {
+                // The last tenth a hundred times slower, so the threads that drew it get robbed
+                std::uint64_t work = i >= Count * 9 / 10 ? 2000 : 20;
+                for (std::uint64_t k = 0; k < work; k++) {
+                    sink.fetch_add(k & 1, std::memory_order_relaxed);
+                }
+                runs[i].fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+        auto wrong = std::count_if(runs.begin(), runs.end(), [](const std::atomic<int>& r) { return r.load() != 20; });
+
+        auto cases = ParameterSweep::Grid({ 10, 30, 45 }, { 1.5, 4, 6 }, 30, 0.005);
+        cases.push_back({ 30, 4, 15, 0.005 });
+        cases.push_back({ 30, 4, 30, 0 });
+        ThreadPool single(1);
+        ParameterSweep one, many;
+        one.Run(cases, single);
+        many.Run(cases, pool);
+        std::size_t differences = 0;
+        for (std::size_t i = 0; i < cases.size(); i++) {
+            const auto& a = one.Results()[i];
+            const auto& b = many.Results()[i];
+            differences += a.Steps != b.Steps || a.MinField != b.MinField || a.MaxField != b.MaxField || a.Coverage != b.Coverage;
+        }
+        // A whole turn on the equator and over a pole at four radii, then half a turn
+        const auto& full = one.Results()[4];
+        const auto& half = one.Results()[cases.size() - 2];
+        auto physical = full.Coverage == 1.0 && std::abs(full.MinField * 64 - 1) < 1e-9 && std::abs(full.MaxField * 64 - 2) < 1e-9 &&
+                        std::abs(half.Coverage - 0.5) < 0.01 && one.Results().back().Steps == 0;
+
+        auto passed = wrong == 0 && differences == 0 && physical;
+        std::printf("sweep          %zu indices run other than once, %zu of %zu rows differ on 8 threads, coverage %.3f and %.3f  %s\n", (std::size_t)wrong,
+                    differences, cases.size(), full.Coverage, half.Coverage, passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // A PNG of one IDAT chunk, the rest of it around a zlib stream
+    static std::vector<std::uint8_t> WrapPng(int width, int height, int depth, int colour, const std::vector<std::uint8_t>& palette,
+                                             const std::vector<std::uint8_t>& transparency, const std::vector<std::uint8_t>& zlib) {
+        std::vector<std::uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        auto chunk = [&](const char* type, const std::vector<std::uint8_t>& data) {
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                png.push_back((std::uint8_t)(data.size() >> shift));
+            }
+            auto start = png.size();
+            png.insert(png.end(), type, type + 4);
+            png.insert(png.end(), data.begin(), data.end());
+            auto crc = Png::Crc32(png.data() + start, data.size() + 4);
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                png.push_back((std::uint8_t)(crc >> shift));
+            }
+        };
+        chunk("IHDR", { 0, 0, (std::uint8_t)(width >> 8), (std::uint8_t)width, 0, 0, (std::uint8_t)(height >> 8), (std::uint8_t)height,
+                        (std::uint8_t)depth, (std::uint8_t)colour, 0, 0, 0 });
+        if (!palette.empty()) {
+            chunk("PLTE", palette);
+        }
+        if (!transparency.empty()) {
+            chunk("tRNS", transparency);
+        }
+        chunk("IDAT", zlib);
+        chunk("IEND", {});
+        return png;
+    }
+
+    static bool VerifyAssets() {
+        // What the encoder writes comes back, with and without alpha
+        constexpr int Width = 37, Height = 23;
+        std::vector<std::uint8_t> rgba((std::size_t)Width * Height * 4);
+        for (int y = 0; y < Height; y++) {
+            for (int x = 0; x < Width; x++) {
+                auto p = rgba.data() + ((std::size_t)y * Width + x) * 4;
+                p[0] = (std::uint8_t)(x * 7);
+                p[1] = (std::uint8_t)(y * 11);
+                p[2] = (std::uint8_t)((x / 4 + y / 4) % 2 * 200);
+                p[3] = (std::uint8_t)(x < 5 ? 0 : x < 30 ? 255 : x * y);
+            }
+        }
+        std::vector<std::uint8_t> encoded[2], decoded;
+        std::size_t roundTrips = 0;
+        for (auto alpha : { false, true }) {
+            Png::Encode(rgba.data(), Width, Height, (std::size_t)Width * 4, alpha, encoded[alpha]);
+            int w = 0, h = 0;
+            auto same = Png::Decode(encoded[alpha].data(), encoded[alpha].size(), decoded, w, h) && w == Width && h == Height;
+            for (std::size_t i = 0; same && i < rgba.size(); i++) {
+                same = decoded[i] == (i % 4 == 3 && !alpha ? 255 : rgba[i]);
+            }
+            roundTrips += same;
+        }
+
+        // Gray and alpha through every filter, deflated with dynamic Huffman codes
+        static const std::vector<std::uint8_t> dynamic = {
+            0x78, 0x01, 0x05, 0xC1, 0x31, 0x48, 0x55, 0x71, 0x14, 0x07, 0xE0, 0xF3, 0xDE, 0xF3, 0xC7, 0xC1,
+            0x0E, 0x5D, 0x7E, 0x08, 0x97, 0x34, 0xFE, 0xC4, 0xA3, 0x3B, 0x88, 0x67, 0x10, 0x6F, 0x20, 0xDE,
+            0x30, 0xB8, 0x61, 0x70, 0xA9, 0xE0, 0x40, 0x88, 0x8B, 0x3C, 0x10, 0x79, 0xDB, 0xDB, 0xC4, 0x41,
+            0x70, 0x53, 0xB7, 0x50, 0x44, 0xDA, 0xDC, 0x24, 0x5C, 0x9C, 0x0C, 0x37, 0xE1, 0x41, 0xD1, 0x22,
+            0x6D, 0xFA, 0x68, 0x69, 0x8B, 0xB6, 0x9C, 0x44, 0x68, 0x70, 0xEB, 0xFB, 0x44, 0x84, 0xD2, 0x95,
+            0x39, 0x79, 0x2D, 0x1F, 0x64, 0x5D, 0x36, 0x64, 0x47, 0x8E, 0xE4, 0x44, 0xBE, 0xC8, 0x37, 0xB9,
+            0x96, 0xDF, 0x72, 0x27, 0x2D, 0x08, 0x95, 0x4A, 0xA5, 0x52, 0xA9, 0x54, 0x2A, 0x95, 0x4A, 0xA5,
+            0x52, 0xA9, 0xD4, 0x36, 0x04, 0x8A, 0x0C, 0x39, 0x12, 0x0A, 0x38, 0x4A, 0x54, 0xA8, 0xD1, 0x20,
+            0xB0, 0x82, 0x1E, 0xFA, 0x18, 0x74, 0x1E, 0x89, 0x65, 0x36, 0x61, 0xB9, 0x4D, 0x59, 0xB2, 0xAE,
+            0x15, 0x36, 0x6D, 0x6E, 0xB3, 0x56, 0xDA, 0xBC, 0x55, 0x36, 0xB4, 0xAF, 0x63, 0x10, 0x28, 0x32,
+            0xE4, 0x48, 0x48, 0x48, 0x48, 0x48, 0x48, 0x48, 0x48, 0x48, 0xE8, 0x21, 0x21, 0xC9, 0x94, 0xCC,
+            0x14, 0x2F, 0x9B, 0x77, 0x83, 0xD5, 0x83, 0xC1, 0xF9, 0xF6, 0xE8, 0xE3, 0xBF, 0xE3, 0xC9, 0xB3,
+            0xC5, 0xCB, 0xB5, 0x1F, 0xBB, 0xBF, 0x4E, 0xFF, 0x5E, 0x3D, 0xDC, 0x8E, 0x3F, 0x6E, 0x3D, 0x13,
+            0x3A, 0x9D, 0x4E, 0xA7, 0xD3, 0xE9, 0x74, 0x3A, 0x9D, 0x4E, 0xA7, 0xD3, 0xE9, 0x6D, 0x08, 0x14,
+            0x19, 0x72, 0x24, 0x14, 0x70, 0x94, 0xA8, 0x50, 0xA3, 0x41, 0x60, 0x05, 0x3D, 0xF4, 0x31, 0xE8,
+            0x3C, 0x11, 0xEB, 0x5A, 0x61, 0xD3, 0xE6, 0x36, 0x6B, 0xA5, 0xCD, 0x5B, 0x65, 0xAF, 0xAC, 0xB6,
+            0x37, 0xD6, 0xD8, 0xFB, 0xFD, 0xB0, 0x9B, 0x31, 0x08, 0x14, 0x19, 0x72, 0x24, 0x14, 0x70, 0x94,
+            0xA8, 0x50, 0xA3, 0x41, 0x8D, 0x1A, 0x35, 0xFA, 0xA8, 0xE5, 0x85, 0x2C, 0x35, 0xCB, 0x07, 0xFD,
+            0xD1, 0xE6, 0xE4, 0xDE, 0xDA, 0xA7, 0xD3, 0xCF, 0xB7, 0x17, 0x73, 0xDF, 0xB7, 0x46, 0xC3, 0x3F,
+            0xED, 0xFB, 0xB7, 0xED, 0xC3, 0x89, 0x9F, 0xCF, 0x9F, 0xB6, 0x16, 0x84, 0xC1, 0x60, 0x30, 0x18,
+            0x0C, 0x06, 0x83, 0xC1, 0x60, 0x30, 0x18, 0x0C, 0xC6, 0x7F, 0xEF, 0x01, 0x45, 0x6E
+        };
+        int w = 0, h = 0;
+        auto grayAlpha = WrapPng(16, 12, 8, 4, {}, {}, dynamic);
+        auto filters = Png::Decode(grayAlpha.data(), grayAlpha.size(), decoded, w, h) && w == 16 && h == 12;
+        for (int y = 0; filters && y < 12; y++) {
+            for (int x = 0; filters && x < 16; x++) {
+                auto p = decoded.data() + (y * 16 + x) * 4;
+                auto gray = (std::uint8_t)(x * 16 + y * 5);
+                filters = p[0] == gray && p[1] == gray && p[2] == gray && p[3] == (std::uint8_t)(x * y * 7);
+            }
+        }
+
+        // A 2 bit palette with transparency in a stored block
+        std::vector<std::uint8_t> rows = { 0, 0x1B, 0xE4, 0, 0x55, 0xAA };
+        std::vector<std::uint8_t> stored = { 0x78, 0x01, 0x01, (std::uint8_t)rows.size(), 0, (std::uint8_t)~rows.size(), 0xFF };
+        stored.insert(stored.end(), rows.begin(), rows.end());
+        auto adler = Png::Adler32(rows.data(), rows.size());
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            stored.push_back((std::uint8_t)(adler >> shift));
+        }
+        std::vector<std::uint8_t> palette = { 10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110, 120 };
+        auto indexed = WrapPng(8, 2, 2, 3, palette, { 0, 128 }, stored);
+        auto packed = Png::Decode(indexed.data(), indexed.size(), decoded, w, h) && w == 8 && h == 2;
+        const int indices[16] = { 0, 1, 2, 3, 3, 2, 1, 0, 1, 1, 1, 1, 2, 2, 2, 2 };
+        for (int i = 0; packed && i < 16; i++) {
+            auto p = decoded.data() + i * 4;
+            auto alpha = indices[i] == 0 ? 0 : indices[i] == 1 ? 128 : 255;
+            packed = std::memcmp(p, palette.data() + indices[i] * 3, 3) == 0 && p[3] == alpha;
+        }
+        // One flipped bit anywhere fails the chunk's CRC
+        indexed[45] ^= 4;
+        auto damaged = !Png::Decode(indexed.data(), indexed.size(), decoded, w, h);
+
+        // Decoded once, then mapped; a changed image is decoded again on its own, a broken cache as a whole
+        const std::string path = "verify_assets.bin";
+        std::remove(path.c_str());
+        std::vector<AssetSource> sources = { { encoded[1].data(), encoded[1].size() }, { encoded[0].data(), encoded[0].size() } };
+        ThreadPool pool(4);
+        AssetCache cache;
+        std::size_t decodes[4] = {};
+        bool mapped[4] = {};
+        auto load = [&](int pass) {
+            auto loaded = cache.Load(sources, path, pool);
+            decodes[pass] = cache.Decoded();
+            mapped[pass] = cache.Mapped();
+            return loaded;
+        };
+        auto cached = load(0) && load(1);
+        // Premultiplied with the encoded colour, exact again wherever it is opaque
+        auto straight = cache.Size() == 2 ? AssetCache::Straight(cache.Image(0)) : std::vector<std::uint8_t>();
+        auto premultiplied = straight.size() == rgba.size();
+        for (std::size_t i = 0; premultiplied && i < rgba.size(); i += 4) {
+            std::uint8_t again[4];
+            AssetCache::Premultiply(straight.data() + i, 1, again);
+            premultiplied = std::memcmp(again, cache.Image(0).Pixels + i, 4) == 0 && (rgba[i + 3] != 255 || std::memcmp(straight.data() + i, rgba.data() + i, 4) == 0);
+        }
+        std::vector<std::uint8_t> other;
+        Png::Encode(rgba.data() + 4, Width - 1, Height, (std::size_t)Width * 4, true, other);
+        sources[1] = { other.data(), other.size() };
+        cached &= load(2) && cache.Image(1).Width == Width - 1;
+        if (auto file = std::fopen(path.c_str(), "r+b")) {
+            std::fputs("BROKEN", file);
+            std::fclose(file);
+        }
+        cached &= load(3);
+        std::vector<std::uint8_t> notPng(100, 7);
+        sources[1] = { notPng.data(), notPng.size() };
+        auto rejected = !cache.Load(sources, path, pool) && !cache.Error().empty();
+        cache.Close();
+        std::remove(path.c_str());
+        cached &= decodes[0] == 2 && decodes[1] == 0 && decodes[2] == 1 && decodes[3] == 2 && mapped[0] && mapped[1] && mapped[2] && mapped[3];
+
+        auto passed = roundTrips == 2 && filters && packed && damaged && cached && premultiplied && rejected;
+        std::printf("assets         %zu of 2 round trips, filters %s, palette %s, decodes %zu %zu %zu %zu  %s\n", roundTrips, filters ? "ok" : "wrong",
+                    packed ? "ok" : "wrong", decodes[0], decodes[1], decodes[2], decodes[3], passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    static int Verify() {
+        auto ok = VerifyPrecision<double>(1e-9, 1e-9);
+        // float can not hold a 2000 px coordinate closer than 1.2e-4 px
+        ok &= VerifyPrecision<float>(1e-3, 1e-5);
+        ok &= VerifyCircularFieldTable<double>(1e-9, 1e-9);
+        // Next to a quarter turn the radius divides by a cosine float only knows to 1e-7
+        ok &= VerifyCircularFieldTable<float>(1e-5, 1e-3);
+        ok &= VerifyCircularFieldTable<long double>(1e-9, 1e-9);
+        ok &= VerifyCircularDipole();
+        ok &= VerifyFieldLines();
+        ok &= VerifyTripleBuffer();
+        ok &= VerifySoftwareRenderer();
+        ok &= VerifyStaticLayer();
+        ok &= VerifyHudFormatting();
+        ok &= VerifyFrameAllocations();
+        ok &= VerifyClock();
+        ok &= VerifyFrameScheduler();
+        ok &= VerifyFrameExport();
+        ok &= VerifyFrameRecorder();
+        ok &= VerifyTelemetry();
+        ok &= VerifyReplay();
+        ok &= VerifyProfiler();
+        ok &= VerifyConjunctions();
+        ok &= VerifyContacts();
+        ok &= VerifyGeomagnetic();
+        ok &= VerifyScenario();
+        ok &= VerifySweep();
+        ok &= VerifyAssets();
+        return ok ? 0 : 1;
+    }
+
+    template<class T>
+    static void PrintDrift(const std::uint64_t* checkpoints, std::size_t count, const Options& options) {
+        auto report = MeasureDrift<T>(checkpoints, count, options.DtSeconds);
+        std::printf("%s: %zu bytes per satellite, %zu satellites\n", report.Precision, report.BytesPerSatellite, report.Satellites);
+        for (std::size_t i = 0; i < report.SampleCount; i++) {
+            const auto& sample = report.Samples[i];
+            std::printf("  %12llu steps  position %.3e px  angle %.3e deg  field %.3e\n",
+                        (unsigned long long)sample.Steps, sample.Position, sample.Angle, sample.Field);
+        }
+    }
+
+    // How far float and double wander from long double, at every power of ten up to --steps
+    static int Drift(const Options& options) {
+        std::uint64_t checkpoints[8];
+        std::size_t count = 0;
+        for (std::uint64_t steps = 10; steps <= options.Steps && count < std::size(checkpoints); steps *= 10) {
+            checkpoints[count++] = steps;
+        }
+        PrintDrift<float>(checkpoints, count, options);
+        PrintDrift<double>(checkpoints, count, options);
+        return 0;
+    }
+
+    // Positions of a whole catalog of elliptical orbits at arbitrary times, without stepping
+    static int Kepler(const Options& options) {
+        Simd::SetActiveInstructionSet(options.Isa);
+
+        auto n = options.Satellites > 0 ? options.Satellites : 1000000;
+        KeplerCatalog catalog;
+        catalog.Reserve(n);
+        for (std::size_t i = 0; i < n; i++) {
+            auto u = (Scalar)std::fmod(i * 0.618033988749895, 1.0);
+            auto v = (Scalar)std::fmod(i * 0.754877666246693, 1.0);
+            auto a = options.EarthRadius * (Scalar(1.5) + Scalar(4.5) * u);
+            auto period = options.PeriodSeconds * std::pow(a / (4 * options.EarthRadius), Scalar(1.5));
+            catalog.Add(OrbitalElements<Scalar>::FromPeriod(a, Scalar(0.9) * v, 2 * Pi<Scalar> * v, 2 * Pi<Scalar> * u, period));
+        }
+
+        // A handful of far apart times, each one a full pass over the catalog
+        constexpr auto Passes = 20;
+        std::vector<Scalar> x, y;
+        auto begin = Now();
+        for (int pass = 0; pass < Passes; pass++) {
+            catalog.Propagate(pass * 86400.0 * 3.7, x, y);
+        }
+        auto seconds = std::chrono::duration<double>(Now() - begin).count();
+
+        std::printf("precision      %s\n", PrecisionName<Scalar>());
+        std::printf("satellites     %zu, %s kernel, %d iterations\n", n, ToString(Simd::ActiveInstructionSet()), KeplerCatalog::Iterations);
+        std::printf("wall           %.3f sec for %d passes\n", seconds, Passes);
+        std::printf("rate           %.0f positions/sec\n", seconds > 0.0 ? n * (double)Passes / seconds : 0.0);
+        std::printf("last           (%.6f, %.6f)\n", (double)x[n - 1], (double)y[n - 1]);
+        return 0;
+    }
+
+    // The dipole over the whole window, one cell per pixel, as often as it can be done in a second or --steps times
+    static int FieldMap(const Options& options) {
+        Simd::SetActiveInstructionSet(options.Isa);
+        ThreadPool pool(options.Threads);
+
+        DipoleField field;
+        field.CenterX = (float)options.Width / 2;
+        field.CenterY = (float)options.Height / 2;
+        field.Radius = (float)options.EarthRadius;
+
+        FieldMapDomain domain;
+        domain.Right = (float)options.Width;
+        domain.Bottom = (float)options.Height;
+        domain.Columns = (std::size_t)options.Width;
+        domain.Rows = (std::size_t)options.Height;
+
+        Simulation::FieldMap map;
+        std::uint64_t maps = 0;
+        auto begin = Now();
+        auto seconds = 0.0;
+        while (maps < options.Steps && (maps == 0 || seconds < 1.0)) {
+            map.Evaluate(field, domain, pool);
+            maps++;
+            seconds = std::chrono::duration<double>(Now() - begin).count();
+        }
+
+        // Between cell centres the bilinear sample should be close to the exact field
+        float x = field.CenterX + 3.3f * field.Radius, y = field.CenterY - 1.7f * field.Radius;
+        float bx, by, magnitude, ex, ey;
+        map.Sample(x, y, bx, by, magnitude);
+        field.At(x, y, ex, ey);
+
+        std::printf("cells          %zu x %zu in %zu tiles, %s kernel, %u threads\n", domain.Columns, domain.Rows, map.Tiles(), ToString(Simd::ActiveInstructionSet()), pool.Size());
+        std::printf("wall           %.3f sec for %llu maps\n", seconds, (unsigned long long)maps);
+        std::printf("rate           %.1f maps/sec, %.0f cells/sec\n", maps / seconds, maps * (double)map.Cells() / seconds);
+        std::printf("sample         (%.6f, %.6f) |B| %.6f, exact (%.6f, %.6f)\n", bx, by, magnitude, ex, ey);
+        return 0;
+    }
+
+    // A full retrace of the family against the cached lookup the renderer does on every other frame,
+    // and the per frame line through the satellite
+    static int FieldLines(const Options& options) {
+        ThreadPool pool(options.Threads);
+
+        DipoleField field;
+        field.CenterX = (float)options.Width / 2;
+        field.CenterY = (float)options.Height / 2;
+        field.Radius = (float)options.EarthRadius;
+
+        FieldLineSettings settings;
+        settings.Right = (float)options.Width;
+        settings.Bottom = (float)options.Height;
+        if (options.Satellites > 0) {
+            settings.Lines = options.Satellites;
+        }
+
+        FieldLineTracer tracer;
+        constexpr auto Passes = 200;
+        auto begin = Now();
+        for (int pass = 0; pass < Passes; pass++) {
+            // A different tilt each time, so nothing is cached
+            field.Tilt = pass * 1e-4f;
+            tracer.Trace(field, settings, pool);
+        }
+        auto traced = std::chrono::duration<double>(Now() - begin).count() / Passes;
+
+        begin = Now();
+        std::size_t points = 0;
+        for (int pass = 0; pass < Passes; pass++) {
+            points += tracer.Trace(field, settings, pool).Points.size();
+        }
+        auto cached = std::chrono::duration<double>(Now() - begin).count() / Passes;
+
+        FieldLineSet through;
+        begin = Now();
+        for (int pass = 0; pass < Passes; pass++) {
+            auto angle = 2 * PI * pass / Passes;
+            auto x = field.CenterX + 442 * std::cos(angle), y = field.CenterY - 442 * std::sin(angle);
+            tracer.TraceThrough(field, settings, (float)x, (float)y, through);
+        }
+        auto satellite = std::chrono::duration<double>(Now() - begin).count() / Passes;
+
+        const auto& lines = tracer.Trace(field, settings, pool);
+        std::printf("lines          %zu lines, %zu points, %u threads\n", lines.Lines(), lines.Points.size(), pool.Size());
+        std::printf("trace          %.3f ms\n", traced * 1e3);
+        std::printf("cached         %.3f us\n", cached * 1e6);
+        std::printf("satellite      %.3f us, %zu points\n", satellite * 1e6, through.Points.size());
+        std::printf("budget         %.1f%% of a 5 ms tick for a retrace\n", traced / 0.005 * 100.0);
+        return points > 0 ? 0 : 1;
+    }
+
+    // Frames of the window's scene drawn by the software renderer, one simulation step apart
+    static int Render(const Options& options) {
+        ThreadPool pool(options.Threads);
+
+        SimulationState state;
+        state.InitializeEarth(options.EarthRadius, options.Width / 2, options.Height / 2);
+        state.InitializeSatellite(options.SatelliteRadius);
+        state.Satellite.PeriodSeconds = options.PeriodSeconds;
+
+        SoftwareRenderer renderer((int)options.Width, (int)options.Height, pool);
+        if (!SetSprites(options, pool, renderer)) {
+            return 1;
+        }
+        Scene scene;
+        Snapshot snapshot;
+        std::size_t dirty = 0;
+        auto begin = Now();
+        for (std::uint64_t frame = 0; frame < options.Frames; frame++) {
+            state.Step(options.DtSeconds);
+            snapshot.Capture(state, frame, 1.0);
+            scene.Draw(renderer, snapshot);
+            dirty += renderer.DirtyTiles();
+        }
+        auto seconds = std::chrono::duration<double>(Now() - begin).count();
+
+        std::printf("frames         %llu at %d x %d, %zu tiles, %u threads\n", (unsigned long long)options.Frames,
+                    renderer.Width(), renderer.Height(), renderer.Tiles(), pool.Size());
+        std::printf("dirty          %.1f tiles per frame\n", options.Frames > 0 ? (double)dirty / options.Frames : 0.0);
+        std::printf("wall           %.3f sec\n", seconds);
+        std::printf("frame          %.3f ms, %.1f frames/sec\n", options.Frames > 0 ? seconds / options.Frames * 1e3 : 0.0,
+                    seconds > 0.0 ? options.Frames / seconds : 0.0);
+        if (options.Output != nullptr) {
+            if (!renderer.WritePPM(options.Output)) {
+                std::fprintf(stderr, "Could not write %s\n", options.Output);
+                return 1;
+            }
+            std::printf("output         %s\n", options.Output);
+        }
+        return 0;
+    }
+
+    static void Busy(std::chrono::nanoseconds work) {
+        auto end = FrameScheduler::Clock::now() + work;
+        while (FrameScheduler::Clock::now() < end) {
+        }
+    }
+
+    // The old ticker loop, work then a fixed delay, against the scheduler's absolute deadlines,
+    // both doing the same busy work per tick on the real clock
+    static int Schedule(const Options& options) {
+        auto work = std::chrono::nanoseconds((std::int64_t)(options.WorkMicroseconds * 1000.0));
+        FrameScheduler schedule(options.Rate);
+        auto ticks = options.Frames;
+        auto expected = std::chrono::duration<double>(schedule.Period() * (std::int64_t)ticks).count();
+
+        auto begin = FrameScheduler::Clock::now();
+        for (std::uint64_t i = 0; i < ticks; i++) {
+            Busy(work);
+            std::this_thread::sleep_for(schedule.Period());
+        }
+        auto delayed = std::chrono::duration<double>(FrameScheduler::Clock::now() - begin).count();
+
+        begin = FrameScheduler::Clock::now();
+        schedule.Start(begin);
+        for (std::uint64_t i = 0; i < ticks; i++) {
+            Busy(work);
+            schedule.Wait();
+        }
+        auto scheduled = std::chrono::duration<double>(FrameScheduler::Clock::now() - begin).count();
+
+        const auto& stats = schedule.Stats();
+        std::printf("ticks          %llu at %.1f Hz, %.0f us of work each\n", (unsigned long long)ticks, options.Rate, options.WorkMicroseconds);
+        std::printf("delay loop     %.3f sec for %.3f sec, drift %+.3f ms\n", delayed, expected, (delayed - expected) * 1e3);
+        std::printf("scheduler      %.3f sec for %.3f sec, drift %+.3f ms, %llu missed\n", scheduled, expected, (scheduled - expected) * 1e3,
+                    (unsigned long long)schedule.Missed());
+        std::printf("lateness       mean %.1f us, sd %.1f us, p99 %.0f us, max %.1f us, spin margin %.0f us\n", stats.MeanMicroseconds(),
+                    stats.DeviationMicroseconds(), stats.PercentileMicroseconds(0.99), stats.MaxMicroseconds(),
+                    std::chrono::duration<double, std::micro>(schedule.SpinMargin()).count());
+        return 0;
+    }
+
+    // Frames of the scene rendered offline, --dt of simulated time apart, through the exporter.
+    // It waits for the encoders rather than drop, so the output is complete and the wall time
+    // shows whether the whole pipeline keeps up with the video's own duration.
+    static int Export(const Options& options) {
+        if (options.Output == nullptr) {
+            std::fprintf(stderr, "--export needs --output\n");
+            return 1;
+        }
+        ThreadPool pool(options.Threads);
+
+        SimulationState state;
+        state.InitializeEarth(options.EarthRadius, options.Width / 2, options.Height / 2);
+        state.InitializeSatellite(options.SatelliteRadius);
+        state.Satellite.PeriodSeconds = options.PeriodSeconds;
+
+        SoftwareRenderer renderer((int)options.Width, (int)options.Height, pool);
+        if (!SetSprites(options, pool, renderer)) {
+            return 1;
+        }
+        Scene scene;
+        Snapshot snapshot;
+
+        FrameExportSettings settings;
+        settings.Format = options.Format;
+        settings.Path = options.Output;
+        settings.Width = renderer.Width();
+        settings.Height = renderer.Height();
+        settings.FramesPerSecond = 1.0 / (double)options.DtSeconds;
+        settings.Backpressure = Backpressure::Wait;
+        FrameExporter exporter(settings);
+        if (exporter.Failed()) {
+            std::fprintf(stderr, "Could not write %s\n", options.Output);
+            return 1;
+        }
+
+        auto begin = Now();
+        for (std::uint64_t frame = 0; frame < options.Frames; frame++) {
+            state.Step(options.DtSeconds);
+            snapshot.Capture(state, frame, 1.0);
+            scene.Draw(renderer, snapshot);
+            exporter.Submit(renderer.Pixels());
+        }
+        auto rendered = std::chrono::duration<double>(Now() - begin).count();
+        exporter.Finish();
+        auto seconds = std::chrono::duration<double>(Now() - begin).count();
+
+        auto stats = exporter.Stats();
+        auto duration = options.Frames * (double)options.DtSeconds;
+        std::printf("frames         %llu at %d x %d, %s, %.3f fps\n", (unsigned long long)options.Frames, settings.Width, settings.Height,
+                    options.Format == ExportFormat::Png ? "png" : "y4m", settings.FramesPerSecond);
+        std::printf("written        %llu frames, %.1f MB, %llu dropped\n", (unsigned long long)stats.Written, stats.Bytes / 1e6,
+                    (unsigned long long)stats.Dropped);
+        std::printf("wall           %.3f sec, %.3f sec of it rendering, for %.3f sec of video: %.2fx real time\n", seconds, rendered, duration,
+                    seconds > 0.0 ? duration / seconds : 0.0);
+        std::printf("encode         %.3f ms per frame\n", stats.Written > 0 ? stats.EncodeSeconds / stats.Written * 1e3 : 0.0);
+        std::printf("backpressure   %llu stalls, %.3f sec waiting for a slot, peak %zu queued of %zu\n", (unsigned long long)stats.Stalls,
+                    stats.StallSeconds, stats.PeakQueued, settings.Slots);
+        if (stats.Failed) {
+            std::fprintf(stderr, "Could not write %s\n", options.Output);
+            return 1;
+        }
+        return 0;
+    }
+
+    // Every column of a recorded file scanned in place, the way analysis tooling reads it
+    static int Scan(const Options& options) {
+        auto begin = Now();
+        TelemetryFile file;
+        if (!file.Open(options.Input)) {
+            std::fprintf(stderr, "Not a telemetry file: %s\n", options.Input);
+            return 1;
+        }
+        double minimum[TelemetryColumns], maximum[TelemetryColumns], sum[TelemetryColumns];
+        for (std::size_t c = 0; c < TelemetryColumns; c++) {
+            minimum[c] = std::numeric_limits<double>::infinity();
+            maximum[c] = -std::numeric_limits<double>::infinity();
+            sum[c] = 0;
+        }
+        for (std::size_t block = 0; block < file.Blocks(); block++) {
+            auto rows = file.RowsIn(block);
+            auto times = file.Times(block);
+            for (std::size_t row = 0; row < rows; row++) {
+                auto seconds = times[row] * 1e-9;
+                minimum[0] = std::min(minimum[0], seconds);
+                maximum[0] = std::max(maximum[0], seconds);
+                sum[0] += seconds;
+            }
+            for (std::size_t c = 1; c < TelemetryColumns; c++) {
+                auto values = file.Column((TelemetryColumn)c, block);
+                auto low = minimum[c], high = maximum[c], total = 0.0;
+                for (std::size_t row = 0; row < rows; row++) {
+                    low = std::min(low, values[row]);
+                    high = std::max(high, values[row]);
+                    total += values[row];
+                }
+                minimum[c] = low;
+                maximum[c] = high;
+                sum[c] += total;
+            }
+        }
+        auto seconds = std::chrono::duration<double>(Now() - begin).count();
+
+        auto rows = file.Rows();
+        auto bytes = (double)rows * TelemetryColumns * sizeof(double);
+        std::printf("rows           %llu in %zu blocks of %zu\n", (unsigned long long)rows, file.Blocks(), file.BlockRows());
+        for (std::size_t c = 0; c < TelemetryColumns; c++) {
+            std::printf("%-14s min %.9g  max %.9g  mean %.9g\n", ToString((TelemetryColumn)c), minimum[c], maximum[c],
+                        rows > 0 ? sum[c] / rows : 0.0);
+        }
+        std::printf("wall           %.3f sec, %.0f MB/sec\n", seconds, seconds > 0.0 ? bytes / seconds / 1e6 : 0.0);
+        return 0;
+    }
+
+    // A recording opened for replay: how long the index takes to build and a seek to answer, then
+    // --frames frames of playback from --seek at --speed, the last one drawn to --output
+    static int Replay(const Options& options) {
+        auto begin = Now();
+        Simulation::Replay replay;
+        if (!replay.Open(options.Input)) {
+            std::fprintf(stderr, "Not a telemetry file: %s\n", options.Input);
+            return 1;
+        }
+        auto opened = std::chrono::duration<double>(Now() - begin).count();
+
+        constexpr int Seeks = 1000000;
+        auto span = (std::uint64_t)(replay.EndNanoseconds() - replay.BeginNanoseconds()) + 1;
+        std::uint64_t sum = 0;
+        begin = Now();
+        for (int i = 0; i < Seeks; i++) {
+            sum += replay.Find(replay.BeginNanoseconds() + (std::int64_t)(i * 11400714819323198485ull % span));
+        }
+        auto seek = std::chrono::duration<double>(Now() - begin).count();
+
+        replay.Seek(replay.BeginNanoseconds() + (std::int64_t)(options.SeekSeconds * 1e9));
+        replay.SetSpeed(options.Speed);
+        Snapshot snapshot;
+        auto frame = std::chrono::nanoseconds((std::int64_t)(1e9 / 60.0));
+        for (std::uint64_t i = 0; i < options.Frames; i++) {
+            replay.Advance(frame);
+        }
+        replay.Capture(snapshot);
+
+        std::printf("rows           %llu, %.3f sec of simulated time\n", (unsigned long long)replay.Rows(),
+                    (replay.EndNanoseconds() - replay.BeginNanoseconds()) * 1e-9);
+        std::printf("index          %zu keyframes, built in %.3f ms\n", replay.Keyframes(), opened * 1e3);
+        std::printf("seek           %.1f ns on average over %d random times (%llu)\n", seek / Seeks * 1e9, Seeks, (unsigned long long)(sum & 1));
+        std::printf("playhead       %.3f sec after %llu frames at %gx, row %llu\n", replay.Position() * 1e-9, (unsigned long long)options.Frames,
+                    replay.Speed(), (unsigned long long)snapshot.Tick);
+        std::printf("angle          %.6f deg, period %.3f sec\n", (double)snapshot.Satellite.AngleDegrees, (double)snapshot.Satellite.PeriodSeconds);
+        std::printf("position       (%.17g, %.17g)\n", (double)snapshot.Satellite.X, (double)snapshot.Satellite.Y);
+        if (options.Output != nullptr) {
+            SoftwareRenderer renderer((int)(snapshot.Earth.X * 2), (int)(snapshot.Earth.Y * 2));
+            Scene scene;
+            scene.Draw(renderer, snapshot);
+            if (!renderer.WritePPM(options.Output)) {
+                std::fprintf(stderr, "Could not write %s\n", options.Output);
+                return 1;
+            }
+            std::printf("output         %s\n", options.Output);
+        }
+        return 0;
+    }
+
+    // Close approach screening of the constellation, at ten times more satellites each time up to
+    // --satellites, to show the time per object staying flat where testing every pair would not
+    static int Conjunctions(const Options& options) {
+        Simd::SetActiveInstructionSet(options.Isa);
+        ThreadPool pool(options.Threads);
+        auto largest = options.Satellites > 0 ? options.Satellites : 100000;
+
+        std::printf("precision      %s, %u threads, within %.3f px\n", PrecisionName<Scalar>(), pool.Size(), (double)options.Distance);
+        for (auto n = std::min<std::size_t>(1000, largest); ; n = std::min(n * 10, largest)) {
+            SimulationState state;
+            state.InitializeEarth(options.EarthRadius, options.Width / 2, options.Height / 2);
+            state.InitializeSatellite(options.SatelliteRadius);
+            state.Satellite.PeriodSeconds = options.PeriodSeconds;
+            auto sized = options;
+            sized.Satellites = n;
+            AddSatellites(state, sized);
+
+            // Far apart instants, so every screen sees a different sky
+            constexpr auto Passes = 20;
+            ConjunctionScreen screen;
+            std::size_t candidates = 0, conjunctions = 0;
+            auto seconds = 0.0;
+            for (int pass = 0; pass < Passes; pass++) {
+                state.Satellites.Propagate(pass * 97.3, state.Earth);
+                auto begin = Now();
+                screen.Screen(state.Satellites, state.Earth, options.Distance, pool);
+                seconds += std::chrono::duration<double>(Now() - begin).count();
+                candidates += screen.Stats().Candidates;
+                conjunctions += screen.Stats().Conjunctions;
+            }
+
+            std::printf("%9zu      %8.3f ms/screen  %6.1f ns/object  %10zu candidates  %8zu conjunctions  %zu cells\n", n, seconds / Passes * 1e3,
+                        seconds / Passes / n * 1e9, candidates / Passes, conjunctions / Passes, screen.Stats().Cells);
+            if (n >= largest) {
+                break;
+            }
+        }
+        return 0;
+    }
+
+    // Contact windows of --contacts stations spread around the Earth with a Kepler catalog of
+    // --satellites, over --duration seconds sampled every --sample seconds
+    static int Contacts(const Options& options) {
+        Simd::SetActiveInstructionSet(options.Isa);
+        ThreadPool pool(options.Threads);
+
+        auto n = options.Satellites > 0 ? options.Satellites : 2000;
+        KeplerCatalog catalog;
+        catalog.Reserve(n);
+        for (std::size_t i = 0; i < n; i++) {
+            auto u = (Scalar)std::fmod(i * 0.618033988749895, 1.0);
+            auto v = (Scalar)std::fmod(i * 0.754877666246693, 1.0);
+            auto a = options.EarthRadius * (Scalar(1.5) + Scalar(4.5) * u);
+            auto period = options.PeriodSeconds * std::pow(a / (4 * options.EarthRadius), Scalar(1.5));
+            catalog.Add(OrbitalElements<Scalar>::FromPeriod(a, Scalar(0.3) * v, 2 * Pi<Scalar> * v, 2 * Pi<Scalar> * u, period));
+        }
+        GroundStations stations;
+        stations.Reserve(options.Stations);
+        for (std::size_t s = 0; s < options.Stations; s++) {
+            // Masks from 0 to 15 degrees
+            stations.Add(2 * Pi<Scalar> * (Scalar)std::fmod(s * 0.618033988749895, 1.0), Scalar(0.26) * (Scalar)(s % 8) / 7);
+        }
+
+        ContactSettings settings;
+        settings.EndSeconds = options.DurationSeconds > 0 ? options.DurationSeconds : 5 * (double)options.PeriodSeconds;
+        settings.SampleSeconds = options.SampleSeconds > 0 ? options.SampleSeconds : (double)options.PeriodSeconds / 100;
+
+        ContactPlanner planner;
+        auto begin = Now();
+        const auto& windows = planner.Plan(stations, catalog, options.EarthRadius, settings, pool);
+        auto seconds = std::chrono::duration<double>(Now() - begin).count();
+        const auto& stats = planner.Stats();
+
+        auto longest = 0.0, total = 0.0;
+        for (const auto& w : windows) {
+            longest = std::max(longest, w.Set - w.Rise);
+            total += w.Set - w.Rise;
+        }
+        std::printf("precision      %s, %s kernel, %u threads\n", PrecisionName<Scalar>(), ToString(Simd::ActiveInstructionSet()), pool.Size());
+        std::printf("pairs          %zu stations x %zu satellites over %.1f sec, sampled every %.3f sec\n", stations.Size(), n, settings.EndSeconds,
+                    settings.SampleSeconds);
+        std::printf("wall           %.3f sec\n", seconds);
+        std::printf("margins        %zu, %.0f per sec\n", stats.Evaluations, seconds > 0.0 ? stats.Evaluations / seconds : 0.0);
+        std::printf("crossings      %zu refined in %zu steps\n", stats.Crossings, stats.RefineSteps);
+        std::printf("windows        %zu, mean %.3f sec, longest %.3f sec\n", windows.size(), windows.empty() ? 0.0 : total / windows.size(), longest);
+        return 0;
+    }
+
+    // The constellation's per tick field update with the Gauss coefficients of --geomagnetic to
+    // --degree, against the circular field table alone
+    static int Geomagnetic(const Options& options) {
+        Simd::SetActiveInstructionSet(options.Isa);
+        GaussCoefficients coefficients;
+        if (!coefficients.Load(options.Input)) {
+            std::fprintf(stderr, "Could not read %s\n", options.Input);
+            return 1;
+        }
+        SphericalHarmonicField model(coefficients, options.Degree);
+
+        SimulationState state;
+        state.InitializeEarth(options.EarthRadius, options.Width / 2, options.Height / 2);
+        state.InitializeSatellite(options.SatelliteRadius);
+        state.Satellite.PeriodSeconds = options.PeriodSeconds;
+        auto sized = options;
+        sized.Satellites = options.Satellites > 0 ? options.Satellites : 100000;
+        AddSatellites(state, sized);
+
+        constexpr auto Ticks = 50;
+        auto measure = [&](const SphericalHarmonicField* field) {
+            state.SetFieldModel(field);
+            auto begin = Now();
+            for (int tick = 0; tick < Ticks; tick++) {
+                state.StepNanoseconds(5000000);
+            }
+            return std::chrono::duration<double>(Now() - begin).count() / Ticks;
+        };
+        auto table = measure(nullptr);
+        auto harmonic = measure(&model);
+        auto n = (double)state.Satellites.Size();
+
+        Scalar equatorX, equatorY, poleX, poleY;
+        model.At(1, 0, equatorX, equatorY);
+        model.At(0, 1, poleX, poleY);
+        std::printf("precision      %s, %s kernel\n", PrecisionName<Scalar>(), ToString(Simd::ActiveInstructionSet()));
+        std::printf("model          %s, degree %d of %d\n", options.Input, model.Degree(), coefficients.Degree);
+        std::printf("surface        equator (%.1f, %.1f) nT, pole (%.1f, %.1f) nT\n", (double)equatorX, (double)equatorY, (double)poleX, (double)poleY);
+        std::printf("table          %8.3f ms/tick  %6.1f ns/satellite\n", table * 1e3, table / n * 1e9);
+        std::printf("harmonic       %8.3f ms/tick  %6.1f ns/satellite\n", harmonic * 1e3, harmonic / n * 1e9);
+        std::printf("satellite      field (%.4f, %.4f) at (%.1f, %.1f)\n", (double)state.CircularField.DirectionX, (double)state.CircularField.DirectionY,
+                    (double)state.Satellite.X, (double)state.Satellite.Y);
+        state.SetFieldModel(nullptr);
+        return 0;
+    }
+
+    // Startup from --scenario: the text parsed and compiled, then the compiled file opened and
+    // applied as the front end would. With --satellites the file is written first, that many of each kind.
+    static int RunScenario(const Options& options) {
+        ThreadPool pool(options.Threads);
+        std::string path = options.Input;
+        if (options.Satellites > 0 && !WriteScenario(path.c_str(), options.Satellites)) {
+            std::fprintf(stderr, "Could not write %s\n", path.c_str());
+            return 1;
+        }
+        auto compiledPath = path + Scenario::CompiledExtension;
+        std::string error;
+        auto begin = Now();
+        if (!Scenario::Compile(path, compiledPath, error, pool)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        auto compile = std::chrono::duration<double>(Now() - begin).count();
+
+        Scenario scenario;
+        begin = Now();
+        if (!scenario.Open(path, pool)) {
+            std::fprintf(stderr, "%s\n", scenario.Error().c_str());
+            return 1;
+        }
+        auto open = std::chrono::duration<double>(Now() - begin).count();
+
+        SimulationState state;
+        state.InitializeEarth(options.EarthRadius, options.Width / 2, options.Height / 2);
+        state.InitializeSatellite(options.SatelliteRadius);
+        KeplerCatalog catalog;
+        begin = Now();
+        scenario.Apply(state);
+        scenario.Apply(state.Earth.Radius, catalog);
+        auto apply = std::chrono::duration<double>(Now() - begin).count();
+
+        std::printf("scenario       %s, %u threads\n", path.c_str(), pool.Size());
+        std::printf("orbits         %zu circular, %zu kepler, period %.3f sec, trajectory %.3f radii\n", scenario.Circular(), scenario.Kepler(),
+                    scenario.PeriodSeconds(), scenario.TrajectoryEarthRadii());
+        std::printf("compile        %9.3f ms  text parsed and written\n", compile * 1e3);
+        std::printf("open           %9.3f ms  %s\n", open * 1e3, scenario.Compiled() ? "COMPILED AGAIN" : "mapped, up to date");
+        std::printf("apply          %9.3f ms  constellation and catalog filled\n", apply * 1e3);
+        return scenario.Compiled() ? 1 : 0;
+    }
+
+    // Independent runs of the displayed satellite over a --periods by --radii grid, or the cases of a
+    // file, each --duration seconds (two minutes by default) in steps of --dt, one row per run
+    static int Sweep(const Options& options) {
+        ThreadPool pool(options.Threads);
+        std::vector<SweepCase> cases;
+        if (std::strcmp(options.Input, "grid") == 0) {
+            SweepRange periods, radii;
+            if (!SweepRange::Parse(options.Periods, periods) || !SweepRange::Parse(options.Radii, radii)) {
+                std::fprintf(stderr, "Ranges are FROM:TO:COUNT or a single value\n");
+                return 1;
+            }
+            auto duration = options.DurationSeconds > 0 ? options.DurationSeconds : 120.0;
+            cases = ParameterSweep::Grid(periods.Values(), radii.Values(), duration, (double)options.DtSeconds);
+        }
+        else {
+            std::string error;
+            if (!ParameterSweep::Load(options.Input, cases, error)) {
+                std::fprintf(stderr, "%s\n", error.c_str());
+                return 1;
+            }
+        }
+
+        ParameterSweep sweep;
+        const auto& results = sweep.Run(cases, pool);
+        std::printf("%10s %8s %10s %8s %10s %12s %12s %9s %10s\n", "period s", "radii", "duration s", "step s", "steps", "min field", "max field", "coverage", "ms");
+        std::uint64_t steps = 0;
+        for (const auto& r : results) {
+            std::printf("%10.3f %8.3f %10.3f %8.4f %10llu %12.5e %12.5e %8.1f%% %10.3f\n", r.Case.PeriodSeconds, r.Case.TrajectoryEarthRadii,
+                        r.Case.DurationSeconds, r.Case.StepSeconds, (unsigned long long)r.Steps, r.MinField, r.MaxField, r.Coverage * 100,
+                        r.Seconds * 1e3);
+            steps += r.Steps;
+        }
+        auto wall = sweep.Seconds();
+        std::printf("precision      %s, %zu runs, %llu steps, %u threads\n", PrecisionName<Scalar>(), results.size(), (unsigned long long)steps, pool.Size());
+        std::printf("wall           %.3f sec, %.0f steps per sec\n", wall, wall > 0 ? steps / wall : 0.0);
+        std::printf("busy           %.3f sec, %.1f%% of the threads' time\n", sweep.BusySeconds(), wall > 0 ? sweep.BusySeconds() / (wall * pool.Size()) * 100 : 0.0);
+        return 0;
+    }
+
+    // The sprites of a directory decoded one after the other, then through a fresh asset cache: decoded
+    // in parallel and written, then mapped from it the way every later start finds them
+    static int Assets(const Options& options) {
+        ThreadPool pool(options.Threads);
+        std::string prefix = std::string(options.Sprites) + "/";
+        std::vector<std::vector<std::uint8_t>> files(std::size(SpriteFiles));
+        std::vector<AssetSource> sources;
+        std::size_t bytes = 0;
+        auto begin = Now();
+        for (std::size_t i = 0; i < files.size(); i++) {
+            if (!ReadFile(prefix + SpriteFiles[i], files[i])) {
+                std::fprintf(stderr, "Could not read %s%s\n", prefix.c_str(), SpriteFiles[i]);
+                return 1;
+            }
+            sources.push_back({ files[i].data(), files[i].size() });
+            bytes += files[i].size();
+        }
+        auto read = std::chrono::duration<double>(Now() - begin).count();
+
+        begin = Now();
+        std::vector<std::uint8_t> rgba;
+        for (std::size_t i = 0; i < files.size(); i++) {
+            int width, height;
+            if (!Png::Decode(files[i].data(), files[i].size(), rgba, width, height)) {
+                std::fprintf(stderr, "Could not decode %s%s\n", prefix.c_str(), SpriteFiles[i]);
+                return 1;
+            }
+            std::printf("%-14s %d x %d, %zu bytes\n", SpriteFiles[i], width, height, files[i].size());
+        }
+        auto serial = std::chrono::duration<double>(Now() - begin).count();
+
+        // Next to the sprites, where the window's own cache would not be touched
+        auto path = prefix + "assets_timing.bin";
+        std::remove(path.c_str());
+        AssetCache cache;
+        begin = Now();
+        auto loaded = cache.Load(sources, path, pool);
+        auto cold = std::chrono::duration<double>(Now() - begin).count();
+        auto decoded = cache.Decoded();
+        auto written = cache.Mapped();
+        begin = Now();
+        loaded &= cache.Load(sources, path, pool);
+        auto warm = std::chrono::duration<double>(Now() - begin).count();
+        auto hits = cache.Decoded() == 0 && cache.Mapped();
+        cache.Close();
+        std::remove(path.c_str());
+        if (!loaded) {
+            std::fprintf(stderr, "%s\n", cache.Error().c_str());
+            return 1;
+        }
+
+        std::printf("read           %9.3f ms  %zu bytes\n", read * 1e3, bytes);
+        std::printf("decode         %9.3f ms  one after the other\n", serial * 1e3);
+        std::printf("cold           %9.3f ms  %zu decoded on %u threads, %s\n", cold * 1e3, decoded, pool.Size(), written ? "written" : "NOT written");
+        std::printf("warm           %9.3f ms  %s\n", warm * 1e3, hits ? "mapped, nothing decoded" : "DECODED AGAIN");
+        return hits ? 0 : 1;
+    }
+
+    // The zones of whatever ran, summed over the whole run, and the trace for chrome://tracing
+    static int ReportProfile(const Options& options) {
+        if (!Profiler::Enabled) {
+            std::fprintf(stderr, "Built without SIMULATION_PROFILING, no profile written\n");
+            return 1;
+        }
+        static Profiler::ZoneSummary zones[64];
+        auto count = Profiler::Summarize(std::chrono::hours(24 * 365), zones, std::size(zones));
+        std::printf("%-10s %-40s %8s %12s %10s %10s %10s\n", "thread", "zone", "count", "total ms", "mean us", "p99 us", "max us");
+        for (std::size_t i = 0; i < count; i++) {
+            const auto& zone = zones[i];
+            std::printf("%-10s %*s%-*s %8llu %12.3f %10.2f %10.2f %10.2f\n", zone.Thread, (int)zone.Depth * 2, "", 40 - (int)zone.Depth * 2,
+                        zone.Name, (unsigned long long)zone.Count, zone.TotalMicroseconds * 1e-3, zone.MeanMicroseconds(),
+                        zone.PercentileMicroseconds(0.99), zone.MaxMicroseconds);
+        }
+        if (!Profiler::WriteChromeTrace(options.Profile)) {
+            std::fprintf(stderr, "Could not write %s\n", options.Profile);
+            return 1;
+        }
+        std::printf("trace          %s\n", options.Profile);
+        return 0;
+    }
+
+    static int Run(const Options& options) {
+        Simd::SetActiveInstructionSet(options.Isa);
+
+        SimulationState state;
+        state.InitializeEarth(options.EarthRadius, options.Width / 2, options.Height / 2);
+        state.InitializeSatellite(options.SatelliteRadius);
+        state.Satellite.PeriodSeconds = options.PeriodSeconds;
+        AddSatellites(state, options);
+
+        std::unique_ptr<TelemetryRecorder> telemetry;
+        if (options.Telemetry != nullptr) {
+            telemetry = std::make_unique<TelemetryRecorder>(options.Telemetry, TelemetryScene::From(state));
+            if (telemetry->Failed()) {
+                std::fprintf(stderr, "Could not write %s\n", options.Telemetry);
+                return 1;
+            }
+        }
+
+        // One step at a time, the way a recorded run evaluates every tick, unless fast forwarding:
+        // StepN jumps straight to the end at the cost of a single step, and lands on the same bits.
+        // Recording telemetry needs every step.
+        auto begin = Now();
+        if (options.FastForward && !telemetry) {
+            state.StepN(options.Steps, options.DtSeconds);
+        }
+        else if (telemetry) {
+            for (std::uint64_t i = 0; i < options.Steps; i++) {
+                state.Step(options.DtSeconds);
+                telemetry->Record(TelemetrySample::From(state));
+            }
+            telemetry->Finish();
+        }
+        else {
+            for (std::uint64_t i = 0; i < options.Steps; i++) {
+                state.Step(options.DtSeconds);
+            }
+        }
+        auto seconds = std::chrono::duration<double>(Now() - begin).count();
+
+        std::printf("precision      %s\n", PrecisionName<Scalar>());
+        std::printf("steps          %llu\n", (unsigned long long)options.Steps);
+        std::printf("simulated      %.3f sec\n", (double)state.ElapsedSeconds());
+        std::printf("wall           %.3f sec\n", seconds);
+        // StepN lands on the end in one evaluation, so it is those that count for the rate
+        auto evaluations = options.FastForward && !telemetry ? 1 : options.Steps;
+        std::printf("rate           %.0f evaluations/sec\n", seconds > 0.0 ? evaluations / seconds : 0.0);
+        std::printf("satellites     %zu (+1), %s kernel\n", state.Satellites.Size(), ToString(Simd::ActiveInstructionSet()));
+        std::printf("updates        %.0f satellites/sec\n", seconds > 0.0 ? evaluations * (state.Satellites.Size() + 1.0) / seconds : 0.0);
+        std::printf("angle          %.6f deg\n", (double)state.Satellite.AngleDegrees);
+        std::printf("position       (%.17g, %.17g)\n", (double)state.Satellite.X, (double)state.Satellite.Y);
+        std::printf("field          (%.6f, %.6f) r = %.6f\n", (double)state.CircularField.DirectionX, (double)state.CircularField.DirectionY, (double)state.CircularField.Radius);
+        if (telemetry) {
+            std::printf("telemetry      %llu rows to %s, %llu stalls\n", (unsigned long long)telemetry->Rows(), options.Telemetry,
+                        (unsigned long long)telemetry->Stalls());
+            if (telemetry->Failed()) {
+                std::fprintf(stderr, "Could not write %s\n", options.Telemetry);
+                return 1;
+            }
+        }
+        return 0;
+    }
+}
+
+static int RunMode(const Simulation::Headless::Options& options) {
+    using namespace Simulation::Headless;
+    switch (options.Mode) {
+    case Mode::Verify:
+        return Verify();
+    case Mode::Drift:
+        return Drift(options);
+    case Mode::Kepler:
+        return Kepler(options);
+    case Mode::FieldMap:
+        return FieldMap(options);
+    case Mode::FieldLines:
+        return FieldLines(options);
+    case Mode::Render:
+        return Render(options);
+    case Mode::Schedule:
+        return Schedule(options);
+    case Mode::Export:
+        return Export(options);
+    case Mode::Scan:
+        return Scan(options);
+    case Mode::Replay:
+        return Replay(options);
+    case Mode::Conjunctions:
+        return Conjunctions(options);
+    case Mode::Contacts:
+        return Contacts(options);
+    case Mode::Geomagnetic:
+        return Geomagnetic(options);
+    case Mode::Scenario:
+        return RunScenario(options);
+    case Mode::Sweep:
+        return Sweep(options);
+    case Mode::Assets:
+        return Assets(options);
+    default:
+        return Run(options);
+    }
+}
+
+int main(int argc, char** argv) {
+    using namespace Simulation::Headless;
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+    Simulation::Profiler::SetThreadName("Main");
+    auto result = RunMode(options);
+    if (options.Profile != nullptr && ReportProfile(options) != 0) {
+        return 1;
+    }
+    return result;
+}
@@ -0,0 +1,53 @@
+#include "../include/hud.h"
+#include <algorithm>
+#include <charconv>
+
+namespace Simulation {
+    HudLine::HudLine() : text(), prefixLength(0), length(0) {
+    }
+
+    HudLine::HudLine(std::wstring_view prefix) : text(), prefixLength(0), length(0) {
+        Append(prefix);
+        prefixLength = length;
+    }
+
+    HudLine& HudLine::Reset() {
+        length = prefixLength;
+        return *this;
+    }
+
+    HudLine& HudLine::Append(std::wstring_view string) {
+        auto count = std::min(string.size(), Capacity - length);
+        std::copy_n(string.data(), count, text + length);
+        length += count;
+        return *this;
+    }
+
+    HudLine& HudLine::Append(std::string_view string) {
+        auto count = std::min(string.size(), Capacity - length);
+        std::copy_n(string.data(), count, text + length);
+        length += count;
+        return *this;
+    }
+
+    HudLine& HudLine::Append(double value, int precision) {
+        // Digits, sign and point are ASCII, widened one by one
+        char digits[320]; // DBL_MAX has 309 digits before the point
+        auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, precision);
+        if (result.ec != std::errc()) {
+            return Append(L"?");
+        }
+        auto count = std::min((std::size_t)(result.ptr - digits), Capacity - length);
+        std::copy_n(digits, count, text + length);
+        length += count;
+        return *this;
+    }
+
+    std::wstring_view HudLine::Text() const {
+        return std::wstring_view(text, length);
+    }
+
+    std::size_t HudLine::PrefixLength() const {
+        return prefixLength;
+    }
+}
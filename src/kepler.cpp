@@ -0,0 +1,123 @@
+#include "../include/kepler.h"
+#include "../include/orbit_kernel.h"
+#include "../include/simd_kernel.h"
+#include <algorithm>
+
+namespace Simulation {
+    template<class T>
+    OrbitalElements<T> OrbitalElements<T>::FromPeriod(T semiMajorAxis, T eccentricity, T argumentOfPeriapsis, T meanAnomalyAtEpoch, T periodSeconds) {
+        return { semiMajorAxis, eccentricity, argumentOfPeriapsis, meanAnomalyAtEpoch, 2 * Pi<T> / periodSeconds };
+    }
+
+    template<class T>
+    std::size_t BasicKeplerCatalog<T>::Size() const {
+        return SemiMajorAxis.size();
+    }
+
+    template<class T>
+    void BasicKeplerCatalog<T>::Reserve(std::size_t n) {
+        for (auto field : { &SemiMajorAxis, &Eccentricity, &ArgumentOfPeriapsis, &MeanAnomalyAtEpoch, &MeanMotion,
+                            &SemiMinorAxis, &CosPeriapsis, &SinPeriapsis }) {
+            field->reserve(n);
+        }
+    }
+
+    template<class T>
+    void BasicKeplerCatalog<T>::Clear() {
+        for (auto field : { &SemiMajorAxis, &Eccentricity, &ArgumentOfPeriapsis, &MeanAnomalyAtEpoch, &MeanMotion,
+                            &SemiMinorAxis, &CosPeriapsis, &SinPeriapsis }) {
+            field->clear();
+        }
+    }
+
+    template<class T>
+    std::size_t BasicKeplerCatalog<T>::Add(const OrbitalElements<T>& elements) {
+        auto index = Size();
+        auto e = std::clamp(elements.Eccentricity, T(0), MaxEccentricity);
+        SemiMajorAxis.push_back(elements.SemiMajorAxis);
+        Eccentricity.push_back(e);
+        ArgumentOfPeriapsis.push_back(elements.ArgumentOfPeriapsis);
+        MeanAnomalyAtEpoch.push_back(elements.MeanAnomalyAtEpoch);
+        MeanMotion.push_back(elements.MeanMotion);
+        SemiMinorAxis.push_back(elements.SemiMajorAxis * std::sqrt(T(1) - e * e));
+        CosPeriapsis.push_back(std::cos(elements.ArgumentOfPeriapsis));
+        SinPeriapsis.push_back(std::sin(elements.ArgumentOfPeriapsis));
+        return index;
+    }
+
+    // M0 + n t, reduced to [-pi, pi] in phase precision before narrowing to T
+    template<class T>
+    static T MeanAnomaly(T meanAnomalyAtEpoch, T meanMotion, PhaseScalar<T> timeSeconds) {
+        using P = PhaseScalar<T>;
+        auto m = meanAnomalyAtEpoch + meanMotion * timeSeconds;
+        m -= 2 * Pi<P> * std::nearbyint(m / (2 * Pi<P>));
+        return T(m);
+    }
+
+    template<class T>
+    void BasicKeplerCatalog<T>::Propagate(PhaseScalar<T> timeSeconds, T* x, T* y) const {
+        auto n = Size();
+
+        // The mean anomalies go through x: the kernel reads every block before writing it
+        auto m0 = MeanAnomalyAtEpoch.data();
+        auto motion = MeanMotion.data();
+        for (std::size_t i = 0; i < n; i++) {
+            x[i] = MeanAnomaly(m0[i], motion[i], timeSeconds);
+        }
+
+        Simd::KeplerArrays<T> arrays = {
+            x, Eccentricity.data(),
+            SemiMajorAxis.data(), SemiMinorAxis.data(),
+            CosPeriapsis.data(), SinPeriapsis.data(),
+            x, y
+        };
+        Simd::SolveKepler(arrays, Iterations, n);
+    }
+
+    template<class T>
+    void BasicKeplerCatalog<T>::Propagate(PhaseScalar<T> timeSeconds, std::vector<T>& x, std::vector<T>& y) const {
+        x.resize(Size());
+        y.resize(Size());
+        Propagate(timeSeconds, x.data(), y.data());
+    }
+
+    template<class T>
+    void BasicKeplerCatalog<T>::PositionAt(std::size_t i, PhaseScalar<T> timeSeconds, T& x, T& y) const {
+        auto m = MeanAnomaly(MeanAnomalyAtEpoch[i], MeanMotion[i], timeSeconds);
+        Kernel::Kepler(m, Eccentricity[i], SemiMajorAxis[i], SemiMinorAxis[i], CosPeriapsis[i], SinPeriapsis[i], Iterations, x, y);
+    }
+
+    template<class T>
+    void BasicKeplerCatalog<T>::PositionsAt(const std::uint32_t* indices, const PhaseScalar<T>* timesSeconds, std::size_t count, T* x, T* y) const {
+        thread_local std::vector<T> e, a, b, cw, sw;
+        for (auto field : { &e, &a, &b, &cw, &sw }) {
+            field->resize(count);
+        }
+        // The mean anomalies go through x, as in Propagate
+        for (std::size_t j = 0; j < count; j++) {
+            auto i = indices[j];
+            x[j] = MeanAnomaly(MeanAnomalyAtEpoch[i], MeanMotion[i], timesSeconds[j]);
+            e[j] = Eccentricity[i];
+            a[j] = SemiMajorAxis[i];
+            b[j] = SemiMinorAxis[i];
+            cw[j] = CosPeriapsis[i];
+            sw[j] = SinPeriapsis[i];
+        }
+
+        Simd::KeplerArrays<T> arrays = {
+            x, e.data(),
+            a.data(), b.data(),
+            cw.data(), sw.data(),
+            x, y
+        };
+        Simd::SolveKepler(arrays, Iterations, count);
+    }
+
+    template struct OrbitalElements<float>;
+    template struct OrbitalElements<double>;
+    template struct OrbitalElements<long double>;
+
+    template class BasicKeplerCatalog<float>;
+    template class BasicKeplerCatalog<double>;
+    template class BasicKeplerCatalog<long double>;
+}
@@ -3,33 +3,96 @@
 #include "../include/graphics.h"
 #include "../include/module_earth.h"
 #include "../include/module_satellite.h"
+#include "../include/simulation_state.h"
+#include "../include/simulation_clock.h"
+#include "../include/snapshot.h"
+#include "../include/command_queue.h"
+#include "../include/frame_scheduler.h"
+#include "../include/replay.h"
+#include "../include/scenario.h"
+#include "../include/profiler.h"
+#include <cstdio>
+#include <string>
 #include <thread>
 
+// timeBeginPeriod, so the schedulers' sleeps wake within a millisecond instead of a 15.6 ms tick
+#pragma comment(lib, "winmm.lib")
+
 namespace Simulation {
     int Width, Height;
-    bool Running;
+    std::atomic<bool> Running;
+    std::atomic<bool> Recording;
+    std::atomic<bool> ProfileOverlay;
     Main MainInstance;
     Graphics* GraphicsInstance;
+    SimulationState StateInstance;
+    SimulationClock ClockInstance;
+    SnapshotBuffer SnapshotsInstance;
+    CommandQueue CommandsInstance;
+    Replay* ReplayInstance;
+    const Scenario* ScenarioInstance;
 
-    int Main::Run(HINSTANCE hInstance) {
+    // The command line as a path: surrounding spaces and quotes removed, in the ANSI code page
+    static std::string CommandLinePath(const wchar_t* commandLine) {
+        std::wstring path = commandLine != nullptr ? commandLine : L"";
+        auto first = path.find_first_not_of(L" \t\"");
+        auto last = path.find_last_not_of(L" \t\"");
+        if (first == std::wstring::npos) {
+            return {};
+        }
+        path = path.substr(first, last - first + 1);
+        auto size = WideCharToMultiByte(CP_ACP, 0, path.c_str(), (int)path.size(), NULL, 0, NULL, NULL);
+        std::string narrow(size, '\0');
+        WideCharToMultiByte(CP_ACP, 0, path.c_str(), (int)path.size(), narrow.data(), size, NULL, NULL);
+        return narrow;
+    }
+
+    int Main::Run(HINSTANCE hInstance, const wchar_t* commandLine) {
         // Create the window
         InitializeWindow(hInstance);
 
+        // A scenario by its extension, compiled or not, anything else a recording. Both live as long
+        // as the threads that read them, the live simulation's defaults are the fallback.
+        Replay replay;
+        Scenario scenario;
+        auto path = CommandLinePath(commandLine);
+        auto isScenario = path.ends_with(Scenario::TextExtension) || path.ends_with(std::string(Scenario::TextExtension) + Scenario::CompiledExtension);
+        if (isScenario) {
+            if (scenario.Open(path)) {
+                ScenarioInstance = &scenario;
+            }
+            else {
+                OutputDebugStringA((scenario.Error() + "\n").c_str());
+            }
+        }
+        else if (!path.empty() && replay.Open(path)) {
+            ReplayInstance = &replay;
+        }
+
         // Create the graphics instance, scope is critical because of the destructor!
         Graphics graphics(hWnd);
         GraphicsInstance = &graphics;
         
         if (graphics.Success()) {
             Running = true;
+            timeBeginPeriod(1);
 
             // Set the earth and satellite's initial size and position
             InitializeModules();
 
-            // Start to update and repaint
+            // Physics and drawing each on a thread of their own, the ticks go from one to the
+            // other through SnapshotsInstance so a slow frame never holds up the physics
             StartTicking();
+            StartRendering();
 
             // Listen to events and keep the main thread alive.
             MessageLoop();
+
+            // Both threads use the graphics, stop them before it goes out of scope
+            Running = false;
+            ticker.join();
+            renderer.join();
+            timeEndPeriod(1);
             
             // Success
             return 0;
@@ -66,21 +129,45 @@ namespace Simulation {
         Satellite::Initialize(GraphicsInstance->GetSatelliteBitmap());
     }
     
-    void Main::StartTicking() const {
-        std::thread ticker([this] {
-            // As long as the simulation is running:
+    // To the debugger's output window, how well a thread kept its deadlines
+    static void ReportJitter(const char* name, const FrameScheduler& scheduler) {
+        const auto& stats = scheduler.Stats();
+        char text[256];
+        std::snprintf(text, sizeof(text), "%s: %llu deadlines, %llu missed, late by %.1f us mean, %.1f us sd, %.1f us p99, %.1f us max\n",
+                      name, (unsigned long long)stats.Count(), (unsigned long long)scheduler.Missed(), stats.MeanMicroseconds(),
+                      stats.DeviationMicroseconds(), stats.PercentileMicroseconds(0.99), stats.MaxMicroseconds());
+        OutputDebugStringA(text);
+    }
+
+    void Main::StartTicking() {
+        ticker = std::thread([] {
+            // As long as the simulation is running, on absolute deadlines so the rate does not drift
+            Profiler::SetThreadName("Simulation");
+            FrameScheduler schedule(TicksPerSecond);
             while (Running) {
                 Satellite::Update();
-                GraphicsInstance->Draw();
-                std::this_thread::sleep_for(TickDelay);
+                schedule.Wait();
             }
+            ReportJitter("Simulation", schedule);
+        });
+    }
+
+    void Main::StartRendering() {
+        renderer = std::thread([this] {
+            // Frames on a schedule of their own, a slow one skips deadlines rather than catching up
+            Profiler::SetThreadName("Renderer");
+            FrameScheduler schedule(FramesPerSecond);
+            FrameScheduler hud(HudRefreshesPerSecond);
+            while (Running) {
+                GraphicsInstance->Draw(hud.Due(FrameScheduler::Clock::now()));
+                schedule.Wait();
+            }
+            ReportJitter("Renderer", schedule);
 
             // Important! Exit the main thread and close the window!
-            SendMessage(hWnd, WM_CLOSE, NULL, NULL);
+            // Posted, the main thread may already be waiting for this thread to finish
+            PostMessage(hWnd, WM_CLOSE, NULL, NULL);
         });
-
-        // Important! Detach the thread
-        ticker.detach();
     }
 
     void Main::MessageLoop() const {
@@ -0,0 +1,145 @@
+#include "../include/mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Simulation {
+#ifdef _WIN32
+    MappedFile::MappedFile() : data(nullptr), size(0), open(false), file(nullptr), mapping(nullptr) {
+    }
+#else
+    MappedFile::MappedFile() : data(nullptr), size(0), open(false) {
+    }
+#endif
+
+    MappedFile::MappedFile(const std::string& path) : MappedFile() {
+        Open(path);
+    }
+
+    MappedFile::~MappedFile() {
+        Close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept : MappedFile() {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            Close();
+            std::swap(data, other.data);
+            std::swap(size, other.size);
+            std::swap(open, other.open);
+#ifdef _WIN32
+            std::swap(file, other.file);
+            std::swap(mapping, other.mapping);
+#endif
+        }
+        return *this;
+    }
+
+    bool MappedFile::IsOpen() const {
+        return open;
+    }
+
+    const std::uint8_t* MappedFile::Data() const {
+        return data;
+    }
+
+    std::size_t MappedFile::Size() const {
+        return size;
+    }
+
+#ifdef _WIN32
+    bool MappedFile::Open(const std::string& path) {
+        Close();
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+            file = nullptr;
+            return false;
+        }
+        LARGE_INTEGER length;
+        if (!GetFileSizeEx(file, &length)) {
+            Close();
+            return false;
+        }
+        size = (std::size_t)length.QuadPart;
+        open = true;
+        if (size == 0) {
+            // Windows refuses to map nothing
+            return true;
+        }
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        data = mapping != nullptr ? static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        if (data == nullptr) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (data != nullptr) {
+            UnmapViewOfFile(data);
+        }
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        if (file != nullptr) {
+            CloseHandle(file);
+        }
+        data = nullptr;
+        mapping = nullptr;
+        file = nullptr;
+        size = 0;
+        open = false;
+    }
+#else
+    bool MappedFile::Open(const std::string& path) {
+        Close();
+        auto descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return false;
+        }
+        struct stat status;
+        if (fstat(descriptor, &status) != 0) {
+            ::close(descriptor);
+            return false;
+        }
+        size = (std::size_t)status.st_size;
+        if (size > 0) {
+            auto address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (address == MAP_FAILED) {
+                ::close(descriptor);
+                size = 0;
+                return false;
+            }
+            // Mostly read front to back, let the kernel read ahead
+            madvise(address, size, MADV_SEQUENTIAL);
+            data = static_cast<const std::uint8_t*>(address);
+        }
+        // The mapping keeps the file alive on its own
+        ::close(descriptor);
+        open = true;
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (data != nullptr) {
+            munmap(const_cast<std::uint8_t*>(data), size);
+        }
+        data = nullptr;
+        size = 0;
+        open = false;
+    }
+#endif
+}
@@ -1,12 +1,13 @@
 #include "../include/module_earth.h"
-#include <string>
+#include "../include/simulation_state.h"
 
 namespace Simulation {
-    long double Earth::Radius, Earth::X, Earth::Y;
+    Scalar Earth::Radius, Earth::X, Earth::Y;
 
     void Earth::Initialize(const ID2D1Bitmap* const bmp) {
-        Radius = bmp->GetSize().width / 2.0l;
-        X = Width / 2.0l;
-        Y = Height / 2.0l;
+        Radius = bmp->GetSize().width / Scalar(2);
+        X = Width / Scalar(2);
+        Y = Height / Scalar(2);
+        StateInstance.InitializeEarth(Radius, X, Y);
     }
 }
\ No newline at end of file
@@ -1,58 +1,159 @@
 #include "../include/module_satellite.h"
 #include "../include/module_earth.h"
 #include "../include/magnetic_field_circular.h"
+#include "../include/simulation_state.h"
+#include "../include/simulation_clock.h"
+#include "../include/snapshot.h"
+#include "../include/command_queue.h"
+#include "../include/telemetry.h"
+#include "../include/replay.h"
+#include "../include/scenario.h"
+#include "../include/profiler.h"
+#include <algorithm>
 
 namespace Simulation {
-    long double Satellite::Radius, Satellite::RadiusTrajectory, Satellite::X, Satellite::Y, Satellite::AngleDegrees, Satellite::AngleRadians;
-    long double Satellite::PeriodSeconds = DefaultPeriodSeconds;
-    long double Satellite::RadialDirectionX, Satellite::RadialDirectionY;
-    long double Satellite::TangentDirectionX, Satellite::TangentDirectionY;
-    Timepoint Satellite::RotationBeginTimepoint;
+    Scalar Satellite::Radius, Satellite::RadiusTrajectory, Satellite::X, Satellite::Y, Satellite::AngleDegrees, Satellite::AngleRadians;
+    Scalar Satellite::PeriodSeconds = SimulationState::DefaultPeriodSeconds;
+    Scalar Satellite::RadialDirectionX, Satellite::RadialDirectionY;
+    Scalar Satellite::TangentDirectionX, Satellite::TangentDirectionY;
+    Timepoint Satellite::LastUpdateTimepoint;
+    std::unique_ptr<TelemetryRecorder> Satellite::Telemetry;
+    std::unique_ptr<SphericalHarmonicField> Satellite::FieldModel;
 
     void Satellite::Initialize(const ID2D1Bitmap* const bmp) {
-        Radius = bmp->GetSize().width / 2.0l;
-        RadiusTrajectory = 4.0l * Earth::Radius;
-        RotationBeginTimepoint = Now();
+        StateInstance.InitializeSatellite(bmp->GetSize().width / Scalar(2));
+        if (ScenarioInstance != nullptr) {
+            ScenarioInstance->Apply(StateInstance);
+        }
+        LastUpdateTimepoint = Now();
+        ClockInstance.Reset();
+
+        // Something for the renderer to pick up before the first tick
+        Publish();
     }
 
     void Satellite::Update() {
-        auto diffMicros = std::chrono::duration_cast<std::chrono::microseconds>(Now() - RotationBeginTimepoint).count();
-        auto periodMicros = PeriodSeconds * 1000000.0l;
-
-        // Update the rotation angle
-        AngleDegrees = 360.0l * diffMicros / periodMicros;
-        AngleRadians = 2.0l * PI * diffMicros / periodMicros;
-        if (AngleDegrees >= 360.0l || AngleRadians >= 2.0l * PI) {
-            RotationBeginTimepoint = Now();
-            AngleDegrees -= 360.0l;
-            AngleRadians -= 2.0l * PI;
+        SIMULATION_PROFILE_ZONE("Satellite::Update");
+        ApplyCommands();
+
+        auto now = Now();
+        auto real = std::chrono::duration_cast<std::chrono::nanoseconds>(now - LastUpdateTimepoint);
+        LastUpdateTimepoint = now;
+
+        if (ReplayInstance != nullptr) {
+            // Recorded ticks in place of the physics, the renderer can not tell the difference
+            ReplayInstance->Advance(real);
+            ReplayInstance->Capture(SnapshotsInstance.Back());
+            SnapshotsInstance.Publish();
+            return;
+        }
+
+        // Run the fixed steps that are due, any number of them costs the same as one.
+        // Telemetry takes a row per step, up to a limit, whatever the frame rate.
+        auto steps = ClockInstance.Advance(real);
+        StateInstance.StepNanoseconds((std::int64_t)steps * ClockInstance.Step().count());
+        if (Telemetry) {
+            Telemetry->RecordSteps(StateInstance, steps, ClockInstance.Step().count());
+        }
+
+        Publish();
+    }
+
+    void Satellite::Mirror(const Snapshot& snapshot) {
+        const auto& state = snapshot.Satellite;
+        Radius = state.Radius;
+        RadiusTrajectory = state.RadiusTrajectory;
+        PeriodSeconds = state.PeriodSeconds;
+        AngleDegrees = state.AngleDegrees;
+        AngleRadians = state.AngleRadians;
+        X = state.X;
+        Y = state.Y;
+        RadialDirectionX = state.RadialDirectionX;
+        RadialDirectionY = state.RadialDirectionY;
+        TangentDirectionX = state.TangentDirectionX;
+        TangentDirectionY = state.TangentDirectionY;
+
+        // Update the magnetic fields
+        MagneticFields::Circular::Mirror(snapshot);
+    }
+
+    void Satellite::ApplyCommands() {
+        if (ReplayInstance != nullptr) {
+            ApplyReplayCommands();
+            return;
+        }
+        for (const auto& command : CommandsInstance.Take()) {
+            switch (command.Kind) {
+            case Command::Type::ChangePeriod: {
+                // Takes effect immediately, the satellite carries on from where it is
+                auto period = StateInstance.Satellite.PeriodSeconds + (Scalar)command.Value;
+                if (period > 0) {
+                    StateInstance.SetPeriod(period);
+                }
+                break;
+            }
+            case Command::Type::ScaleTimeWarp:
+                ClockInstance.SetTimeWarp(ClockInstance.TimeWarp() * command.Value);
+                break;
+            case Command::Type::ToggleTelemetry:
+                // Stopping writes out the last block, a fresh start overwrites the file
+                if (Telemetry) {
+                    Telemetry.reset();
+                }
+                else {
+                    Telemetry = std::make_unique<TelemetryRecorder>(TelemetryPath, TelemetryScene::From(StateInstance));
+                    if (Telemetry->Failed()) {
+                        Telemetry.reset();
+                    }
+                }
+                break;
+            case Command::Type::ToggleFieldModel:
+                if (StateInstance.FieldModel() != nullptr) {
+                    StateInstance.SetFieldModel(nullptr);
+                }
+                else {
+                    if (!FieldModel) {
+                        GaussCoefficients coefficients;
+                        if (!coefficients.Load(FieldModelPath)) {
+                            break;
+                        }
+                        FieldModel = std::make_unique<SphericalHarmonicField>(coefficients);
+                    }
+                    StateInstance.SetFieldModel(FieldModel.get());
+                }
+                break;
+            default:
+                break;
+            }
         }
+    }
 
-        // Update the location
-        X = Earth::X + RadiusTrajectory * cos(AngleRadians);
-        Y = Earth::Y - RadiusTrajectory * sin(AngleRadians);
-
-        // Update the axes
-        {
-            // Update the radial axis
-            {
-                double x = Earth::X - Satellite::X;
-                double y = Satellite::Y - Earth::Y;
-                double size = sqrt(pow(x, 2) + pow(y, 2));
-                RadialDirectionX = x / size;
-                RadialDirectionY = y / size;
+    void Satellite::ApplyReplayCommands() {
+        auto& replay = *ReplayInstance;
+        for (const auto& command : CommandsInstance.Take()) {
+            switch (command.Kind) {
+            case Command::Type::ScaleTimeWarp:
+                replay.SetSpeed(replay.Speed() * command.Value);
+                break;
+            case Command::Type::TogglePause:
+                replay.SetPaused(!replay.Paused());
+                break;
+            case Command::Type::Seek: {
+                // In double first, Value may reach past either end of the recording
+                auto target = replay.Position() + command.Value * 1e9;
+                target = std::clamp(target, (double)replay.BeginNanoseconds(), (double)replay.EndNanoseconds());
+                replay.Seek((std::int64_t)target);
+                break;
             }
-            // Update the tangent axis
-            {
-                double x = Satellite::Y - Earth::Y;
-                double y = Satellite::X - Earth::X;
-                double size = sqrt(pow(x, 2) + pow(y, 2));
-                TangentDirectionX = x / size;
-                TangentDirectionY = y / size;
+            default:
+                // The period and the telemetry are whatever was recorded
+                break;
             }
         }
+    }
 
-        // Update the magnetic fields
-        MagneticFields::Circular::Update();
+    void Satellite::Publish() {
+        SnapshotsInstance.Back().Capture(StateInstance, ClockInstance.Steps(), ClockInstance.TimeWarp());
+        SnapshotsInstance.Publish();
     }
 }
\ No newline at end of file
@@ -0,0 +1,702 @@
+#include "../include/png.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+
+namespace Simulation::Png {
+    static constexpr auto CrcTable = [] {
+        std::array<std::uint32_t, 256> table = {};
+        for (std::uint32_t n = 0; n < 256; n++) {
+            auto c = n;
+            for (int k = 0; k < 8; k++) {
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return table;
+    }();
+
+    std::uint32_t Crc32(const std::uint8_t* data, std::size_t size, std::uint32_t crc) {
+        crc = ~crc;
+        for (std::size_t i = 0; i < size; i++) {
+            crc = CrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    std::uint32_t Adler32(const std::uint8_t* data, std::size_t size, std::uint32_t adler) {
+        std::uint32_t a = adler & 0xFFFF, b = adler >> 16;
+        while (size > 0) {
+            // The largest run that can not overflow b before the modulo
+            auto run = std::min<std::size_t>(size, 5552);
+            for (std::size_t i = 0; i < run; i++) {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += run;
+            size -= run;
+        }
+        return (b << 16) | a;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    // Deflate writes its bits from the least significant end, Huffman codes from their first bit
+    class BitWriter {
+    public:
+        explicit BitWriter(std::vector<std::uint8_t>& out) : out(out), bits(0), count(0) {
+        }
+
+        void Bits(std::uint32_t value, int n) {
+            bits |= (std::uint64_t)value << count;
+            count += n;
+            while (count >= 8) {
+                out.push_back((std::uint8_t)bits);
+                bits >>= 8;
+                count -= 8;
+            }
+        }
+
+        void Code(std::uint32_t code, int n) {
+            std::uint32_t reversed = 0;
+            for (int i = 0; i < n; i++) {
+                reversed = (reversed << 1) | ((code >> i) & 1);
+            }
+            Bits(reversed, n);
+        }
+
+        void Flush() {
+            if (count > 0) {
+                out.push_back((std::uint8_t)bits);
+            }
+            bits = 0;
+            count = 0;
+        }
+    private:
+        std::vector<std::uint8_t>& out;
+        std::uint64_t bits;
+        int count;
+    };
+
+    // The fixed literal/length code of RFC 1951 3.2.6
+    static void Symbol(BitWriter& writer, int symbol) {
+        if (symbol < 144) {
+            writer.Code(0x30 + symbol, 8);
+        }
+        else if (symbol < 256) {
+            writer.Code(0x190 + symbol - 144, 9);
+        }
+        else if (symbol < 280) {
+            writer.Code(symbol - 256, 7);
+        }
+        else {
+            writer.Code(0xC0 + symbol - 280, 8);
+        }
+    }
+
+    static constexpr std::uint16_t LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static constexpr std::uint8_t LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static constexpr std::uint16_t DistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    static constexpr std::uint8_t DistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    static void Match(BitWriter& writer, int length, int distance) {
+        auto l = (int)(std::upper_bound(std::begin(LengthBase), std::end(LengthBase), length) - std::begin(LengthBase)) - 1;
+        Symbol(writer, 257 + l);
+        writer.Bits(length - LengthBase[l], LengthExtra[l]);
+        auto d = (int)(std::upper_bound(std::begin(DistanceBase), std::end(DistanceBase), distance) - std::begin(DistanceBase)) - 1;
+        writer.Code(d, 5);
+        writer.Bits(distance - DistanceBase[d], DistanceExtra[d]);
+    }
+
+    // A zlib stream of one fixed Huffman block
+    static void Deflate(const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& out) {
+        constexpr int HashBits = 15;
+        constexpr std::size_t Window = 32768, MinMatch = 3, MaxMatch = 258;
+        thread_local std::vector<std::int64_t> head;
+        head.assign((std::size_t)1 << HashBits, -1);
+
+        out.push_back(0x78);
+        out.push_back(0x01);
+        BitWriter writer(out);
+        writer.Bits(1, 1);  // Final block
+        writer.Bits(1, 2);  // Fixed codes
+
+        std::size_t i = 0;
+        while (i < size) {
+            std::size_t length = 0, distance = 0;
+            if (i + MinMatch <= size) {
+                auto hash = ((data[i] << 16 | data[i + 1] << 8 | data[i + 2]) * 2654435761u) >> (32 - HashBits);
+                auto candidate = head[hash];
+                head[hash] = (std::int64_t)i;
+                if (candidate >= 0 && i - (std::size_t)candidate <= Window) {
+                    auto limit = std::min(MaxMatch, size - i);
+                    auto from = data + candidate, to = data + i;
+                    while (length < limit && from[length] == to[length]) {
+                        length++;
+                    }
+                    distance = i - (std::size_t)candidate;
+                }
+            }
+            if (length >= MinMatch) {
+                Match(writer, (int)length, (int)distance);
+                // Only the end of a long match goes into the table, enough to chain runs together
+                auto end = i + length;
+                for (auto k = std::max(i + 1, end > MinMatch ? end - MinMatch : 0); k < end && k + MinMatch <= size; k++) {
+                    auto hash = ((data[k] << 16 | data[k + 1] << 8 | data[k + 2]) * 2654435761u) >> (32 - HashBits);
+                    head[hash] = (std::int64_t)k;
+                }
+                i = end;
+            }
+            else {
+                Symbol(writer, data[i]);
+                i++;
+            }
+        }
+        Symbol(writer, 256);
+        writer.Flush();
+
+        auto adler = Adler32(data, size);
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back((std::uint8_t)(adler >> shift));
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    static void Put32(std::vector<std::uint8_t>& out, std::uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back((std::uint8_t)(value >> shift));
+        }
+    }
+
+    static void Chunk(std::vector<std::uint8_t>& out, const char* type, const std::uint8_t* data, std::size_t size) {
+        Put32(out, (std::uint32_t)size);
+        auto start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data, data + size);
+        Put32(out, Crc32(out.data() + start, size + 4));
+    }
+
+    void Encode(const std::uint8_t* rgba, int width, int height, std::size_t stride, bool alpha, std::vector<std::uint8_t>& out) {
+        auto channels = alpha ? 4 : 3;
+        auto rowBytes = (std::size_t)width * channels;
+
+        // Each row with whichever of None, Sub and Up leaves the smallest sum of magnitudes
+        thread_local std::vector<std::uint8_t> filtered, previous, row, candidate[3];
+        filtered.resize((rowBytes + 1) * height);
+        previous.assign(rowBytes, 0);
+        row.resize(rowBytes);
+        for (auto& c : candidate) {
+            c.resize(rowBytes);
+        }
+        for (int y = 0; y < height; y++) {
+            auto source = rgba + (std::size_t)y * stride;
+            for (int x = 0; x < width; x++) {
+                std::memcpy(row.data() + (std::size_t)x * channels, source + (std::size_t)x * 4, channels);
+            }
+            std::uint64_t cost[3] = {};
+            for (std::size_t i = 0; i < rowBytes; i++) {
+                auto left = i >= (std::size_t)channels ? row[i - channels] : 0;
+                candidate[0][i] = row[i];
+                candidate[1][i] = (std::uint8_t)(row[i] - left);
+                candidate[2][i] = (std::uint8_t)(row[i] - previous[i]);
+                for (int f = 0; f < 3; f++) {
+                    cost[f] += (std::uint64_t)std::abs((int)(std::int8_t)candidate[f][i]);
+                }
+            }
+            auto best = (int)(std::min_element(cost, cost + 3) - cost);
+            auto target = filtered.data() + (std::size_t)y * (rowBytes + 1);
+            target[0] = (std::uint8_t)best;
+            std::memcpy(target + 1, candidate[best].data(), rowBytes);
+            std::swap(previous, row);
+        }
+
+        static constexpr std::uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        out.insert(out.end(), Signature, Signature + 8);
+
+        std::uint8_t header[13];
+        for (int i = 0; i < 4; i++) {
+            header[i] = (std::uint8_t)(width >> (24 - 8 * i));
+            header[4 + i] = (std::uint8_t)(height >> (24 - 8 * i));
+        }
+        header[8] = 8;                  // Bits per channel
+        header[9] = alpha ? 6 : 2;      // RGBA or RGB
+        header[10] = 0;                 // Deflate
+        header[11] = 0;                 // Adaptive filters
+        header[12] = 0;                 // Not interlaced
+        Chunk(out, "IHDR", header, sizeof(header));
+
+        thread_local std::vector<std::uint8_t> compressed;
+        compressed.clear();
+        Deflate(filtered.data(), filtered.size(), compressed);
+        Chunk(out, "IDAT", compressed.data(), compressed.size());
+        Chunk(out, "IEND", nullptr, 0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    // Bits from the least significant end, as deflate writes them. Reading past the end gives
+    // zeros and sets Overrun rather than failing on the spot, so the hot path stays branch-free.
+    class BitReader {
+    public:
+        BitReader(const std::uint8_t* data, std::size_t size) : Overrun(false), data(data), size(size), position(0), bits(0), count(0) {
+        }
+
+        std::uint32_t Peek(int n) {
+            if (count < n) {
+                Refill();
+            }
+            return (std::uint32_t)(bits & (((std::uint64_t)1 << n) - 1));
+        }
+
+        void Skip(int n) {
+            if (count < n) {
+                Refill();
+                if (count < n) {
+                    Overrun = true;
+                    count = n;
+                }
+            }
+            bits >>= n;
+            count -= n;
+        }
+
+        std::uint32_t Bits(int n) {
+            auto value = Peek(n);
+            Skip(n);
+            return value;
+        }
+
+        // Drops the bits up to the next byte and hands out the bytes that follow in place
+        const std::uint8_t* Bytes(std::size_t n) {
+            Skip(count & 7);
+            // Whole bytes still in the buffer go back first
+            position -= (std::size_t)count / 8;
+            bits = 0;
+            count = 0;
+            if (n > size - position) {
+                Overrun = true;
+                return nullptr;
+            }
+            auto bytes = data + position;
+            position += n;
+            return bytes;
+        }
+
+        bool Overrun;
+    private:
+        const std::uint8_t* data;
+        std::size_t size, position;
+        std::uint64_t bits;
+        int count;
+
+        void Refill() {
+            while (count <= 56 && position < size) {
+                bits |= (std::uint64_t)data[position++] << count;
+                count += 8;
+            }
+        }
+    };
+
+    // A canonical code of RFC 1951 3.2.2. Codes up to FastBits long come out of one table
+    // lookup, the rare longer ones are walked a bit at a time.
+    class Huffman {
+    public:
+        static constexpr int MaxBits = 15;
+        static constexpr int FastBits = 10;
+
+        // False if the lengths over-subscribe the code. An incomplete code is allowed, as zlib does.
+        bool Build(const std::uint8_t* lengths, int n) {
+            std::fill(std::begin(counts), std::end(counts), (std::uint16_t)0);
+            for (int i = 0; i < n; i++) {
+                counts[lengths[i]]++;
+            }
+            counts[0] = 0;
+            int left = 1;
+            for (int length = 1; length <= MaxBits; length++) {
+                left = left * 2 - counts[length];
+                if (left < 0) {
+                    return false;
+                }
+            }
+
+            std::uint16_t offsets[MaxBits + 2] = {};
+            for (int length = 1; length <= MaxBits; length++) {
+                offsets[length + 1] = offsets[length] + counts[length];
+            }
+            for (int i = 0; i < n; i++) {
+                if (lengths[i] != 0) {
+                    symbols[offsets[lengths[i]]++] = (std::uint16_t)i;
+                }
+            }
+
+            std::fill(std::begin(fast), std::end(fast), (std::uint16_t)0);
+            std::uint32_t code = 0;
+            int index = 0;
+            for (int length = 1; length <= FastBits; length++) {
+                for (int k = 0; k < counts[length]; k++, code++) {
+                    std::uint32_t reversed = 0;
+                    for (int i = 0; i < length; i++) {
+                        reversed = (reversed << 1) | ((code >> i) & 1);
+                    }
+                    auto entry = (std::uint16_t)(length << 9 | symbols[index++]);
+                    for (auto r = reversed; r < (1u << FastBits); r += 1u << length) {
+                        fast[r] = entry;
+                    }
+                }
+                code <<= 1;
+            }
+            return true;
+        }
+
+        // -1 for a code that is not in the table
+        int Decode(BitReader& reader) const {
+            auto entry = fast[reader.Peek(FastBits)];
+            if (entry != 0) {
+                reader.Skip(entry >> 9);
+                return entry & 0x1FF;
+            }
+            int code = 0, first = 0, index = 0;
+            for (int length = 1; length <= MaxBits; length++) {
+                code |= (int)reader.Bits(1);
+                auto count = (int)counts[length];
+                if (code - count < first) {
+                    return symbols[index + code - first];
+                }
+                index += count;
+                first = (first + count) << 1;
+                code <<= 1;
+            }
+            return -1;
+        }
+    private:
+        std::uint16_t counts[MaxBits + 1];
+        std::uint16_t symbols[288];
+        std::uint16_t fast[1 << FastBits];  // Length << 9 | symbol, 0 where a longer code starts
+    };
+
+    static bool Codes(BitReader& reader, Huffman& literals, Huffman& distances) {
+        static constexpr std::uint8_t Order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+        auto literalCount = (int)reader.Bits(5) + 257;
+        auto distanceCount = (int)reader.Bits(5) + 1;
+        auto lengthCount = (int)reader.Bits(4) + 4;
+        if (literalCount > 286 || distanceCount > 30) {
+            return false;
+        }
+
+        std::uint8_t lengths[286 + 30] = {};
+        for (int i = 0; i < lengthCount; i++) {
+            lengths[Order[i]] = (std::uint8_t)reader.Bits(3);
+        }
+        Huffman lengthCode;
+        if (!lengthCode.Build(lengths, 19)) {
+            return false;
+        }
+
+        std::fill(std::begin(lengths), std::end(lengths), (std::uint8_t)0);
+        for (int i = 0; i < literalCount + distanceCount; ) {
+            auto symbol = lengthCode.Decode(reader);
+            if (symbol < 0 || reader.Overrun) {
+                return false;
+            }
+            if (symbol < 16) {
+                lengths[i++] = (std::uint8_t)symbol;
+                continue;
+            }
+            std::uint8_t length = 0;
+            int repeat;
+            if (symbol == 16) {
+                if (i == 0) {
+                    return false;
+                }
+                length = lengths[i - 1];
+                repeat = 3 + (int)reader.Bits(2);
+            }
+            else if (symbol == 17) {
+                repeat = 3 + (int)reader.Bits(3);
+            }
+            else {
+                repeat = 11 + (int)reader.Bits(7);
+            }
+            if (i + repeat > literalCount + distanceCount) {
+                return false;
+            }
+            while (repeat-- > 0) {
+                lengths[i++] = length;
+            }
+        }
+        // Without an end of block code no block could ever finish
+        return lengths[256] != 0 && literals.Build(lengths, literalCount) && distances.Build(lengths + literalCount, distanceCount);
+    }
+
+    static bool Inflate(const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& out) {
+        if (size < 6 || (data[0] & 0x0F) != 8 || (data[0] >> 4) > 7 || (data[1] & 0x20) != 0 || (data[0] << 8 | data[1]) % 31 != 0) {
+            return false;
+        }
+        BitReader reader(data + 2, size - 2);
+        Huffman literals, distances;
+        auto final = false;
+        while (!final) {
+            final = reader.Bits(1) != 0;
+            auto type = reader.Bits(2);
+            if (type == 0) {
+                auto header = reader.Bytes(4);
+                if (header == nullptr || (header[0] | header[1] << 8) != (~(header[2] | header[3] << 8) & 0xFFFF)) {
+                    return false;
+                }
+                std::size_t length = header[0] | header[1] << 8;
+                auto bytes = reader.Bytes(length);
+                if (bytes == nullptr) {
+                    return false;
+                }
+                out.insert(out.end(), bytes, bytes + length);
+                continue;
+            }
+            if (type == 1) {
+                std::uint8_t lengths[288 + 30];
+                std::fill(lengths, lengths + 144, (std::uint8_t)8);
+                std::fill(lengths + 144, lengths + 256, (std::uint8_t)9);
+                std::fill(lengths + 256, lengths + 280, (std::uint8_t)7);
+                std::fill(lengths + 280, lengths + 288, (std::uint8_t)8);
+                std::fill(lengths + 288, lengths + 318, (std::uint8_t)5);
+                literals.Build(lengths, 288);
+                distances.Build(lengths + 288, 30);
+            }
+            else if (type != 2 || !Codes(reader, literals, distances)) {
+                return false;
+            }
+
+            for (;;) {
+                auto symbol = literals.Decode(reader);
+                if (symbol < 0 || reader.Overrun) {
+                    return false;
+                }
+                if (symbol < 256) {
+                    out.push_back((std::uint8_t)symbol);
+                    continue;
+                }
+                if (symbol == 256) {
+                    break;
+                }
+                auto l = symbol - 257;
+                if (l >= 29) {
+                    return false;
+                }
+                std::size_t length = LengthBase[l] + reader.Bits(LengthExtra[l]);
+                auto d = distances.Decode(reader);
+                if (d < 0 || d >= 30) {
+                    return false;
+                }
+                std::size_t distance = DistanceBase[d] + reader.Bits(DistanceExtra[d]);
+                if (distance > out.size()) {
+                    return false;
+                }
+                // Byte by byte, a match may overlap what it copies
+                auto from = out.size() - distance;
+                out.resize(out.size() + length);
+                auto target = out.data() + out.size() - length;
+                for (std::size_t i = 0; i < length; i++) {
+                    target[i] = out[from + i];
+                }
+            }
+        }
+
+        auto trailer = reader.Bytes(4);
+        if (trailer == nullptr || reader.Overrun) {
+            return false;
+        }
+        auto adler = (std::uint32_t)trailer[0] << 24 | trailer[1] << 16 | trailer[2] << 8 | trailer[3];
+        return adler == Adler32(out.data(), out.size());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    static std::uint32_t Get32(const std::uint8_t* data) {
+        return (std::uint32_t)data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3];
+    }
+
+    static std::uint8_t Paeth(int a, int b, int c) {
+        auto p = a + b - c;
+        auto pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+        return (std::uint8_t)(pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+    }
+
+    bool Decode(const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& rgba, int& width, int& height) {
+        static constexpr std::uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        if (size < 8 || std::memcmp(data, Signature, 8) != 0) {
+            return false;
+        }
+
+        std::uint32_t w = 0, h = 0;
+        int depth = 0, colour = -1;
+        std::uint8_t palette[256][4] = {};
+        int paletteSize = 0;
+        // Gray or RGB samples that stand for transparent, -1 if none
+        int key[3] = { -1, -1, -1 };
+        thread_local std::vector<std::uint8_t> compressed;
+        compressed.clear();
+        auto ended = false;
+        for (std::size_t at = 8; !ended; ) {
+            if (size - at < 12) {
+                return false;
+            }
+            auto length = Get32(data + at);
+            if (length > size - at - 12) {
+                return false;
+            }
+            auto type = data + at + 4, body = data + at + 8;
+            if (Crc32(type, length + 4) != Get32(body + length)) {
+                return false;
+            }
+            if (std::memcmp(type, "IHDR", 4) == 0) {
+                if (length != 13) {
+                    return false;
+                }
+                w = Get32(body);
+                h = Get32(body + 4);
+                depth = body[8];
+                colour = body[9];
+                if (body[10] != 0 || body[11] != 0 || body[12] != 0) {
+                    return false;
+                }
+            }
+            else if (std::memcmp(type, "PLTE", 4) == 0) {
+                if (length % 3 != 0 || length > 768) {
+                    return false;
+                }
+                paletteSize = (int)length / 3;
+                for (int i = 0; i < paletteSize; i++) {
+                    palette[i][0] = body[i * 3];
+                    palette[i][1] = body[i * 3 + 1];
+                    palette[i][2] = body[i * 3 + 2];
+                    palette[i][3] = 255;
+                }
+            }
+            else if (std::memcmp(type, "tRNS", 4) == 0) {
+                if (colour == 3) {
+                    for (std::uint32_t i = 0; i < length && i < 256; i++) {
+                        palette[i][3] = body[i];
+                    }
+                }
+                else if (colour == 0 && length == 2) {
+                    key[0] = body[0] << 8 | body[1];
+                }
+                else if (colour == 2 && length == 6) {
+                    for (int c = 0; c < 3; c++) {
+                        key[c] = body[c * 2] << 8 | body[c * 2 + 1];
+                    }
+                }
+            }
+            else if (std::memcmp(type, "IDAT", 4) == 0) {
+                compressed.insert(compressed.end(), body, body + length);
+            }
+            else if (std::memcmp(type, "IEND", 4) == 0) {
+                ended = true;
+            }
+            else if ((type[0] & 0x20) == 0) {
+                // An ancillary chunk can be skipped, a critical one it does not know can not
+                return false;
+            }
+            at += (std::size_t)length + 12;
+        }
+
+        int channels;
+        switch (colour) {
+        case 0: channels = 1; break;
+        case 2: channels = 3; break;
+        case 3: channels = 1; break;
+        case 4: channels = 2; break;
+        case 6: channels = 4; break;
+        default: return false;
+        }
+        auto validDepth = depth == 8 || (depth == 16 && colour != 3) || ((depth == 1 || depth == 2 || depth == 4) && (colour == 0 || colour == 3));
+        if (!validDepth || w == 0 || h == 0 || w > 0x7FFFFFFF / 8 || h > 0x7FFFFFFF || (colour == 3 && paletteSize == 0)) {
+            return false;
+        }
+
+        auto bitsPerPixel = channels * depth;
+        auto rowBytes = ((std::size_t)w * bitsPerPixel + 7) / 8;
+        // The byte to the left for the filters, a whole pixel back or one byte for packed samples
+        auto left = (std::size_t)std::max(1, bitsPerPixel / 8);
+        thread_local std::vector<std::uint8_t> raw;
+        raw.clear();
+        raw.reserve((rowBytes + 1) * h);
+        if (!Inflate(compressed.data(), compressed.size(), raw) || raw.size() < (rowBytes + 1) * h) {
+            return false;
+        }
+
+        rgba.resize((std::size_t)w * h * 4);
+        auto maximum = (1 << depth) - 1;
+        // Down to 8 bits: the high byte of 16, low depths stretched over the whole range
+        auto scale = [&](int sample) {
+            return (std::uint8_t)(depth == 16 ? sample >> 8 : sample * 255 / maximum);
+        };
+        for (std::uint32_t y = 0; y < h; y++) {
+            auto row = raw.data() + (std::size_t)y * (rowBytes + 1);
+            auto filter = row[0];
+            auto line = row + 1;
+            auto above = y > 0 ? line - (rowBytes + 1) : nullptr;
+            for (std::size_t i = 0; i < rowBytes; i++) {
+                int a = i >= left ? line[i - left] : 0;
+                int b = above != nullptr ? above[i] : 0;
+                int c = above != nullptr && i >= left ? above[i - left] : 0;
+                switch (filter) {
+                case 0: break;
+                case 1: line[i] = (std::uint8_t)(line[i] + a); break;
+                case 2: line[i] = (std::uint8_t)(line[i] + b); break;
+                case 3: line[i] = (std::uint8_t)(line[i] + (a + b) / 2); break;
+                case 4: line[i] = (std::uint8_t)(line[i] + Paeth(a, b, c)); break;
+                default: return false;
+                }
+            }
+
+            auto target = rgba.data() + (std::size_t)y * w * 4;
+            for (std::uint32_t x = 0; x < w; x++, target += 4) {
+                int samples[4];
+                for (int c = 0; c < channels; c++) {
+                    if (depth == 16) {
+                        auto at = line + ((std::size_t)x * channels + c) * 2;
+                        samples[c] = at[0] << 8 | at[1];
+                    }
+                    else {
+                        auto bit = ((std::size_t)x * channels + c) * depth;
+                        samples[c] = (line[bit / 8] >> (8 - depth - bit % 8)) & maximum;
+                    }
+                }
+                switch (colour) {
+                case 0:
+                    target[0] = target[1] = target[2] = scale(samples[0]);
+                    target[3] = samples[0] == key[0] ? 0 : 255;
+                    break;
+                case 2:
+                    for (int c = 0; c < 3; c++) {
+                        target[c] = scale(samples[c]);
+                    }
+                    target[3] = samples[0] == key[0] && samples[1] == key[1] && samples[2] == key[2] ? 0 : 255;
+                    break;
+                case 3:
+                    if (samples[0] >= paletteSize) {
+                        return false;
+                    }
+                    std::memcpy(target, palette[samples[0]], 4);
+                    break;
+                case 4:
+                    target[0] = target[1] = target[2] = scale(samples[0]);
+                    target[3] = scale(samples[1]);
+                    break;
+                case 6:
+                    for (int c = 0; c < 4; c++) {
+                        target[c] = scale(samples[c]);
+                    }
+                    break;
+                }
+            }
+        }
+        width = (int)w;
+        height = (int)h;
+        return true;
+    }
+}
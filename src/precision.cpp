@@ -0,0 +1,88 @@
+#include "../include/precision.h"
+#include "../include/simulation_state.h"
+#include <algorithm>
+
+namespace Simulation {
+    template<>
+    const char* PrecisionName<float>() {
+        return "float";
+    }
+
+    template<>
+    const char* PrecisionName<double>() {
+        return "double";
+    }
+
+    template<>
+    const char* PrecisionName<long double>() {
+        return "long double";
+    }
+
+    template<class T>
+    static void InitializeDriftScenario(BasicSimulationState<T>& state, std::size_t satellites) {
+        state.InitializeEarth(T(110.5l), T(960), T(540));
+        state.InitializeSatellite(T(200));
+        state.Satellites.Reserve(satellites);
+        for (std::size_t i = 0; i < satellites; i++) {
+            auto t = (long double)i / satellites;
+            auto radius = 1.5l * 110.5l + 4.5l * 110.5l * t;
+            auto period = 30.0l * std::pow(radius / 442.0l, 1.5l);
+            state.Satellites.Add(T(radius), T(period), T(2.0l * PI * t));
+        }
+        state.Satellites.Update(state.Earth);
+    }
+
+    static double AngleDistance(long double a, long double b) {
+        auto d = std::fmod(std::abs(a - b), 360.0l);
+        return (double)std::min(d, 360.0l - d);
+    }
+
+    template<class T>
+    DriftReport MeasureDrift(const std::uint64_t* checkpoints, std::size_t count, long double dtSeconds) {
+        constexpr std::size_t Satellites = 16;
+
+        DriftReport report = {};
+        report.Precision = PrecisionName<T>();
+        report.BytesPerSatellite = BasicConstellation<T>::BytesPerSatellite;
+        report.Satellites = Satellites + 1;
+
+        BasicSimulationState<T> state;
+        BasicSimulationState<long double> reference;
+        InitializeDriftScenario(state, Satellites);
+        InitializeDriftScenario(reference, Satellites);
+
+        std::uint64_t steps = 0;
+        count = std::min(count, std::size(report.Samples));
+        for (std::size_t k = 0; k < count; k++) {
+            state.StepN(checkpoints[k] - steps, T(dtSeconds));
+            reference.StepN(checkpoints[k] - steps, dtSeconds);
+            steps = checkpoints[k];
+
+            DriftSample sample = { steps, 0.0, 0.0, 0.0 };
+            // The displayed satellite
+            {
+                const auto& s = state.Satellite;
+                const auto& r = reference.Satellite;
+                sample.Position = (double)std::hypot(s.X - r.X, s.Y - r.Y);
+                sample.Angle = AngleDistance(s.AngleDegrees, r.AngleDegrees);
+                sample.Field = (double)std::hypot(state.CircularField.DirectionX - reference.CircularField.DirectionX,
+                                                  state.CircularField.DirectionY - reference.CircularField.DirectionY);
+            }
+            // The constellation
+            const auto& s = state.Satellites;
+            const auto& r = reference.Satellites;
+            for (std::size_t i = 0; i < s.Size(); i++) {
+                sample.Position = std::max(sample.Position, (double)std::hypot(s.X[i] - r.X[i], s.Y[i] - r.Y[i]));
+                sample.Angle = std::max(sample.Angle, AngleDistance(s.AngleDegrees[i], r.AngleDegrees[i]));
+                sample.Field = std::max(sample.Field, (double)std::hypot(s.FieldDirectionX[i] - r.FieldDirectionX[i],
+                                                                         s.FieldDirectionY[i] - r.FieldDirectionY[i]));
+            }
+            report.Samples[report.SampleCount++] = sample;
+        }
+        return report;
+    }
+
+    template DriftReport MeasureDrift<float>(const std::uint64_t*, std::size_t, long double);
+    template DriftReport MeasureDrift<double>(const std::uint64_t*, std::size_t, long double);
+    template DriftReport MeasureDrift<long double>(const std::uint64_t*, std::size_t, long double);
+}
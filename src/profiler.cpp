@@ -0,0 +1,244 @@
+#include "../include/profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(SIMULATION_PROFILING)
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace Simulation::Profiler {
+    double ZoneSummary::MeanMicroseconds() const {
+        return Count > 0 ? TotalMicroseconds / Count : 0.0;
+    }
+
+    double ZoneSummary::PercentileMicroseconds(double fraction) const {
+        auto target = (std::uint64_t)std::ceil(std::clamp(fraction, 0.0, 1.0) * Count);
+        std::uint64_t seen = 0;
+        for (std::size_t b = 0; b < Buckets; b++) {
+            seen += Histogram[b];
+            if (seen >= target && seen > 0) {
+                return FirstBucketMicroseconds * std::exp2((b + 1) / 8.0);
+            }
+        }
+        return MaxMicroseconds;
+    }
+
+#if defined(SIMULATION_PROFILING)
+    namespace {
+        struct ThreadBuffer {
+            Event Events[EventsPerThread];
+            // Index of the next event, Events holds the EventsPerThread before it
+            std::atomic<std::uint64_t> Head{ 0 };
+            // Events before this one were cleared
+            std::atomic<std::uint64_t> Floor{ 0 };
+            std::atomic<const char*> Name{ nullptr };
+            std::uint32_t Id = 0;
+            // Only touched by the owning thread
+            std::uint32_t Depth = 0;
+        };
+
+        std::chrono::steady_clock::time_point Epoch() {
+            static const auto epoch = std::chrono::steady_clock::now();
+            return epoch;
+        }
+
+        // Buffers live until the process ends, a thread's events outlive the thread
+        std::mutex& RegistryMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::vector<std::unique_ptr<ThreadBuffer>>& Registry() {
+            static std::vector<std::unique_ptr<ThreadBuffer>> registry;
+            return registry;
+        }
+
+        thread_local ThreadBuffer* current = nullptr;
+
+        ThreadBuffer& Current() {
+            if (current == nullptr) {
+                auto buffer = std::make_unique<ThreadBuffer>();
+                std::lock_guard lock(RegistryMutex());
+                buffer->Id = (std::uint32_t)Registry().size() + 1;
+                current = buffer.get();
+                Registry().push_back(std::move(buffer));
+            }
+            return *current;
+        }
+
+        // The buffer's events, oldest first, without those its thread overwrote during the copy.
+        // Call with the registry locked.
+        void CopyEvents(const ThreadBuffer& buffer, std::vector<Event>& out) {
+            out.clear();
+            auto head = buffer.Head.load(std::memory_order_acquire);
+            auto from = std::max(buffer.Floor.load(std::memory_order_relaxed), head > EventsPerThread ? head - EventsPerThread : 0);
+            for (auto i = from; i < head; i++) {
+                out.push_back(buffer.Events[i % EventsPerThread]);
+            }
+            // The slot of index head - EventsPerThread may be half written by now
+            auto after = buffer.Head.load(std::memory_order_acquire);
+            auto valid = after >= EventsPerThread ? after - EventsPerThread + 1 : 0;
+            if (valid > from) {
+                out.erase(out.begin(), out.begin() + (std::ptrdiff_t)std::min<std::uint64_t>(valid - from, out.size()));
+            }
+        }
+
+        std::size_t Bucket(double microseconds) {
+            if (microseconds <= ZoneSummary::FirstBucketMicroseconds) {
+                return 0;
+            }
+            auto b = (std::size_t)(8.0 * std::log2(microseconds / ZoneSummary::FirstBucketMicroseconds));
+            return std::min(b, ZoneSummary::Buckets - 1);
+        }
+
+        void WriteEscaped(std::FILE* file, const char* text) {
+            for (auto c = text; *c != 0; c++) {
+                if (*c == '"' || *c == '\\') {
+                    std::fputc('\\', file);
+                    std::fputc(*c, file);
+                }
+                else if ((unsigned char)*c < 0x20) {
+                    std::fprintf(file, "\\u%04x", (unsigned)(unsigned char)*c);
+                }
+                else {
+                    std::fputc(*c, file);
+                }
+            }
+        }
+    }
+
+    void SetThreadName(const char* name) {
+        Current().Name.store(name, std::memory_order_relaxed);
+    }
+
+    std::int64_t Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch()).count();
+    }
+
+    Zone::Zone(const char* name) : name(name) {
+        Current().Depth++;
+        begin = Now();
+    }
+
+    Zone::~Zone() {
+        auto end = Now();
+        auto& buffer = Current();
+        buffer.Depth--;
+        auto head = buffer.Head.load(std::memory_order_relaxed);
+        buffer.Events[head % EventsPerThread] = { name, begin, end, buffer.Depth };
+        buffer.Head.store(head + 1, std::memory_order_release);
+    }
+
+    std::size_t Summarize(std::chrono::nanoseconds window, ZoneSummary* summaries, std::size_t capacity) {
+        static std::mutex mutex;
+        static std::vector<Event> events;
+        std::lock_guard summarizing(mutex);
+        std::lock_guard lock(RegistryMutex());
+
+        auto since = Now() - window.count();
+        std::size_t count = 0;
+        for (const auto& buffer : Registry()) {
+            CopyEvents(*buffer, events);
+            auto first = count;
+            auto thread = buffer->Name.load(std::memory_order_relaxed);
+            for (const auto& event : events) {
+                if (event.End < since) {
+                    continue;
+                }
+                auto summary = summaries + first;
+                auto last = summaries + count;
+                while (summary < last && summary->Name != event.Name) {
+                    summary++;
+                }
+                if (summary == last) {
+                    // A zone not seen yet on this thread
+                    if (count == capacity) {
+                        continue;
+                    }
+                    count++;
+                    *summary = {};
+                    summary->Name = event.Name;
+                    summary->Thread = thread != nullptr ? thread : "thread";
+                    summary->Depth = event.Depth;
+                }
+                auto microseconds = (event.End - event.Begin) * 1e-3;
+                summary->Count++;
+                summary->TotalMicroseconds += microseconds;
+                summary->MaxMicroseconds = std::max(summary->MaxMicroseconds, microseconds);
+                summary->Histogram[Bucket(microseconds)]++;
+            }
+            // Outer zones first, otherwise as they first appeared: inner zones end, and are recorded, first
+            std::stable_sort(summaries + first, summaries + count,
+                             [](const ZoneSummary& a, const ZoneSummary& b) { return a.Depth < b.Depth; });
+        }
+        return count;
+    }
+
+    bool WriteChromeTrace(const char* path) {
+        auto file = std::fopen(path, "w");
+        if (file == nullptr) {
+            return false;
+        }
+        std::vector<Event> events;
+        std::lock_guard lock(RegistryMutex());
+        std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+        auto separator = "";
+        for (const auto& buffer : Registry()) {
+            auto name = buffer->Name.load(std::memory_order_relaxed);
+            if (name != nullptr) {
+                std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", separator, buffer->Id);
+                WriteEscaped(file, name);
+                std::fputs("\"}}", file);
+                separator = ",\n";
+            }
+            CopyEvents(*buffer, events);
+            for (const auto& event : events) {
+                std::fprintf(file, "%s{\"name\":\"", separator);
+                WriteEscaped(file, event.Name);
+                std::fprintf(file, "\",\"cat\":\"simulation\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                             event.Begin * 1e-3, (event.End - event.Begin) * 1e-3, buffer->Id);
+                separator = ",\n";
+            }
+        }
+        std::fputs("\n]}\n", file);
+        return std::fclose(file) == 0;
+    }
+
+    void Clear() {
+        std::lock_guard lock(RegistryMutex());
+        for (const auto& buffer : Registry()) {
+            buffer->Floor.store(buffer->Head.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    }
+#else
+    void SetThreadName(const char*) {
+    }
+
+    std::int64_t Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::size_t Summarize(std::chrono::nanoseconds, ZoneSummary*, std::size_t) {
+        return 0;
+    }
+
+    bool WriteChromeTrace(const char*) {
+        return false;
+    }
+
+    void Clear() {
+    }
+
+    Zone::Zone(const char* name) : name(name), begin(0) {
+    }
+
+    Zone::~Zone() {
+    }
+#endif
+}
@@ -0,0 +1,151 @@
+#include "../include/replay.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Simulation {
+    bool Replay::Open(const std::string& path) {
+        keyframes.clear();
+        if (!file.Open(path) || file.Rows() == 0) {
+            return false;
+        }
+        begin = Time(0);
+        end = Time(file.Rows() - 1);
+
+        // One pass down the time column: keyframe k is the last row at or before begin + k intervals,
+        // settled by the first row past that point
+        keyframes.assign((std::size_t)((end - begin) / KeyframeNanoseconds) + 1, 0);
+        std::size_t next = 0;
+        std::uint64_t row = 0;
+        for (std::size_t block = 0; block < file.Blocks(); block++) {
+            auto times = file.Times(block);
+            auto rows = file.RowsIn(block);
+            for (std::size_t i = 0; i < rows; i++, row++) {
+                while (next < keyframes.size() && begin + (std::int64_t)next * KeyframeNanoseconds < times[i]) {
+                    keyframes[next++] = row - 1;
+                }
+            }
+        }
+        while (next < keyframes.size()) {
+            keyframes[next++] = file.Rows() - 1;
+        }
+        position = begin;
+        carry = 0;
+        return true;
+    }
+
+    std::uint64_t Replay::Rows() const {
+        return file.Rows();
+    }
+
+    std::size_t Replay::Keyframes() const {
+        return keyframes.size();
+    }
+
+    std::int64_t Replay::BeginNanoseconds() const {
+        return begin;
+    }
+
+    std::int64_t Replay::EndNanoseconds() const {
+        return end;
+    }
+
+    std::int64_t Replay::Position() const {
+        return position;
+    }
+
+    void Replay::Seek(std::int64_t nanoseconds) {
+        position = std::clamp(nanoseconds, begin, end);
+        carry = 0;
+    }
+
+    bool Replay::Paused() const {
+        return paused;
+    }
+
+    void Replay::SetPaused(bool value) {
+        paused = value;
+    }
+
+    double Replay::Speed() const {
+        return speed;
+    }
+
+    void Replay::SetSpeed(double value) {
+        speed = std::clamp(value, MinSpeed, MaxSpeed);
+    }
+
+    void Replay::Advance(std::chrono::nanoseconds real) {
+        if (paused || real.count() <= 0) {
+            return;
+        }
+        auto step = real.count() * speed + carry;
+        auto whole = std::floor(step);
+        carry = step - whole;
+        position = whole >= (double)(end - position) ? end : position + (std::int64_t)whole;
+    }
+
+    std::uint64_t Replay::Find(std::int64_t nanoseconds) const {
+        if (nanoseconds <= begin) {
+            return 0;
+        }
+        auto k = std::min((std::size_t)((nanoseconds - begin) / KeyframeNanoseconds), keyframes.size() - 1);
+        // The answer lies between this keyframe and the next one
+        auto low = keyframes[k];
+        auto high = k + 1 < keyframes.size() ? keyframes[k + 1] : file.Rows() - 1;
+        while (low < high) {
+            auto middle = low + (high - low + 1) / 2;
+            if (Time(middle) <= nanoseconds) {
+                low = middle;
+            }
+            else {
+                high = middle - 1;
+            }
+        }
+        return low;
+    }
+
+    std::int64_t Replay::Time(std::uint64_t row) const {
+        auto blockRows = file.BlockRows();
+        return file.Times((std::size_t)(row / blockRows))[row % blockRows];
+    }
+
+    double Replay::Value(TelemetryColumn column, std::uint64_t row) const {
+        auto blockRows = file.BlockRows();
+        return file.Column(column, (std::size_t)(row / blockRows))[row % blockRows];
+    }
+
+    template<class T>
+    void Replay::Capture(BasicSnapshot<T>& snapshot) const {
+        auto row = Find(position);
+        const auto& scene = file.Scene();
+        snapshot.Tick = row;
+        snapshot.ElapsedNanoseconds = Time(row);
+        snapshot.TimeWarp = speed;
+        snapshot.Earth = { (T)scene.EarthRadius, (T)scene.EarthX, (T)scene.EarthY };
+
+        auto& satellite = snapshot.Satellite;
+        satellite.Radius = (T)scene.SatelliteRadius;
+        satellite.RadiusTrajectory = (T)scene.RadiusTrajectory;
+        satellite.X = (T)Value(TelemetryColumn::X, row);
+        satellite.Y = (T)Value(TelemetryColumn::Y, row);
+        satellite.PeriodSeconds = (T)Value(TelemetryColumn::Period, row);
+        satellite.AngleDegrees = (T)Value(TelemetryColumn::Angle, row);
+        satellite.AngleRadians = satellite.AngleDegrees * Pi<T> / T(180);
+        // Whatever puts the satellite at this angle at this time
+        satellite.PhaseOffset = satellite.AngleDegrees / 360 - snapshot.ElapsedNanoseconds * 1e-9 / satellite.PeriodSeconds;
+        satellite.RadialDirectionX = (T)Value(TelemetryColumn::RadialX, row);
+        satellite.RadialDirectionY = (T)Value(TelemetryColumn::RadialY, row);
+        satellite.TangentDirectionX = (T)Value(TelemetryColumn::TangentX, row);
+        satellite.TangentDirectionY = (T)Value(TelemetryColumn::TangentY, row);
+
+        auto& field = snapshot.CircularField;
+        field.Radius = (T)Value(TelemetryColumn::FieldRadius, row);
+        field.DirectionX = (T)Value(TelemetryColumn::FieldX, row);
+        field.DirectionY = (T)Value(TelemetryColumn::FieldY, row);
+    }
+
+    template void Replay::Capture(BasicSnapshot<float>&) const;
+    template void Replay::Capture(BasicSnapshot<double>&) const;
+    template void Replay::Capture(BasicSnapshot<long double>&) const;
+}
@@ -0,0 +1,420 @@
+#include "../include/scenario.h"
+#include "../include/simulation_state.h"
+#include "../include/kepler.h"
+#include "../include/precision.h"
+#include "../include/profiler.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <system_error>
+#include <vector>
+
+namespace Simulation {
+    namespace {
+        // What one chunk of the text holds, in the order it appears
+        struct Chunk {
+            std::vector<double> Columns[ScenarioColumns];
+            // The last of each in the chunk, NaN if there is none
+            double PeriodSeconds = std::numeric_limits<double>::quiet_NaN();
+            double TrajectoryEarthRadii = std::numeric_limits<double>::quiet_NaN();
+            std::size_t Lines = 0;
+            std::size_t ErrorLine = 0;  // In the chunk, from 1, 0 if it parsed
+            std::string Error;
+        };
+
+        struct Line {
+            const char* Position;
+            const char* End;
+
+            void SkipSpaces() {
+                while (Position < End && (*Position == ' ' || *Position == '\t')) {
+                    Position++;
+                }
+            }
+
+            // Nothing but spaces left, comments and line ends already cut off
+            bool Empty() {
+                SkipSpaces();
+                return Position == End;
+            }
+
+            bool Word(const char*& word, std::size_t& length) {
+                SkipSpaces();
+                word = Position;
+                while (Position < End && *Position != ' ' && *Position != '\t') {
+                    Position++;
+                }
+                length = (std::size_t)(Position - word);
+                return length > 0;
+            }
+
+            bool Number(double& value) {
+                SkipSpaces();
+                auto [next, failure] = std::from_chars(Position, End, value);
+                if (failure != std::errc() || (next < End && *next != ' ' && *next != '\t') || !std::isfinite(value)) {
+                    return false;
+                }
+                Position = next;
+                return true;
+            }
+        };
+
+        constexpr auto DegreesToRadians = Pi<double> / 180;
+
+        // One record, false with the reason in error
+        bool ParseLine(Line line, Chunk& chunk, std::string& error) {
+            const char* word;
+            std::size_t length;
+            if (line.Empty()) {
+                return true;
+            }
+            line.Word(word, length);
+            auto is = [&](const char* keyword) {
+                return std::strlen(keyword) == length && std::memcmp(keyword, word, length) == 0;
+            };
+            double values[5];
+            std::size_t count;
+            if (is("period") || is("trajectory")) {
+                count = 1;
+            }
+            else if (is("circular")) {
+                count = 3;
+            }
+            else if (is("kepler")) {
+                count = 5;
+            }
+            else {
+                error = "unknown record '" + std::string(word, length) + "'";
+                return false;
+            }
+            for (std::size_t i = 0; i < count; i++) {
+                if (!line.Number(values[i])) {
+                    error = "expected " + std::to_string(count) + " numbers after '" + std::string(word, length) + "'";
+                    return false;
+                }
+            }
+            if (!line.Empty()) {
+                error = "more than " + std::to_string(count) + " numbers after '" + std::string(word, length) + "'";
+                return false;
+            }
+
+            auto& columns = chunk.Columns;
+            auto push = [&](ScenarioColumn column, double value) {
+                columns[(std::size_t)column].push_back(value);
+            };
+            if (is("period") || is("trajectory")) {
+                if (!(values[0] > 0)) {
+                    error = "not positive";
+                    return false;
+                }
+                (is("period") ? chunk.PeriodSeconds : chunk.TrajectoryEarthRadii) = values[0];
+            }
+            else if (is("circular")) {
+                if (!(values[0] > 0) || !(values[1] > 0)) {
+                    error = "radius and period have to be positive";
+                    return false;
+                }
+                push(ScenarioColumn::RadiusTrajectory, values[0]);
+                push(ScenarioColumn::PeriodSeconds, values[1]);
+                push(ScenarioColumn::AngleRadians, values[2] * DegreesToRadians);
+            }
+            else {
+                if (!(values[0] > 0) || !(values[4] > 0) || !(values[1] >= 0 && values[1] < 1)) {
+                    error = "semi-major axis and period have to be positive, eccentricity in [0, 1)";
+                    return false;
+                }
+                // The same clamp and derived values as BasicKeplerCatalog::Add
+                auto e = std::min(values[1], (double)BasicKeplerCatalog<double>::MaxEccentricity);
+                auto periapsis = values[2] * DegreesToRadians;
+                push(ScenarioColumn::SemiMajorAxis, values[0]);
+                push(ScenarioColumn::Eccentricity, e);
+                push(ScenarioColumn::ArgumentOfPeriapsis, periapsis);
+                push(ScenarioColumn::MeanAnomalyAtEpoch, values[3] * DegreesToRadians);
+                push(ScenarioColumn::MeanMotion, 2 * Pi<double> / values[4]);
+                push(ScenarioColumn::SemiMinorAxis, values[0] * std::sqrt(1 - e * e));
+                push(ScenarioColumn::CosPeriapsis, std::cos(periapsis));
+                push(ScenarioColumn::SinPeriapsis, std::sin(periapsis));
+            }
+            return true;
+        }
+
+        // Whole lines from begin to end, stopping at the first bad one
+        void ParseChunk(const char* begin, const char* end, Chunk& chunk) {
+            for (auto position = begin; position < end; ) {
+                auto newline = static_cast<const char*>(std::memchr(position, '\n', (std::size_t)(end - position)));
+                auto lineEnd = newline != nullptr ? newline : end;
+                chunk.Lines++;
+                auto comment = static_cast<const char*>(std::memchr(position, '#', (std::size_t)(lineEnd - position)));
+                auto contentEnd = comment != nullptr ? comment : lineEnd;
+                if (contentEnd > position && contentEnd[-1] == '\r') {
+                    contentEnd--;
+                }
+                if (!ParseLine({ position, contentEnd }, chunk, chunk.Error)) {
+                    chunk.ErrorLine = chunk.Lines;
+                    return;
+                }
+                position = lineEnd + 1;
+            }
+        }
+
+        bool WriteAll(std::FILE* file, const void* data, std::size_t bytes) {
+            return bytes == 0 || std::fwrite(data, 1, bytes, file) == bytes;
+        }
+
+        // The text's size and modification time, as the compiled header keeps them
+        bool Stamp(const std::string& path, std::uint64_t& bytes, std::int64_t& modified) {
+            std::error_code failure;
+            auto size = std::filesystem::file_size(path, failure);
+            if (failure) {
+                return false;
+            }
+            auto time = std::filesystem::last_write_time(path, failure);
+            if (failure) {
+                return false;
+            }
+            bytes = size;
+            modified = (std::int64_t)time.time_since_epoch().count();
+            return true;
+        }
+
+        bool EndsWith(const std::string& text, const char* suffix) {
+            auto length = std::strlen(suffix);
+            return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+        }
+    }
+
+    bool Scenario::Compile(const std::string& textPath, const std::string& compiledPath, std::string& error, ThreadPool& pool) {
+        SIMULATION_PROFILE_ZONE("Scenario::Compile");
+        std::uint64_t sourceBytes;
+        std::int64_t sourceModified;
+        MappedFile text;
+        if (!Stamp(textPath, sourceBytes, sourceModified) || !text.Open(textPath)) {
+            error = textPath + ": can not be read";
+            return false;
+        }
+
+        // A few chunks per thread, each moved on to the start of a line
+        auto begin = reinterpret_cast<const char*>(text.Data());
+        auto size = text.Size();
+        auto count = size < (std::size_t(1) << 16) ? std::size_t(1) : (std::size_t)pool.Size() * 4;
+        std::vector<const char*> bounds(count + 1);
+        bounds[0] = begin;
+        bounds[count] = begin + size;
+        for (std::size_t c = 1; c < count; c++) {
+            auto at = std::max(begin + size * c / count, bounds[c - 1]);
+            auto newline = at < begin + size ? static_cast<const char*>(std::memchr(at, '\n', (std::size_t)(begin + size - at))) : nullptr;
+            bounds[c] = newline != nullptr ? newline + 1 : begin + size;
+        }
+        std::vector<Chunk> chunks(count);
+        pool.ParallelFor(count, [&](std::size_t c) {
+            ParseChunk(bounds[c], bounds[c + 1], chunks[c]);
+        });
+
+        ScenarioHeader header = {};
+        std::memcpy(header.Magic, ScenarioHeader::Signature, sizeof(header.Magic));
+        header.Version = ScenarioHeader::CurrentVersion;
+        header.HeaderBytes = (std::uint32_t)ScenarioHeader::Bytes;
+        header.SourceBytes = sourceBytes;
+        header.SourceModified = sourceModified;
+        header.PeriodSeconds = DefaultPeriodSeconds;
+        header.TrajectoryEarthRadii = DefaultTrajectoryEarthRadii;
+        std::size_t line = 0;
+        for (const auto& chunk : chunks) {
+            if (chunk.ErrorLine != 0) {
+                error = textPath + ":" + std::to_string(line + chunk.ErrorLine) + ": " + chunk.Error;
+                return false;
+            }
+            line += chunk.Lines;
+            header.PeriodSeconds = std::isnan(chunk.PeriodSeconds) ? header.PeriodSeconds : chunk.PeriodSeconds;
+            header.TrajectoryEarthRadii = std::isnan(chunk.TrajectoryEarthRadii) ? header.TrajectoryEarthRadii : chunk.TrajectoryEarthRadii;
+            header.Circular += chunk.Columns[(std::size_t)ScenarioColumn::RadiusTrajectory].size();
+            header.Kepler += chunk.Columns[(std::size_t)ScenarioColumn::SemiMajorAxis].size();
+        }
+        auto offset = (std::uint64_t)ScenarioHeader::Bytes;
+        for (std::size_t column = 0; column < ScenarioColumns; column++) {
+            header.Offsets[column] = offset;
+            auto rows = column < (std::size_t)ScenarioColumn::SemiMajorAxis ? header.Circular : header.Kepler;
+            offset += (rows * sizeof(double) + ScenarioHeader::Alignment - 1) / ScenarioHeader::Alignment * ScenarioHeader::Alignment;
+        }
+        header.FileBytes = offset;
+
+        // Next to the old file, then over it, so nobody ever maps half a file
+        auto temporary = compiledPath + ".tmp";
+        auto file = std::fopen(temporary.c_str(), "wb");
+        if (file == nullptr) {
+            error = temporary + ": can not be written";
+            return false;
+        }
+        static const std::uint8_t zeros[ScenarioHeader::Bytes] = {};
+        auto ok = WriteAll(file, &header, sizeof(header)) && WriteAll(file, zeros, ScenarioHeader::Bytes - sizeof(header));
+        for (std::size_t column = 0; ok && column < ScenarioColumns; column++) {
+            std::size_t bytes = 0;
+            for (const auto& chunk : chunks) {
+                const auto& values = chunk.Columns[column];
+                ok &= WriteAll(file, values.data(), values.size() * sizeof(double));
+                bytes += values.size() * sizeof(double);
+            }
+            auto end = column + 1 < ScenarioColumns ? header.Offsets[column + 1] : header.FileBytes;
+            ok &= WriteAll(file, zeros, (std::size_t)(end - header.Offsets[column] - bytes));
+        }
+        ok &= std::fclose(file) == 0;
+        std::error_code failure;
+        if (ok) {
+            std::filesystem::rename(temporary, compiledPath, failure);
+        }
+        if (!ok || failure) {
+            std::remove(temporary.c_str());
+            error = compiledPath + ": can not be written";
+            return false;
+        }
+        return true;
+    }
+
+    bool Scenario::Open(const std::string& path, ThreadPool& pool) {
+        SIMULATION_PROFILE_ZONE("Scenario::Open");
+        Close();
+        std::uint64_t sourceBytes;
+        std::int64_t sourceModified;
+        if (EndsWith(path, CompiledExtension) || !Stamp(path, sourceBytes, sourceModified)) {
+            auto compiledPath = EndsWith(path, CompiledExtension) ? path : path + CompiledExtension;
+            if (!Map(compiledPath)) {
+                error = compiledPath + ": not a compiled scenario";
+                return false;
+            }
+            return true;
+        }
+
+        auto compiledPath = path + CompiledExtension;
+        if (Map(compiledPath) && header->SourceBytes == sourceBytes && header->SourceModified == sourceModified) {
+            return true;
+        }
+        // Unmapped first, Windows can not replace a mapped file
+        Close();
+        if (!Compile(path, compiledPath, error, pool)) {
+            return false;
+        }
+        compiled = true;
+        if (!Map(compiledPath)) {
+            error = compiledPath + ": not a compiled scenario";
+            return false;
+        }
+        return true;
+    }
+
+    void Scenario::Close() {
+        file.Close();
+        header = nullptr;
+        error.clear();
+        compiled = false;
+    }
+
+    bool Scenario::IsOpen() const {
+        return header != nullptr;
+    }
+
+    const std::string& Scenario::Error() const {
+        return error;
+    }
+
+    bool Scenario::Compiled() const {
+        return compiled;
+    }
+
+    double Scenario::PeriodSeconds() const {
+        return header->PeriodSeconds;
+    }
+
+    double Scenario::TrajectoryEarthRadii() const {
+        return header->TrajectoryEarthRadii;
+    }
+
+    std::size_t Scenario::Circular() const {
+        return (std::size_t)header->Circular;
+    }
+
+    std::size_t Scenario::Kepler() const {
+        return (std::size_t)header->Kepler;
+    }
+
+    const double* Scenario::Column(ScenarioColumn column) const {
+        return reinterpret_cast<const double*>(file.Data() + header->Offsets[(std::size_t)column]);
+    }
+
+    template<class T>
+    void Scenario::Apply(BasicSimulationState<T>& state) const {
+        SIMULATION_PROFILE_ZONE("Scenario::Apply");
+        state.Satellite.PeriodSeconds = T(PeriodSeconds());
+        state.Satellite.RadiusTrajectory = T(TrajectoryEarthRadii()) * state.Earth.Radius;
+        state.SetOrbitFraction(0);
+
+        auto n = Circular();
+        const auto* radius = Column(ScenarioColumn::RadiusTrajectory);
+        const auto* period = Column(ScenarioColumn::PeriodSeconds);
+        const auto* angle = Column(ScenarioColumn::AngleRadians);
+        auto& satellites = state.Satellites;
+        satellites.Clear();
+        satellites.Reserve(n);
+        for (std::size_t i = 0; i < n; i++) {
+            satellites.Add(T(radius[i]) * state.Earth.Radius, T(period[i]), T(angle[i]));
+        }
+        satellites.Propagate(state.ElapsedSeconds(), state.Earth);
+    }
+
+    template<class T>
+    void Scenario::Apply(T earthRadius, BasicKeplerCatalog<T>& catalog) const {
+        SIMULATION_PROFILE_ZONE("Scenario::Apply");
+        auto n = Kepler();
+        auto copy = [&](std::vector<T>& to, ScenarioColumn column, T scale) {
+            const auto* from = Column(column);
+            to.resize(n);
+            for (std::size_t i = 0; i < n; i++) {
+                to[i] = T(from[i]) * scale;
+            }
+        };
+        copy(catalog.SemiMajorAxis, ScenarioColumn::SemiMajorAxis, earthRadius);
+        copy(catalog.Eccentricity, ScenarioColumn::Eccentricity, T(1));
+        copy(catalog.ArgumentOfPeriapsis, ScenarioColumn::ArgumentOfPeriapsis, T(1));
+        copy(catalog.MeanAnomalyAtEpoch, ScenarioColumn::MeanAnomalyAtEpoch, T(1));
+        copy(catalog.MeanMotion, ScenarioColumn::MeanMotion, T(1));
+        copy(catalog.SemiMinorAxis, ScenarioColumn::SemiMinorAxis, earthRadius);
+        copy(catalog.CosPeriapsis, ScenarioColumn::CosPeriapsis, T(1));
+        copy(catalog.SinPeriapsis, ScenarioColumn::SinPeriapsis, T(1));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    bool Scenario::Map(const std::string& path) {
+        header = nullptr;
+        if (!file.Open(path) || file.Size() < ScenarioHeader::Bytes) {
+            file.Close();
+            return false;
+        }
+        const auto* mapped = reinterpret_cast<const ScenarioHeader*>(file.Data());
+        auto valid = std::memcmp(mapped->Magic, ScenarioHeader::Signature, sizeof(mapped->Magic)) == 0 &&
+                     mapped->Version == ScenarioHeader::CurrentVersion && mapped->HeaderBytes == ScenarioHeader::Bytes &&
+                     mapped->FileBytes == file.Size();
+        for (std::size_t column = 0; valid && column < ScenarioColumns; column++) {
+            auto rows = column < (std::size_t)ScenarioColumn::SemiMajorAxis ? mapped->Circular : mapped->Kepler;
+            auto offset = mapped->Offsets[column];
+            valid = offset % ScenarioHeader::Alignment == 0 && offset >= ScenarioHeader::Bytes && rows <= file.Size() / sizeof(double) &&
+                    offset + rows * sizeof(double) <= file.Size();
+        }
+        if (!valid) {
+            file.Close();
+            return false;
+        }
+        header = mapped;
+        return true;
+    }
+
+    template void Scenario::Apply<float>(BasicSimulationState<float>&) const;
+    template void Scenario::Apply<double>(BasicSimulationState<double>&) const;
+    template void Scenario::Apply<long double>(BasicSimulationState<long double>&) const;
+    template void Scenario::Apply<float>(float, BasicKeplerCatalog<float>&) const;
+    template void Scenario::Apply<double>(double, BasicKeplerCatalog<double>&) const;
+    template void Scenario::Apply<long double>(long double, BasicKeplerCatalog<long double>&) const;
+}
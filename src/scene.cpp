@@ -0,0 +1,264 @@
+#include "../include/scene.h"
+#include "../include/profiler.h"
+#include <cmath>
+
+namespace Simulation {
+    long double FieldLinesWidth = 10.0f;
+    long double BaseArrowLength = 150.0l, BaseArrowWidth = 25.0l;
+
+    void Scene::Draw(Renderer& renderer, const Snapshot& snapshot, bool refreshHud) {
+        SIMULATION_PROFILE_ZONE("Scene::Draw");
+        MeasureLabels(renderer);
+        UpdateFieldLines(renderer, snapshot);
+
+        renderer.BeginFrame(Background);
+        // Only drawn again when the planet, the orbit or the period change
+        if (renderer.BeginLayer(StaticLayerKey(renderer, snapshot))) {
+            DrawStatic(renderer, snapshot);
+            if (!renderer.EndLayer()) {
+                // Lost, straight onto the frame this time
+                DrawStatic(renderer, snapshot);
+            }
+        }
+        DrawSatelliteFieldLine(renderer);
+        DrawSatellite(renderer, snapshot);
+        DrawAxes(renderer, snapshot);
+        DrawMagneticFieldsDirections(renderer, snapshot);
+        DrawInfoAngle(renderer, snapshot, refreshHud);
+        DrawProfile(renderer, refreshHud);
+        renderer.EndFrame();
+    }
+
+    void Scene::SetProfileOverlay(bool show) {
+        profileOverlay = show;
+    }
+
+    void Scene::DrawPhase(Renderer& renderer, const Snapshot& snapshot, Phase phase) {
+        MeasureLabels(renderer);
+        UpdateFieldLines(renderer, snapshot);
+
+        renderer.BeginFrame(Background);
+        switch (phase) {
+        case Phase::Earth:
+            DrawEarth(renderer, snapshot);
+            break;
+        case Phase::Trajectory:
+            DrawTrajectory(renderer, snapshot);
+            break;
+        case Phase::FieldLines:
+            DrawMagneticFieldLines(renderer);
+            break;
+        case Phase::SatelliteFieldLine:
+            DrawSatelliteFieldLine(renderer);
+            break;
+        case Phase::Satellite:
+            DrawSatellite(renderer, snapshot);
+            break;
+        case Phase::Axes:
+            DrawAxes(renderer, snapshot);
+            break;
+        case Phase::FieldDirection:
+            DrawMagneticFieldsDirections(renderer, snapshot);
+            break;
+        case Phase::InfoAngle:
+            DrawInfoAngle(renderer, snapshot, true);
+            break;
+        case Phase::InfoOrbit:
+            DrawInfoOrbit(renderer, snapshot);
+            break;
+        default:
+            break;
+        }
+        renderer.EndFrame();
+    }
+
+    const char* Scene::ToString(Phase phase) {
+        switch (phase) {
+        case Phase::Earth: return "earth";
+        case Phase::Trajectory: return "trajectory";
+        case Phase::FieldLines: return "field_lines";
+        case Phase::SatelliteFieldLine: return "satellite_field_line";
+        case Phase::Satellite: return "satellite";
+        case Phase::Axes: return "axes";
+        case Phase::FieldDirection: return "field_direction";
+        case Phase::InfoAngle: return "info_angle";
+        case Phase::InfoOrbit: return "info_orbit";
+        default: return "unknown";
+        }
+    }
+
+    std::uint64_t Scene::StaticLayerKey(const Renderer& renderer, const Snapshot& snapshot) const {
+        // FNV-1a over everything the static layer is drawn from. Through double, long double has
+        // padding bytes that would make the key differ for equal values.
+        std::uint64_t key = 0xCBF29CE484222325ull;
+        auto mix = [&key](const auto& value) {
+            auto bytes = reinterpret_cast<const unsigned char*>(&value);
+            for (std::size_t i = 0; i < sizeof(value); i++) {
+                key = (key ^ bytes[i]) * 0x100000001B3ull;
+            }
+        };
+        mix(renderer.Width());
+        mix(renderer.Height());
+        mix(Background);
+        mix((double)snapshot.Earth.X);
+        mix((double)snapshot.Earth.Y);
+        mix((double)snapshot.Earth.Radius);
+        mix((double)snapshot.Satellite.RadiusTrajectory);
+        mix((double)snapshot.Satellite.PeriodSeconds);
+        mix(fieldLines->Generation);
+        mix((double)FieldLinesWidth);
+        return key;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    void Scene::MeasureLabels(Renderer& renderer) {
+        if (measuredWith == &renderer) {
+            return;
+        }
+        renderer.MeasureString(L"R", radialAxisWidth, radialAxisHeight);
+        renderer.MeasureString(L"T", tangentAxisWidth, tangentAxisHeight);
+        renderer.MeasureString(L"B", magneticFieldWidth, magneticFieldHeight);
+        measuredWith = &renderer;
+    }
+
+    void Scene::UpdateFieldLines(const Renderer& renderer, const Snapshot& snapshot) {
+        SIMULATION_PROFILE_ZONE("Scene::UpdateFieldLines");
+        DipoleField field;
+        field.CenterX = (float)snapshot.Earth.X;
+        field.CenterY = (float)snapshot.Earth.Y;
+        field.Radius = (float)snapshot.Earth.Radius;
+        FieldLineSettings settings;
+        settings.Right = (float)renderer.Width();
+        settings.Bottom = (float)renderer.Height();
+
+        // The family is cached by the tracer, the line through the satellite moves with it. That one
+        // is traced in the dipole tilted to run along the B arrow, whichever model the arrow is from.
+        fieldLines = &fieldLineTracer.Trace(field, settings);
+        auto x = (float)snapshot.Satellite.X, y = (float)snapshot.Satellite.Y;
+        auto through = field;
+        through.Tilt = field.TiltAlong(x, y, (float)snapshot.CircularField.DirectionX, (float)snapshot.CircularField.DirectionY);
+        fieldLineTracer.TraceThrough(through, settings, x, y, satelliteFieldLine);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    void Scene::DrawStatic(Renderer& renderer, const Snapshot& snapshot) {
+        DrawEarth(renderer, snapshot);
+        DrawTrajectory(renderer, snapshot);
+        DrawMagneticFieldLines(renderer);
+        DrawInfoOrbit(renderer, snapshot);
+    }
+
+    void Scene::DrawEarth(Renderer& renderer, const Snapshot& snapshot) const {
+        SIMULATION_PROFILE_ZONE("Scene::DrawEarth");
+        const auto& earth = snapshot.Earth;
+        renderer.DrawBitmap(BitmapId::Earth, (float)earth.X, (float)earth.Y, (float)(2 * earth.Radius), 0.0f);
+    }
+
+    void Scene::DrawTrajectory(Renderer& renderer, const Snapshot& snapshot) const {
+        SIMULATION_PROFILE_ZONE("Scene::DrawTrajectory");
+        auto radius = (float)snapshot.Satellite.RadiusTrajectory;
+        Stroke stroke = { SatelliteTrajectoryLineColor, SatelliteTrajectoryLineWidth, StrokeStyle::Dashed };
+        renderer.DrawEllipse((float)snapshot.Earth.X, (float)snapshot.Earth.Y, radius, radius, stroke);
+    }
+
+    void Scene::DrawMagneticFieldLines(Renderer& renderer) const {
+        SIMULATION_PROFILE_ZONE("Scene::DrawMagneticFieldLines");
+        // Faint red
+        renderer.DrawPolylines(*fieldLines, { { 1.0f, 0.0f, 0.0f, 0.2f }, (float)FieldLinesWidth / 4.0f, StrokeStyle::Solid });
+    }
+
+    void Scene::DrawSatelliteFieldLine(Renderer& renderer) const {
+        SIMULATION_PROFILE_ZONE("Scene::DrawSatelliteFieldLine");
+        // Weak red
+        renderer.DrawPolylines(satelliteFieldLine, { { 1.0f, 0.0f, 0.0f, 0.5f }, (float)FieldLinesWidth, StrokeStyle::Solid });
+    }
+
+    void Scene::DrawSatellite(Renderer& renderer, const Snapshot& snapshot) const {
+        SIMULATION_PROFILE_ZONE("Scene::DrawSatellite");
+        const auto& satellite = snapshot.Satellite;
+        renderer.DrawBitmap(BitmapId::Satellite, (float)satellite.X, (float)satellite.Y, (float)(2 * satellite.Radius), -(float)satellite.AngleDegrees);
+    }
+
+    void Scene::DrawAxes(Renderer& renderer, const Snapshot& snapshot) const {
+        SIMULATION_PROFILE_ZONE("Scene::DrawAxes");
+        const auto& satellite = snapshot.Satellite;
+        Color white = { 1.0f, 1.0f, 1.0f, 1.0f };
+        DrawArrow(renderer, snapshot, satellite.RadialDirectionX, satellite.RadialDirectionY, white, L"R", radialAxisWidth, radialAxisHeight);
+        DrawArrow(renderer, snapshot, satellite.TangentDirectionX, satellite.TangentDirectionY, white, L"T", tangentAxisWidth, tangentAxisHeight);
+    }
+
+    void Scene::DrawMagneticFieldsDirections(Renderer& renderer, const Snapshot& snapshot) const {
+        SIMULATION_PROFILE_ZONE("Scene::DrawMagneticFieldsDirections");
+        // Strong red
+        const auto& field = snapshot.CircularField;
+        DrawArrow(renderer, snapshot, field.DirectionX, field.DirectionY, { 1.0f, 0.0f, 0.0f, 1.0f }, L"B", magneticFieldWidth, magneticFieldHeight);
+    }
+
+    void Scene::DrawInfoAngle(Renderer& renderer, const Snapshot& snapshot, bool refresh) {
+        SIMULATION_PROFILE_ZONE("Scene::DrawInfoAngle");
+        const auto& satellite = snapshot.Satellite;
+        // Nothing after the prefix yet on the very first frame
+        if (refresh || angleText.Text().size() == angleText.PrefixLength()) {
+            angleText.Reset().Append((double)(satellite.AngleRadians / Pi<Scalar>)).Append(L"π (").Append((double)satellite.AngleDegrees).Append(L"°)");
+        }
+        renderer.DrawString(angleText.Text(), angleText.PrefixLength(), InfoX, InfoY, TextColor);
+    }
+
+    void Scene::DrawInfoOrbit(Renderer& renderer, const Snapshot& snapshot) {
+        SIMULATION_PROFILE_ZONE("Scene::DrawInfoOrbit");
+        auto period = (double)snapshot.Satellite.PeriodSeconds;
+        periodText.Reset().Append(period).Append(L"sec");
+        frequencyText.Reset().Append(1.0 / period).Append(L"Hz");
+        speedText.Reset().Append(2.0 / period).Append(L"π/sec (").Append(360.0 / period).Append(L"°/sec)");
+
+        renderer.DrawString(periodText.Text(), periodText.PrefixLength(), InfoX, InfoY + InfoLineSpacing, TextColor);
+        renderer.DrawString(frequencyText.Text(), frequencyText.PrefixLength(), InfoX, InfoY + 2 * InfoLineSpacing, TextColor);
+        renderer.DrawString(speedText.Text(), speedText.PrefixLength(), InfoX, InfoY + 3 * InfoLineSpacing, TextColor);
+    }
+
+    // One line per zone of the last second, indented by nesting under a line per thread:
+    // mean, 99th percentile and worst duration
+    void Scene::DrawProfile(Renderer& renderer, bool refresh) {
+        if (!Profiler::Enabled || !profileOverlay) {
+            return;
+        }
+        if (refresh || profileLineCount == 0) {
+            profileSummaries.resize(ProfileLines);
+            auto zones = Profiler::Summarize(std::chrono::seconds(1), profileSummaries.data(), profileSummaries.size());
+            profileLineCount = 0;
+            const char* thread = nullptr;
+            for (std::size_t i = 0; i < zones && profileLineCount < ProfileLines; i++) {
+                const auto& zone = profileSummaries[i];
+                if (zone.Thread != thread && profileLineCount + 1 < ProfileLines) {
+                    thread = zone.Thread;
+                    profileText[profileLineCount++].Reset().Append(std::string_view(thread)).Append(L":");
+                }
+                auto& line = profileText[profileLineCount++].Reset();
+                for (std::uint32_t depth = 0; depth <= zone.Depth; depth++) {
+                    line.Append(L"  ");
+                }
+                line.Append(std::string_view(zone.Name)).Append(L" ").Append(zone.MeanMicroseconds(), 1).Append(L" / ")
+                    .Append(zone.PercentileMicroseconds(0.99), 1).Append(L" / ").Append(zone.MaxMicroseconds, 1).Append(L" us");
+            }
+        }
+        for (std::size_t i = 0; i < profileLineCount; i++) {
+            renderer.DrawString(profileText[i].Text(), profileText[i].PrefixLength(), InfoX, ProfileY + i * ProfileLineSpacing, TextColor);
+        }
+    }
+
+    void Scene::DrawArrow(Renderer& renderer, const Snapshot& snapshot, Scalar dx, Scalar dy, Color color, std::wstring_view label, float labelWidth, float labelHeight) const {
+        auto x = (long double)snapshot.Satellite.X, y = (long double)snapshot.Satellite.Y;
+        Stroke stroke = { color, (float)BaseArrowWidth, StrokeStyle::Arrow };
+        renderer.DrawLine((float)x, (float)y, (float)(x + dx * BaseArrowLength), (float)(y - dy * BaseArrowLength), stroke);
+
+        // Label centred 50 px past the tip
+        auto size = BaseArrowLength * std::sqrt((long double)(dx * dx + dy * dy));
+        if (size <= 0) {
+            return;
+        }
+        auto len = BaseArrowLength * (size + 50.0l) / size;
+        renderer.DrawString(label, label.size(), (float)(x + dx * len - labelWidth / 2.0l), (float)(y - dy * len - labelHeight / 2.0l), color);
+    }
+}
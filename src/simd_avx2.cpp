@@ -0,0 +1,49 @@
+#include "../include/simd_orbit.h"
+#include "../include/simd_kepler.h"
+#include "../include/simd_dipole.h"
+#include "../include/simd_visibility.h"
+#include "../include/simd_harmonic.h"
+
+// Compiled for AVX2, only called after cpu_features.cpp confirmed the CPU supports it
+
+namespace Simulation::Simd {
+    void UpdateOrbitsAVX2(double earthX, double earthY, const OrbitArrays<double>& arrays, std::size_t n) {
+        UpdateOrbitsVector<AVX2<double>>(earthX, earthY, arrays, n);
+    }
+
+    void UpdateOrbitsAVX2(float earthX, float earthY, const OrbitArrays<float>& arrays, std::size_t n) {
+        UpdateOrbitsVector<AVX2<float>>(earthX, earthY, arrays, n);
+    }
+
+    void SolveKeplerAVX2(const KeplerArrays<double>& arrays, int iterations, std::size_t n) {
+        SolveKeplerVector<AVX2<double>>(arrays, iterations, n);
+    }
+
+    void SolveKeplerAVX2(const KeplerArrays<float>& arrays, int iterations, std::size_t n) {
+        SolveKeplerVector<AVX2<float>>(arrays, iterations, n);
+    }
+
+    void EvaluateDipoleRowAVX2(const DipoleRow<double>& row, std::size_t n) {
+        EvaluateDipoleRowVector<AVX2<double>>(row, n);
+    }
+
+    void EvaluateDipoleRowAVX2(const DipoleRow<float>& row, std::size_t n) {
+        EvaluateDipoleRowVector<AVX2<float>>(row, n);
+    }
+
+    void EvaluateVisibilityAVX2(const VisibilityRow<double>& row, std::size_t n) {
+        EvaluateVisibilityVector<AVX2<double>>(row, n);
+    }
+
+    void EvaluateVisibilityAVX2(const VisibilityRow<float>& row, std::size_t n) {
+        EvaluateVisibilityVector<AVX2<float>>(row, n);
+    }
+
+    void EvaluateHarmonicFieldAVX2(const HarmonicRows<double>& rows, std::size_t n) {
+        EvaluateHarmonicFieldVector<AVX2<double>>(rows, n);
+    }
+
+    void EvaluateHarmonicFieldAVX2(const HarmonicRows<float>& rows, std::size_t n) {
+        EvaluateHarmonicFieldVector<AVX2<float>>(rows, n);
+    }
+}
@@ -0,0 +1,49 @@
+#include "../include/simd_orbit.h"
+#include "../include/simd_kepler.h"
+#include "../include/simd_dipole.h"
+#include "../include/simd_visibility.h"
+#include "../include/simd_harmonic.h"
+
+// Compiled for AVX512, only called after cpu_features.cpp confirmed the CPU supports it
+
+namespace Simulation::Simd {
+    void UpdateOrbitsAVX512(double earthX, double earthY, const OrbitArrays<double>& arrays, std::size_t n) {
+        UpdateOrbitsVector<AVX512<double>>(earthX, earthY, arrays, n);
+    }
+
+    void UpdateOrbitsAVX512(float earthX, float earthY, const OrbitArrays<float>& arrays, std::size_t n) {
+        UpdateOrbitsVector<AVX512<float>>(earthX, earthY, arrays, n);
+    }
+
+    void SolveKeplerAVX512(const KeplerArrays<double>& arrays, int iterations, std::size_t n) {
+        SolveKeplerVector<AVX512<double>>(arrays, iterations, n);
+    }
+
+    void SolveKeplerAVX512(const KeplerArrays<float>& arrays, int iterations, std::size_t n) {
+        SolveKeplerVector<AVX512<float>>(arrays, iterations, n);
+    }
+
+    void EvaluateDipoleRowAVX512(const DipoleRow<double>& row, std::size_t n) {
+        EvaluateDipoleRowVector<AVX512<double>>(row, n);
+    }
+
+    void EvaluateDipoleRowAVX512(const DipoleRow<float>& row, std::size_t n) {
+        EvaluateDipoleRowVector<AVX512<float>>(row, n);
+    }
+
+    void EvaluateVisibilityAVX512(const VisibilityRow<double>& row, std::size_t n) {
+        EvaluateVisibilityVector<AVX512<double>>(row, n);
+    }
+
+    void EvaluateVisibilityAVX512(const VisibilityRow<float>& row, std::size_t n) {
+        EvaluateVisibilityVector<AVX512<float>>(row, n);
+    }
+
+    void EvaluateHarmonicFieldAVX512(const HarmonicRows<double>& rows, std::size_t n) {
+        EvaluateHarmonicFieldVector<AVX512<double>>(rows, n);
+    }
+
+    void EvaluateHarmonicFieldAVX512(const HarmonicRows<float>& rows, std::size_t n) {
+        EvaluateHarmonicFieldVector<AVX512<float>>(rows, n);
+    }
+}
@@ -0,0 +1,455 @@
+#include "../include/simd_kernel.h"
+#include "../include/orbit_kernel.h"
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+#if defined(SIMULATION_SIMD_X86)
+#include "../include/simd_orbit.h"
+#include "../include/simd_kepler.h"
+#include "../include/simd_dipole.h"
+#include "../include/simd_visibility.h"
+#include "../include/simd_harmonic.h"
+#endif
+
+namespace Simulation::Simd {
+    static std::atomic<InstructionSet> activeInstructionSet = DetectInstructionSet();
+
+    InstructionSet ActiveInstructionSet() {
+        return activeInstructionSet.load(std::memory_order_relaxed);
+    }
+
+    void SetActiveInstructionSet(InstructionSet set) {
+        while (!IsSupported(set)) {
+            set = (InstructionSet)((int)set - 1);
+        }
+        activeInstructionSet.store(set, std::memory_order_relaxed);
+    }
+
+    template<class T>
+    void UpdateOrbits(T earthX, T earthY, const OrbitArrays<T>& arrays, std::size_t n) {
+        UpdateOrbits(ActiveInstructionSet(), earthX, earthY, arrays, n);
+    }
+
+    template<class T>
+    void UpdateOrbits(InstructionSet set, T earthX, T earthY, const OrbitArrays<T>& arrays, std::size_t n) {
+#if defined(SIMULATION_SIMD_X86)
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            switch (set) {
+            case InstructionSet::SSE2:
+                UpdateOrbitsSSE2(earthX, earthY, arrays, n);
+                return;
+            case InstructionSet::AVX2:
+                UpdateOrbitsAVX2(earthX, earthY, arrays, n);
+                return;
+            case InstructionSet::AVX512:
+                UpdateOrbitsAVX512(earthX, earthY, arrays, n);
+                return;
+            default:
+                break;
+            }
+        }
+#endif
+        UpdateOrbitsScalar(earthX, earthY, arrays, 0, n);
+    }
+
+    template<class T>
+    void UpdateOrbitsScalar(T earthX, T earthY, const OrbitArrays<T>& a, std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i++) {
+            Kernel::Location(earthX, earthY, a.RadiusTrajectory[i], a.AngleRadians[i], a.X[i], a.Y[i]);
+            Kernel::RadialAxis(earthX, earthY, a.X[i], a.Y[i], a.RadialDirectionX[i], a.RadialDirectionY[i]);
+            Kernel::TangentAxis(earthX, earthY, a.X[i], a.Y[i], a.TangentDirectionX[i], a.TangentDirectionY[i]);
+        }
+    }
+
+    template<class T>
+    Accuracy MeasureAccuracy(InstructionSet set, std::size_t samples) {
+        const auto earthX = T(960), earthY = T(540);
+
+        // Exact quarter turns first, then an even sweep over the whole orbit at assorted radii
+        std::vector<T> radius, angle;
+        for (auto deg : { 0.0l, 90.0l, 180.0l, 270.0l }) {
+            radius.push_back(T(442));
+            angle.push_back(T(deg * PI / 180.0l));
+        }
+        for (std::size_t i = 0; i < samples; i++) {
+            radius.push_back(T(100 + (i % 97) * 10));
+            angle.push_back(T(2.0l * PI * i / samples));
+        }
+
+        auto n = angle.size();
+        std::vector<T> out[6];
+        for (auto& v : out) {
+            v.resize(n);
+        }
+        OrbitArrays<T> arrays = { radius.data(), angle.data(), out[0].data(), out[1].data(), out[2].data(), out[3].data(), out[4].data(), out[5].data() };
+        UpdateOrbits(set, earthX, earthY, arrays, n);
+
+        Accuracy accuracy = {};
+        for (std::size_t i = 0; i < n; i++) {
+            long double x, y, rx, ry, tx, ty;
+            Kernel::Location<long double>(earthX, earthY, radius[i], angle[i], x, y);
+            Kernel::RadialAxis<long double>(earthX, earthY, x, y, rx, ry);
+            Kernel::TangentAxis<long double>(earthX, earthY, x, y, tx, ty);
+            accuracy.Location = std::max({ accuracy.Location, (double)std::abs(out[0][i] - x), (double)std::abs(out[1][i] - y) });
+            accuracy.Axes = std::max({ accuracy.Axes, (double)std::abs(out[2][i] - rx), (double)std::abs(out[3][i] - ry),
+                                                      (double)std::abs(out[4][i] - tx), (double)std::abs(out[5][i] - ty) });
+        }
+        return accuracy;
+    }
+
+    template<class T>
+    void SolveKepler(const KeplerArrays<T>& arrays, int iterations, std::size_t n) {
+        SolveKepler(ActiveInstructionSet(), arrays, iterations, n);
+    }
+
+    template<class T>
+    void SolveKepler(InstructionSet set, const KeplerArrays<T>& arrays, int iterations, std::size_t n) {
+#if defined(SIMULATION_SIMD_X86)
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            switch (set) {
+            case InstructionSet::SSE2:
+                SolveKeplerSSE2(arrays, iterations, n);
+                return;
+            case InstructionSet::AVX2:
+                SolveKeplerAVX2(arrays, iterations, n);
+                return;
+            case InstructionSet::AVX512:
+                SolveKeplerAVX512(arrays, iterations, n);
+                return;
+            default:
+                break;
+            }
+        }
+#endif
+        SolveKeplerScalar(arrays, iterations, 0, n);
+    }
+
+    template<class T>
+    void SolveKeplerScalar(const KeplerArrays<T>& a, int iterations, std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i++) {
+            Kernel::Kepler(a.MeanAnomaly[i], a.Eccentricity[i], a.SemiMajorAxis[i], a.SemiMinorAxis[i], a.CosPeriapsis[i], a.SinPeriapsis[i], iterations, a.X[i], a.Y[i]);
+        }
+    }
+
+    template<class T>
+    double MeasureKeplerAccuracy(InstructionSet set, std::size_t samples) {
+        constexpr auto Eccentricities = 34;
+        constexpr auto Iterations = sizeof(T) > sizeof(float) ? 5 : 4;
+
+        // Mean anomalies over [-pi, pi] (both ends included) against eccentricities over [0, 0.99]
+        std::vector<T> m, e, a, b, cw, sw;
+        for (std::size_t i = 0; i <= samples; i++) {
+            for (int j = 0; j < Eccentricities; j++) {
+                auto ecc = 0.99l * j / (Eccentricities - 1);
+                auto w = 0.7l * j;
+                m.push_back(T(-PI + 2.0l * PI * i / samples));
+                e.push_back(T(ecc));
+                a.push_back(T(500));
+                b.push_back(T(500.0l * std::sqrt(1.0l - ecc * ecc)));
+                cw.push_back(T(std::cos(w)));
+                sw.push_back(T(std::sin(w)));
+            }
+        }
+
+        auto n = m.size();
+        std::vector<T> x(n), y(n);
+        KeplerArrays<T> arrays = { m.data(), e.data(), a.data(), b.data(), cw.data(), sw.data(), x.data(), y.data() };
+        SolveKepler(set, arrays, Iterations, n);
+
+        auto accuracy = 0.0;
+        for (std::size_t i = 0; i < n; i++) {
+            // Reference: long double Newton to convergence
+            long double M = m[i], ecc = e[i];
+            auto E = ecc < 0.8l ? M : (M < 0 ? -PI : PI);
+            for (int k = 0; k < 100; k++) {
+                auto delta = (E - ecc * std::sin(E) - M) / (1.0l - ecc * std::cos(E));
+                E -= delta;
+                if (std::abs(delta) < 1e-18l) {
+                    break;
+                }
+            }
+            auto px = a[i] * (std::cos(E) - ecc);
+            auto py = b[i] * std::sin(E);
+            auto rx = cw[i] * px - sw[i] * py;
+            auto ry = sw[i] * px + cw[i] * py;
+            accuracy = std::max({ accuracy, (double)std::abs(x[i] - rx), (double)std::abs(y[i] - ry) });
+        }
+        return accuracy;
+    }
+
+    template<class T>
+    void EvaluateDipoleRow(const DipoleRow<T>& row, std::size_t n) {
+        EvaluateDipoleRow(ActiveInstructionSet(), row, n);
+    }
+
+    template<class T>
+    void EvaluateDipoleRow(InstructionSet set, const DipoleRow<T>& row, std::size_t n) {
+#if defined(SIMULATION_SIMD_X86)
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            switch (set) {
+            case InstructionSet::SSE2:
+                EvaluateDipoleRowSSE2(row, n);
+                return;
+            case InstructionSet::AVX2:
+                EvaluateDipoleRowAVX2(row, n);
+                return;
+            case InstructionSet::AVX512:
+                EvaluateDipoleRowAVX512(row, n);
+                return;
+            default:
+                break;
+            }
+        }
+#endif
+        EvaluateDipoleRowScalar(row, 0, n);
+    }
+
+    template<class T>
+    void EvaluateDipoleRowScalar(const DipoleRow<T>& row, std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i++) {
+            auto dx = row.StartX + T(i) * row.StepX;
+            Kernel::Dipole(dx, row.OffsetY, row.MomentX, row.MomentY, row.Radius, row.Strength, row.X[i], row.Y[i]);
+            row.Magnitude[i] = std::sqrt(row.X[i] * row.X[i] + row.Y[i] * row.Y[i]);
+        }
+    }
+
+    template<class T>
+    double MeasureDipoleAccuracy(InstructionSet set, std::size_t samples) {
+        constexpr auto Rows = 64;
+        const auto radius = T(110.5);
+        const auto tilt = 0.4l;
+        const auto mx = T(std::sin(tilt)), my = T(-std::cos(tilt));
+
+        // Rows from pole to pole, through the surface, out to ten planet radii on both sides
+        std::vector<T> x(samples), y(samples), magnitude(samples);
+        auto accuracy = 0.0;
+        for (int j = 0; j < Rows; j++) {
+            DipoleRow<T> row = {};
+            row.StartX = T(-10) * radius;
+            row.StepX = T(20) * radius / T(samples);
+            row.OffsetY = radius * T(-10 + 20.0l * j / (Rows - 1));
+            row.MomentX = mx;
+            row.MomentY = my;
+            row.Radius = radius;
+            row.Strength = T(1);
+            row.X = x.data();
+            row.Y = y.data();
+            row.Magnitude = magnitude.data();
+            EvaluateDipoleRow(set, row, samples);
+
+            for (std::size_t i = 0; i < samples; i++) {
+                long double dx = row.StartX + T(i) * row.StepX, bx, by;
+                // Right on the surface rounding alone decides which side a sample falls on
+                if (std::abs(std::sqrt(dx * dx + row.OffsetY * row.OffsetY) / radius - 1.0l) < 1e-4l) {
+                    continue;
+                }
+                Kernel::Dipole<long double>(dx, row.OffsetY, mx, my, radius, 1.0l, bx, by);
+                auto size = std::sqrt(bx * bx + by * by);
+                if (size == 0.0l) {
+                    accuracy = std::max({ accuracy, (double)std::abs(x[i]), (double)std::abs(y[i]) });
+                    continue;
+                }
+                accuracy = std::max({ accuracy, (double)(std::abs(x[i] - bx) / size), (double)(std::abs(y[i] - by) / size),
+                                                 (double)(std::abs(magnitude[i] - size) / size) });
+            }
+        }
+        return accuracy;
+    }
+
+    template<class T>
+    void EvaluateVisibility(const VisibilityRow<T>& row, std::size_t n) {
+        EvaluateVisibility(ActiveInstructionSet(), row, n);
+    }
+
+    template<class T>
+    void EvaluateVisibility(InstructionSet set, const VisibilityRow<T>& row, std::size_t n) {
+#if defined(SIMULATION_SIMD_X86)
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            switch (set) {
+            case InstructionSet::SSE2:
+                EvaluateVisibilitySSE2(row, n);
+                return;
+            case InstructionSet::AVX2:
+                EvaluateVisibilityAVX2(row, n);
+                return;
+            case InstructionSet::AVX512:
+                EvaluateVisibilityAVX512(row, n);
+                return;
+            default:
+                break;
+            }
+        }
+#endif
+        EvaluateVisibilityScalar(row, 0, n);
+    }
+
+    template<class T>
+    void EvaluateVisibilityScalar(const VisibilityRow<T>& row, std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i++) {
+            row.Margin[i] = Kernel::VisibilityMargin(row.X[i], row.Y[i], row.StationX, row.StationY, row.UpX, row.UpY, row.MaskTerm);
+        }
+    }
+
+    template<class T>
+    double MeasureVisibilityAccuracy(InstructionSet set, std::size_t samples) {
+        constexpr auto Stations = 64;
+        const auto radius = 110.5l;
+        const auto mask = 0.17l;
+
+        // Satellites on a spiral from the surface out to ten radii, all the way around
+        std::vector<T> x(samples), y(samples), margin(samples);
+        for (std::size_t i = 0; i < samples; i++) {
+            auto r = radius * (1.0l + 9.0l * i / samples);
+            auto a = 37.0l * 2.0l * PI * i / samples;
+            x[i] = T(r * std::cos(a));
+            y[i] = T(r * std::sin(a));
+        }
+
+        auto accuracy = 0.0;
+        for (int j = 0; j < Stations; j++) {
+            auto angle = 2.0l * PI * j / Stations;
+            VisibilityRow<T> row = {};
+            row.UpX = T(std::cos(angle));
+            row.UpY = T(std::sin(angle));
+            row.StationX = T(radius) * row.UpX;
+            row.StationY = T(radius) * row.UpY;
+            row.MaskTerm = T(std::sin(mask) * std::sin(mask));
+            row.X = x.data();
+            row.Y = y.data();
+            row.Margin = margin.data();
+            EvaluateVisibility(set, row, samples);
+
+            for (std::size_t i = 0; i < samples; i++) {
+                long double dx = (long double)x[i] - row.StationX, dy = (long double)y[i] - row.StationY;
+                auto exact = Kernel::VisibilityMargin<long double>(x[i], y[i], row.StationX, row.StationY, row.UpX, row.UpY, row.MaskTerm);
+                auto scale = dx * dx + dy * dy;
+                if (scale > 0.0l) {
+                    accuracy = std::max(accuracy, (double)(std::abs(margin[i] - exact) / scale));
+                }
+            }
+        }
+        return accuracy;
+    }
+
+    template<class T>
+    void EvaluateHarmonicField(const HarmonicRows<T>& rows, std::size_t n) {
+        EvaluateHarmonicField(ActiveInstructionSet(), rows, n);
+    }
+
+    template<class T>
+    void EvaluateHarmonicField(InstructionSet set, const HarmonicRows<T>& rows, std::size_t n) {
+#if defined(SIMULATION_SIMD_X86)
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            switch (set) {
+            case InstructionSet::SSE2:
+                EvaluateHarmonicFieldSSE2(rows, n);
+                return;
+            case InstructionSet::AVX2:
+                EvaluateHarmonicFieldAVX2(rows, n);
+                return;
+            case InstructionSet::AVX512:
+                EvaluateHarmonicFieldAVX512(rows, n);
+                return;
+            default:
+                break;
+            }
+        }
+#endif
+        EvaluateHarmonicFieldScalar(rows, 0, n);
+    }
+
+    template<class T>
+    void EvaluateHarmonicFieldScalar(const HarmonicRows<T>& rows, std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i++) {
+            auto x = (rows.X[i] - rows.CenterX) * rows.InverseRadius;
+            auto y = (rows.CenterY - rows.Y[i]) * rows.InverseRadius;
+            Kernel::HarmonicField(x, y, rows.Degree, rows.Terms, rows.RecurrenceA, rows.RecurrenceB, rows.Normalization, rows.DirectionX[i], rows.DirectionY[i]);
+        }
+    }
+
+    template<class T>
+    double MeasureHarmonicAccuracy(InstructionSet set, std::size_t samples) {
+        constexpr auto Degree = 8;
+        constexpr auto Size = (Degree + 1) * (Degree + 2) / 2;
+        const auto radius = 110.5l;
+
+        // Terms shrinking with the degree like a planet's, dipole first
+        long double terms[Size] = {}, a[Size] = {}, b[Size] = {};
+        for (int n = 1; n <= Degree; n++) {
+            for (int m = 0; m <= n; m++) {
+                terms[n * (n + 1) / 2 + m] = std::cos(1.7l * n + 2.3l * m) / (n * n * n);
+            }
+        }
+        terms[1] = -1.0l;
+        Kernel::HarmonicRecurrence(Degree, a, b);
+        T rowTerms[Size], rowA[Size], rowB[Size];
+        for (int k = 0; k < Size; k++) {
+            rowTerms[k] = T(terms[k]);
+            rowA[k] = T(a[k]);
+            rowB[k] = T(b[k]);
+        }
+
+        // Satellites on a spiral from the surface out to ten radii, all the way around
+        std::vector<T> x(samples), y(samples), directionX(samples), directionY(samples);
+        for (std::size_t i = 0; i < samples; i++) {
+            auto r = radius * (1.0l + 9.0l * i / samples);
+            auto angle = 37.0l * 2.0l * PI * i / samples;
+            x[i] = T(r * std::cos(angle));
+            y[i] = T(-r * std::sin(angle));
+        }
+
+        HarmonicRows<T> rows = {};
+        rows.Degree = Degree;
+        rows.Terms = rowTerms;
+        rows.RecurrenceA = rowA;
+        rows.RecurrenceB = rowB;
+        rows.Normalization = T(1);
+        rows.InverseRadius = T(1 / radius);
+        rows.X = x.data();
+        rows.Y = y.data();
+        rows.DirectionX = directionX.data();
+        rows.DirectionY = directionY.data();
+        EvaluateHarmonicField(set, rows, samples);
+
+        auto accuracy = 0.0;
+        for (std::size_t i = 0; i < samples; i++) {
+            long double bx, by;
+            Kernel::HarmonicField<long double>(x[i] / radius, -y[i] / radius, Degree, terms, a, b, 1.0l, bx, by);
+            auto size = std::sqrt(bx * bx + by * by);
+            if (size > 0.0l) {
+                auto error = std::hypot(directionX[i] - bx, directionY[i] - by);
+                accuracy = std::max(accuracy, (double)(error / size));
+            }
+        }
+        return accuracy;
+    }
+
+#define INSTANTIATE(T) \
+    template void UpdateOrbits<T>(T, T, const OrbitArrays<T>&, std::size_t); \
+    template void UpdateOrbits<T>(InstructionSet, T, T, const OrbitArrays<T>&, std::size_t); \
+    template void UpdateOrbitsScalar<T>(T, T, const OrbitArrays<T>&, std::size_t, std::size_t); \
+    template Accuracy MeasureAccuracy<T>(InstructionSet, std::size_t); \
+    template void SolveKepler<T>(const KeplerArrays<T>&, int, std::size_t); \
+    template void SolveKepler<T>(InstructionSet, const KeplerArrays<T>&, int, std::size_t); \
+    template void SolveKeplerScalar<T>(const KeplerArrays<T>&, int, std::size_t, std::size_t); \
+    template double MeasureKeplerAccuracy<T>(InstructionSet, std::size_t); \
+    template void EvaluateDipoleRow<T>(const DipoleRow<T>&, std::size_t); \
+    template void EvaluateDipoleRow<T>(InstructionSet, const DipoleRow<T>&, std::size_t); \
+    template void EvaluateDipoleRowScalar<T>(const DipoleRow<T>&, std::size_t, std::size_t); \
+    template double MeasureDipoleAccuracy<T>(InstructionSet, std::size_t); \
+    template void EvaluateVisibility<T>(const VisibilityRow<T>&, std::size_t); \
+    template void EvaluateVisibility<T>(InstructionSet, const VisibilityRow<T>&, std::size_t); \
+    template void EvaluateVisibilityScalar<T>(const VisibilityRow<T>&, std::size_t, std::size_t); \
+    template double MeasureVisibilityAccuracy<T>(InstructionSet, std::size_t); \
+    template void EvaluateHarmonicField<T>(const HarmonicRows<T>&, std::size_t); \
+    template void EvaluateHarmonicField<T>(InstructionSet, const HarmonicRows<T>&, std::size_t); \
+    template void EvaluateHarmonicFieldScalar<T>(const HarmonicRows<T>&, std::size_t, std::size_t); \
+    template double MeasureHarmonicAccuracy<T>(InstructionSet, std::size_t);
+
+    INSTANTIATE(float)
+    INSTANTIATE(double)
+    INSTANTIATE(long double)
+#undef INSTANTIATE
+}
@@ -0,0 +1,49 @@
+#include "../include/simd_orbit.h"
+#include "../include/simd_kepler.h"
+#include "../include/simd_dipole.h"
+#include "../include/simd_visibility.h"
+#include "../include/simd_harmonic.h"
+
+// Compiled for SSE2, only called after cpu_features.cpp confirmed the CPU supports it
+
+namespace Simulation::Simd {
+    void UpdateOrbitsSSE2(double earthX, double earthY, const OrbitArrays<double>& arrays, std::size_t n) {
+        UpdateOrbitsVector<SSE2<double>>(earthX, earthY, arrays, n);
+    }
+
+    void UpdateOrbitsSSE2(float earthX, float earthY, const OrbitArrays<float>& arrays, std::size_t n) {
+        UpdateOrbitsVector<SSE2<float>>(earthX, earthY, arrays, n);
+    }
+
+    void SolveKeplerSSE2(const KeplerArrays<double>& arrays, int iterations, std::size_t n) {
+        SolveKeplerVector<SSE2<double>>(arrays, iterations, n);
+    }
+
+    void SolveKeplerSSE2(const KeplerArrays<float>& arrays, int iterations, std::size_t n) {
+        SolveKeplerVector<SSE2<float>>(arrays, iterations, n);
+    }
+
+    void EvaluateDipoleRowSSE2(const DipoleRow<double>& row, std::size_t n) {
+        EvaluateDipoleRowVector<SSE2<double>>(row, n);
+    }
+
+    void EvaluateDipoleRowSSE2(const DipoleRow<float>& row, std::size_t n) {
+        EvaluateDipoleRowVector<SSE2<float>>(row, n);
+    }
+
+    void EvaluateVisibilitySSE2(const VisibilityRow<double>& row, std::size_t n) {
+        EvaluateVisibilityVector<SSE2<double>>(row, n);
+    }
+
+    void EvaluateVisibilitySSE2(const VisibilityRow<float>& row, std::size_t n) {
+        EvaluateVisibilityVector<SSE2<float>>(row, n);
+    }
+
+    void EvaluateHarmonicFieldSSE2(const HarmonicRows<double>& rows, std::size_t n) {
+        EvaluateHarmonicFieldVector<SSE2<double>>(rows, n);
+    }
+
+    void EvaluateHarmonicFieldSSE2(const HarmonicRows<float>& rows, std::size_t n) {
+        EvaluateHarmonicFieldVector<SSE2<float>>(rows, n);
+    }
+}
@@ -0,0 +1,48 @@
+#include "../include/simulation_clock.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Simulation {
+    SimulationClock::SimulationClock(std::chrono::nanoseconds step) : step(step), timeWarp(MinTimeWarp), accumulator(0.0), steps(0) {
+    }
+
+    std::chrono::nanoseconds SimulationClock::Step() const {
+        return step;
+    }
+
+    double SimulationClock::StepSeconds() const {
+        return std::chrono::duration<double>(step).count();
+    }
+
+    double SimulationClock::TimeWarp() const {
+        return timeWarp;
+    }
+
+    void SimulationClock::SetTimeWarp(double warp) {
+        timeWarp = std::clamp(warp, MinTimeWarp, MaxTimeWarp);
+    }
+
+    std::uint64_t SimulationClock::Advance(std::chrono::nanoseconds real) {
+        if (real.count() > 0) {
+            accumulator += real.count() * timeWarp;
+        }
+        auto stepNanoseconds = (double)step.count();
+        auto due = std::floor(accumulator / stepNanoseconds);
+        accumulator -= due * stepNanoseconds;
+        steps += (std::uint64_t)due;
+        return (std::uint64_t)due;
+    }
+
+    double SimulationClock::Alpha() const {
+        return accumulator / step.count();
+    }
+
+    std::uint64_t SimulationClock::Steps() const {
+        return steps;
+    }
+
+    void SimulationClock::Reset() {
+        accumulator = 0.0;
+        steps = 0;
+    }
+}
@@ -0,0 +1,136 @@
+#include "../include/simulation_state.h"
+#include "../include/orbit_kernel.h"
+#include "../include/circular_field_table.h"
+#include "../include/profiler.h"
+
+namespace Simulation {
+    template<class T>
+    BasicSimulationState<T>::BasicSimulationState() : Earth(), Satellite(), CircularField(), Satellites(), ElapsedNanoseconds(0), fieldModel(nullptr) {
+        Satellite.PeriodSeconds = DefaultPeriodSeconds;
+    }
+
+    template<class T>
+    void BasicSimulationState<T>::InitializeEarth(T radius, T x, T y) {
+        Earth.Radius = radius;
+        Earth.X = x;
+        Earth.Y = y;
+    }
+
+    template<class T>
+    void BasicSimulationState<T>::InitializeSatellite(T radius) {
+        Satellite.Radius = radius;
+        Satellite.RadiusTrajectory = DefaultTrajectoryEarthRadii * Earth.Radius;
+        ElapsedNanoseconds = 0;
+        SetOrbitFraction(0);
+    }
+
+    template<class T>
+    PhaseScalar<T> BasicSimulationState<T>::ElapsedSeconds() const {
+        return ElapsedNanoseconds / PhaseScalar<T>(1000000000);
+    }
+
+    template<class T>
+    void BasicSimulationState<T>::SetOrbitFraction(T fraction) {
+        auto phase = fraction - ElapsedSeconds() / Satellite.PeriodSeconds;
+        Satellite.PhaseOffset = phase - std::floor(phase);
+        Update();
+    }
+
+    template<class T>
+    void BasicSimulationState<T>::SetPeriod(T seconds) {
+        // Keep the current phase: offset' + t / period' == offset + t / period
+        auto t = ElapsedSeconds();
+        auto phase = Satellite.PhaseOffset + t / Satellite.PeriodSeconds - t / seconds;
+        Satellite.PhaseOffset = phase - std::floor(phase);
+        Satellite.PeriodSeconds = seconds;
+        Update();
+    }
+
+    template<class T>
+    void BasicSimulationState<T>::Update() {
+        SIMULATION_PROFILE_ZONE("State::Update");
+        UpdateAngle(ElapsedSeconds(), Satellite);
+        UpdateLocation(Satellite);
+        UpdateAxes(Satellite);
+        UpdateCircularField(Satellite, CircularField);
+    }
+
+    template<class T>
+    void BasicSimulationState<T>::Step(T dtSeconds) {
+        StepN(1, dtSeconds);
+    }
+
+    template<class T>
+    void BasicSimulationState<T>::StepN(std::uint64_t n, T dtSeconds) {
+        auto dtNanoseconds = std::llround((long double)dtSeconds * 1e9l);
+        StepNanoseconds((std::int64_t)n * dtNanoseconds);
+    }
+
+    template<class T>
+    void BasicSimulationState<T>::StepNanoseconds(std::int64_t nanoseconds) {
+        SIMULATION_PROFILE_ZONE("State::Step");
+        ElapsedNanoseconds += nanoseconds;
+        Update();
+        Satellites.Propagate(ElapsedSeconds(), Earth);
+    }
+
+    template<class T>
+    DisplayedState<T> BasicSimulationState<T>::DisplayedAt(std::int64_t elapsedNanoseconds) const {
+        DisplayedState<T> displayed = { elapsedNanoseconds, Satellite, CircularField };
+        UpdateAngle(elapsedNanoseconds / PhaseScalar<T>(1000000000), displayed.Satellite);
+        UpdateLocation(displayed.Satellite);
+        UpdateAxes(displayed.Satellite);
+        UpdateCircularField(displayed.Satellite, displayed.CircularField);
+        return displayed;
+    }
+
+    template<class T>
+    void BasicSimulationState<T>::SetFieldModel(const BasicSphericalHarmonicField<T>* model) {
+        fieldModel = model;
+        Satellites.FieldModel = model;
+        Update();
+        Satellites.Update(Earth);
+    }
+
+    template<class T>
+    const BasicSphericalHarmonicField<T>* BasicSimulationState<T>::FieldModel() const {
+        return fieldModel;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    template<class T>
+    void BasicSimulationState<T>::UpdateAngle(PhaseScalar<T> elapsedSeconds, SatelliteState<T>& satellite) const {
+        auto phase = satellite.PhaseOffset + elapsedSeconds / satellite.PeriodSeconds;
+        phase -= std::floor(phase);
+        if (phase >= 1) {
+            phase = 0; // A tiny negative phase rounds up to a full turn
+        }
+        satellite.AngleDegrees = T(360 * phase);
+        satellite.AngleRadians = T(2 * Pi<PhaseScalar<T>> * phase);
+    }
+
+    template<class T>
+    void BasicSimulationState<T>::UpdateLocation(SatelliteState<T>& satellite) const {
+        Kernel::Location(Earth.X, Earth.Y, satellite.RadiusTrajectory, satellite.AngleRadians, satellite.X, satellite.Y);
+    }
+
+    template<class T>
+    void BasicSimulationState<T>::UpdateAxes(SatelliteState<T>& satellite) const {
+        Kernel::RadialAxis(Earth.X, Earth.Y, satellite.X, satellite.Y, satellite.RadialDirectionX, satellite.RadialDirectionY);
+        Kernel::TangentAxis(Earth.X, Earth.Y, satellite.X, satellite.Y, satellite.TangentDirectionX, satellite.TangentDirectionY);
+    }
+
+    template<class T>
+    void BasicSimulationState<T>::UpdateCircularField(const SatelliteState<T>& satellite, CircularFieldState<T>& field) const {
+        SIMULATION_PROFILE_ZONE("Circular::Update");
+        DefaultCircularFieldTable<T>().Lookup(satellite.AngleRadians, satellite.RadiusTrajectory, field.DirectionX, field.DirectionY, field.Radius);
+        if (fieldModel != nullptr) {
+            fieldModel->Directions(Earth, &satellite.X, &satellite.Y, &field.DirectionX, &field.DirectionY, 1);
+        }
+    }
+
+    template class BasicSimulationState<float>;
+    template class BasicSimulationState<double>;
+    template class BasicSimulationState<long double>;
+}
@@ -0,0 +1,565 @@
+#include "../include/software_renderer.h"
+#include "../include/profiler.h"
+#include "../include/bitmap_font.h"
+#include "../include/field_lines.h"
+#include "../include/precision.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace Simulation {
+    // The discs drawn until a bitmap is supplied. The satellite image is mostly transparent
+    // around a small body, its disc only takes the middle of the square.
+    static constexpr Color PlaceholderEarth = { 0.15f, 0.35f, 0.8f, 1.0f };
+    static constexpr Color PlaceholderSatellite = { 0.7f, 0.7f, 0.75f, 1.0f };
+    static constexpr float PlaceholderSatelliteScale = 0.25f;
+
+    // Area of a one pixel wide box filter covered by an edge at signed distance d, inside positive
+    static float Coverage(float d) {
+        return std::clamp(d + 0.5f, 0.0f, 1.0f);
+    }
+
+    // Straight alpha over straight alpha
+    static void Blend(std::uint8_t* pixel, const Color& color, float coverage) {
+        auto a = color.A * coverage;
+        if (a <= 0) {
+            return;
+        }
+        const float source[3] = { color.R, color.G, color.B };
+        for (int c = 0; c < 3; c++) {
+            auto d = pixel[c] / 255.0f;
+            pixel[c] = (std::uint8_t)std::lround((d + (source[c] - d) * a) * 255.0f);
+        }
+        auto d = pixel[3] / 255.0f;
+        pixel[3] = (std::uint8_t)std::lround((d + (1 - d) * a) * 255.0f);
+    }
+
+    // Distance from (px, py) to the segment (x1, y1)-(x2, y2)
+    static float SegmentDistance(float px, float py, float x1, float y1, float x2, float y2) {
+        auto dx = x2 - x1, dy = y2 - y1;
+        auto length = dx * dx + dy * dy;
+        auto t = length > 0 ? std::clamp(((px - x1) * dx + (py - y1) * dy) / length, 0.0f, 1.0f) : 0.0f;
+        auto ex = px - (x1 + t * dx), ey = py - (y1 + t * dy);
+        return std::sqrt(ex * ex + ey * ey);
+    }
+
+    SoftwareRenderer::SoftwareRenderer(int width, int height, ThreadPool& pool) :
+        width(width), height(height), columns((width + TileSize - 1) / TileSize), rows((height + TileSize - 1) / TileSize),
+        pool(pool), pixels((std::size_t)width * height * 4), background{ 0, 0, 0, 1 },
+        layerKey(0), layerValid(false), layerUsed(false), layerChanged(false), recordingLayer(false),
+        drawnLast((std::size_t)columns * rows, 0), drawnNow((std::size_t)columns * rows, 0) {
+    }
+
+    const std::uint8_t* SoftwareRenderer::Pixels() const {
+        return pixels.data();
+    }
+
+    void SoftwareRenderer::SetBitmap(BitmapId id, int bitmapWidth, int bitmapHeight, std::vector<std::uint8_t> rgba) {
+        auto& image = bitmaps[(int)id];
+        image.Width = bitmapWidth;
+        image.Height = bitmapHeight;
+        image.Pixels = std::move(rgba);
+        // The key only covers what the scene draws, the kept layer may show the old image
+        layerValid = false;
+    }
+
+    bool SoftwareRenderer::WritePPM(const char* path) const {
+        auto file = std::fopen(path, "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+        std::vector<std::uint8_t> row((std::size_t)width * 3);
+        auto ok = true;
+        for (int y = 0; y < height && ok; y++) {
+            auto source = pixels.data() + (std::size_t)y * width * 4;
+            for (int x = 0; x < width; x++) {
+                row[x * 3 + 0] = source[x * 4 + 0];
+                row[x * 3 + 1] = source[x * 4 + 1];
+                row[x * 3 + 2] = source[x * 4 + 2];
+            }
+            ok = std::fwrite(row.data(), 1, row.size(), file) == row.size();
+        }
+        return std::fclose(file) == 0 && ok;
+    }
+
+    std::size_t SoftwareRenderer::DirtyTiles() const {
+        return dirty.size();
+    }
+
+    std::size_t SoftwareRenderer::Tiles() const {
+        return (std::size_t)columns * rows;
+    }
+
+    int SoftwareRenderer::Width() const {
+        return width;
+    }
+
+    int SoftwareRenderer::Height() const {
+        return height;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    void SoftwareRenderer::BeginFrame(Color color) {
+        // A new background shows through everywhere the layer left empty
+        if (color.R != background.R || color.G != background.G || color.B != background.B || color.A != background.A) {
+            layerValid = false;
+        }
+        background = color;
+        commands.clear();
+        text.clear();
+        layerUsed = false;
+        layerChanged = false;
+    }
+
+    void SoftwareRenderer::EndFrame() {
+        SIMULATION_PROFILE_ZONE("SoftwareRenderer::EndFrame");
+        // Without a layer every tile starts from the background, and the kept layer is lost
+        auto tiles = (std::size_t)columns * rows;
+        auto full = !layerUsed || layerChanged;
+        if (!layerUsed) {
+            layerValid = false;
+        }
+
+        std::fill(drawnNow.begin(), drawnNow.end(), 0);
+        for (const auto& command : commands) {
+            MarkCommand(drawnNow, command);
+        }
+        dirty.clear();
+        for (std::size_t tile = 0; tile < tiles; tile++) {
+            if (full || drawnNow[tile] || drawnLast[tile]) {
+                dirty.push_back(tile);
+            }
+        }
+        std::swap(drawnLast, drawnNow);
+
+        auto base = layerUsed ? layer.data() : nullptr;
+        pool.ParallelFor(dirty.size(), [this, base](std::size_t i) { RasterizeTile(pixels.data(), base, dirty[i]); });
+    }
+
+    bool SoftwareRenderer::BeginLayer(std::uint64_t key) {
+        layerUsed = true;
+        if (layerValid && key == layerKey) {
+            return false;
+        }
+        layerKey = key;
+        recordingLayer = true;
+        return true;
+    }
+
+    bool SoftwareRenderer::EndLayer() {
+        if (!recordingLayer) {
+            return true;
+        }
+        recordingLayer = false;
+
+        // Everything recorded so far is the layer, rasterized on its own and dropped from the frame
+        layer.resize(pixels.size());
+        pool.ParallelFor((std::size_t)columns * rows, [this](std::size_t tile) { RasterizeTile(layer.data(), nullptr, tile); });
+        commands.clear();
+        layerValid = true;
+        layerChanged = true;
+        return true;
+    }
+
+    void SoftwareRenderer::DrawBitmap(BitmapId id, float centerX, float centerY, float size, float rotationDegrees) {
+        Command command{};
+        command.Kind = Command::Type::Bitmap;
+        command.Bitmap = id;
+        command.Parameters[0] = centerX;
+        command.Parameters[1] = centerY;
+        command.Parameters[2] = size;
+        command.Parameters[3] = rotationDegrees * Pi<float> / 180.0f;
+        // The corners of the turned square stay within half its diagonal
+        auto reach = size * 0.7072f + 1;
+        command.MinX = centerX - reach;
+        command.MaxX = centerX + reach;
+        command.MinY = centerY - reach;
+        command.MaxY = centerY + reach;
+        commands.push_back(command);
+    }
+
+    void SoftwareRenderer::DrawEllipse(float centerX, float centerY, float radiusX, float radiusY, const Stroke& stroke) {
+        Command command{};
+        command.Kind = Command::Type::Ellipse;
+        command.Stroke = stroke;
+        command.Parameters[0] = centerX;
+        command.Parameters[1] = centerY;
+        command.Parameters[2] = radiusX;
+        command.Parameters[3] = radiusY;
+        auto half = stroke.Width / 2 + 1;
+        command.MinX = centerX - radiusX - half;
+        command.MaxX = centerX + radiusX + half;
+        command.MinY = centerY - radiusY - half;
+        command.MaxY = centerY + radiusY + half;
+        commands.push_back(command);
+    }
+
+    void SoftwareRenderer::DrawLine(float x1, float y1, float x2, float y2, const Stroke& stroke) {
+        Command command{};
+        command.Kind = Command::Type::Line;
+        command.Stroke = stroke;
+        command.Parameters[0] = x1;
+        command.Parameters[1] = y1;
+        command.Parameters[2] = x2;
+        command.Parameters[3] = y2;
+        // Caps reach at most half the width past either end
+        auto reach = stroke.Width + 1;
+        command.MinX = std::min(x1, x2) - reach;
+        command.MaxX = std::max(x1, x2) + reach;
+        command.MinY = std::min(y1, y2) - reach;
+        command.MaxY = std::max(y1, y2) + reach;
+        commands.push_back(command);
+    }
+
+    void SoftwareRenderer::DrawPolylines(const FieldLineSet& lines, const Stroke& stroke) {
+        if (lines.Points.empty()) {
+            return;
+        }
+        Command command{};
+        command.Kind = Command::Type::Polylines;
+        command.Stroke = stroke;
+        command.Lines = &lines;
+        command.MinX = command.MinY = INFINITY;
+        command.MaxX = command.MaxY = -INFINITY;
+        for (const auto& point : lines.Points) {
+            command.MinX = std::min(command.MinX, point.X);
+            command.MaxX = std::max(command.MaxX, point.X);
+            command.MinY = std::min(command.MinY, point.Y);
+            command.MaxY = std::max(command.MaxY, point.Y);
+        }
+        auto half = stroke.Width / 2 + 1;
+        command.MinX -= half;
+        command.MaxX += half;
+        command.MinY -= half;
+        command.MaxY += half;
+        commands.push_back(command);
+    }
+
+    void SoftwareRenderer::DrawString(std::wstring_view string, std::size_t, float x, float y, Color color) {
+        Command command{};
+        command.Kind = Command::Type::Text;
+        command.Stroke.Color = color;
+        command.Parameters[0] = std::round(x);
+        command.Parameters[1] = std::round(y);
+        command.TextBegin = text.size();
+        for (auto c : string) {
+            text.push_back((char32_t)c);
+        }
+        command.TextEnd = text.size();
+        float w, h;
+        MeasureString(string, w, h);
+        command.MinX = command.Parameters[0];
+        command.MinY = command.Parameters[1];
+        command.MaxX = command.MinX + w;
+        command.MaxY = command.MinY + h;
+        commands.push_back(command);
+    }
+
+    void SoftwareRenderer::MeasureString(std::wstring_view string, float& w, float& h) {
+        w = (float)(string.size() * BitmapFont::Advance * TextScale);
+        h = (float)(BitmapFont::LineHeight * TextScale);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    void SoftwareRenderer::MarkTiles(std::vector<std::uint8_t>& tiles, float minX, float minY, float maxX, float maxY) const {
+        // Rasterizing may reach one pixel past the bounds
+        auto x0 = std::max(0, (int)std::floor(minX) / TileSize), x1 = std::min(columns - 1, ((int)std::ceil(maxX) + 1) / TileSize);
+        auto y0 = std::max(0, (int)std::floor(minY) / TileSize), y1 = std::min(rows - 1, ((int)std::ceil(maxY) + 1) / TileSize);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                tiles[(std::size_t)y * columns + x] = 1;
+            }
+        }
+    }
+
+    void SoftwareRenderer::MarkCommand(std::vector<std::uint8_t>& tiles, const Command& command) const {
+        if (command.MaxX < 0 || command.MaxY < 0 || command.MinX > width || command.MinY > height) {
+            return;
+        }
+        if (command.Kind != Command::Type::Polylines) {
+            MarkTiles(tiles, command.MinX, command.MinY, command.MaxX, command.MaxY);
+            return;
+        }
+
+        // A line across the screen only touches the tiles along it, not its whole bounding box
+        const auto& lines = *command.Lines;
+        auto reach = command.Stroke.Width / 2 + 1;
+        for (std::size_t i = 0; i < lines.Lines(); i++) {
+            std::size_t count;
+            auto points = lines.Line(i, count);
+            for (std::size_t k = 1; k < count; k++) {
+                auto a = points[k - 1], b = points[k];
+                auto minX = std::min(a.X, b.X) - reach, maxX = std::max(a.X, b.X) + reach;
+                auto minY = std::min(a.Y, b.Y) - reach, maxY = std::max(a.Y, b.Y) + reach;
+                if (maxX >= 0 && maxY >= 0 && minX <= width && minY <= height) {
+                    MarkTiles(tiles, minX, minY, maxX, maxY);
+                }
+            }
+        }
+    }
+
+    void SoftwareRenderer::RasterizeTile(std::uint8_t* target, const std::uint8_t* base, std::size_t index) {
+        Tile tile;
+        tile.Pixels = target;
+        tile.Stride = width * 4;
+        tile.X0 = (int)(index % columns) * TileSize;
+        tile.Y0 = (int)(index / columns) * TileSize;
+        tile.X1 = std::min(tile.X0 + TileSize, width);
+        tile.Y1 = std::min(tile.Y0 + TileSize, height);
+
+        if (base != nullptr) {
+            for (int y = tile.Y0; y < tile.Y1; y++) {
+                auto offset = (std::size_t)y * tile.Stride + tile.X0 * 4;
+                std::copy(base + offset, base + offset + (tile.X1 - tile.X0) * 4, target + offset);
+            }
+        }
+        else {
+            const std::uint8_t clear[4] = {
+                (std::uint8_t)std::lround(background.R * 255.0f),
+                (std::uint8_t)std::lround(background.G * 255.0f),
+                (std::uint8_t)std::lround(background.B * 255.0f),
+                (std::uint8_t)std::lround(background.A * 255.0f)
+            };
+            for (int y = tile.Y0; y < tile.Y1; y++) {
+                auto row = tile.Pixels + (std::size_t)y * tile.Stride;
+                for (int x = tile.X0; x < tile.X1; x++) {
+                    std::copy(clear, clear + 4, row + x * 4);
+                }
+            }
+        }
+
+        for (const auto& command : commands) {
+            if (command.MaxX < tile.X0 || command.MinX > tile.X1 || command.MaxY < tile.Y0 || command.MinY > tile.Y1) {
+                continue;
+            }
+            // Only the part of the tile the command can reach
+            Tile clipped = tile;
+            clipped.X0 = std::max(tile.X0, (int)std::floor(command.MinX));
+            clipped.Y0 = std::max(tile.Y0, (int)std::floor(command.MinY));
+            clipped.X1 = std::min(tile.X1, (int)std::ceil(command.MaxX) + 1);
+            clipped.Y1 = std::min(tile.Y1, (int)std::ceil(command.MaxY) + 1);
+            switch (command.Kind) {
+            case Command::Type::Bitmap:
+                RasterizeBitmap(clipped, command);
+                break;
+            case Command::Type::Ellipse:
+                RasterizeEllipse(clipped, command);
+                break;
+            case Command::Type::Line:
+                RasterizeLine(clipped, command);
+                break;
+            case Command::Type::Polylines:
+                RasterizePolylines(clipped, command);
+                break;
+            case Command::Type::Text:
+                RasterizeText(clipped, command);
+                break;
+            }
+        }
+    }
+
+    void SoftwareRenderer::RasterizeBitmap(const Tile& tile, const Command& command) const {
+        auto cx = command.Parameters[0], cy = command.Parameters[1];
+        auto size = command.Parameters[2], half = size / 2;
+        auto cosine = std::cos(command.Parameters[3]), sine = std::sin(command.Parameters[3]);
+        const auto& image = bitmaps[(int)command.Bitmap];
+
+        for (int y = tile.Y0; y < tile.Y1; y++) {
+            auto row = tile.Pixels + (std::size_t)y * tile.Stride;
+            for (int x = tile.X0; x < tile.X1; x++) {
+                // Back into the unturned square, clockwise on screen is the other way round in y down
+                auto dx = x + 0.5f - cx, dy = y + 0.5f - cy;
+                auto u = dx * cosine + dy * sine;
+                auto v = -dx * sine + dy * cosine;
+
+                if (image.Pixels.empty()) {
+                    auto earth = command.Bitmap == BitmapId::Earth;
+                    auto radius = earth ? half : half * PlaceholderSatelliteScale;
+                    Blend(row + x * 4, earth ? PlaceholderEarth : PlaceholderSatellite, Coverage(radius - std::sqrt(u * u + v * v)));
+                    continue;
+                }
+
+                // Bilinear on premultiplied values, so transparent texels do not bleed their colour
+                auto sx = (u + half) / size * image.Width - 0.5f;
+                auto sy = (v + half) / size * image.Height - 0.5f;
+                if (sx < -0.5f || sy < -0.5f || sx > image.Width - 0.5f || sy > image.Height - 0.5f) {
+                    continue;
+                }
+                auto x0 = (int)std::floor(sx), y0 = (int)std::floor(sy);
+                auto fx = sx - x0, fy = sy - y0;
+                float sum[4] = {};
+                for (int j = 0; j < 2; j++) {
+                    for (int i = 0; i < 2; i++) {
+                        auto tx = std::clamp(x0 + i, 0, image.Width - 1);
+                        auto ty = std::clamp(y0 + j, 0, image.Height - 1);
+                        auto weight = (i ? fx : 1 - fx) * (j ? fy : 1 - fy);
+                        auto texel = image.Pixels.data() + ((std::size_t)ty * image.Width + tx) * 4;
+                        auto alpha = texel[3] / 255.0f;
+                        for (int c = 0; c < 3; c++) {
+                            sum[c] += weight * alpha * texel[c] / 255.0f;
+                        }
+                        sum[3] += weight * alpha;
+                    }
+                }
+                if (sum[3] > 0) {
+                    Color color = { sum[0] / sum[3], sum[1] / sum[3], sum[2] / sum[3], sum[3] };
+                    Blend(row + x * 4, color, 1.0f);
+                }
+            }
+        }
+    }
+
+    void SoftwareRenderer::RasterizeEllipse(const Tile& tile, const Command& command) const {
+        auto cx = command.Parameters[0], cy = command.Parameters[1];
+        auto rx = command.Parameters[2], ry = command.Parameters[3];
+        const auto& stroke = command.Stroke;
+        auto half = stroke.Width / 2;
+        // Dash and gap each twice the width, measured along the mean radius
+        auto dash = 2 * stroke.Width, period = 2 * dash, mean = (rx + ry) / 2;
+
+        for (int y = tile.Y0; y < tile.Y1; y++) {
+            auto row = tile.Pixels + (std::size_t)y * tile.Stride;
+            for (int x = tile.X0; x < tile.X1; x++) {
+                auto dx = x + 0.5f - cx, dy = y + 0.5f - cy;
+                float distance;
+                if (rx == ry) {
+                    distance = std::abs(std::sqrt(dx * dx + dy * dy) - rx);
+                }
+                else {
+                    // First order distance to the implicit curve, |f| / |grad f|
+                    auto f = dx * dx / (rx * rx) + dy * dy / (ry * ry) - 1;
+                    auto gx = 2 * dx / (rx * rx), gy = 2 * dy / (ry * ry);
+                    distance = std::abs(f) / std::sqrt(gx * gx + gy * gy);
+                }
+                auto coverage = Coverage(half - distance);
+                if (coverage <= 0) {
+                    continue;
+                }
+                if (stroke.Style == StrokeStyle::Dashed) {
+                    auto along = (std::atan2(dy, dx) + Pi<float>) * mean;
+                    auto phase = std::fmod(along, period);
+                    // Signed distance to the nearest dash end
+                    auto inside = phase < dash ? std::min(phase, dash - phase) : std::max(dash - phase, phase - period);
+                    coverage *= Coverage(inside);
+                }
+                Blend(row + x * 4, stroke.Color, coverage);
+            }
+        }
+    }
+
+    void SoftwareRenderer::RasterizeLine(const Tile& tile, const Command& command) const {
+        auto x1 = command.Parameters[0], y1 = command.Parameters[1];
+        auto x2 = command.Parameters[2], y2 = command.Parameters[3];
+        const auto& stroke = command.Stroke;
+        auto half = stroke.Width / 2;
+        auto length = std::sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+        if (length <= 0) {
+            return;
+        }
+        auto ux = (x2 - x1) / length, uy = (y2 - y1) / length;
+
+        for (int y = tile.Y0; y < tile.Y1; y++) {
+            auto row = tile.Pixels + (std::size_t)y * tile.Stride;
+            for (int x = tile.X0; x < tile.X1; x++) {
+                auto px = x + 0.5f - x1, py = y + 0.5f - y1;
+                // Along the line from the start and across it
+                auto t = px * ux + py * uy;
+                auto n = std::abs(px * uy - py * ux);
+                float inside;
+                if (stroke.Style == StrokeStyle::Arrow) {
+                    if (t < 0) {
+                        // Round start cap
+                        inside = half - std::sqrt(t * t + n * n);
+                    }
+                    else if (t > length) {
+                        // Triangle end cap, its tip half the width past the end
+                        inside = std::min(half - n, (half - n - (t - length)) / 1.41421356f);
+                    }
+                    else {
+                        inside = half - n;
+                    }
+                }
+                else {
+                    inside = std::min(half - n, std::min(t, length - t));
+                }
+                Blend(row + x * 4, stroke.Color, Coverage(inside));
+            }
+        }
+    }
+
+    void SoftwareRenderer::RasterizePolylines(const Tile& tile, const Command& command) const {
+        const auto& lines = *command.Lines;
+        const auto& stroke = command.Stroke;
+        auto half = stroke.Width / 2, reach = half + 1;
+
+        // Nearest segment per pixel, each segment only visiting the pixels it can reach. Blending
+        // once from the nearest distance keeps overlapping segments of one set from doubling up
+        // and makes the joins round.
+        thread_local float nearest[TileSize * TileSize];
+        std::fill(nearest, nearest + TileSize * TileSize, INFINITY);
+        auto touched = false;
+        for (std::size_t i = 0; i < lines.Lines(); i++) {
+            std::size_t count;
+            auto points = lines.Line(i, count);
+            for (std::size_t k = 1; k < count; k++) {
+                auto a = points[k - 1], b = points[k];
+                auto x0 = std::max(tile.X0, (int)std::floor(std::min(a.X, b.X) - reach));
+                auto x1 = std::min(tile.X1, (int)std::ceil(std::max(a.X, b.X) + reach));
+                auto y0 = std::max(tile.Y0, (int)std::floor(std::min(a.Y, b.Y) - reach));
+                auto y1 = std::min(tile.Y1, (int)std::ceil(std::max(a.Y, b.Y) + reach));
+                for (int y = y0; y < y1; y++) {
+                    auto row = nearest + (y - tile.Y0) * TileSize - tile.X0;
+                    for (int x = x0; x < x1; x++) {
+                        row[x] = std::min(row[x], SegmentDistance(x + 0.5f, y + 0.5f, a.X, a.Y, b.X, b.Y));
+                    }
+                }
+                touched |= x0 < x1 && y0 < y1;
+            }
+        }
+        if (!touched) {
+            return;
+        }
+
+        for (int y = tile.Y0; y < tile.Y1; y++) {
+            auto row = tile.Pixels + (std::size_t)y * tile.Stride;
+            auto distances = nearest + (y - tile.Y0) * TileSize - tile.X0;
+            for (int x = tile.X0; x < tile.X1; x++) {
+                if (distances[x] < reach) {
+                    Blend(row + x * 4, stroke.Color, Coverage(half - distances[x]));
+                }
+            }
+        }
+    }
+
+    void SoftwareRenderer::RasterizeText(const Tile& tile, const Command& command) const {
+        auto originX = (int)command.Parameters[0], originY = (int)command.Parameters[1];
+        for (auto i = command.TextBegin; i < command.TextEnd; i++) {
+            auto glyph = BitmapFont::Glyph(text[i]);
+            auto glyphX = originX + (int)(i - command.TextBegin) * BitmapFont::Advance * TextScale;
+            if (glyphX >= tile.X1 || glyphX + BitmapFont::GlyphWidth * TextScale <= tile.X0) {
+                continue;
+            }
+            for (int r = 0; r < BitmapFont::GlyphHeight; r++) {
+                for (int c = 0; c < BitmapFont::GlyphWidth; c++) {
+                    if ((glyph[r] & (0x10 >> c)) == 0) {
+                        continue;
+                    }
+                    // One font pixel is a TextScale square
+                    auto left = std::max(tile.X0, glyphX + c * TextScale);
+                    auto right = std::min(tile.X1, glyphX + (c + 1) * TextScale);
+                    auto top = std::max(tile.Y0, originY + r * TextScale);
+                    auto bottom = std::min(tile.Y1, originY + (r + 1) * TextScale);
+                    for (int y = top; y < bottom; y++) {
+                        auto row = tile.Pixels + (std::size_t)y * tile.Stride;
+                        for (int x = left; x < right; x++) {
+                            Blend(row + x * 4, command.Stroke.Color, 1.0f);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
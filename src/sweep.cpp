@@ -0,0 +1,165 @@
+#include "../include/sweep.h"
+#include "../include/simulation_state.h"
+#include "../include/profiler.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace Simulation {
+    bool SweepRange::Parse(const char* text, SweepRange& range) {
+        char* end;
+        range.From = std::strtod(text, &end);
+        if (end == text) {
+            return false;
+        }
+        if (*end == 0) {
+            range.To = range.From;
+            range.Count = 1;
+            return std::isfinite(range.From);
+        }
+        if (*end != ':') {
+            return false;
+        }
+        auto next = end + 1;
+        range.To = std::strtod(next, &end);
+        if (end == next || *end != ':') {
+            return false;
+        }
+        next = end + 1;
+        range.Count = (std::size_t)std::strtoull(next, &end, 10);
+        return end != next && *end == 0 && range.Count > 0 && std::isfinite(range.From) && std::isfinite(range.To);
+    }
+
+    std::vector<double> SweepRange::Values() const {
+        std::vector<double> values(Count);
+        for (std::size_t i = 0; i < Count; i++) {
+            values[i] = Count > 1 ? From + (To - From) * i / (Count - 1) : From;
+        }
+        return values;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    template<class T>
+    std::vector<SweepCase> BasicParameterSweep<T>::Grid(const std::vector<double>& periods, const std::vector<double>& radii, double durationSeconds, double stepSeconds) {
+        std::vector<SweepCase> cases;
+        cases.reserve(periods.size() * radii.size());
+        for (auto period : periods) {
+            for (auto radius : radii) {
+                cases.push_back({ period, radius, durationSeconds, stepSeconds });
+            }
+        }
+        return cases;
+    }
+
+    template<class T>
+    bool BasicParameterSweep<T>::Load(const std::string& path, std::vector<SweepCase>& cases, std::string& error) {
+        auto file = std::fopen(path.c_str(), "r");
+        if (file == nullptr) {
+            error = path + ": can not be read";
+            return false;
+        }
+        cases.clear();
+        char text[512];
+        for (std::size_t line = 1; std::fgets(text, sizeof(text), file) != nullptr; line++) {
+            if (auto comment = std::strchr(text, '#')) {
+                *comment = 0;
+            }
+            SweepCase c;
+            char rest;
+            auto fields = std::sscanf(text, "%lf %lf %lf %lf %c", &c.PeriodSeconds, &c.TrajectoryEarthRadii, &c.DurationSeconds, &c.StepSeconds, &rest);
+            if (fields == EOF) {
+                continue;
+            }
+            if (fields != 4) {
+                error = path + ":" + std::to_string(line) + ": expected PERIOD RADII DURATION STEP";
+                std::fclose(file);
+                return false;
+            }
+            cases.push_back(c);
+        }
+        std::fclose(file);
+        return true;
+    }
+
+    template<class T>
+    const std::vector<SweepResult>& BasicParameterSweep<T>::Run(const std::vector<SweepCase>& cases, ThreadPool& pool) {
+        SIMULATION_PROFILE_ZONE("ParameterSweep::Run");
+        results.assign(cases.size(), {});
+        auto begin = Now();
+        pool.ParallelFor(cases.size(), [&](std::size_t i) {
+            results[i] = RunCase(cases[i]);
+        });
+        seconds = std::chrono::duration<double>(Now() - begin).count();
+        return results;
+    }
+
+    template<class T>
+    const std::vector<SweepResult>& BasicParameterSweep<T>::Results() const {
+        return results;
+    }
+
+    template<class T>
+    double BasicParameterSweep<T>::Seconds() const {
+        return seconds;
+    }
+
+    template<class T>
+    double BasicParameterSweep<T>::BusySeconds() const {
+        auto busy = 0.0;
+        for (const auto& result : results) {
+            busy += result.Seconds;
+        }
+        return busy;
+    }
+
+    template<class T>
+    SweepResult BasicParameterSweep<T>::RunCase(const SweepCase& c) {
+        SweepResult result = {};
+        result.Case = c;
+        auto step = std::llround(c.StepSeconds * 1e9);
+        if (!(c.PeriodSeconds > 0) || !(c.TrajectoryEarthRadii > 0) || !(c.DurationSeconds >= 0) || step <= 0) {
+            return result;
+        }
+        auto begin = Now();
+
+        // Lengths in Earth radii, the Earth at the origin
+        BasicSimulationState<T> state;
+        state.InitializeEarth(T(1), T(0), T(0));
+        state.InitializeSatellite(T(0));
+        state.Satellite.PeriodSeconds = T(c.PeriodSeconds);
+        state.Satellite.RadiusTrajectory = T(c.TrajectoryEarthRadii);
+        state.SetOrbitFraction(0);
+
+        auto falloff = 1.0 / (c.TrajectoryEarthRadii * c.TrajectoryEarthRadii * c.TrajectoryEarthRadii);
+        auto steps = (std::uint64_t)std::ceil(c.DurationSeconds * 1e9 / (double)step);
+        auto minimum = std::numeric_limits<double>::max(), maximum = 0.0;
+        std::bitset<360> sectors;
+        for (std::uint64_t k = 0; ; k++) {
+            const auto& field = state.CircularField;
+            auto strength = std::sqrt((double)field.DirectionX * (double)field.DirectionX + (double)field.DirectionY * (double)field.DirectionY);
+            minimum = std::min(minimum, strength);
+            maximum = std::max(maximum, strength);
+            sectors.set(std::min((std::size_t)state.Satellite.AngleDegrees, sectors.size() - 1));
+            if (k == steps) {
+                break;
+            }
+            state.StepNanoseconds(step);
+        }
+
+        result.Steps = steps;
+        result.MinField = minimum * falloff;
+        result.MaxField = maximum * falloff;
+        result.Coverage = (double)sectors.count() / sectors.size();
+        result.Seconds = std::chrono::duration<double>(Now() - begin).count();
+        return result;
+    }
+
+    template class BasicParameterSweep<float>;
+    template class BasicParameterSweep<double>;
+    template class BasicParameterSweep<long double>;
+}
@@ -0,0 +1,243 @@
+#include "../include/telemetry.h"
+#include "../include/profiler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace Simulation {
+    const char* ToString(TelemetryColumn column) {
+        switch (column) {
+        case TelemetryColumn::Time: return "time_ns";
+        case TelemetryColumn::Angle: return "angle_deg";
+        case TelemetryColumn::X: return "x";
+        case TelemetryColumn::Y: return "y";
+        case TelemetryColumn::RadialX: return "radial_x";
+        case TelemetryColumn::RadialY: return "radial_y";
+        case TelemetryColumn::TangentX: return "tangent_x";
+        case TelemetryColumn::TangentY: return "tangent_y";
+        case TelemetryColumn::FieldX: return "field_x";
+        case TelemetryColumn::FieldY: return "field_y";
+        case TelemetryColumn::FieldRadius: return "field_radius";
+        case TelemetryColumn::Period: return "period_sec";
+        default: return "unknown";
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    TelemetryRecorder::TelemetryRecorder(const std::string& path, const TelemetryScene& scene, std::size_t blockRows)
+        : blockRows(std::max<std::size_t>(1, blockRows)), file(nullptr), filling(nullptr), rows(0), stalls(0), stopping(false), failed(false) {
+        blocks.resize(Buffers);
+        for (auto& block : blocks) {
+            block.Cells.assign(TelemetryColumns * this->blockRows, 0);
+            block.Rows = 0;
+            freeBlocks.push_back(&block);
+        }
+        full.reserve(Buffers);
+
+        file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            failed = true;
+            return;
+        }
+        std::vector<std::uint8_t> bytes(TelemetryHeader::Bytes, 0);
+        TelemetryHeader header = {};
+        std::memcpy(header.Magic, TelemetryHeader::Signature, sizeof(header.Magic));
+        header.Version = TelemetryHeader::CurrentVersion;
+        header.HeaderBytes = (std::uint32_t)TelemetryHeader::Bytes;
+        header.Columns = (std::uint32_t)TelemetryColumns;
+        header.BlockRows = (std::uint32_t)this->blockRows;
+        header.Rows = 0;
+        header.Scene = scene;
+        for (std::size_t c = 0; c < TelemetryColumns; c++) {
+            auto& info = header.ColumnInfo[c];
+            std::strncpy(info.Name, ToString((TelemetryColumn)c), sizeof(info.Name) - 1);
+            info.Type = c == (std::size_t)TelemetryColumn::Time ? TelemetryHeader::Int64 : TelemetryHeader::Float64;
+        }
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        if (std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size()) {
+            failed = true;
+            return;
+        }
+        writer = std::thread([this] { WriterLoop(); });
+    }
+
+    TelemetryRecorder::~TelemetryRecorder() {
+        Finish();
+    }
+
+    bool TelemetryRecorder::Failed() const {
+        std::lock_guard lock(mutex);
+        return failed;
+    }
+
+    std::uint64_t TelemetryRecorder::Rows() const {
+        return rows;
+    }
+
+    std::uint64_t TelemetryRecorder::Stalls() const {
+        return stalls;
+    }
+
+    void TelemetryRecorder::Record(const TelemetrySample& sample) {
+        if (filling == nullptr) {
+            std::unique_lock lock(mutex);
+            if (stopping || !writer.joinable()) {
+                return;
+            }
+            if (freeBlocks.empty()) {
+                stalls++;
+                freed.wait(lock, [this] { return !freeBlocks.empty(); });
+            }
+            filling = freeBlocks.back();
+            freeBlocks.pop_back();
+            filling->Rows = 0;
+        }
+
+        // Column c of the block starts at cell c * blockRows
+        auto row = filling->Rows;
+        auto cells = filling->Cells.data();
+        std::memcpy(cells + row, &sample.ElapsedNanoseconds, sizeof(std::uint64_t));
+        for (std::size_t c = 1; c < TelemetryColumns; c++) {
+            std::memcpy(cells + c * blockRows + row, &sample.Values[c - 1], sizeof(std::uint64_t));
+        }
+        filling->Rows++;
+        rows++;
+        if (filling->Rows == blockRows) {
+            Queue(filling);
+            filling = nullptr;
+        }
+    }
+
+    void TelemetryRecorder::Queue(Block* block) {
+        {
+            std::lock_guard lock(mutex);
+            full.push_back(block);
+        }
+        queued.notify_one();
+    }
+
+    void TelemetryRecorder::Finish() {
+        if (!writer.joinable()) {
+            if (file != nullptr) {
+                std::fclose(file);
+                file = nullptr;
+            }
+            return;
+        }
+        if (filling != nullptr && filling->Rows > 0) {
+            // Zero what the previous use of the buffer left behind the last row
+            for (std::size_t c = 0; c < TelemetryColumns; c++) {
+                auto column = filling->Cells.data() + c * blockRows;
+                std::fill(column + filling->Rows, column + blockRows, 0);
+            }
+            Queue(filling);
+        }
+        filling = nullptr;
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        queued.notify_all();
+        writer.join();
+        if (std::fclose(file) != 0) {
+            std::lock_guard lock(mutex);
+            failed = true;
+        }
+        file = nullptr;
+    }
+
+    void TelemetryRecorder::WriterLoop() {
+        Profiler::SetThreadName("Telemetry");
+        std::uint64_t written = 0;
+        while (true) {
+            Block* block;
+            {
+                std::unique_lock lock(mutex);
+                queued.wait(lock, [this] { return !full.empty() || stopping; });
+                if (full.empty()) {
+                    return;
+                }
+                block = full.front();
+                full.erase(full.begin());
+            }
+
+            SIMULATION_PROFILE_ZONE("TelemetryRecorder::Write");
+            // The block first, then the row count that makes it visible to readers
+            auto bytes = block->Cells.size() * sizeof(std::uint64_t);
+            auto ok = std::fwrite(block->Cells.data(), 1, bytes, file) == bytes;
+            written += block->Rows;
+            ok &= std::fseek(file, (long)offsetof(TelemetryHeader, Rows), SEEK_SET) == 0;
+            ok &= std::fwrite(&written, sizeof(written), 1, file) == 1;
+            ok &= std::fseek(file, 0, SEEK_END) == 0;
+            ok &= std::fflush(file) == 0;
+
+            {
+                std::lock_guard lock(mutex);
+                failed |= !ok;
+                freeBlocks.push_back(block);
+            }
+            freed.notify_one();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    bool TelemetryFile::Open(const std::string& path) {
+        header = nullptr;
+        blocks = 0;
+        if (!file.Open(path) || file.Size() < TelemetryHeader::Bytes) {
+            return false;
+        }
+        auto candidate = reinterpret_cast<const TelemetryHeader*>(file.Data());
+        if (std::memcmp(candidate->Magic, TelemetryHeader::Signature, sizeof(candidate->Magic)) != 0 ||
+            candidate->Version != TelemetryHeader::CurrentVersion || candidate->HeaderBytes != TelemetryHeader::Bytes ||
+            candidate->Columns != TelemetryColumns || candidate->BlockRows == 0) {
+            return false;
+        }
+        // Only the blocks the header counts, a file still being recorded may have more
+        auto blockBytes = (std::uint64_t)candidate->BlockRows * TelemetryColumns * sizeof(std::uint64_t);
+        auto count = (candidate->Rows + candidate->BlockRows - 1) / candidate->BlockRows;
+        if (TelemetryHeader::Bytes + count * blockBytes > file.Size()) {
+            return false;
+        }
+        header = candidate;
+        blocks = (std::size_t)count;
+        return true;
+    }
+
+    std::uint64_t TelemetryFile::Rows() const {
+        return header != nullptr ? header->Rows : 0;
+    }
+
+    const TelemetryScene& TelemetryFile::Scene() const {
+        return header->Scene;
+    }
+
+    std::size_t TelemetryFile::BlockRows() const {
+        return header != nullptr ? header->BlockRows : 0;
+    }
+
+    std::size_t TelemetryFile::Blocks() const {
+        return blocks;
+    }
+
+    std::size_t TelemetryFile::RowsIn(std::size_t block) const {
+        auto begin = (std::uint64_t)block * header->BlockRows;
+        return (std::size_t)std::min<std::uint64_t>(header->BlockRows, header->Rows - begin);
+    }
+
+    const std::uint8_t* TelemetryFile::Cells(std::size_t column, std::size_t block) const {
+        auto columnBytes = (std::size_t)header->BlockRows * sizeof(std::uint64_t);
+        return file.Data() + TelemetryHeader::Bytes + (block * TelemetryColumns + column) * columnBytes;
+    }
+
+    const std::int64_t* TelemetryFile::Times(std::size_t block) const {
+        return reinterpret_cast<const std::int64_t*>(Cells((std::size_t)TelemetryColumn::Time, block));
+    }
+
+    const double* TelemetryFile::Column(TelemetryColumn column, std::size_t block) const {
+        return reinterpret_cast<const double*>(Cells((std::size_t)column, block));
+    }
+}
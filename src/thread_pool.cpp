@@ -0,0 +1,161 @@
+#include "../include/thread_pool.h"
+#include "../include/profiler.h"
+
+#include <algorithm>
+
+namespace Simulation {
+    static thread_local bool insideTask = false;
+
+    static std::uint64_t Pack(std::uint64_t begin, std::uint64_t end) {
+        return begin | end << 32;
+    }
+
+    static std::uint64_t Begin(std::uint64_t bounds) {
+        return bounds & 0xFFFFFFFFu;
+    }
+
+    static std::uint64_t End(std::uint64_t bounds) {
+        return bounds >> 32;
+    }
+
+    ThreadPool::ThreadPool(unsigned threads) : generation(0), busy(0), stopping(false), task(nullptr), offset(0) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        ranges.reset(new Range[threads]);
+        for (unsigned i = 0; i < threads; i++) {
+            ranges[i].Bounds.store(0, std::memory_order_relaxed);
+        }
+        for (unsigned i = 1; i < threads; i++) {
+            workers.emplace_back([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    unsigned ThreadPool::Size() const {
+        return (unsigned)workers.size() + 1;
+    }
+
+    void ThreadPool::ParallelFor(std::size_t n, const std::function<void(std::size_t)>& fn) {
+        if (n == 0) {
+            return;
+        }
+        if (insideTask || workers.empty() || n == 1) {
+            for (std::size_t i = 0; i < n; i++) {
+                fn(i);
+            }
+            return;
+        }
+
+        std::lock_guard callerLock(callerMutex);
+        for (std::size_t first = 0; first < n; first += MaxRange) {
+            auto rounds = std::min(n - first, MaxRange);
+            auto threads = Size();
+            {
+                std::lock_guard lock(mutex);
+                task = &fn;
+                offset = first;
+                for (unsigned i = 0; i < threads; i++) {
+                    ranges[i].Bounds.store(Pack(rounds * i / threads, rounds * (i + 1) / threads), std::memory_order_relaxed);
+                }
+                busy = (unsigned)workers.size();
+                generation++;
+            }
+            wake.notify_all();
+
+            RunTasks(0);
+
+            // The workers still hold a pointer to the task until they check out
+            std::unique_lock lock(mutex);
+            done.wait(lock, [this] { return busy == 0; });
+            task = nullptr;
+        }
+    }
+
+    ThreadPool& ThreadPool::Shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    void ThreadPool::WorkerLoop(unsigned index) {
+        Profiler::SetThreadName("Pool");
+        std::uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+
+            RunTasks(index);
+
+            {
+                std::lock_guard lock(mutex);
+                busy--;
+            }
+            done.notify_one();
+        }
+    }
+
+    void ThreadPool::RunTasks(unsigned index) {
+        insideTask = true;
+        auto& own = ranges[index].Bounds;
+        do {
+            auto bounds = own.load(std::memory_order_acquire);
+            while (Begin(bounds) < End(bounds)) {
+                // Fails only when a thief took the back half in between
+                if (own.compare_exchange_weak(bounds, Pack(Begin(bounds) + 1, End(bounds)), std::memory_order_acq_rel)) {
+                    (*task)(offset + Begin(bounds));
+                    bounds = own.load(std::memory_order_acquire);
+                }
+            }
+        } while (Steal(index));
+        insideTask = false;
+    }
+
+    // Half of the largest range left into the thief's own, false once no range has two indices
+    // left: a last one is for its owner to run
+    bool ThreadPool::Steal(unsigned index) {
+        auto threads = Size();
+        while (true) {
+            unsigned victim = index;
+            std::uint64_t largest = 1;
+            for (unsigned k = 1; k < threads; k++) {
+                auto other = (index + k) % threads;
+                auto bounds = ranges[other].Bounds.load(std::memory_order_relaxed);
+                if (End(bounds) > Begin(bounds) && End(bounds) - Begin(bounds) > largest) {
+                    largest = End(bounds) - Begin(bounds);
+                    victim = other;
+                }
+            }
+            if (victim == index) {
+                return false;
+            }
+            auto& from = ranges[victim].Bounds;
+            auto bounds = from.load(std::memory_order_acquire);
+            auto begin = Begin(bounds), end = End(bounds);
+            if (end <= begin || end - begin < 2) {
+                continue;
+            }
+            auto middle = begin + (end - begin) / 2;
+            if (from.compare_exchange_strong(bounds, Pack(begin, middle), std::memory_order_acq_rel)) {
+                // Empty until now, so nobody else writes it
+                ranges[index].Bounds.store(Pack(middle, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+}
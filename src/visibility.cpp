@@ -0,0 +1,286 @@
+#include "../include/visibility.h"
+#include "../include/kepler.h"
+#include "../include/orbit_kernel.h"
+#include "../include/simd_kernel.h"
+#include "../include/profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Simulation {
+    template<class T>
+    std::size_t BasicGroundStations<T>::Size() const {
+        return AngleRadians.size();
+    }
+
+    template<class T>
+    void BasicGroundStations<T>::Reserve(std::size_t n) {
+        for (auto field : { &AngleRadians, &MinElevation, &UpX, &UpY, &MaskTerm }) {
+            field->reserve(n);
+        }
+    }
+
+    template<class T>
+    void BasicGroundStations<T>::Clear() {
+        for (auto field : { &AngleRadians, &MinElevation, &UpX, &UpY, &MaskTerm }) {
+            field->clear();
+        }
+    }
+
+    template<class T>
+    std::size_t BasicGroundStations<T>::Add(T angleRadians, T minElevationRadians) {
+        auto index = Size();
+        auto mask = std::clamp(minElevationRadians, T(0), Pi<T> / 2);
+        AngleRadians.push_back(angleRadians);
+        MinElevation.push_back(mask);
+        UpX.push_back(std::cos(angleRadians));
+        UpY.push_back(std::sin(angleRadians));
+        MaskTerm.push_back(std::sin(mask) * std::sin(mask));
+        return index;
+    }
+
+    template<class T>
+    T BasicGroundStations<T>::Elevation(std::size_t station, T earthRadius, T x, T y) const {
+        auto dx = x - earthRadius * UpX[station];
+        auto dy = y - earthRadius * UpY[station];
+        auto up = dx * UpX[station] + dy * UpY[station];
+        auto across = dx * UpY[station] - dy * UpX[station];
+        return std::atan2(up, std::abs(across));
+    }
+
+    template<class T>
+    void BasicGroundStations<T>::Margins(std::size_t station, T earthRadius, const T* x, const T* y, T* margin, std::size_t n) const {
+        Simd::VisibilityRow<T> row = {};
+        row.StationX = earthRadius * UpX[station];
+        row.StationY = earthRadius * UpY[station];
+        row.UpX = UpX[station];
+        row.UpY = UpY[station];
+        row.MaskTerm = MaskTerm[station];
+        row.X = x;
+        row.Y = y;
+        row.Margin = margin;
+        Simd::EvaluateVisibility(row, n);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    template<class T>
+    const std::vector<ContactWindow>& BasicContactPlanner<T>::Plan(const BasicGroundStations<T>& stations, const BasicKeplerCatalog<T>& catalog, T earthRadius,
+                                                                   const ContactSettings& settings, ThreadPool& pool) {
+        SIMULATION_PROFILE_ZONE("ContactPlanner::Plan");
+        windows.clear();
+        stats = {};
+        auto stationCount = stations.Size();
+        auto n = catalog.Size();
+        auto begin = settings.BeginSeconds, end = settings.EndSeconds;
+        if (stationCount == 0 || n == 0 || !(end > begin) || !(settings.SampleSeconds > 0)) {
+            return windows;
+        }
+
+        // The last sample lands on the end of the range
+        auto samples = (std::size_t)std::ceil((end - begin) / settings.SampleSeconds) + 1;
+        auto timeOf = [&](std::size_t k) {
+            return std::min(begin + k * settings.SampleSeconds, end);
+        };
+        stats.Samples = samples;
+
+        x.resize(BlockSamples * n);
+        y.resize(BlockSamples * n);
+        margins[0].resize(stationCount * n);
+        margins[1].resize(stationCount * n);
+        rise.assign(stationCount * n, std::numeric_limits<double>::quiet_NaN());
+        if (workspaces.size() < stationCount) {
+            workspaces.resize(stationCount);
+        }
+        for (std::size_t s = 0; s < stationCount; s++) {
+            workspaces[s].Windows.clear();
+            workspaces[s].Stats = {};
+        }
+
+        for (std::size_t first = 0; first < samples; first += BlockSamples) {
+            auto count = std::min(BlockSamples, samples - first);
+            pool.ParallelFor(count, [&](std::size_t k) {
+                catalog.Propagate(PhaseScalar<T>(timeOf(first + k)), x.data() + k * n, y.data() + k * n);
+            });
+
+            pool.ParallelFor(stationCount, [&](std::size_t s) {
+                auto& work = workspaces[s];
+                auto open = rise.data() + s * n;
+                work.Crossings.clear();
+                for (std::size_t k = 0; k < count; k++) {
+                    auto sample = first + k;
+                    auto current = margins[sample & 1].data() + s * n;
+                    stations.Margins(s, earthRadius, x.data() + k * n, y.data() + k * n, current, n);
+                    work.Stats.Evaluations += n;
+                    if (sample == 0) {
+                        for (std::size_t i = 0; i < n; i++) {
+                            if (current[i] >= T(0)) {
+                                open[i] = begin;
+                            }
+                        }
+                        continue;
+                    }
+
+                    auto previous = margins[(sample & 1) ^ 1].data() + s * n;
+                    for (std::size_t i = 0; i < n; i++) {
+                        if ((current[i] >= T(0)) != (previous[i] >= T(0))) {
+                            work.Crossings.push_back({ (std::uint32_t)i, current[i] >= T(0), 0, timeOf(sample - 1), timeOf(sample), 0.0, 0.0 });
+                        }
+                    }
+                }
+
+                Refine(stations, catalog, earthRadius, s, settings.ToleranceSeconds, work);
+                // Found sample by sample, so in time order for each satellite
+                for (const auto& crossing : work.Crossings) {
+                    auto t = (crossing.Begin + crossing.End) / 2;
+                    auto i = crossing.Satellite;
+                    if (crossing.Rising) {
+                        open[i] = t;
+                    }
+                    else {
+                        work.Windows.push_back({ (std::uint32_t)s, i, open[i], t });
+                        open[i] = std::numeric_limits<double>::quiet_NaN();
+                    }
+                }
+                work.Stats.Crossings += work.Crossings.size();
+            });
+        }
+
+        // Close what is still open at the end of the range, then order each station's windows
+        pool.ParallelFor(stationCount, [&](std::size_t s) {
+            auto open = rise.data() + s * n;
+            auto& found = workspaces[s].Windows;
+            for (std::size_t i = 0; i < n; i++) {
+                if (!std::isnan(open[i])) {
+                    found.push_back({ (std::uint32_t)s, (std::uint32_t)i, open[i], end });
+                }
+            }
+            std::sort(found.begin(), found.end(), [](const ContactWindow& a, const ContactWindow& b) {
+                return a.Satellite != b.Satellite ? a.Satellite < b.Satellite : a.Rise < b.Rise;
+            });
+        });
+
+        for (std::size_t s = 0; s < stationCount; s++) {
+            const auto& work = workspaces[s];
+            windows.insert(windows.end(), work.Windows.begin(), work.Windows.end());
+            stats.Evaluations += work.Stats.Evaluations;
+            stats.Crossings += work.Stats.Crossings;
+            stats.RefineSteps += work.Stats.RefineSteps;
+        }
+        return windows;
+    }
+
+    template<class T>
+    const std::vector<ContactWindow>& BasicContactPlanner<T>::Windows() const {
+        return windows;
+    }
+
+    template<class T>
+    const ContactStats& BasicContactPlanner<T>::Stats() const {
+        return stats;
+    }
+
+    // False position keeps each sign change bracketed, and halving the end that stays put twice in
+    // a row (Illinois) stops it from creeping up on the root from one side only. It works on
+    // sin(elevation) - sin(mask) rather than the margin, whose slope vanishes at a zero mask.
+    // Every step locates all the unfinished crossings in one pass of the vector Kepler solver.
+    template<class T>
+    void BasicContactPlanner<T>::Refine(const BasicGroundStations<T>& stations, const BasicKeplerCatalog<T>& catalog, T earthRadius,
+                                        std::size_t station, double tolerance, Workspace& work) const {
+        constexpr auto MaxSteps = 64;
+        auto& crossings = work.Crossings;
+        if (crossings.empty()) {
+            return;
+        }
+        auto upX = (double)stations.UpX[station], upY = (double)stations.UpY[station];
+        auto stationX = (double)earthRadius * upX, stationY = (double)earthRadius * upY;
+        auto sinMask = std::sin((double)stations.MinElevation[station]);
+
+        // The satellites of the active crossings at work.Times
+        auto locate = [&]() {
+            auto count = work.Active.size();
+            work.Satellites.resize(count);
+            work.X.resize(count);
+            work.Y.resize(count);
+            for (std::size_t j = 0; j < count; j++) {
+                work.Satellites[j] = crossings[work.Active[j]].Satellite;
+            }
+            catalog.PositionsAt(work.Satellites.data(), work.Times.data(), count, work.X.data(), work.Y.data());
+            work.Stats.RefineSteps += count;
+        };
+        auto value = [&](std::size_t j) {
+            auto dx = (double)work.X[j] - stationX, dy = (double)work.Y[j] - stationY;
+            return (dx * upX + dy * upY) / std::sqrt(dx * dx + dy * dy) - sinMask;
+        };
+
+        // Both ends of every bracket. The sample grid decided which side each end is on, keep that
+        // even where the two ways of measuring round differently.
+        work.Active.resize(crossings.size());
+        work.Times.resize(crossings.size());
+        for (auto atEnd : { false, true }) {
+            for (std::size_t j = 0; j < crossings.size(); j++) {
+                work.Active[j] = (std::uint32_t)j;
+                work.Times[j] = PhaseScalar<T>(atEnd ? crossings[j].End : crossings[j].Begin);
+            }
+            locate();
+            for (std::size_t j = 0; j < crossings.size(); j++) {
+                auto& c = crossings[j];
+                auto visible = c.Rising == atEnd;
+                auto size = std::max(std::abs(value(j)), 1e-300);
+                (atEnd ? c.EndValue : c.BeginValue) = visible ? size : -size;
+            }
+        }
+
+        for (int step = 0; step < MaxSteps; step++) {
+            work.Active.clear();
+            work.Times.clear();
+            for (std::size_t j = 0; j < crossings.size(); j++) {
+                const auto& c = crossings[j];
+                if (c.End - c.Begin <= tolerance) {
+                    continue;
+                }
+                auto t = (c.Begin * c.EndValue - c.End * c.BeginValue) / (c.EndValue - c.BeginValue);
+                if (!(t > c.Begin && t < c.End)) {
+                    t = (c.Begin + c.End) / 2;
+                }
+                work.Active.push_back((std::uint32_t)j);
+                work.Times.push_back(PhaseScalar<T>(t));
+            }
+            if (work.Active.empty()) {
+                break;
+            }
+            locate();
+
+            for (std::size_t j = 0; j < work.Active.size(); j++) {
+                auto& c = crossings[work.Active[j]];
+                auto t = (double)work.Times[j];
+                auto f = value(j);
+                // Visible counts as the non-negative side, as on the sample grid
+                if ((f >= 0.0) == (c.EndValue >= 0.0)) {
+                    c.End = t;
+                    c.EndValue = f;
+                    if (c.Kept == -1) {
+                        c.BeginValue /= 2;
+                    }
+                    c.Kept = -1;
+                }
+                else {
+                    c.Begin = t;
+                    c.BeginValue = f;
+                    if (c.Kept == 1) {
+                        c.EndValue /= 2;
+                    }
+                    c.Kept = 1;
+                }
+            }
+        }
+    }
+
+    template class BasicGroundStations<float>;
+    template class BasicGroundStations<double>;
+    template class BasicGroundStations<long double>;
+
+    template class BasicContactPlanner<float>;
+    template class BasicContactPlanner<double>;
+    template class BasicContactPlanner<long double>;
+}